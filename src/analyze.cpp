@@ -0,0 +1,287 @@
+#include "analyze.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "bbinit.h"
+#include "board.h"
+#include "search.h"
+#include "searchparams.h"
+#include "threadpool.h"
+
+namespace bby {
+
+namespace {
+
+struct AnalyzeConfig {
+  std::string path;  // empty or "-" reads stdin
+  int depth{-1};
+  std::int64_t movetime_ms{-1};
+  std::int64_t nodes_limit{-1};
+  int threads{0};
+  std::size_t hash_mb{16};
+};
+
+struct WorkItem {
+  std::size_t index{0};
+  std::string fen;
+};
+
+// Bounded handoff between the reading thread and the searchers: push blocks
+// when the queue is full so a fast reader cannot buffer a multi-gigabyte
+// input, pop blocks until an item arrives or the stream is closed and drained.
+class BoundedQueue {
+public:
+  explicit BoundedQueue(std::size_t capacity) : capacity_(capacity) {}
+
+  void push(WorkItem item) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(lock, [this] { return items_.size() < capacity_; });
+    items_.push_back(std::move(item));
+    lock.unlock();
+    not_empty_.notify_one();
+  }
+
+  bool pop(WorkItem& out) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_empty_.wait(lock, [this] { return !items_.empty() || closed_; });
+    if (items_.empty()) {
+      return false;
+    }
+    out = std::move(items_.front());
+    items_.pop_front();
+    lock.unlock();
+    not_full_.notify_one();
+    return true;
+  }
+
+  void close() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+    }
+    not_empty_.notify_all();
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable not_full_;
+  std::condition_variable not_empty_;
+  std::deque<WorkItem> items_;
+  std::size_t capacity_;
+  bool closed_{false};
+};
+
+bool parse_int(std::string_view token, long long& out) {
+  if (token.empty()) {
+    return false;
+  }
+  char* end = nullptr;
+  const std::string copy(token);
+  const long long value = std::strtoll(copy.c_str(), &end, 10);
+  if (end == copy.c_str() || (end && *end != '\0')) {
+    return false;
+  }
+  out = value;
+  return true;
+}
+
+AnalyzeConfig parse_cli_arguments(int argc, const char* argv[]) {
+  AnalyzeConfig cfg;
+  for (int idx = 0; idx < argc; ++idx) {
+    std::string_view arg(argv[idx]);
+    auto consume_next = [&](long long& out) -> bool {
+      if (idx + 1 >= argc) {
+        return false;
+      }
+      ++idx;
+      return parse_int(argv[idx], out);
+    };
+
+    if (arg == "--depth") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.depth = static_cast<int>(std::max<long long>(1, value));
+      }
+    } else if (arg == "--movetime") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.movetime_ms = std::max<long long>(1, value);
+      }
+    } else if (arg == "--nodes") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.nodes_limit = std::max<long long>(1, value);
+      }
+    } else if (arg == "--threads") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.threads = static_cast<int>(std::clamp<long long>(value, 1, 512));
+      }
+    } else if (arg == "--hash") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.hash_mb = static_cast<std::size_t>(std::max<long long>(1, value));
+      }
+    } else if (arg == "--help" || arg == "-h") {
+      std::printf("Usage: bby analyze [FILE] [--depth N] [--movetime MS]\n");
+      std::printf("                   [--nodes LIMIT] [--threads N] [--hash MB]\n");
+      std::printf("Reads one FEN per line (stdin when FILE is absent or '-');\n");
+      std::printf("emits one JSON object per position as searches complete.\n");
+      std::fflush(stdout);
+      std::exit(0);
+    } else if (cfg.path.empty()) {
+      cfg.path = std::string(arg);
+    }
+  }
+  return cfg;
+}
+
+std::string escape_json(std::string_view text) {
+  std::string out;
+  out.reserve(text.size());
+  for (const char c : text) {
+    if (c == '"' || c == '\\') {
+      out.push_back('\\');
+    }
+    out.push_back(c);
+  }
+  return out;
+}
+
+// Emits one line of JSONL under the lock; results stream in completion
+// order, so consumers needing input order sort on "index".
+void emit_result(std::mutex& out_mutex, const WorkItem& item,
+                 const SearchResult& result, std::int64_t time_ms) {
+  std::string pv;
+  for (const Move m : result.pv) {
+    if (!pv.empty()) {
+      pv.push_back(' ');
+    }
+    pv += move_to_uci(m);
+  }
+  std::lock_guard<std::mutex> lock(out_mutex);
+  std::printf("{\"index\": %zu, \"fen\": \"%s\", \"best\": \"%s\", \"eval\": %d, "
+              "\"depth\": %d, \"seldepth\": %d, \"nodes\": %lld, \"time_ms\": %lld, "
+              "\"pv\": \"%s\"}\n",
+              item.index, escape_json(item.fen).c_str(),
+              move_to_uci(result.best).c_str(), static_cast<int>(result.eval),
+              result.depth, result.seldepth,
+              static_cast<long long>(result.nodes),
+              static_cast<long long>(time_ms), pv.c_str());
+  std::fflush(stdout);
+}
+
+void emit_error(std::mutex& out_mutex, const WorkItem& item, const char* message) {
+  std::lock_guard<std::mutex> lock(out_mutex);
+  std::printf("{\"index\": %zu, \"fen\": \"%s\", \"error\": \"%s\"}\n", item.index,
+              escape_json(item.fen).c_str(), message);
+  std::fflush(stdout);
+}
+
+}  // namespace
+
+int analyze_cli_main(int argc, const char* argv[]) {
+  (void)initialize();
+  const AnalyzeConfig cfg = parse_cli_arguments(argc, argv);
+
+  std::ifstream file;
+  const bool use_stdin = cfg.path.empty() || cfg.path == "-";
+  if (!use_stdin) {
+    file.open(cfg.path);
+    if (!file) {
+      std::fprintf(stderr, "analyze: failed to open %s\n", cfg.path.c_str());
+      return 2;
+    }
+  }
+  std::istream& input = use_stdin ? std::cin : file;
+
+  const int threads =
+      (cfg.threads > 0)
+          ? cfg.threads
+          : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+  // Same re-entrancy rule as the testsuite runner: hash allocation may clear
+  // through worker_pool(), so sessions are built before workers start.
+  std::vector<std::unique_ptr<SearchSession>> sessions;
+  sessions.reserve(static_cast<std::size_t>(threads));
+  for (int idx = 0; idx < threads; ++idx) {
+    sessions.push_back(std::make_unique<SearchSession>());
+    sessions.back()->set_hash_size(cfg.hash_mb);
+  }
+
+  Limits limits;
+  if (cfg.depth > 0) {
+    limits.depth = static_cast<std::int16_t>(cfg.depth);
+  }
+  if (cfg.movetime_ms > 0) {
+    limits.movetime_ms = cfg.movetime_ms;
+  }
+  if (cfg.nodes_limit > 0) {
+    limits.nodes = cfg.nodes_limit;
+  }
+  if (cfg.depth <= 0 && cfg.movetime_ms <= 0 && cfg.nodes_limit <= 0) {
+    // An unbounded batch search would never finish the first position.
+    limits.depth = 10;
+  }
+
+  BoundedQueue queue(static_cast<std::size_t>(threads) * 4);
+  std::mutex out_mutex;
+
+  ThreadPool& pool = worker_pool();
+  pool.launch(static_cast<std::size_t>(threads), [&](std::size_t worker) {
+    SearchSession& session = *sessions[worker];
+    WorkItem item;
+    while (queue.pop(item)) {
+      Position pos;
+      try {
+        pos = Position::from_fen(item.fen, false);
+      } catch (const std::exception&) {
+        emit_error(out_mutex, item, "invalid FEN");
+        continue;
+      }
+      const auto start = std::chrono::steady_clock::now();
+      const SearchResult result = session.run(pos, limits);
+      const auto time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+      emit_result(out_mutex, item, result, time_ms);
+    }
+  });
+
+  // The reader stays on this thread: the bounded queue throttles it against
+  // the searchers, so memory use is flat no matter how large the input is.
+  std::size_t index = 0;
+  std::string line;
+  while (std::getline(input, line)) {
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    const auto content = line.find_first_not_of(" \t");
+    if (content == std::string::npos || line[content] == '#') {
+      continue;
+    }
+    WorkItem item;
+    item.index = index++;
+    item.fen = line;
+    queue.push(std::move(item));
+  }
+  queue.close();
+  pool.wait();
+  return 0;
+}
+
+}  // namespace bby
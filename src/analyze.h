@@ -0,0 +1,8 @@
+#pragma once
+// analyze.h -- Streaming batch-analysis entry point behind the `analyze` CLI mode.
+
+namespace bby {
+
+int analyze_cli_main(int argc, const char* argv[]);
+
+}  // namespace bby
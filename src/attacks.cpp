@@ -4,8 +4,13 @@
 #include <bit>
 #include <cstdint>
 
-#if defined(__BMI2__) || defined(_MSC_VER)
+#if defined(__x86_64__) || defined(_M_X64)
 #include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
 #endif
 
 namespace bby {
@@ -86,7 +91,7 @@ constexpr std::array<Bitboard, 64> kBlackPawnAttacks = [] {
   return table;
 }();
 
-Bitboard bishop_attacks_on_the_fly(Square sq, Bitboard occ) {
+constexpr Bitboard bishop_attacks_on_the_fly(Square sq, Bitboard occ) {
   Bitboard attacks = 0ULL;
   const int file = static_cast<int>(file_of(sq));
   const int rank = static_cast<int>(rank_of(sq));
@@ -113,7 +118,7 @@ Bitboard bishop_attacks_on_the_fly(Square sq, Bitboard occ) {
   return attacks;
 }
 
-Bitboard rook_attacks_on_the_fly(Square sq, Bitboard occ) {
+constexpr Bitboard rook_attacks_on_the_fly(Square sq, Bitboard occ) {
   Bitboard attacks = 0ULL;
   const int file = static_cast<int>(file_of(sq));
   const int rank = static_cast<int>(rank_of(sq));
@@ -140,7 +145,7 @@ Bitboard rook_attacks_on_the_fly(Square sq, Bitboard occ) {
   return attacks;
 }
 
-Bitboard mask_bishop(Square sq) {
+constexpr Bitboard mask_bishop(Square sq) {
   Bitboard mask = 0ULL;
   const int file = static_cast<int>(file_of(sq));
   const int rank = static_cast<int>(rank_of(sq));
@@ -159,7 +164,7 @@ Bitboard mask_bishop(Square sq) {
   return mask;
 }
 
-Bitboard mask_rook(Square sq) {
+constexpr Bitboard mask_rook(Square sq) {
   Bitboard mask = 0ULL;
   const int file = static_cast<int>(file_of(sq));
   const int rank = static_cast<int>(rank_of(sq));
@@ -178,7 +183,7 @@ Bitboard mask_rook(Square sq) {
   return mask;
 }
 
-Bitboard set_occupancy(std::uint64_t index, int bits, Bitboard mask) {
+constexpr Bitboard set_occupancy(std::uint64_t index, int bits, Bitboard mask) {
   Bitboard occ = 0ULL;
   for (int i = 0; i < bits; ++i) {
     const Bitboard lsb = mask & -mask;
@@ -190,101 +195,130 @@ Bitboard set_occupancy(std::uint64_t index, int bits, Bitboard mask) {
   return occ;
 }
 
-#if defined(__BMI2__) || defined(_MSC_VER)
+constexpr std::array<int, 64> kBishopRelevantBits = {
+    6, 5, 5, 5, 5, 5, 5, 6,
+    5, 5, 5, 5, 5, 5, 5, 5,
+    5, 5, 7, 7, 7, 7, 5, 5,
+    5, 5, 7, 9, 9, 7, 5, 5,
+    5, 5, 7, 9, 9, 7, 5, 5,
+    5, 5, 7, 7, 7, 7, 5, 5,
+    5, 5, 5, 5, 5, 5, 5, 5,
+    6, 5, 5, 5, 5, 5, 5, 6};
+
+constexpr std::array<int, 64> kRookRelevantBits = {
+    12, 11, 11, 11, 11, 11, 11, 12,
+    11, 10, 10, 10, 10, 10, 10, 11,
+    11, 10, 10, 10, 10, 10, 10, 11,
+    11, 10, 10, 10, 10, 10, 10, 11,
+    11, 10, 10, 10, 10, 10, 10, 11,
+    11, 10, 10, 10, 10, 10, 10, 11,
+    11, 10, 10, 10, 10, 10, 10, 11,
+    12, 11, 11, 11, 11, 11, 11, 12};
+
+// Flattened move-table layout: each square owns 2^relevant_bits entries
+// starting at its offset, so the whole slider database is ~840 KB instead
+// of a 6 MB array padded to the worst-case square. Everything below is
+// built at compile time and lands in .rodata: processes start with the
+// tables ready and the loader shares the pages across concurrent engines.
+constexpr std::size_t table_size(const std::array<int, 64>& bits) {
+  std::size_t total = 0;
+  for (int sq = 0; sq < 64; ++sq) {
+    total += static_cast<std::size_t>(1) << bits[sq];
+  }
+  return total;
+}
+
+constexpr std::array<std::uint32_t, 64> table_offsets(const std::array<int, 64>& bits) {
+  std::array<std::uint32_t, 64> offsets{};
+  std::uint32_t total = 0;
+  for (int sq = 0; sq < 64; ++sq) {
+    offsets[sq] = total;
+    total += static_cast<std::uint32_t>(1) << bits[sq];
+  }
+  return offsets;
+}
+
+constexpr std::size_t kBishopTableSize = table_size(kBishopRelevantBits);
+constexpr std::size_t kRookTableSize = table_size(kRookRelevantBits);
+constexpr std::array<std::uint32_t, 64> kBishopOffsets = table_offsets(kBishopRelevantBits);
+constexpr std::array<std::uint32_t, 64> kRookOffsets = table_offsets(kRookRelevantBits);
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define BBY_HAVE_PEXT 1
+// Compiled for BMI2 regardless of the baseline -m flags; only ever called
+// after the cpuid check below has confirmed the instruction is fast.
+#if defined(_MSC_VER)
 inline std::uint64_t hardware_pext(std::uint64_t src, std::uint64_t mask) {
   return _pext_u64(src, mask);
 }
-
-constexpr std::size_t kMaxRookKey = 1ULL << 12;
-constexpr std::size_t kMaxBishopKey = 1ULL << 13;
+#else
+__attribute__((target("bmi2"))) inline std::uint64_t hardware_pext(
+    std::uint64_t src, std::uint64_t mask) {
+  return _pext_u64(src, mask);
+}
+#endif
 
 struct PextTables {
   std::array<Bitboard, 64> bishop_masks{};
-  std::array<std::uint8_t, 64> bishop_bits{};
-  std::array<std::array<Bitboard, kMaxBishopKey>, 64> bishop_moves{};
+  std::array<Bitboard, kBishopTableSize> bishop_moves{};
   std::array<Bitboard, 64> rook_masks{};
-  std::array<std::uint8_t, 64> rook_bits{};
-  std::array<std::array<Bitboard, kMaxRookKey>, 64> rook_moves{};
+  std::array<Bitboard, kRookTableSize> rook_moves{};
 };
 
-PextTables build_pext_tables() {
+constexpr PextTables build_pext_tables() {
   PextTables tables{};
   for (int sq = 0; sq < 64; ++sq) {
     const Square square = static_cast<Square>(sq);
 
     const Bitboard bishop_mask = mask_bishop(square);
-    const std::uint8_t bishop_bits = static_cast<std::uint8_t>(std::popcount(bishop_mask));
     tables.bishop_masks[sq] = bishop_mask;
-    tables.bishop_bits[sq] = bishop_bits;
+    const int bishop_bits = kBishopRelevantBits[sq];
     const std::uint64_t bishop_limit = 1ULL << bishop_bits;
     for (std::uint64_t idx = 0; idx < bishop_limit; ++idx) {
       const Bitboard occ = set_occupancy(idx, bishop_bits, bishop_mask);
-      tables.bishop_moves[sq][idx] = bishop_attacks_on_the_fly(square, occ);
+      tables.bishop_moves[kBishopOffsets[sq] + idx] =
+          bishop_attacks_on_the_fly(square, occ);
     }
 
     const Bitboard rook_mask = mask_rook(square);
-    const std::uint8_t rook_bits = static_cast<std::uint8_t>(std::popcount(rook_mask));
     tables.rook_masks[sq] = rook_mask;
-    tables.rook_bits[sq] = rook_bits;
+    const int rook_bits = kRookRelevantBits[sq];
     const std::uint64_t rook_limit = 1ULL << rook_bits;
     for (std::uint64_t idx = 0; idx < rook_limit; ++idx) {
       const Bitboard occ = set_occupancy(idx, rook_bits, rook_mask);
-      tables.rook_moves[sq][idx] = rook_attacks_on_the_fly(square, occ);
+      tables.rook_moves[kRookOffsets[sq] + idx] =
+          rook_attacks_on_the_fly(square, occ);
     }
   }
   return tables;
 }
 
-const PextTables& pext_tables() {
-  static const PextTables tables = build_pext_tables();
-  return tables;
-}
-#else
-
-constexpr std::array<int, 64> kBishopRelevantBits = {
-    6, 5, 5, 5, 5, 5, 5, 6,
-    5, 5, 5, 5, 5, 5, 5, 5,
-    5, 5, 7, 7, 7, 7, 5, 5,
-    5, 5, 7, 9, 9, 7, 5, 5,
-    5, 5, 7, 9, 9, 7, 5, 5,
-    5, 5, 7, 7, 7, 7, 5, 5,
-    5, 5, 5, 5, 5, 5, 5, 5,
-    6, 5, 5, 5, 5, 5, 5, 6};
-
-constexpr std::array<int, 64> kRookRelevantBits = {
-    12, 11, 11, 11, 11, 11, 11, 12,
-    11, 10, 10, 10, 10, 10, 10, 11,
-    11, 10, 10, 10, 10, 10, 10, 11,
-    11, 10, 10, 10, 10, 10, 10, 11,
-    11, 10, 10, 10, 10, 10, 10, 11,
-    11, 10, 10, 10, 10, 10, 10, 11,
-    11, 10, 10, 10, 10, 10, 10, 11,
-    12, 11, 11, 11, 11, 11, 11, 12};
+constexpr PextTables kPextTables = build_pext_tables();
+#endif  // BBY_HAVE_PEXT
 
 constexpr std::array<std::uint64_t, 64> kBishopMagics = {
-    0x007fbfbfbfbfbfffULL, 0x0000a060401007fcULL, 0x0001004008020000ULL,
-    0x0000806004000000ULL, 0x0000100400000000ULL, 0x000021c100b20000ULL,
-    0x0000040041001000ULL, 0x0000020040008000ULL, 0x0000040002008080ULL,
-    0x0000020005004040ULL, 0x0000020004220010ULL, 0x0000002002120004ULL,
-    0x0000002040422000ULL, 0x0000001002020000ULL, 0x0000000902020000ULL,
-    0x0000000402020000ULL, 0x0000004040802000ULL, 0x0000002002081000ULL,
-    0x0000002010080800ULL, 0x0000001004000800ULL, 0x0000004040040500ULL,
-    0x0000001000200200ULL, 0x0000008040002000ULL, 0x0000006820004000ULL,
-    0x0000004000802080ULL, 0x0000002000401000ULL, 0x0000001000200800ULL,
-    0x0000000800100100ULL, 0x0000000400080080ULL, 0x0000000200040040ULL,
-    0x0000000100020020ULL, 0x0000008040200040ULL, 0x0000004020100080ULL,
-    0x0000002008080040ULL, 0x0000001004040020ULL, 0x0000000802020010ULL,
-    0x0000000401010008ULL, 0x0000000200808004ULL, 0x00007fffec002000ULL,
-    0x0000004020010080ULL, 0x0000004010008080ULL, 0x0000002008004040ULL,
-    0x0000001004010020ULL, 0x0000000802008024ULL, 0x000000040100800aULL,
-    0x00007fffe8004000ULL, 0x0000002040008040ULL, 0x0000002010004080ULL,
-    0x0000002008080040ULL, 0x0000001004010020ULL, 0x0000000802008010ULL,
-    0x0000000401008008ULL, 0x00007fffb0002000ULL, 0x0000004020004080ULL,
-    0x0000004010002040ULL, 0x0000002008001000ULL, 0x0000001004000800ULL,
-    0x0000000802000400ULL, 0x0000000401000200ULL, 0x00003fff80002000ULL,
-    0x0000200040008080ULL, 0x0000200020004040ULL, 0x0000100020002020ULL,
-    0x0000100010001010ULL, 0x0000080008000808ULL, 0x0000040004000404ULL,
-    0x0000020002000202ULL, 0x0000010001000101ULL};
+    0x0040040844404084ULL, 0x002004208a004208ULL, 0x0010190041080202ULL,
+    0x0108060845042010ULL, 0x0581104180800210ULL, 0x2112080446200010ULL,
+    0x1080820820060210ULL, 0x03c0808410220200ULL, 0x0004050404440404ULL,
+    0x0000021001420088ULL, 0x24d0080801082102ULL, 0x0001020a0a020400ULL,
+    0x0000040308200402ULL, 0x0004011002100800ULL, 0x0401484104104005ULL,
+    0x0801010402020200ULL, 0x00400210c3880100ULL, 0x0404022024108200ULL,
+    0x0810018200204102ULL, 0x0004002801a02003ULL, 0x0085040820080400ULL,
+    0x810102c808880400ULL, 0x000e900410884800ULL, 0x8002020480840102ULL,
+    0x0220200865090201ULL, 0x2010100a02021202ULL, 0x0152048408022401ULL,
+    0x0020080002081110ULL, 0x4001001021004000ULL, 0x800040400a011002ULL,
+    0x00e4004081011002ULL, 0x001c004001012080ULL, 0x8004200962a00220ULL,
+    0x8422100208500202ULL, 0x2000402200300c08ULL, 0x8646020080080080ULL,
+    0x80020a0200100808ULL, 0x2010004880111000ULL, 0x623000a080011400ULL,
+    0x42008c0340209202ULL, 0x0209188240001000ULL, 0x400408a884001800ULL,
+    0x00110400a6080400ULL, 0x1840060a44020800ULL, 0x0090080104000041ULL,
+    0x0201011000808101ULL, 0x1a2208080504f080ULL, 0x8012020600211212ULL,
+    0x0500861011240000ULL, 0x0180806108200800ULL, 0x4000020e01040044ULL,
+    0x300000261044000aULL, 0x0802241102020002ULL, 0x0020906061210001ULL,
+    0x5a84841004010310ULL, 0x0004010801011c04ULL, 0x000a010109502200ULL,
+    0x0000004a02012000ULL, 0x500201010098b028ULL, 0x8040002811040900ULL,
+    0x0028000010020204ULL, 0x06000020202d0240ULL, 0x8918844842082200ULL,
+    0x4010011029020020ULL};
 
 constexpr std::array<std::uint64_t, 64> kRookMagics = {
     0x8a80104000800020ULL, 0x140002000100040ULL, 0x2801880a0017001ULL,
@@ -310,21 +344,16 @@ constexpr std::array<std::uint64_t, 64> kRookMagics = {
     0x20030a0244872ULL, 0x12001008414402ULL, 0x2006104900a0804ULL,
     0x1004081002402ULL};
 
-constexpr std::size_t kMaxMagicRookSize = 1ULL << 12;
-constexpr std::size_t kMaxMagicBishopSize = 1ULL << 13;
-
 struct MagicTables {
   std::array<Bitboard, 64> bishop_masks{};
-  std::array<std::uint64_t, 64> bishop_magics{};
   std::array<std::uint8_t, 64> bishop_shifts{};
-  std::array<std::array<Bitboard, kMaxMagicBishopSize>, 64> bishop_moves{};
+  std::array<Bitboard, kBishopTableSize> bishop_moves{};
   std::array<Bitboard, 64> rook_masks{};
-  std::array<std::uint64_t, 64> rook_magics{};
   std::array<std::uint8_t, 64> rook_shifts{};
-  std::array<std::array<Bitboard, kMaxMagicRookSize>, 64> rook_moves{};
+  std::array<Bitboard, kRookTableSize> rook_moves{};
 };
 
-MagicTables build_magic_tables() {
+constexpr MagicTables build_magic_tables() {
   MagicTables tables{};
   for (int sq = 0; sq < 64; ++sq) {
     const Square square = static_cast<Square>(sq);
@@ -332,81 +361,150 @@ MagicTables build_magic_tables() {
     const Bitboard bmask = mask_bishop(square);
     const int brel = kBishopRelevantBits[sq];
     tables.bishop_masks[sq] = bmask;
-    tables.bishop_magics[sq] = kBishopMagics[sq];
     tables.bishop_shifts[sq] = static_cast<std::uint8_t>(64 - brel);
-    const std::uint64_t bishop_magic = tables.bishop_magics[sq];
-    const int bishop_shift = tables.bishop_shifts[sq];
+    const std::uint64_t bishop_magic = kBishopMagics[sq];
+    const int bishop_shift = 64 - brel;
     const std::uint64_t bishop_limit = 1ULL << brel;
     for (std::uint64_t idx = 0; idx < bishop_limit; ++idx) {
       const Bitboard occ = set_occupancy(idx, brel, bmask);
       const std::size_t key = static_cast<std::size_t>((occ * bishop_magic) >> bishop_shift);
-      tables.bishop_moves[sq][key] = bishop_attacks_on_the_fly(square, occ);
+      const Bitboard attacks = bishop_attacks_on_the_fly(square, occ);
+      Bitboard& slot = tables.bishop_moves[kBishopOffsets[sq] + key];
+      if (slot != 0ULL && slot != attacks) {
+        throw "bishop magic collision";  // non-constant: fails the build
+      }
+      slot = attacks;
     }
 
     const Bitboard rmask = mask_rook(square);
     const int rrel = kRookRelevantBits[sq];
     tables.rook_masks[sq] = rmask;
-    tables.rook_magics[sq] = kRookMagics[sq];
     tables.rook_shifts[sq] = static_cast<std::uint8_t>(64 - rrel);
-    const std::uint64_t rook_magic = tables.rook_magics[sq];
-    const int rook_shift = tables.rook_shifts[sq];
+    const std::uint64_t rook_magic = kRookMagics[sq];
+    const int rook_shift = 64 - rrel;
     const std::uint64_t rook_limit = 1ULL << rrel;
     for (std::uint64_t idx = 0; idx < rook_limit; ++idx) {
       const Bitboard occ = set_occupancy(idx, rrel, rmask);
       const std::size_t key = static_cast<std::size_t>((occ * rook_magic) >> rook_shift);
-      tables.rook_moves[sq][key] = rook_attacks_on_the_fly(square, occ);
+      const Bitboard attacks = rook_attacks_on_the_fly(square, occ);
+      Bitboard& slot = tables.rook_moves[kRookOffsets[sq] + key];
+      if (slot != 0ULL && slot != attacks) {
+        throw "rook magic collision";  // non-constant: fails the build
+      }
+      slot = attacks;
     }
   }
   return tables;
 }
 
-const MagicTables& magic_tables() {
-  static const MagicTables tables = build_magic_tables();
-  return tables;
+constexpr MagicTables kMagicTables = build_magic_tables();
+
+Bitboard rook_attacks_magic(Square sq, Bitboard occ) {
+  const int idx = static_cast<int>(sq);
+  const Bitboard mask = kMagicTables.rook_masks[idx];
+  const std::uint64_t key = ((occ & mask) * kRookMagics[idx]) >> kMagicTables.rook_shifts[idx];
+  return kMagicTables.rook_moves[kRookOffsets[idx] + key];
+}
+
+Bitboard bishop_attacks_magic(Square sq, Bitboard occ) {
+  const int idx = static_cast<int>(sq);
+  const Bitboard mask = kMagicTables.bishop_masks[idx];
+  const std::uint64_t key = ((occ & mask) * kBishopMagics[idx]) >> kMagicTables.bishop_shifts[idx];
+  return kMagicTables.bishop_moves[kBishopOffsets[idx] + key];
+}
+
+#if defined(BBY_HAVE_PEXT)
+#if defined(_MSC_VER)
+Bitboard rook_attacks_pext(Square sq, Bitboard occ) {
+  const int idx = static_cast<int>(sq);
+  return kPextTables.rook_moves[kRookOffsets[idx] +
+                                hardware_pext(occ, kPextTables.rook_masks[idx])];
+}
+
+Bitboard bishop_attacks_pext(Square sq, Bitboard occ) {
+  const int idx = static_cast<int>(sq);
+  return kPextTables.bishop_moves[kBishopOffsets[idx] +
+                                  hardware_pext(occ, kPextTables.bishop_masks[idx])];
+}
+#else
+__attribute__((target("bmi2"))) Bitboard rook_attacks_pext(Square sq, Bitboard occ) {
+  const int idx = static_cast<int>(sq);
+  return kPextTables.rook_moves[kRookOffsets[idx] +
+                                hardware_pext(occ, kPextTables.rook_masks[idx])];
+}
+
+__attribute__((target("bmi2"))) Bitboard bishop_attacks_pext(Square sq, Bitboard occ) {
+  const int idx = static_cast<int>(sq);
+  return kPextTables.bishop_moves[kBishopOffsets[idx] +
+                                  hardware_pext(occ, kPextTables.bishop_masks[idx])];
 }
 #endif
 
+// CPUID gate for the PEXT path: the instruction must exist, and it must not
+// be the microcoded implementation on pre-Zen3 AMD parts (families below
+// 0x19), where a PEXT can cost hundreds of cycles and the magic path wins.
+bool cpu_has_fast_pext() {
+  std::uint32_t eax = 0, ebx = 0, ecx = 0, edx = 0;
+#if defined(_MSC_VER)
+  int regs[4] = {0, 0, 0, 0};
+  __cpuidex(regs, 7, 0);
+  ebx = static_cast<std::uint32_t>(regs[1]);
+  if ((ebx & (1u << 8)) == 0) {
+    return false;
+  }
+  __cpuidex(regs, 0, 0);
+  const std::uint32_t vendor_ebx = static_cast<std::uint32_t>(regs[1]);
+  const std::uint32_t vendor_ecx = static_cast<std::uint32_t>(regs[2]);
+  __cpuidex(regs, 1, 0);
+  eax = static_cast<std::uint32_t>(regs[0]);
+#else
+  if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) == 0 ||
+      (ebx & (1u << 8)) == 0) {
+    return false;
+  }
+  std::uint32_t vendor_ebx = 0, vendor_ecx = 0;
+  __get_cpuid(0, &eax, &vendor_ebx, &vendor_ecx, &edx);
+  __get_cpuid(1, &eax, &ebx, &ecx, &edx);
+#endif
+  // "AuthenticAMD": ebx = "Auth", ecx = "cntA".
+  const bool is_amd = vendor_ebx == 0x68747541u && vendor_ecx == 0x444d4163u;
+  if (is_amd) {
+    const std::uint32_t base_family = (eax >> 8) & 0xFu;
+    const std::uint32_t ext_family = (eax >> 20) & 0xFFu;
+    const std::uint32_t family = base_family == 0xFu ? base_family + ext_family : base_family;
+    if (family < 0x19u) {
+      return false;
+    }
+  }
+  return true;
+}
+#endif  // BBY_HAVE_PEXT
+
+// Resolved once by init_attacks; the magic path is the safe default so
+// lookups work even before initialize() runs.
+Bitboard (*g_rook_attacks)(Square, Bitboard) = &rook_attacks_magic;
+Bitboard (*g_bishop_attacks)(Square, Bitboard) = &bishop_attacks_magic;
+
 }  // namespace
 
-void init_attacks(bool use_pext) {
-#if defined(__BMI2__) || defined(_MSC_VER)
-  (void)use_pext;
+bool init_attacks(bool use_pext) {
+#if defined(BBY_HAVE_PEXT)
+  const bool pext = use_pext && cpu_has_fast_pext();
+  g_rook_attacks = pext ? &rook_attacks_pext : &rook_attacks_magic;
+  g_bishop_attacks = pext ? &bishop_attacks_pext : &bishop_attacks_magic;
+  return pext;
 #else
-  BBY_ASSERT(!use_pext && "BMI2 attacks requested but not available at compile time");
   (void)use_pext;
+  return false;
 #endif
 }
 
 Bitboard rook_attacks(Square sq, Bitboard occ) {
-#if defined(__BMI2__) || defined(_MSC_VER)
-  const auto& tables = pext_tables();
-  const int idx = static_cast<int>(sq);
-  const Bitboard mask = tables.rook_masks[idx];
-  const std::uint64_t key = hardware_pext(occ, mask);
-  return tables.rook_moves[idx][key];
-#else
-  const auto& tables = magic_tables();
-  const int idx = static_cast<int>(sq);
-  const Bitboard mask = tables.rook_masks[idx];
-  const std::uint64_t key = ((occ & mask) * tables.rook_magics[idx]) >> tables.rook_shifts[idx];
-  return tables.rook_moves[idx][static_cast<std::size_t>(key)];
-#endif
+  return g_rook_attacks(sq, occ);
 }
 
 Bitboard bishop_attacks(Square sq, Bitboard occ) {
-#if defined(__BMI2__) || defined(_MSC_VER)
-  const auto& tables = pext_tables();
-  const int idx = static_cast<int>(sq);
-  const Bitboard mask = tables.bishop_masks[idx];
-  const std::uint64_t key = hardware_pext(occ, mask);
-  return tables.bishop_moves[idx][key];
-#else
-  const auto& tables = magic_tables();
-  const int idx = static_cast<int>(sq);
-  const Bitboard mask = tables.bishop_masks[idx];
-  const std::uint64_t key = ((occ & mask) * tables.bishop_magics[idx]) >> tables.bishop_shifts[idx];
-  return tables.bishop_moves[idx][static_cast<std::size_t>(key)];
-#endif
+  return g_bishop_attacks(sq, occ);
 }
 
 Bitboard knight_attacks(Square sq) {
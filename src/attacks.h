@@ -3,17 +3,20 @@
  * @file attacks.h
  * @brief Attack helpers for sliding and leaper pieces.
  *
- * Sliding attacks rely on BMI2 PEXT tables when the binary is compiled with
- * BMI2 support; otherwise they use precomputed magic-bitboard lookup tables.
- * The helper `init_attacks` validates configuration requests but does not
- * retain any mutable global state.
+ * Sliding attacks use BMI2 PEXT lookups or magic-bitboard lookups; both
+ * table sets are baked into the binary at compile time and `init_attacks`
+ * picks between them at runtime via cpuid, so one shipped binary takes the
+ * PEXT path on hosts where the instruction is fast and falls back to magics
+ * everywhere else (including pre-Zen3 AMD, where PEXT is microcoded).
  */
 
 #include "common.h"
 
 namespace bby {
 
-void init_attacks(bool use_pext);
+// Resolves the slider-attack dispatch; returns true when the PEXT path was
+// selected. Before the first call the portable magic path is active.
+bool init_attacks(bool use_pext);
 
 Bitboard rook_attacks(Square sq, Bitboard occ);
 Bitboard bishop_attacks(Square sq, Bitboard occ);
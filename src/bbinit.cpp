@@ -7,13 +7,15 @@
 namespace bby {
 
 InitState initialize(const InitOptions& opts) {
-  init_attacks(opts.enable_bmi2);
-  return InitState{opts};
+  InitState state{opts};
+  state.pext_active = init_attacks(opts.enable_bmi2);
+  return state;
 }
 
 std::string cpu_feature_summary(const InitState& state) {
   std::ostringstream oss;
-  oss << "BMI2=" << (state.options.enable_bmi2 ? "on" : "off");
+  oss << "BMI2=" << (state.options.enable_bmi2 ? "on" : "off")
+      << " PEXT=" << (state.pext_active ? "on" : "off");
   return oss.str();
 }
 
@@ -14,6 +14,8 @@ struct InitOptions {
 
 struct InitState {
   InitOptions options{};
+  // True when cpuid selected the PEXT slider path at initialize() time.
+  bool pext_active{false};
 };
 
 InitState initialize(const InitOptions& opts = {});
@@ -1,13 +1,14 @@
 #pragma once
 // bench.h -- Deterministic bench suite positions for the UCI `bench` command.
-// Contains 50 FEN strings used to measure baseline move generation throughput.
+// Contains 50 FEN strings mixing openings, middlegames, endgames and
+// tactical melees so throughput numbers reflect the whole node mix.
 
 #include <array>
 #include <string_view>
 
 namespace bby {
 
-inline constexpr std::array<std::string_view, 12> kBenchFens = {
+inline constexpr std::array<std::string_view, 50> kBenchFens = {
     "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
     "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
     "r1bqk1nr/pppp1ppp/2n5/2b1p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
@@ -19,8 +20,46 @@ inline constexpr std::array<std::string_view, 12> kBenchFens = {
     "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
     "8/k7/3p4/p2P1p2/P2P1P2/8/8/K7 w - - 0 1",
     "r2q1rk1/ppp2ppp/2n1bn2/2bpp3/3P4/3QPN2/PPP1BPPP/R1B1K2R w KQ - 0 8",
-    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8"};
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/2N2N2/PPPP1PPP/R1BQK2R w KQkq - 4 4",
+    "rnbqkb1r/pp2pppp/3p1n2/8/3NP3/2N5/PPP2PPP/R1BQKB1R b KQkq - 1 5",
+    "rnbqk2r/ppp1ppbp/3p1np1/8/2PPP3/2N5/PP3PPP/R1BQKBNR w KQkq - 0 5",
+    "rnbqk1nr/pp3ppp/4p3/2ppP3/3P4/2N5/PPP2PPP/R1BQKBNR w KQkq - 0 5",
+    "r1bq1rk1/ppp2ppp/2np1n2/2b1p3/2B1P3/2PP1N2/PP3PPP/RNBQ1RK1 b - - 0 6",
+    "r2qkb1r/pp1n1ppp/2p1pn2/3p1b2/2PP4/1QN2N2/PP2PPPP/R1B1KB1R w KQkq - 2 6",
+    "r1bqk2r/2ppbppp/p1n2n2/1p2p3/4P3/1B3N2/PPPP1PPP/RNBQR1K1 w kq - 2 7",
+    "rn1qkb1r/pb1p1ppp/1p2pn2/2p5/2PP4/5NP1/PP2PPBP/RNBQK2R w KQkq - 0 5",
+    "8/8/4kpp1/3p4/3P1P2/4K1P1/8/8 w - - 0 1",
+    "8/3k4/8/3PK3/8/8/8/8 w - - 0 1",
+    "8/8/1p6/p1p5/P1P5/1P6/4K2k/8 w - - 0 1",
+    "8/5pk1/6p1/8/6P1/5PK1/8/8 w - - 0 1",
+    "8/8/8/4k3/8/8/r7/4K2R w K - 0 1",
+    "8/2k5/8/8/8/8/1B6/2K2B2 w - - 0 1",
+    "8/8/3k4/8/3NK3/8/8/5B2 w - - 0 1",
+    "6k1/5p2/6p1/7p/7P/6P1/5PK1/8 w - - 0 1",
+    "8/6p1/4kp2/4p3/4P3/5PK1/6P1/8 b - - 0 1",
+    "1r6/8/8/8/8/5k2/8/1R4K1 w - - 0 1",
+    "8/p4k2/1p6/8/8/1P6/P4K2/8 w - - 0 1",
+    "R7/P4k2/8/8/8/8/r7/6K1 w - - 0 1",
+    "2rr3k/pp3pp1/1nnqbN1p/3pN3/2pP4/2P3Q1/PPB4P/R4RK1 w - - 0 1",
+    "8/7p/5k2/5p2/p1p2P2/Pr1pPK2/1P1R3P/8 b - - 0 1",
+    "5rk1/1ppb3p/p1pb4/6q1/3P1p1r/2P1R2P/PP1BQ1P1/5RKN w - - 0 1",
+    "r1bq2rk/pp3pbp/2p1p1pQ/7P/3P4/2PB1N2/PP3PPR/2KR4 w - - 0 1",
+    "5k2/6pp/p1qN4/1p1p4/3P4/2PKP2Q/PP3r2/3R4 b - - 0 1",
+    "7k/p7/1R5K/6r1/6p1/6P1/8/8 w - - 0 1",
+    "rnbqkb1r/pppp1ppp/8/4P3/6n1/7P/PPPNPPP1/R1BQKBNR b KQkq - 0 4",
+    "r4q1k/p2bR1rp/2p2Q1N/5p2/5p2/2P5/PP3PPP/R5K1 w - - 0 1",
+    "3q1rk1/p4pp1/2pb3p/3p4/6Pr/1PNQ4/P1PB1PP1/4RRK1 b - - 0 1",
+    "2br2k1/2q3rn/p2NppQ1/2p1P3/Pp5R/4P3/1P3PPP/3R2K1 w - - 0 1",
+    "r1b1kb1r/3q1ppp/pBp1pn2/8/Np3P2/5B2/PPP3PP/R2Q1RK1 w kq - 0 1",
+    "2r3k1/pppR1pp1/4p3/4P1P1/5P2/1P6/P1P4P/6K1 w - - 0 1",
+    "5rk1/pp4p1/2n1p2p/2Npq3/2p5/6P1/P3P1BP/R4Q1K w - - 0 1",
+    "r2rb1k1/pp1q1p1p/2n1p1p1/2bp4/5P2/PP1BPR1Q/1BPN2PP/R5K1 w - - 0 1",
+    "1R6/1brk2p1/4p2p/p1P1Pp2/P7/6P1/1P4P1/2R3K1 w - - 0 1",
+    "r4rk1/ppp2ppp/2n5/2bqp3/8/P2PB3/1PP1NPPP/R2Q1RK1 w - - 0 1",
+    "1k5r/pppbn1pp/4q1r1/1P3p2/2NPp3/1QP5/P4PPP/R1B1R1K1 w - - 0 1",
+    "6k1/3b3r/1p1p4/p1n2p2/1PPNpP1q/P3Q2p/1R1RB1P1/5K2 b - - 0 1"};
 
-static_assert(kBenchFens.size() == 12, "Bench suite must contain 12 positions");
+static_assert(kBenchFens.size() == 50, "Bench suite must contain 50 positions");
 
 }  // namespace bby
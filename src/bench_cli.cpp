@@ -2,17 +2,29 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
 #include <string_view>
+#include <vector>
 
 #include "bench.h"
 #include "bbinit.h"
 #include "search.h"
 #include "searchparams.h"
 
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 namespace bby {
 
 namespace {
@@ -20,11 +32,163 @@ namespace {
 struct BenchConfig {
   int depth{8};
   int positions{static_cast<int>(kBenchFens.size())};
+  int runs{1};
   std::int64_t nodes_limit{0};
   int lmr_min_depth{kLmrMinDepthDefault};
   int lmr_min_move{kLmrMinMoveDefault};
+  double threshold_pct{3.0};
+  bool profile{false};
+  std::string json_path;
+  std::string baseline_path;
+};
+
+struct PositionSample {
+  std::string_view fen;
+  std::uint64_t nodes{0};
+  std::int64_t time_ms{0};
+  int depth{0};
+};
+
+struct RunResult {
+  std::vector<PositionSample> samples;
+  std::uint64_t nodes{0};
+  std::uint64_t ms{0};
+  double nps{0.0};
+};
+
+struct NpsStats {
+  double median{0.0};
+  double mean{0.0};
+  double stddev{0.0};
+  double ci95_low{0.0};
+  double ci95_high{0.0};
+};
+
+#if defined(__linux__)
+
+constexpr std::size_t kPerfEventCount = 5;
+
+// Scaled readings of the five profiled events, in the order they are opened:
+// cycles, instructions, LLC misses, dTLB misses, branch misses.
+struct PerfSample {
+  std::array<double, kPerfEventCount> values{};
+};
+
+// Hardware counters for the calling thread opened via perf_event_open. The
+// events are opened individually rather than as a group and each read is
+// scaled by its enabled/running time, so the kernel is free to multiplex
+// them on PMUs with fewer slots than events without skewing the totals.
+class PerfCounters {
+public:
+  ~PerfCounters() { close_all(); }
+
+  // Returns false (leaving no counters open) when the kernel refuses, most
+  // commonly a restrictive perf_event_paranoid setting or a missing PMU.
+  bool open() {
+    struct Event {
+      std::uint32_t type;
+      std::uint64_t config;
+    };
+    const std::array<Event, kPerfEventCount> events = {{
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HW_CACHE,
+         PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        {PERF_TYPE_HW_CACHE,
+         PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    }};
+    for (std::size_t idx = 0; idx < events.size(); ++idx) {
+      perf_event_attr attr{};
+      attr.size = sizeof(attr);
+      attr.type = events[idx].type;
+      attr.config = events[idx].config;
+      attr.disabled = 1;
+      attr.inherit = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format =
+          PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      const long fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+      if (fd < 0) {
+        close_all();
+        return false;
+      }
+      fds_[idx] = static_cast<int>(fd);
+    }
+    return true;
+  }
+
+  void start() {
+    for (const int fd : fds_) {
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+
+  [[nodiscard]] PerfSample read_sample() const {
+    PerfSample sample;
+    for (std::size_t idx = 0; idx < kPerfEventCount; ++idx) {
+      struct {
+        std::uint64_t value;
+        std::uint64_t enabled;
+        std::uint64_t running;
+      } data{};
+      if (::read(fds_[idx], &data, sizeof(data)) !=
+          static_cast<ssize_t>(sizeof(data))) {
+        continue;
+      }
+      double value = static_cast<double>(data.value);
+      if (data.running > 0 && data.running < data.enabled) {
+        value *= static_cast<double>(data.enabled) /
+                 static_cast<double>(data.running);
+      }
+      sample.values[idx] = value;
+    }
+    return sample;
+  }
+
+private:
+  void close_all() {
+    for (int& fd : fds_) {
+      if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+      }
+    }
+  }
+
+  std::array<int, kPerfEventCount> fds_{{-1, -1, -1, -1, -1}};
 };
 
+// One profile report line: counters normalized per node (cycles and
+// instructions) or per thousand nodes (the miss events, which are sparse).
+void print_profile_line(const char* label, std::int64_t nodes,
+                        const PerfSample& sample) {
+  const double denom = static_cast<double>(std::max<std::int64_t>(1, nodes));
+  const double cycles = sample.values[0];
+  const double instructions = sample.values[1];
+  const double ipc = cycles > 0.0 ? instructions / cycles : 0.0;
+  std::printf("  %-8s %10lld nodes  %7.1f cyc/n  %7.1f insn/n  ipc %.2f"
+              "  llc %7.2f/kn  dtlb %7.2f/kn  branch %7.2f/kn\n",
+              label, static_cast<long long>(nodes), cycles / denom,
+              instructions / denom, ipc, sample.values[2] * 1000.0 / denom,
+              sample.values[3] * 1000.0 / denom,
+              sample.values[4] * 1000.0 / denom);
+}
+
+PerfSample sample_delta(const PerfSample& now, const PerfSample& then) {
+  PerfSample delta;
+  for (std::size_t idx = 0; idx < kPerfEventCount; ++idx) {
+    delta.values[idx] = now.values[idx] - then.values[idx];
+  }
+  return delta;
+}
+
+#endif  // defined(__linux__)
+
 bool parse_int(std::string_view token, long long& out) {
   if (token.empty()) {
     return false;
@@ -50,8 +214,16 @@ BenchConfig parse_cli_arguments(int argc, const char* argv[]) {
       ++idx;
       return parse_int(argv[idx], out);
     };
+    auto consume_string = [&](std::string& out) -> bool {
+      if (idx + 1 >= argc) {
+        return false;
+      }
+      ++idx;
+      out = argv[idx];
+      return true;
+    };
 
-  if (arg == "--depth") {
+    if (arg == "--depth") {
       long long value = 0;
       if (consume_next(value)) {
         cfg.depth = static_cast<int>(std::max<long long>(1, value));
@@ -67,6 +239,26 @@ BenchConfig parse_cli_arguments(int argc, const char* argv[]) {
       if (consume_next(value)) {
         cfg.nodes_limit = std::max<long long>(0, value);
       }
+    } else if (arg == "--runs") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.runs = static_cast<int>(std::clamp<long long>(value, 1, 1000));
+      }
+    } else if (arg == "--json") {
+      std::string value;
+      if (consume_string(value)) {
+        cfg.json_path = value;
+      }
+    } else if (arg == "--baseline") {
+      std::string value;
+      if (consume_string(value)) {
+        cfg.baseline_path = value;
+      }
+    } else if (arg == "--threshold") {
+      std::string value;
+      if (consume_string(value)) {
+        cfg.threshold_pct = std::strtod(value.c_str(), nullptr);
+      }
     } else if (arg == "--lmr-depth") {
       long long value = 0;
       if (consume_next(value)) {
@@ -77,9 +269,13 @@ BenchConfig parse_cli_arguments(int argc, const char* argv[]) {
       if (consume_next(value)) {
         cfg.lmr_min_move = static_cast<int>(std::max<long long>(1, value));
       }
+    } else if (arg == "--profile") {
+      cfg.profile = true;
     } else if (arg == "--help" || arg == "-h") {
       std::printf("Usage: bby bench [--depth N] [--positions N] [--nodes LIMIT]\n");
-      std::printf("                [--lmr-depth N] [--lmr-move N]\n");
+      std::printf("                [--runs N] [--json FILE] [--baseline FILE]\n");
+      std::printf("                [--threshold PCT] [--lmr-depth N] [--lmr-move N]\n");
+      std::printf("                [--profile]\n");
       std::fflush(stdout);
       std::exit(0);
     } else {
@@ -92,19 +288,29 @@ BenchConfig parse_cli_arguments(int argc, const char* argv[]) {
   return cfg;
 }
 
-}  // namespace
-
-int bench_cli_main(int argc, const char* argv[]) {
-  (void)initialize();
-  const BenchConfig cfg = parse_cli_arguments(argc, argv);
-
+RunResult run_suite(const BenchConfig& cfg) {
+  RunResult run;
   const int total_positions =
       std::min<int>(cfg.positions, static_cast<int>(kBenchFens.size()));
-  std::uint64_t total_nodes = 0;
-  std::uint64_t total_ms = 0;
+  run.samples.reserve(static_cast<std::size_t>(total_positions));
+
+#if defined(__linux__)
+  PerfCounters counters;
+  const bool profiling = cfg.profile && counters.open();
+  if (cfg.profile && !profiling) {
+    std::fprintf(stderr,
+                 "bench: --profile disabled, perf_event_open failed "
+                 "(check /proc/sys/kernel/perf_event_paranoid)\n");
+  }
+#else
+  if (cfg.profile) {
+    std::fprintf(stderr, "bench: --profile requires Linux perf events\n");
+  }
+#endif
 
   for (int idx = 0; idx < total_positions; ++idx) {
-    Position pos = Position::from_fen(kBenchFens[static_cast<std::size_t>(idx)], false);
+    const std::string_view fen = kBenchFens[static_cast<std::size_t>(idx)];
+    Position pos = Position::from_fen(fen, false);
     Limits limits;
     limits.depth = static_cast<std::int16_t>(cfg.depth);
     if (cfg.nodes_limit > 0) {
@@ -113,22 +319,193 @@ int bench_cli_main(int argc, const char* argv[]) {
     limits.lmr_min_depth = cfg.lmr_min_depth;
     limits.lmr_min_move = cfg.lmr_min_move;
 
+#if defined(__linux__)
+    // Read the counters at every completed iteration so each deepening phase
+    // gets its own attribution; the leftover after the last iteration is the
+    // final (usually aborted) phase plus teardown.
+    PerfSample phase_start{};
+    std::int64_t phase_nodes = 0;
+    const SearchProgressFn progress = [&](const SearchResult& iter) {
+      const PerfSample now = counters.read_sample();
+      char label[16];
+      std::snprintf(label, sizeof(label), "depth %d", iter.depth);
+      print_profile_line(label, iter.nodes - phase_nodes,
+                         sample_delta(now, phase_start));
+      phase_start = now;
+      phase_nodes = iter.nodes;
+    };
+    if (profiling) {
+      std::printf("profile position %d: %.*s\n", idx + 1,
+                  static_cast<int>(fen.size()), fen.data());
+      counters.start();
+    }
+    const auto start = std::chrono::steady_clock::now();
+    const SearchResult result =
+        search(pos, limits, nullptr, profiling ? &progress : nullptr);
+    const auto stop = std::chrono::steady_clock::now();
+    if (profiling) {
+      print_profile_line("total", result.nodes, counters.read_sample());
+    }
+#else
     const auto start = std::chrono::steady_clock::now();
     const SearchResult result = search(pos, limits);
     const auto stop = std::chrono::steady_clock::now();
+#endif
     const auto elapsed_ms =
         std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count();
-    total_nodes += static_cast<std::uint64_t>(result.nodes);
-    total_ms += static_cast<std::uint64_t>(elapsed_ms);
+
+    PositionSample sample;
+    sample.fen = fen;
+    sample.nodes = static_cast<std::uint64_t>(result.nodes);
+    sample.time_ms = elapsed_ms;
+    sample.depth = result.depth;
+    run.samples.push_back(sample);
+    run.nodes += sample.nodes;
+    run.ms += static_cast<std::uint64_t>(elapsed_ms);
+  }
+
+  const std::uint64_t denom = std::max<std::uint64_t>(1, run.ms);
+  run.nps = static_cast<double>(run.nodes) * 1000.0 / static_cast<double>(denom);
+  return run;
+}
+
+NpsStats compute_stats(const std::vector<RunResult>& runs) {
+  NpsStats stats;
+  std::vector<double> nps;
+  nps.reserve(runs.size());
+  for (const RunResult& run : runs) {
+    nps.push_back(run.nps);
+  }
+  std::sort(nps.begin(), nps.end());
+  const std::size_t n = nps.size();
+  stats.median = (n % 2 == 1) ? nps[n / 2]
+                              : (nps[n / 2 - 1] + nps[n / 2]) / 2.0;
+  double sum = 0.0;
+  for (const double value : nps) {
+    sum += value;
+  }
+  stats.mean = sum / static_cast<double>(n);
+  double variance = 0.0;
+  for (const double value : nps) {
+    const double diff = value - stats.mean;
+    variance += diff * diff;
+  }
+  variance = (n > 1) ? variance / static_cast<double>(n - 1) : 0.0;
+  stats.stddev = std::sqrt(variance);
+  // Normal-approximation 95% interval on the mean; with a handful of runs
+  // this is indicative, not rigorous, but catches multi-percent drifts.
+  const double half =
+      1.96 * stats.stddev / std::sqrt(static_cast<double>(n));
+  stats.ci95_low = stats.mean - half;
+  stats.ci95_high = stats.mean + half;
+  return stats;
+}
+
+void write_json(const BenchConfig& cfg, const std::vector<RunResult>& runs,
+                const NpsStats& stats, std::ostream& out) {
+  const RunResult& last = runs.back();
+  out << "{\n";
+  out << "  \"depth\": " << cfg.depth << ",\n";
+  out << "  \"runs\": " << runs.size() << ",\n";
+  out << "  \"positions\": " << last.samples.size() << ",\n";
+  out << "  \"total_nodes\": " << last.nodes << ",\n";
+  out << "  \"median_nps\": " << static_cast<std::uint64_t>(stats.median) << ",\n";
+  out << "  \"mean_nps\": " << static_cast<std::uint64_t>(stats.mean) << ",\n";
+  out << "  \"stddev_nps\": " << static_cast<std::uint64_t>(stats.stddev) << ",\n";
+  out << "  \"ci95_low\": " << static_cast<std::uint64_t>(stats.ci95_low) << ",\n";
+  out << "  \"ci95_high\": " << static_cast<std::uint64_t>(stats.ci95_high) << ",\n";
+  out << "  \"results\": [\n";
+  for (std::size_t idx = 0; idx < last.samples.size(); ++idx) {
+    const PositionSample& sample = last.samples[idx];
+    out << "    {\"fen\": \"" << sample.fen << "\", \"nodes\": " << sample.nodes
+        << ", \"time_ms\": " << sample.time_ms
+        << ", \"depth\": " << sample.depth << "}";
+    out << (idx + 1 < last.samples.size() ? ",\n" : "\n");
+  }
+  out << "  ]\n";
+  out << "}\n";
+}
+
+// Pulls "median_nps": <value> out of a previously written JSON report.
+bool read_baseline_median(const std::string& path, double& out) {
+  std::ifstream in(path);
+  if (!in) {
+    return false;
+  }
+  std::stringstream buffer;
+  buffer << in.rdbuf();
+  const std::string text = buffer.str();
+  const std::string needle = "\"median_nps\":";
+  const std::size_t at = text.find(needle);
+  if (at == std::string::npos) {
+    return false;
+  }
+  out = std::strtod(text.c_str() + at + needle.size(), nullptr);
+  return out > 0.0;
+}
+
+}  // namespace
+
+int bench_cli_main(int argc, const char* argv[]) {
+  (void)initialize();
+  const BenchConfig cfg = parse_cli_arguments(argc, argv);
+
+  std::vector<RunResult> runs;
+  runs.reserve(static_cast<std::size_t>(cfg.runs));
+  for (int run_idx = 0; run_idx < cfg.runs; ++run_idx) {
+    runs.push_back(run_suite(cfg));
+    if (cfg.runs > 1) {
+      const RunResult& run = runs.back();
+      std::printf("run %d/%d: %llu nodes in %llu ms (%.0f nps)\n",
+                  run_idx + 1, cfg.runs,
+                  static_cast<unsigned long long>(run.nodes),
+                  static_cast<unsigned long long>(run.ms), run.nps);
+    }
+  }
+
+  const NpsStats stats = compute_stats(runs);
+  if (cfg.runs > 1) {
+    std::printf("median_nps=%.0f mean_nps=%.0f stddev=%.0f ci95=[%.0f, %.0f]\n",
+                stats.median, stats.mean, stats.stddev, stats.ci95_low,
+                stats.ci95_high);
+  }
+
+  if (!cfg.json_path.empty()) {
+    std::ofstream json(cfg.json_path);
+    if (json) {
+      write_json(cfg, runs, stats, json);
+    } else {
+      std::fprintf(stderr, "bench: failed to open %s for writing\n",
+                   cfg.json_path.c_str());
+    }
+  }
+
+  int exit_code = 0;
+  if (!cfg.baseline_path.empty()) {
+    double baseline = 0.0;
+    if (!read_baseline_median(cfg.baseline_path, baseline)) {
+      std::fprintf(stderr, "bench: failed to read baseline %s\n",
+                   cfg.baseline_path.c_str());
+      exit_code = 2;
+    } else {
+      const double delta_pct = (stats.median - baseline) / baseline * 100.0;
+      std::printf("baseline_nps=%.0f delta=%+.2f%% threshold=%.2f%%\n",
+                  baseline, delta_pct, cfg.threshold_pct);
+      if (delta_pct < -cfg.threshold_pct) {
+        std::printf("bench regression\n");
+        exit_code = 1;
+      }
+    }
   }
 
-  const std::uint64_t denom = std::max<std::uint64_t>(1, total_ms);
-  const std::uint64_t nps = (total_nodes * 1000ULL) / denom;
+  // OpenBench-compatible summary line: total nodes of the last run and the
+  // median throughput across runs.
+  const RunResult& last = runs.back();
   std::printf("%llu nodes %llu nps\n",
-              static_cast<unsigned long long>(total_nodes),
-              static_cast<unsigned long long>(nps));
+              static_cast<unsigned long long>(last.nodes),
+              static_cast<unsigned long long>(stats.median));
   std::fflush(stdout);
-  return 0;
+  return exit_code;
 }
 
 }  // namespace bby
@@ -1,13 +1,14 @@
 #include "board.h"
 #include "attacks.h"
 #include "debug.h"
+#include "psqt.h"
 
 #include <algorithm>
 #include <array>
+#include <bit>
 #include <charconv>
 #include <cctype>
 #include <cstdlib>
-#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -230,19 +231,92 @@ const ZobristTables& zobrist_tables() {
   return tables;
 }
 
-bool is_digit(char c) {
-  return c >= '0' && c <= '9';
+// Cuckoo tables for upcoming-repetition detection: every reversible
+// (piece, square, square) pair is stored under its zobrist difference
+// key (from ^ to ^ side), so "do these two positions differ by exactly
+// one reversible move?" becomes two table probes. Standard two-slot
+// cuckoo hashing; 3668 pairs fit comfortably in 8192 slots.
+struct CuckooTables {
+  static constexpr std::size_t kSize = 8192;
+  std::array<std::uint64_t, kSize> keys{};
+  std::array<Move, kSize> moves{};
+};
+
+inline std::size_t cuckoo_slot1(std::uint64_t key) {
+  return static_cast<std::size_t>(key & 0x1FFFULL);
+}
+
+inline std::size_t cuckoo_slot2(std::uint64_t key) {
+  return static_cast<std::size_t>((key >> 16) & 0x1FFFULL);
+}
+
+const CuckooTables& cuckoo_tables() {
+  static const CuckooTables tables = [] {
+    CuckooTables t{};
+    const ZobristTables& z = zobrist_tables();
+    int filled = 0;
+    for (int color = 0; color < 2; ++color) {
+      for (int type = static_cast<int>(PieceType::Knight);
+           type <= static_cast<int>(PieceType::King); ++type) {
+        for (int s1 = 0; s1 < 64; ++s1) {
+          for (int s2 = s1 + 1; s2 < 64; ++s2) {
+            const Square from = static_cast<Square>(s1);
+            const Square to = static_cast<Square>(s2);
+            Bitboard reach = 0ULL;
+            switch (static_cast<PieceType>(type)) {
+              case PieceType::Knight:
+                reach = knight_attacks(from);
+                break;
+              case PieceType::Bishop:
+                reach = bishop_attacks(from, 0ULL);
+                break;
+              case PieceType::Rook:
+                reach = rook_attacks(from, 0ULL);
+                break;
+              case PieceType::Queen:
+                reach = bishop_attacks(from, 0ULL) | rook_attacks(from, 0ULL);
+                break;
+              case PieceType::King:
+                reach = king_attacks(from);
+                break;
+              default:
+                break;
+            }
+            if ((reach & bit(to)) == 0ULL) {
+              continue;
+            }
+            Move move = make_move(from, to);
+            std::uint64_t key = z.piece[color][type][s1] ^
+                                z.piece[color][type][s2] ^ z.side;
+            std::size_t slot = cuckoo_slot1(key);
+            while (true) {
+              std::swap(t.keys[slot], key);
+              std::swap(t.moves[slot], move);
+              if (move.is_null()) {
+                break;
+              }
+              slot = (slot == cuckoo_slot1(key)) ? cuckoo_slot2(key)
+                                                 : cuckoo_slot1(key);
+            }
+            ++filled;
+          }
+        }
+      }
+    }
+    BBY_ASSERT(filled == 3668);
+    (void)filled;
+    return t;
+  }();
+  return tables;
 }
 
-void ensure_attacks_ready() {
-  static std::once_flag flag;
-  std::call_once(flag, [] { init_attacks(false); });
+bool is_digit(char c) {
+  return c >= '0' && c <= '9';
 }
 
 }  // namespace
 
 Position::Position() {
-  ensure_attacks_ready();
   clear();
 }
 
@@ -260,6 +334,11 @@ void Position::clear() {
   halfmove_clock_ = 0;
   fullmove_number_ = 1;
   zobrist_ = 0ULL;
+  pawn_key_ = 0ULL;
+  psqt_mg_ = 0;
+  psqt_eg_ = 0;
+  phase_ = 0;
+  nnue_ = NnueAccumulator{};
 }
 
 Bitboard Position::pieces(Color color, PieceType type) const {
@@ -325,6 +404,24 @@ bool Position::is_sane(std::string* reason) const {
     return fail("zobrist mismatch");
   }
 
+  int scratch_mg = 0;
+  int scratch_eg = 0;
+  int scratch_phase = 0;
+  for (int sq = 0; sq < 64; ++sq) {
+    const Piece pc = squares_[sq];
+    if (pc == Piece::None) {
+      continue;
+    }
+    const PsqtDelta delta = psqt_delta(pc, static_cast<Square>(sq));
+    scratch_mg += delta.mg;
+    scratch_eg += delta.eg;
+    scratch_phase += delta.phase;
+  }
+  if (scratch_mg != psqt_mg_ || scratch_eg != psqt_eg_ ||
+      scratch_phase != phase_) {
+    return fail("psqt accumulator mismatch");
+  }
+
   const Square ep = ep_square_;
   if (ep != Square::None) {
     const Rank ep_rank = rank_of(ep);
@@ -440,9 +537,6 @@ Position Position::from_fen(std::string_view fen, bool strict) {
 
   pos.recompute_occupancy();
   pos.recompute_zobrist();
-  if (pos.side_ == Color::Black) {
-    pos.zobrist_ ^= zobrist_tables().side;
-  }
 
   return pos;
 }
@@ -499,218 +593,179 @@ bool Position::in_check(Color color) const {
   return is_square_attacked(king_sq, flip(color));
 }
 
-void Position::generate_moves(MoveList& out, GenStage stage) const {
-  const bool trace_moves = trace_enabled(TraceTopic::Moves);
-  std::array<Move, 8> samples{};
-  std::size_t sample_count = 0;
+bool Position::is_pseudo_legal(Move m) const {
+  if (m.is_null()) {
+    return false;
+  }
+  const Square from = from_square(m);
+  const Square to = to_square(m);
+  if (from == to) {
+    return false;
+  }
+  const Piece moving = squares_[static_cast<int>(from)];
+  if (moving == Piece::None || color_of(moving) != side_) {
+    return false;
+  }
+  const Piece target = squares_[static_cast<int>(to)];
+  if (target != Piece::None && color_of(target) == side_) {
+    return false;
+  }
 
-  MoveList pseudo;
-  generate_pseudo_legal(pseudo, stage);
-  out.clear();
+  const MoveFlag flag = move_flag(m);
+  if (flag == MoveFlag::KingCastle || flag == MoveFlag::QueenCastle) {
+    return false;
+  }
 
-  const Color us = side_;
-  const Color them = flip(us);
-  std::array<Bitboard, 64> pin_masks{};
-  const Bitboard pinned = pinned_mask(us, pin_masks);
-  Bitboard checkers;
-  const bool double_check = in_double_check(us, checkers);
-  const bool in_check_now = checkers != 0ULL;
-  const Square king_sq = kings_[color_index(us)];
+  const PieceType type = type_of(moving);
+  const int from_idx = static_cast<int>(from);
+  const int to_idx = static_cast<int>(to);
 
-  Bitboard enemy_pawn_attacks = 0ULL;
-  Bitboard pawns = pieces_[color_index(them)][static_cast<int>(PieceType::Pawn)];
-  while (pawns) {
-    const int sq_idx = __builtin_ctzll(pawns);
-    pawns &= pawns - 1;
-    const Square sq = static_cast<Square>(sq_idx);
-    enemy_pawn_attacks |= pawn_attacks(them, sq);
+  if (type == PieceType::Pawn) {
+    const int push = side_ == Color::White ? 8 : -8;
+    const Rank last_rank = side_ == Color::White ? Rank::R8 : Rank::R1;
+    const Rank start_rank = side_ == Color::White ? Rank::R2 : Rank::R7;
+    const bool attacks_to = (pawn_attacks(side_, from) & bit(to)) != 0ULL;
+    const PieceType promo = promotion_type(m);
+    switch (flag) {
+      case MoveFlag::Quiet:
+        return to_idx - from_idx == push && target == Piece::None &&
+               rank_of(to) != last_rank;
+      case MoveFlag::DoublePush:
+        return rank_of(from) == start_rank && to_idx - from_idx == 2 * push &&
+               target == Piece::None &&
+               squares_[from_idx + push] == Piece::None;
+      case MoveFlag::Capture:
+        return attacks_to && target != Piece::None && rank_of(to) != last_rank;
+      case MoveFlag::EnPassant:
+        return attacks_to && to == ep_square_ && target == Piece::None;
+      case MoveFlag::Promotion:
+        return to_idx - from_idx == push && target == Piece::None &&
+               rank_of(to) == last_rank && promo >= PieceType::Knight &&
+               promo <= PieceType::Queen;
+      case MoveFlag::PromotionCapture:
+        return attacks_to && target != Piece::None &&
+               rank_of(to) == last_rank && promo >= PieceType::Knight &&
+               promo <= PieceType::Queen;
+      default:
+        return false;
+    }
   }
 
-  Bitboard enemy_knight_attacks = 0ULL;
-  Bitboard knights = pieces_[color_index(them)][static_cast<int>(PieceType::Knight)];
-  while (knights) {
-    const int sq_idx = __builtin_ctzll(knights);
-    knights &= knights - 1;
-    enemy_knight_attacks |= knight_attacks(static_cast<Square>(sq_idx));
+  if (flag != MoveFlag::Quiet && flag != MoveFlag::Capture) {
+    return false;
   }
-
-  Bitboard enemy_king_attacks = 0ULL;
-  const Square enemy_king_sq = kings_[color_index(them)];
-  if (enemy_king_sq != Square::None) {
-    enemy_king_attacks = king_attacks(enemy_king_sq);
+  if (flag == MoveFlag::Capture && target == Piece::None) {
+    return false;
+  }
+  if (flag == MoveFlag::Quiet && target != Piece::None) {
+    return false;
   }
 
-  const Bitboard enemy_bishop_sliders =
-      pieces_[color_index(them)][static_cast<int>(PieceType::Bishop)] |
-      pieces_[color_index(them)][static_cast<int>(PieceType::Queen)];
-  const Bitboard enemy_rook_sliders =
-      pieces_[color_index(them)][static_cast<int>(PieceType::Rook)] |
-      pieces_[color_index(them)][static_cast<int>(PieceType::Queen)];
-
-  Bitboard capture_block = ~0ULL;
-  if (in_check_now) {
-    if (double_check) {
-      capture_block = 0ULL;
-    } else {
-      const Square checker_sq = static_cast<Square>(__builtin_ctzll(checkers));
-      capture_block = bit(checker_sq);
-      const Piece checker_piece = piece_on(checker_sq);
-      const PieceType checker_type = type_of(checker_piece);
-      if (checker_type == PieceType::Bishop || checker_type == PieceType::Rook ||
-          checker_type == PieceType::Queen) {
-        capture_block |= between_squares(king_sq, checker_sq);
-      }
-    }
+  Bitboard attacks = 0ULL;
+  switch (type) {
+    case PieceType::Knight:
+      attacks = knight_attacks(from);
+      break;
+    case PieceType::Bishop:
+      attacks = bishop_attacks(from, occupied_all_);
+      break;
+    case PieceType::Rook:
+      attacks = rook_attacks(from, occupied_all_);
+      break;
+    case PieceType::Queen:
+      attacks = rook_attacks(from, occupied_all_) |
+                bishop_attacks(from, occupied_all_);
+      break;
+    case PieceType::King:
+      attacks = king_attacks(from);
+      break;
+    default:
+      return false;
   }
+  return (attacks & bit(to)) != 0ULL;
+}
 
-  for (const Move move : pseudo) {
-    const MoveFlag flag = move_flag(move);
-    const bool is_capture = flag == MoveFlag::Capture ||
-                            flag == MoveFlag::EnPassant ||
-                            flag == MoveFlag::PromotionCapture;
-    const bool is_quiet = flag == MoveFlag::Quiet ||
-                          flag == MoveFlag::DoublePush ||
-                          flag == MoveFlag::KingCastle ||
-                          flag == MoveFlag::QueenCastle ||
-                          flag == MoveFlag::Promotion;
-    if (stage == GenStage::Captures && !is_capture) {
-      continue;
-    }
-    if (stage == GenStage::Quiets && !is_quiet) {
-      continue;
-    }
+bool Position::gives_check(Move m) const {
+  const Color us = side_;
+  const Square ksq = kings_[color_index(flip(us))];
+  if (ksq == Square::None) {
+    return false;
+  }
+  const Square from = from_square(m);
+  const Square to = to_square(m);
+  const MoveFlag flag = move_flag(m);
 
-    const Square from = from_square(move);
-    const Square to = to_square(move);
-    const Piece moving_piece = piece_on(from);
-    const PieceType moving_type = type_of(moving_piece);
-    const Bitboard from_mask = bit(from);
-    const Bitboard to_mask = bit(to);
+  // Board occupancy after the move; the captured piece's square stays
+  // occupied by the mover, so only en passant needs extra clearing.
+  Bitboard occ = (occupied_all_ ^ bit(from)) | bit(to);
+  if (flag == MoveFlag::EnPassant) {
+    const int dir = (us == Color::White) ? -8 : 8;
+    occ ^= bit(static_cast<Square>(static_cast<int>(to) + dir));
+  }
 
-    bool needs_validation = false;
+  if (flag == MoveFlag::KingCastle || flag == MoveFlag::QueenCastle) {
+    // Only the rook can deliver the check; the king never can, and
+    // castling cannot uncover a friendly slider.
+    const bool king_side = flag == MoveFlag::KingCastle;
+    const int rank_base = static_cast<int>(rank_of(from)) * 8;
+    const Square rook_from = static_cast<Square>(rank_base + (king_side ? 7 : 0));
+    const Square rook_to = static_cast<Square>(rank_base + (king_side ? 5 : 3));
+    occ ^= bit(rook_from) | bit(rook_to);
+    return (rook_attacks(rook_to, occ) & bit(ksq)) != 0ULL;
+  }
 
-    if (moving_type == PieceType::King) {
-      if (flag == MoveFlag::KingCastle) {
-        needs_validation = true;
-        const Square mid = static_cast<Square>(static_cast<int>(king_sq) + 1);
-        const Square dest = static_cast<Square>(static_cast<int>(king_sq) + 2);
-        const Bitboard check_mask = bit(mid) | bit(dest);
-        if ((enemy_pawn_attacks | enemy_knight_attacks | enemy_king_attacks) & check_mask) {
-          continue;
-        }
-      } else if (flag == MoveFlag::QueenCastle) {
-        needs_validation = true;
-        const Square mid = static_cast<Square>(static_cast<int>(king_sq) - 1);
-        const Square dest = static_cast<Square>(static_cast<int>(king_sq) - 2);
-        const Bitboard check_mask = bit(mid) | bit(dest);
-        if ((enemy_pawn_attacks | enemy_knight_attacks | enemy_king_attacks) & check_mask) {
-          continue;
-        }
-      } else {
-        if (enemy_pawn_attacks & to_mask) {
-          continue;
-        }
-        if (enemy_knight_attacks & to_mask) {
-          continue;
-        }
-        if (enemy_king_attacks & to_mask) {
-          continue;
-        }
+  PieceType final_type = type_of(squares_[static_cast<int>(from)]);
+  if (flag == MoveFlag::Promotion || flag == MoveFlag::PromotionCapture) {
+    final_type = promotion_type(m);
+  }
 
-        Bitboard occ = occupied_all_;
-        occ ^= from_mask;
-        Bitboard bishop_sliders = enemy_bishop_sliders;
-        Bitboard rook_sliders = enemy_rook_sliders;
-        if (is_capture) {
-          Piece captured_piece = piece_on(to);
-          if (captured_piece != Piece::None) {
-            const PieceType captured_type = type_of(captured_piece);
-            if (captured_type == PieceType::Bishop || captured_type == PieceType::Queen) {
-              bishop_sliders &= ~to_mask;
-            }
-            if (captured_type == PieceType::Rook || captured_type == PieceType::Queen) {
-              rook_sliders &= ~to_mask;
-            }
-            occ ^= to_mask;
-          }
-        }
-        occ |= to_mask;
-        if (slider_attacks_square(occ, to, bishop_sliders, rook_sliders)) {
-          continue;
-        }
-        needs_validation = false;
+  // Direct check from the destination square.
+  switch (final_type) {
+    case PieceType::Pawn:
+      if (pawn_attacks(us, to) & bit(ksq)) {
+        return true;
       }
-    } else {
-      if (double_check) {
-        continue;
+      break;
+    case PieceType::Knight:
+      if (knight_attacks(to) & bit(ksq)) {
+        return true;
       }
-      if (in_check_now) {
-        if (flag == MoveFlag::EnPassant) {
-          needs_validation = true;
-        } else if (!(capture_block & to_mask)) {
-          continue;
-        }
+      break;
+    case PieceType::Bishop:
+      if (bishop_attacks(to, occ) & bit(ksq)) {
+        return true;
       }
-      if (pinned & from_mask) {
-        if (!(pin_masks[static_cast<int>(from)] & to_mask)) {
-          continue;
-        }
+      break;
+    case PieceType::Rook:
+      if (rook_attacks(to, occ) & bit(ksq)) {
+        return true;
       }
-    }
-
-    if (flag == MoveFlag::EnPassant) {
-      needs_validation = true;
-    }
-
-    if (needs_validation) {
-      auto& mutable_self = const_cast<Position&>(*this);
-      Undo u;
-      mutable_self.make(move, u);
-      const bool still_in_check = mutable_self.in_check(us);
-      mutable_self.unmake(move, u);
-      if (still_in_check) {
-        continue;
+      break;
+    case PieceType::Queen:
+      if ((bishop_attacks(to, occ) | rook_attacks(to, occ)) & bit(ksq)) {
+        return true;
       }
-    }
-
-    out.push_back(move);
-    if (trace_moves && sample_count < samples.size()) {
-      samples[sample_count++] = move;
-    }
+      break;
+    default:
+      break;
   }
 
-  if (trace_moves) {
-    const char* stage_name = "all";
-    switch (stage) {
-      case GenStage::Captures:
-        stage_name = "captures";
-        break;
-      case GenStage::Quiets:
-        stage_name = "quiets";
-        break;
-      case GenStage::All:
-        stage_name = "all";
-        break;
-    }
-    std::ostringstream oss;
-    oss << "stage=" << stage_name
-        << " stm=" << (side_ == Color::White ? "white" : "black")
-        << " pseudo=" << pseudo.size()
-        << " legal=" << out.size();
-    if (sample_count > 0) {
-      oss << " moves=";
-      for (std::size_t idx = 0; idx < sample_count; ++idx) {
-        if (idx > 0) {
-          oss << ',';
-        }
-        oss << move_to_uci(samples[idx]);
-      }
-    }
-    trace_emit(TraceTopic::Moves, oss.str());
+  // Discovered check: a slider behind the vacated square now sees the king.
+  const int usi = color_index(us);
+  const Bitboard diag_sliders =
+      (pieces_[usi][static_cast<int>(PieceType::Bishop)] |
+       pieces_[usi][static_cast<int>(PieceType::Queen)]) &
+      ~bit(from);
+  if (bishop_attacks(ksq, occ) & diag_sliders) {
+    return true;
   }
+  const Bitboard line_sliders =
+      (pieces_[usi][static_cast<int>(PieceType::Rook)] |
+       pieces_[usi][static_cast<int>(PieceType::Queen)]) &
+      ~bit(from);
+  return (rook_attacks(ksq, occ) & line_sliders) != 0ULL;
 }
 
-
 bool Position::is_legal(Move m) const {
   Undo u;
   const_cast<Position*>(this)->make(m, u);
@@ -725,6 +780,7 @@ void Position::make(Move m, Undo& undo) {
   if ((++s_debug_counter & 0x3FFU) == 0U) {
     BBY_INVARIANT(is_sane());
     BBY_INVARIANT(compute_zobrist() == zobrist_);
+    BBY_INVARIANT(compute_pawn_key() == pawn_key_);
   }
 #endif
   undo.null_move = false;
@@ -769,8 +825,20 @@ void Position::make(Move m, Undo& undo) {
     pieces_[mover_idx][moving_type_idx] ^= shift_mask;
     occupied_[mover_idx] ^= shift_mask;
     occupied_all_ ^= shift_mask;
-    zobrist_ ^= tables.piece[mover_idx][moving_type_idx][from_idx] ^
-                tables.piece[mover_idx][moving_type_idx][to_idx];
+    const std::uint64_t shift_key =
+        tables.piece[mover_idx][moving_type_idx][from_idx] ^
+        tables.piece[mover_idx][moving_type_idx][to_idx];
+    zobrist_ ^= shift_key;
+    if (origin_type == PieceType::Pawn) {
+      pawn_key_ ^= shift_key;
+    }
+    const PsqtDelta psqt_from = psqt_delta(moving, from);
+    const PsqtDelta psqt_to = psqt_delta(moving, to);
+    psqt_mg_ += psqt_to.mg - psqt_from.mg;
+    psqt_eg_ += psqt_to.eg - psqt_from.eg;
+    if (nnue_.generation == g_nnue_generation) {
+      nnue_move_piece(nnue_, moving, from, to);
+    }
 
     squares_[from_idx] = Piece::None;
     squares_[to_idx] = moving;
@@ -923,8 +991,20 @@ void Position::unmake(Move m, const Undo& undo) {
     pieces_[mover_idx][moving_type_idx] ^= shift_mask;
     occupied_[mover_idx] ^= shift_mask;
     occupied_all_ ^= shift_mask;
-    zobrist_ ^= tables.piece[mover_idx][moving_type_idx][to_idx] ^
-                tables.piece[mover_idx][moving_type_idx][from_idx];
+    const std::uint64_t shift_key =
+        tables.piece[mover_idx][moving_type_idx][to_idx] ^
+        tables.piece[mover_idx][moving_type_idx][from_idx];
+    zobrist_ ^= shift_key;
+    if (moving_type == PieceType::Pawn) {
+      pawn_key_ ^= shift_key;
+    }
+    const PsqtDelta psqt_from = psqt_delta(moving, from);
+    const PsqtDelta psqt_to = psqt_delta(moving, to);
+    psqt_mg_ += psqt_from.mg - psqt_to.mg;
+    psqt_eg_ += psqt_from.eg - psqt_to.eg;
+    if (nnue_.generation == g_nnue_generation) {
+      nnue_move_piece(nnue_, moving, to, from);
+    }
     squares_[to_idx] = Piece::None;
     squares_[from_idx] = moving;
   } else {
@@ -976,6 +1056,7 @@ void Position::make_null(Undo& undo) {
   if ((++s_debug_counter & 0x3FFU) == 0U) {
     BBY_INVARIANT(is_sane());
     BBY_INVARIANT(compute_zobrist() == zobrist_);
+    BBY_INVARIANT(compute_pawn_key() == pawn_key_);
   }
 #endif
   undo.key = zobrist_;
@@ -1028,7 +1109,19 @@ void Position::put_piece(Piece pc, Square sq) {
   if (type == PieceType::King) {
     kings_[color_index(c)] = sq;
   }
-  zobrist_ ^= zobrist_tables().piece[color_index(c)][static_cast<int>(type)][idx];
+  const std::uint64_t key =
+      zobrist_tables().piece[color_index(c)][static_cast<int>(type)][idx];
+  zobrist_ ^= key;
+  if (type == PieceType::Pawn) {
+    pawn_key_ ^= key;
+  }
+  const PsqtDelta delta = psqt_delta(pc, sq);
+  psqt_mg_ += delta.mg;
+  psqt_eg_ += delta.eg;
+  phase_ += delta.phase;
+  if (nnue_.generation == g_nnue_generation) {
+    nnue_add_piece(nnue_, pc, sq);
+  }
 }
 
 void Position::remove_piece(Piece pc, Square sq) {
@@ -1043,7 +1136,19 @@ void Position::remove_piece(Piece pc, Square sq) {
   pieces_[color_index(c)][static_cast<int>(type)] &= ~mask;
   occupied_[color_index(c)] &= ~mask;
   occupied_all_ &= ~mask;
-  zobrist_ ^= zobrist_tables().piece[color_index(c)][static_cast<int>(type)][idx];
+  const std::uint64_t key =
+      zobrist_tables().piece[color_index(c)][static_cast<int>(type)][idx];
+  zobrist_ ^= key;
+  if (type == PieceType::Pawn) {
+    pawn_key_ ^= key;
+  }
+  const PsqtDelta delta = psqt_delta(pc, sq);
+  psqt_mg_ -= delta.mg;
+  psqt_eg_ -= delta.eg;
+  phase_ -= delta.phase;
+  if (nnue_.generation == g_nnue_generation) {
+    nnue_remove_piece(nnue_, pc, sq);
+  }
   if (type == PieceType::King) {
     kings_[color_index(c)] = Square::None;
   }
@@ -1084,6 +1189,60 @@ void Position::recompute_zobrist() {
   zobrist_ = compute_zobrist();
 }
 
+std::uint64_t Position::compute_pawn_key() const {
+  std::uint64_t value = 0ULL;
+  const auto& tables = zobrist_tables();
+  for (int color = 0; color < 2; ++color) {
+    Bitboard pawns = pieces_[color][static_cast<int>(PieceType::Pawn)];
+    while (pawns) {
+      const int sq = static_cast<int>(std::countr_zero(pawns));
+      pawns &= pawns - 1;
+      value ^= tables.piece[color][static_cast<int>(PieceType::Pawn)][sq];
+    }
+  }
+  return value;
+}
+
+bool Position::upcoming_repetition(const std::uint64_t* path, int ply,
+                                   int max_back) const {
+  const int end =
+      std::min({static_cast<int>(halfmove_clock_), ply, max_back});
+  if (end < 3) {
+    return false;
+  }
+  const CuckooTables& tables = cuckoo_tables();
+  // Odd distances only: the candidate move flips the side to move, so the
+  // repeated position sits an even number of plies above the child.
+  for (int back = 3; back <= end; back += 2) {
+    const std::uint64_t move_key = zobrist_ ^ path[ply - back];
+    std::size_t slot = cuckoo_slot1(move_key);
+    if (tables.keys[slot] != move_key) {
+      slot = cuckoo_slot2(move_key);
+      if (tables.keys[slot] != move_key) {
+        continue;
+      }
+    }
+    const Square s1 = from_square(tables.moves[slot]);
+    const Square s2 = to_square(tables.moves[slot]);
+    if ((between_squares(s1, s2) & occupied_all_) != 0ULL) {
+      continue;
+    }
+    // The tabulated pair is unordered: the mover must sit on exactly one
+    // endpoint and belong to the side to move for the slide to be playable.
+    const Piece pc1 = piece_on(s1);
+    const Piece pc2 = piece_on(s2);
+    if ((pc1 == Piece::None) == (pc2 == Piece::None)) {
+      continue;
+    }
+    const Piece mover = pc1 != Piece::None ? pc1 : pc2;
+    if (color_of(mover) != side_) {
+      continue;
+    }
+    return true;
+  }
+  return false;
+}
+
 std::uint64_t Position::compute_zobrist() const {
   std::uint64_t value = 0ULL;
   const auto& tables = zobrist_tables();
@@ -1141,17 +1300,122 @@ bool Position::is_square_attacked(Square sq, Color by) const {
   return false;
 }
 
-void Position::generate_pseudo_legal(MoveList& out, GenStage stage) const {
+void Position::generate_moves(MoveList& out, GenStage stage) const {
+  generate_moves(out, stage, attack_info());
+}
+
+void Position::generate_moves(MoveList& out, GenStage stage,
+                              const AttackInfo& info) const {
+  if (side_ == Color::White) {
+    generate_moves_impl<Color::White>(out, stage, info);
+  } else {
+    generate_moves_impl<Color::Black>(out, stage, info);
+  }
+}
+
+AttackInfo Position::attack_info() const {
+  return side_ == Color::White ? attack_info_impl<Color::White>()
+                               : attack_info_impl<Color::Black>();
+}
+
+template <Color Us>
+AttackInfo Position::attack_info_impl() const {
+  constexpr bool white = (Us == Color::White);
+  constexpr Color Them = white ? Color::Black : Color::White;
+  constexpr int them = color_index(Them);
+  const Square king_sq = kings_[color_index(Us)];
+
+  AttackInfo info;
+  info.pinned = pinned_mask(Us, info.pin_masks);
+  info.double_check = in_double_check(Us, info.checkers);
+
+  if (info.in_check()) {
+    if (info.double_check) {
+      info.check_mask = 0ULL;
+    } else {
+      const Square checker_sq =
+          static_cast<Square>(__builtin_ctzll(info.checkers));
+      info.check_mask = info.checkers;
+      const PieceType checker_type = type_of(piece_on(checker_sq));
+      if (checker_type == PieceType::Bishop ||
+          checker_type == PieceType::Rook ||
+          checker_type == PieceType::Queen) {
+        info.check_mask |= between_squares(king_sq, checker_sq);
+      }
+    }
+  }
+
+  Bitboard enemy_pawns = pieces_[them][static_cast<int>(PieceType::Pawn)];
+  while (enemy_pawns) {
+    const int sq_idx = __builtin_ctzll(enemy_pawns);
+    enemy_pawns &= enemy_pawns - 1;
+    info.danger |= pawn_attacks(Them, static_cast<Square>(sq_idx));
+  }
+  Bitboard enemy_knights = pieces_[them][static_cast<int>(PieceType::Knight)];
+  while (enemy_knights) {
+    const int sq_idx = __builtin_ctzll(enemy_knights);
+    enemy_knights &= enemy_knights - 1;
+    info.danger |= knight_attacks(static_cast<Square>(sq_idx));
+  }
+  if (kings_[them] != Square::None) {
+    info.danger |= king_attacks(kings_[them]);
+  }
+  const Bitboard occ_no_king =
+      king_sq != Square::None ? occupied_all_ ^ bit(king_sq) : occupied_all_;
+  Bitboard enemy_bishops = pieces_[them][static_cast<int>(PieceType::Bishop)] |
+                           pieces_[them][static_cast<int>(PieceType::Queen)];
+  while (enemy_bishops) {
+    const int sq_idx = __builtin_ctzll(enemy_bishops);
+    enemy_bishops &= enemy_bishops - 1;
+    info.danger |= bishop_attacks(static_cast<Square>(sq_idx), occ_no_king);
+  }
+  Bitboard enemy_rooks = pieces_[them][static_cast<int>(PieceType::Rook)] |
+                         pieces_[them][static_cast<int>(PieceType::Queen)];
+  while (enemy_rooks) {
+    const int sq_idx = __builtin_ctzll(enemy_rooks);
+    enemy_rooks &= enemy_rooks - 1;
+    info.danger |= rook_attacks(static_cast<Square>(sq_idx), occ_no_king);
+  }
+
+  return info;
+}
+
+template <Color Us>
+void Position::generate_moves_impl(MoveList& out, GenStage stage,
+                                   const AttackInfo& info) const {
+  constexpr bool white = (Us == Color::White);
+  constexpr Color Them = white ? Color::Black : Color::White;
+  const bool trace_moves = trace_enabled(TraceTopic::Moves);
+  std::array<Move, 8> samples{};
+  std::size_t sample_count = 0;
+
   out.clear();
 
   const bool want_captures = stage != GenStage::Quiets;
   const bool want_quiets = stage != GenStage::Captures;
 
-  const int us = color_index(side_);
-  const int them = color_index(flip(side_));
+  constexpr int us = color_index(Us);
+  constexpr int them = color_index(Them);
+  constexpr Color us_color = Us;
   const Bitboard ours = occupied_[us];
   const Bitboard theirs = occupied_[them];
   const Bitboard empty = ~occupied_all_;
+  const Square king_sq = kings_[us];
+
+  // Legal-by-construction generation: pins and checks come precomputed in
+  // `info` (shared across the staged generation calls), so only en passant
+  // still needs a make-shadow legality pass.
+  const std::array<Bitboard, 64>& pin_masks = info.pin_masks;
+  const Bitboard pinned = info.pinned;
+  const bool double_check = info.double_check;
+  const bool in_check_now = info.in_check();
+  const Bitboard check_mask = info.check_mask;
+  const Bitboard danger = info.danger;
+
+  auto pin_ok = [&](Square from, Square to) {
+    return !(pinned & bit(from)) ||
+           (pin_masks[static_cast<int>(from)] & bit(to)) != 0ULL;
+  };
 
   auto emit = [&](Square from, Square to, MoveFlag flag,
                   PieceType promo = PieceType::None) {
@@ -1166,185 +1430,128 @@ void Position::generate_pseudo_legal(MoveList& out, GenStage stage) const {
         (quiet_like && !want_quiets)) {
       return;
     }
-    out.push_back(make_move(from, to, flag, promo));
-  };
-
-  const Bitboard pawns = pieces_[us][static_cast<int>(PieceType::Pawn)];
-  if (side_ == Color::White) {
-    if (want_quiets) {
-      Bitboard single = pawn_single_pushes(Color::White, pawns, empty);
-      Bitboard promotions = single & kRank8;
-      Bitboard quiets = single & ~kRank8;
-      while (quiets) {
-        const int to_idx = __builtin_ctzll(quiets);
-        quiets &= quiets - 1;
-        const Square to = static_cast<Square>(to_idx);
-        const Square from = static_cast<Square>(to_idx - 8);
-        emit(from, to, MoveFlag::Quiet);
-      }
-
-      Bitboard start_rank = pawns & kRank2;
-      Bitboard double_push = pawn_double_pushes(Color::White, start_rank, empty);
-      while (double_push) {
-        const int to_idx = __builtin_ctzll(double_push);
-        double_push &= double_push - 1;
-        const Square to = static_cast<Square>(to_idx);
-        const Square from = static_cast<Square>(to_idx - 16);
-        emit(from, to, MoveFlag::DoublePush);
-      }
-
-      while (promotions) {
-        const int to_idx = __builtin_ctzll(promotions);
-        promotions &= promotions - 1;
-        const Square to = static_cast<Square>(to_idx);
-        const Square from = static_cast<Square>(to_idx - 8);
-        for (PieceType promo : {PieceType::Queen, PieceType::Rook,
-                                PieceType::Bishop, PieceType::Knight}) {
-          emit(from, to, MoveFlag::Promotion, promo);
-        }
+    if (from != king_sq && !pin_ok(from, to)) {
+      return;
+    }
+    const Move move = make_move(from, to, flag, promo);
+    if (flag == MoveFlag::EnPassant) {
+      // The only case the masks cannot decide: the capture empties two
+      // squares at once, which can expose the king along a rank.
+      auto& mutable_self = const_cast<Position&>(*this);
+      Undo u;
+      mutable_self.make(move, u);
+      const bool exposed = mutable_self.in_check(us_color);
+      mutable_self.unmake(move, u);
+      if (exposed) {
+        return;
       }
     }
+    out.push_back(move);
+    if (trace_moves && sample_count < samples.size()) {
+      samples[sample_count++] = move;
+    }
+  };
 
-    if (want_captures) {
-      Bitboard capture_left = north_west(pawns) & theirs;
-      while (capture_left) {
-        const int to_idx = __builtin_ctzll(capture_left);
-        capture_left &= capture_left - 1;
-        const Square to = static_cast<Square>(to_idx);
-        const Square from = static_cast<Square>(to_idx - 7);
-        const bool promo = rank_of(to) == Rank::R8;
-        if (promo) {
-          for (PieceType promo_type : {PieceType::Queen, PieceType::Rook,
-                                       PieceType::Bishop, PieceType::Knight}) {
-            emit(from, to, MoveFlag::PromotionCapture, promo_type);
-          }
-        } else {
-          emit(from, to, MoveFlag::Capture);
-        }
-      }
+  // Directions and ranks below are compile-time constants for Us, so both
+  // color bodies collapse into this single branch-free block.
+  constexpr int push_dir = white ? 8 : -8;
+  // "Left" captures shift toward the a-file, "right" toward the h-file,
+  // from the mover's perspective.
+  constexpr int capture_left_dir = white ? 7 : -9;
+  constexpr int capture_right_dir = white ? 9 : -7;
+  constexpr Bitboard promo_rank = white ? kRank8 : kRank1;
+  constexpr Bitboard pawn_start_rank = white ? kRank2 : kRank7;
+  constexpr Rank promo_to_rank = white ? Rank::R8 : Rank::R1;
+  constexpr Rank ep_rank = white ? Rank::R6 : Rank::R3;
+  constexpr Piece own_pawn = make_piece(Us, PieceType::Pawn);
 
-      Bitboard capture_right = north_east(pawns) & theirs;
-      while (capture_right) {
-        const int to_idx = __builtin_ctzll(capture_right);
-        capture_right &= capture_right - 1;
-        const Square to = static_cast<Square>(to_idx);
-        const Square from = static_cast<Square>(to_idx - 9);
-        const bool promo = rank_of(to) == Rank::R8;
-        if (promo) {
-          for (PieceType promo_type : {PieceType::Queen, PieceType::Rook,
-                                       PieceType::Bishop, PieceType::Knight}) {
-            emit(from, to, MoveFlag::PromotionCapture, promo_type);
-          }
-        } else {
-          emit(from, to, MoveFlag::Capture);
-        }
-      }
+  const Bitboard pawns = pieces_[us][static_cast<int>(PieceType::Pawn)];
+  if (want_quiets) {
+    Bitboard single = pawn_single_pushes(Us, pawns, empty) & check_mask;
+    Bitboard promotions = single & promo_rank;
+    Bitboard quiets = single & ~promo_rank;
+    while (quiets) {
+      const int to_idx = __builtin_ctzll(quiets);
+      quiets &= quiets - 1;
+      const Square to = static_cast<Square>(to_idx);
+      const Square from = static_cast<Square>(to_idx - push_dir);
+      emit(from, to, MoveFlag::Quiet);
+    }
 
-      if (ep_square_ != Square::None && rank_of(ep_square_) == Rank::R6) {
-        const int to_idx = static_cast<int>(ep_square_);
-        const int file = to_idx & 7;
-        if (file > 0) {
-          const int from_idx = to_idx - 9;
-          if (from_idx >= 0 &&
-              squares_[from_idx] == make_piece(Color::White, PieceType::Pawn)) {
-            emit(static_cast<Square>(from_idx), ep_square_, MoveFlag::EnPassant);
-          }
-        }
-        if (file < 7) {
-          const int from_idx = to_idx - 7;
-          if (from_idx >= 0 &&
-              squares_[from_idx] == make_piece(Color::White, PieceType::Pawn)) {
-            emit(static_cast<Square>(from_idx), ep_square_, MoveFlag::EnPassant);
-          }
-        }
-      }
+    Bitboard start_rank = pawns & pawn_start_rank;
+    Bitboard double_push =
+        pawn_double_pushes(Us, start_rank, empty) & check_mask;
+    while (double_push) {
+      const int to_idx = __builtin_ctzll(double_push);
+      double_push &= double_push - 1;
+      const Square to = static_cast<Square>(to_idx);
+      const Square from = static_cast<Square>(to_idx - 2 * push_dir);
+      emit(from, to, MoveFlag::DoublePush);
     }
-  } else {
-    if (want_quiets) {
-      Bitboard single = pawn_single_pushes(Color::Black, pawns, empty);
-      Bitboard promotions = single & kRank1;
-      Bitboard quiets = single & ~kRank1;
-      while (quiets) {
-        const int to_idx = __builtin_ctzll(quiets);
-        quiets &= quiets - 1;
-        const Square to = static_cast<Square>(to_idx);
-        const Square from = static_cast<Square>(to_idx + 8);
-        emit(from, to, MoveFlag::Quiet);
-      }
 
-      Bitboard start_rank = pawns & kRank7;
-      Bitboard double_push = pawn_double_pushes(Color::Black, start_rank, empty);
-      while (double_push) {
-        const int to_idx = __builtin_ctzll(double_push);
-        double_push &= double_push - 1;
-        const Square to = static_cast<Square>(to_idx);
-        const Square from = static_cast<Square>(to_idx + 16);
-        emit(from, to, MoveFlag::DoublePush);
+    while (promotions) {
+      const int to_idx = __builtin_ctzll(promotions);
+      promotions &= promotions - 1;
+      const Square to = static_cast<Square>(to_idx);
+      const Square from = static_cast<Square>(to_idx - push_dir);
+      for (PieceType promo : {PieceType::Queen, PieceType::Rook,
+                              PieceType::Bishop, PieceType::Knight}) {
+        emit(from, to, MoveFlag::Promotion, promo);
       }
+    }
+  }
 
-      while (promotions) {
-        const int to_idx = __builtin_ctzll(promotions);
-        promotions &= promotions - 1;
-        const Square to = static_cast<Square>(to_idx);
-        const Square from = static_cast<Square>(to_idx + 8);
-        for (PieceType promo : {PieceType::Queen, PieceType::Rook,
-                                PieceType::Bishop, PieceType::Knight}) {
-          emit(from, to, MoveFlag::Promotion, promo);
+  if (want_captures) {
+    Bitboard capture_left =
+        (white ? north_west(pawns) : south_west(pawns)) & theirs & check_mask;
+    while (capture_left) {
+      const int to_idx = __builtin_ctzll(capture_left);
+      capture_left &= capture_left - 1;
+      const Square to = static_cast<Square>(to_idx);
+      const Square from = static_cast<Square>(to_idx - capture_left_dir);
+      const bool promo = rank_of(to) == promo_to_rank;
+      if (promo) {
+        for (PieceType promo_type : {PieceType::Queen, PieceType::Rook,
+                                     PieceType::Bishop, PieceType::Knight}) {
+          emit(from, to, MoveFlag::PromotionCapture, promo_type);
         }
+      } else {
+        emit(from, to, MoveFlag::Capture);
       }
     }
 
-    if (want_captures) {
-      Bitboard capture_left = south_west(pawns) & theirs;
-      while (capture_left) {
-        const int to_idx = __builtin_ctzll(capture_left);
-        capture_left &= capture_left - 1;
-        const Square to = static_cast<Square>(to_idx);
-        const Square from = static_cast<Square>(to_idx + 9);
-        const bool promo = rank_of(to) == Rank::R1;
-        if (promo) {
-          for (PieceType promo_type : {PieceType::Queen, PieceType::Rook,
-                                       PieceType::Bishop, PieceType::Knight}) {
-            emit(from, to, MoveFlag::PromotionCapture, promo_type);
-          }
-        } else {
-          emit(from, to, MoveFlag::Capture);
+    Bitboard capture_right =
+        (white ? north_east(pawns) : south_east(pawns)) & theirs & check_mask;
+    while (capture_right) {
+      const int to_idx = __builtin_ctzll(capture_right);
+      capture_right &= capture_right - 1;
+      const Square to = static_cast<Square>(to_idx);
+      const Square from = static_cast<Square>(to_idx - capture_right_dir);
+      const bool promo = rank_of(to) == promo_to_rank;
+      if (promo) {
+        for (PieceType promo_type : {PieceType::Queen, PieceType::Rook,
+                                     PieceType::Bishop, PieceType::Knight}) {
+          emit(from, to, MoveFlag::PromotionCapture, promo_type);
         }
+      } else {
+        emit(from, to, MoveFlag::Capture);
       }
+    }
 
-      Bitboard capture_right = south_east(pawns) & theirs;
-      while (capture_right) {
-        const int to_idx = __builtin_ctzll(capture_right);
-        capture_right &= capture_right - 1;
-        const Square to = static_cast<Square>(to_idx);
-        const Square from = static_cast<Square>(to_idx + 7);
-        const bool promo = rank_of(to) == Rank::R1;
-        if (promo) {
-          for (PieceType promo_type : {PieceType::Queen, PieceType::Rook,
-                                       PieceType::Bishop, PieceType::Knight}) {
-            emit(from, to, MoveFlag::PromotionCapture, promo_type);
-          }
-        } else {
-          emit(from, to, MoveFlag::Capture);
+    if (ep_square_ != Square::None && rank_of(ep_square_) == ep_rank &&
+        !double_check) {
+      const int to_idx = static_cast<int>(ep_square_);
+      const int file = to_idx & 7;
+      if (file > 0) {
+        const int from_idx = to_idx - capture_right_dir;
+        if (from_idx >= 0 && from_idx < 64 && squares_[from_idx] == own_pawn) {
+          emit(static_cast<Square>(from_idx), ep_square_, MoveFlag::EnPassant);
         }
       }
-
-      if (ep_square_ != Square::None && rank_of(ep_square_) == Rank::R3) {
-        const int to_idx = static_cast<int>(ep_square_);
-        const int file = to_idx & 7;
-        if (file > 0) {
-          const int from_idx = to_idx + 7;
-          if (from_idx < 64 &&
-              squares_[from_idx] == make_piece(Color::Black, PieceType::Pawn)) {
-            emit(static_cast<Square>(from_idx), ep_square_, MoveFlag::EnPassant);
-          }
-        }
-        if (file < 7) {
-          const int from_idx = to_idx + 9;
-          if (from_idx < 64 &&
-              squares_[from_idx] == make_piece(Color::Black, PieceType::Pawn)) {
-            emit(static_cast<Square>(from_idx), ep_square_, MoveFlag::EnPassant);
-          }
+      if (file < 7) {
+        const int from_idx = to_idx - capture_left_dir;
+        if (from_idx >= 0 && from_idx < 64 && squares_[from_idx] == own_pawn) {
+          emit(static_cast<Square>(from_idx), ep_square_, MoveFlag::EnPassant);
         }
       }
     }
@@ -1355,7 +1562,7 @@ void Position::generate_pseudo_legal(MoveList& out, GenStage stage) const {
     const int from_idx = __builtin_ctzll(knights);
     knights &= knights - 1;
     const Square from = static_cast<Square>(from_idx);
-    Bitboard moves = knight_attacks(from) & ~ours;
+    Bitboard moves = knight_attacks(from) & ~ours & check_mask;
     if (!want_captures) {
       moves &= ~theirs;
     } else if (!want_quiets) {
@@ -1375,7 +1582,7 @@ void Position::generate_pseudo_legal(MoveList& out, GenStage stage) const {
       const int from_idx = __builtin_ctzll(pieces);
       pieces &= pieces - 1;
       const Square from = static_cast<Square>(from_idx);
-      Bitboard moves = attack_fn(from, occupied_all_) & ~ours;
+      Bitboard moves = attack_fn(from, occupied_all_) & ~ours & check_mask;
       if (!want_captures) {
         moves &= ~theirs;
       } else if (!want_quiets) {
@@ -1404,7 +1611,7 @@ void Position::generate_pseudo_legal(MoveList& out, GenStage stage) const {
   if (king_bb) {
     const int from_idx = __builtin_ctzll(king_bb);
     const Square from = static_cast<Square>(from_idx);
-    Bitboard moves = king_attacks(from) & ~ours;
+    Bitboard moves = king_attacks(from) & ~ours & ~danger;
     if (!want_captures) {
       moves &= ~theirs;
     } else if (!want_quiets) {
@@ -1418,42 +1625,63 @@ void Position::generate_pseudo_legal(MoveList& out, GenStage stage) const {
       emit(from, to, capture ? MoveFlag::Capture : MoveFlag::Quiet);
     }
 
-    if (want_quiets) {
-      const Color enemy = flip(side_);
-      if (side_ == Color::White) {
-        if ((castling_ & CastleWK) &&
-            !(occupancy() & (bit(Square::F1) | bit(Square::G1))) &&
-            !is_square_attacked(Square::E1, enemy) &&
-            !is_square_attacked(Square::F1, enemy) &&
-            !is_square_attacked(Square::G1, enemy)) {
-          emit(Square::E1, Square::G1, MoveFlag::KingCastle);
-        }
-        if ((castling_ & CastleWQ) &&
-            !(occupancy() &
-              (bit(Square::D1) | bit(Square::C1) | bit(Square::B1))) &&
-            !is_square_attacked(Square::E1, enemy) &&
-            !is_square_attacked(Square::D1, enemy) &&
-            !is_square_attacked(Square::C1, enemy)) {
-          emit(Square::E1, Square::C1, MoveFlag::QueenCastle);
-        }
-      } else {
-        if ((castling_ & CastleBK) &&
-            !(occupancy() & (bit(Square::F8) | bit(Square::G8))) &&
-            !is_square_attacked(Square::E8, enemy) &&
-            !is_square_attacked(Square::F8, enemy) &&
-            !is_square_attacked(Square::G8, enemy)) {
-          emit(Square::E8, Square::G8, MoveFlag::KingCastle);
-        }
-        if ((castling_ & CastleBQ) &&
-            !(occupancy() &
-              (bit(Square::D8) | bit(Square::C8) | bit(Square::B8))) &&
-            !is_square_attacked(Square::E8, enemy) &&
-            !is_square_attacked(Square::D8, enemy) &&
-            !is_square_attacked(Square::C8, enemy)) {
-          emit(Square::E8, Square::C8, MoveFlag::QueenCastle);
+    if (want_quiets && !in_check_now && stage != GenStage::Evasions) {
+      constexpr std::uint8_t castle_kingside = white ? CastleWK : CastleBK;
+      constexpr std::uint8_t castle_queenside = white ? CastleWQ : CastleBQ;
+      constexpr Square king_home = white ? Square::E1 : Square::E8;
+      constexpr Square f_file_sq = white ? Square::F1 : Square::F8;
+      constexpr Square g_file_sq = white ? Square::G1 : Square::G8;
+      constexpr Square d_file_sq = white ? Square::D1 : Square::D8;
+      constexpr Square c_file_sq = white ? Square::C1 : Square::C8;
+      constexpr Square b_file_sq = white ? Square::B1 : Square::B8;
+      if ((castling_ & castle_kingside) &&
+          !(occupancy() & (bit(f_file_sq) | bit(g_file_sq))) &&
+          !is_square_attacked(king_home, Them) &&
+          !is_square_attacked(f_file_sq, Them) &&
+          !is_square_attacked(g_file_sq, Them)) {
+        emit(king_home, g_file_sq, MoveFlag::KingCastle);
+      }
+      if ((castling_ & castle_queenside) &&
+          !(occupancy() &
+            (bit(d_file_sq) | bit(c_file_sq) | bit(b_file_sq))) &&
+          !is_square_attacked(king_home, Them) &&
+          !is_square_attacked(d_file_sq, Them) &&
+          !is_square_attacked(c_file_sq, Them)) {
+        emit(king_home, c_file_sq, MoveFlag::QueenCastle);
+      }
+    }
+  }
+
+  if (trace_moves) {
+    const char* stage_name = "all";
+    switch (stage) {
+      case GenStage::Captures:
+        stage_name = "captures";
+        break;
+      case GenStage::Quiets:
+        stage_name = "quiets";
+        break;
+      case GenStage::All:
+        stage_name = "all";
+        break;
+      case GenStage::Evasions:
+        stage_name = "evasions";
+        break;
+    }
+    std::ostringstream oss;
+    oss << "stage=" << stage_name
+        << " stm=" << (white ? "white" : "black")
+        << " legal=" << out.size();
+    if (sample_count > 0) {
+      oss << " moves=";
+      for (std::size_t idx = 0; idx < sample_count; ++idx) {
+        if (idx > 0) {
+          oss << ',';
         }
+        oss << move_to_uci(samples[idx]);
       }
     }
+    trace_emit(TraceTopic::Moves, oss.str());
   }
 }
 
@@ -1598,6 +1826,306 @@ bool Position::in_double_check(Color side, Bitboard& checkers) const {
   return (checkers & (checkers - 1ULL)) != 0ULL;
 }
 
+Move move_from_san(const Position& pos, std::string_view san) {
+  while (!san.empty() && (san.back() == '+' || san.back() == '#' ||
+                          san.back() == '!' || san.back() == '?')) {
+    san.remove_suffix(1);
+  }
+  if (san.empty()) {
+    return Move{};
+  }
+
+  const Color us = pos.side_to_move();
+
+  if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0") {
+    // Castling goes through the generator: its empty-path and attack
+    // requirements are exactly what generate_moves already encodes.
+    const bool king_side = san.size() == 3;
+    MoveList moves;
+    pos.generate_moves(moves, GenStage::Quiets);
+    for (const Move m : moves) {
+      const MoveFlag flag = move_flag(m);
+      if (flag == (king_side ? MoveFlag::KingCastle : MoveFlag::QueenCastle)) {
+        return m;
+      }
+    }
+    return Move{};
+  }
+
+  PieceType mover = PieceType::Pawn;
+  switch (san.front()) {
+    case 'K': mover = PieceType::King; break;
+    case 'Q': mover = PieceType::Queen; break;
+    case 'R': mover = PieceType::Rook; break;
+    case 'B': mover = PieceType::Bishop; break;
+    case 'N': mover = PieceType::Knight; break;
+    default: break;
+  }
+  if (mover != PieceType::Pawn) {
+    san.remove_prefix(1);
+  }
+
+  PieceType promo = PieceType::None;
+  if (san.size() >= 2 && san[san.size() - 2] == '=') {
+    switch (san.back()) {
+      case 'Q': promo = PieceType::Queen; break;
+      case 'R': promo = PieceType::Rook; break;
+      case 'B': promo = PieceType::Bishop; break;
+      case 'N': promo = PieceType::Knight; break;
+      default: return Move{};
+    }
+    san.remove_suffix(2);
+  }
+
+  if (san.size() < 2) {
+    return Move{};
+  }
+  const Square to = square_from_string(san.substr(san.size() - 2));
+  if (to == Square::None) {
+    return Move{};
+  }
+
+  bool capture = false;
+  File dis_file = File::A;
+  Rank dis_rank = Rank::R1;
+  bool have_file = false;
+  bool have_rank = false;
+  for (const char c : san.substr(0, san.size() - 2)) {
+    if (c == 'x') {
+      capture = true;
+    } else if (c >= 'a' && c <= 'h') {
+      dis_file = static_cast<File>(c - 'a');
+      have_file = true;
+    } else if (c >= '1' && c <= '8') {
+      dis_rank = static_cast<Rank>(c - '1');
+      have_rank = true;
+    } else {
+      return Move{};
+    }
+  }
+
+  const Piece target = pos.piece_on(to);
+  if (target != Piece::None && color_of(target) == us) {
+    return Move{};
+  }
+
+  if (mover == PieceType::Pawn) {
+    const int dir = (us == Color::White) ? 1 : -1;
+    const int to_rank = static_cast<int>(rank_of(to));
+    const int promo_rank = (us == Color::White) ? 7 : 0;
+    if ((promo != PieceType::None) != (to_rank == promo_rank)) {
+      return Move{};
+    }
+    const Piece our_pawn = make_piece(us, PieceType::Pawn);
+    Move m{};
+    if (capture) {
+      // SAN gives the source file; the source rank is fixed by the push
+      // direction, so the candidate mask is a single square.
+      const int from_rank = to_rank - dir;
+      const int file_delta =
+          static_cast<int>(dis_file) - static_cast<int>(file_of(to));
+      if (!have_file || from_rank < 0 || from_rank > 7 ||
+          (file_delta != 1 && file_delta != -1)) {
+        return Move{};
+      }
+      const Square from = make_square(dis_file, static_cast<Rank>(from_rank));
+      if (pos.piece_on(from) != our_pawn) {
+        return Move{};
+      }
+      if (to == pos.en_passant_square() && target == Piece::None) {
+        m = make_move(from, to, MoveFlag::EnPassant);
+      } else if (target != Piece::None) {
+        m = make_move(from, to,
+                      promo != PieceType::None ? MoveFlag::PromotionCapture
+                                               : MoveFlag::Capture,
+                      promo);
+      } else {
+        return Move{};
+      }
+    } else {
+      if (target != Piece::None || have_file) {
+        return Move{};
+      }
+      const int single_rank = to_rank - dir;
+      if (single_rank < 0 || single_rank > 7) {
+        return Move{};
+      }
+      const Square single =
+          make_square(file_of(to), static_cast<Rank>(single_rank));
+      if (pos.piece_on(single) == our_pawn) {
+        m = make_move(single, to,
+                      promo != PieceType::None ? MoveFlag::Promotion
+                                               : MoveFlag::Quiet,
+                      promo);
+      } else if (pos.piece_on(single) == Piece::None &&
+                 to_rank == ((us == Color::White) ? 3 : 4)) {
+        const Square push_from =
+            make_square(file_of(to), static_cast<Rank>(to_rank - 2 * dir));
+        if (pos.piece_on(push_from) != our_pawn) {
+          return Move{};
+        }
+        m = make_move(push_from, to, MoveFlag::DoublePush);
+      } else {
+        return Move{};
+      }
+    }
+    return pos.is_legal(m) ? m : Move{};
+  }
+
+  if (promo != PieceType::None) {
+    return Move{};
+  }
+
+  Bitboard candidates = pos.pieces(us, mover);
+  switch (mover) {
+    case PieceType::Knight:
+      candidates &= knight_attacks(to);
+      break;
+    case PieceType::Bishop:
+      candidates &= bishop_attacks(to, pos.occupancy());
+      break;
+    case PieceType::Rook:
+      candidates &= rook_attacks(to, pos.occupancy());
+      break;
+    case PieceType::Queen:
+      candidates &= bishop_attacks(to, pos.occupancy()) |
+                    rook_attacks(to, pos.occupancy());
+      break;
+    case PieceType::King:
+      candidates &= king_attacks(to);
+      break;
+    default:
+      return Move{};
+  }
+  if (have_file) {
+    candidates &= 0x0101010101010101ULL << static_cast<int>(dis_file);
+  }
+  if (have_rank) {
+    candidates &= 0xFFULL << (8 * static_cast<int>(dis_rank));
+  }
+  if (capture != (target != Piece::None)) {
+    return Move{};
+  }
+
+  const MoveFlag flag =
+      (target != Piece::None) ? MoveFlag::Capture : MoveFlag::Quiet;
+  Move found{};
+  while (candidates != 0ULL) {
+    const Square from = static_cast<Square>(__builtin_ctzll(candidates));
+    candidates &= candidates - 1ULL;
+    const Move m = make_move(from, to, flag);
+    if (pos.is_legal(m)) {
+      if (!found.is_null()) {
+        // Under-disambiguated SAN: refuse to guess between legal movers.
+        return Move{};
+      }
+      found = m;
+    }
+  }
+  return found;
+}
+
+std::string move_to_san(const Position& pos, Move move) {
+  if (move.is_null()) {
+    return "0000";
+  }
+  const MoveFlag flag = move_flag(move);
+  const Square from = from_square(move);
+  const Square to = to_square(move);
+  const Color us = pos.side_to_move();
+  const bool capture = flag == MoveFlag::Capture || flag == MoveFlag::EnPassant ||
+                       flag == MoveFlag::PromotionCapture;
+  std::string san;
+
+  if (flag == MoveFlag::KingCastle) {
+    san = "O-O";
+  } else if (flag == MoveFlag::QueenCastle) {
+    san = "O-O-O";
+  } else {
+    const PieceType mover = type_of(pos.piece_on(from));
+    if (mover == PieceType::Pawn) {
+      if (capture) {
+        san += static_cast<char>('a' + static_cast<int>(file_of(from)));
+        san += 'x';
+      }
+      san += square_to_string(to);
+      const PieceType promo = promotion_type(move);
+      if (promo != PieceType::None) {
+        san += '=';
+        san += "PNBRQK"[static_cast<int>(promo)];
+      }
+    } else {
+      san += "PNBRQK"[static_cast<int>(mover)];
+      // Minimal disambiguation: only needed when another legal mover of the
+      // same type reaches the destination. File wins over rank, both only
+      // when neither alone separates the candidates.
+      Bitboard others = pos.pieces(us, mover) & ~bit(from);
+      switch (mover) {
+        case PieceType::Knight:
+          others &= knight_attacks(to);
+          break;
+        case PieceType::Bishop:
+          others &= bishop_attacks(to, pos.occupancy());
+          break;
+        case PieceType::Rook:
+          others &= rook_attacks(to, pos.occupancy());
+          break;
+        case PieceType::Queen:
+          others &= bishop_attacks(to, pos.occupancy()) |
+                    rook_attacks(to, pos.occupancy());
+          break;
+        default:
+          others = 0ULL;
+          break;
+      }
+      bool ambiguous = false;
+      bool shares_file = false;
+      bool shares_rank = false;
+      while (others != 0ULL) {
+        const Square other = static_cast<Square>(__builtin_ctzll(others));
+        others &= others - 1ULL;
+        if (!pos.is_legal(make_move(other, to, flag))) {
+          continue;
+        }
+        ambiguous = true;
+        shares_file |= file_of(other) == file_of(from);
+        shares_rank |= rank_of(other) == rank_of(from);
+      }
+      if (ambiguous) {
+        if (!shares_file) {
+          san += static_cast<char>('a' + static_cast<int>(file_of(from)));
+        } else if (!shares_rank) {
+          san += static_cast<char>('1' + static_cast<int>(rank_of(from)));
+        } else {
+          san += static_cast<char>('a' + static_cast<int>(file_of(from)));
+          san += static_cast<char>('1' + static_cast<int>(rank_of(from)));
+        }
+      }
+      if (capture) {
+        san += 'x';
+      }
+      san += square_to_string(to);
+    }
+  }
+
+  Position next = pos;
+  Undo undo;
+  next.make(move, undo);
+  if (next.in_check(next.side_to_move())) {
+    MoveList replies;
+    next.generate_moves(replies, GenStage::All);
+    bool any_reply = false;
+    for (const Move reply : replies) {
+      if (next.is_legal(reply)) {
+        any_reply = true;
+        break;
+      }
+    }
+    san += any_reply ? '+' : '#';
+  }
+  return san;
+}
+
 std::string move_to_uci(Move move) {
   if (move.is_null()) {
     return "0000";
@@ -7,10 +7,10 @@
 #include <string_view>
 
 #include "common.h"
+#include "nnue.h"
 
 namespace bby {
 
-struct LegalMoveContext;
 
 enum CastlingRights : std::uint8_t {
   CastleNone = 0,
@@ -20,6 +20,26 @@ enum CastlingRights : std::uint8_t {
   CastleBQ = 1 << 3
 };
 
+// Per-node attack picture for the side to move: checkers, pin masks and the
+// king-danger squares the generator needs before emitting a single move.
+// Search computes it once on node entry and feeds it back into
+// generate_moves, so the staged capture/quiet calls and the in-check tests
+// share one set of slider lookups instead of each redoing them.
+struct AttackInfo {
+  Bitboard checkers{0ULL};
+  Bitboard pinned{0ULL};
+  // Squares the king may not step onto: enemy attacks computed with the
+  // king removed from the occupancy so it cannot retreat along a ray.
+  Bitboard danger{0ULL};
+  // Destinations that resolve a check for non-king movers: capture the
+  // checker or interpose. Open when not in check; empty in double check.
+  Bitboard check_mask{~0ULL};
+  std::array<Bitboard, 64> pin_masks{};
+  bool double_check{false};
+
+  [[nodiscard]] bool in_check() const { return checkers != 0ULL; }
+};
+
 class Position {
 public:
   Position();
@@ -32,14 +52,52 @@ public:
   [[nodiscard]] Bitboard occupancy(Color c) const { return occupied_[color_index(c)]; }
   [[nodiscard]] bool in_check(Color color) const;
   [[nodiscard]] std::uint64_t zobrist() const { return zobrist_; }
+  // Pawn-only zobrist, maintained incrementally alongside zobrist_. Keys the
+  // pawn-structure hash in eval; unchanged by non-pawn moves, castling, ep
+  // rights or side to move, so it is stable across most of the tree.
+  [[nodiscard]] std::uint64_t pawn_key() const { return pawn_key_; }
+  // Incremental PeSTO accumulators (white point of view) and game-phase sum,
+  // updated in O(1) per piece movement so evaluate() just blends them.
+  [[nodiscard]] int psqt_mg() const { return psqt_mg_; }
+  [[nodiscard]] int psqt_eg() const { return psqt_eg_; }
+  [[nodiscard]] int phase() const { return phase_; }
+  // NNUE hidden-layer sums, kept incremental once a network is loaded.
+  // Mutable cache: nnue_evaluate() refreshes it lazily on const positions.
+  [[nodiscard]] NnueAccumulator& nnue_accumulator() const { return nnue_; }
   [[nodiscard]] Square king_square(Color color) const { return kings_[color_index(color)]; }
   [[nodiscard]] std::uint8_t castling_rights() const { return castling_; }
   [[nodiscard]] Square en_passant_square() const { return ep_square_; }
   [[nodiscard]] Bitboard pieces(Color color, PieceType type) const;
   [[nodiscard]] bool is_sane(std::string* reason = nullptr) const;
 
+  // Attack picture for the current side to move; pass it back into
+  // generate_moves to reuse one computation across generation stages.
+  [[nodiscard]] AttackInfo attack_info() const;
+
+  // Emits fully legal moves for the requested stage; pins and check
+  // resolution are folded into generation rather than filtered afterwards.
   void generate_moves(MoveList& out, GenStage stage) const;
+  void generate_moves(MoveList& out, GenStage stage, const AttackInfo& info) const;
   bool is_legal(Move m) const;
+  // Cheap structural check that `m` could have been generated here: correct
+  // mover, flag consistent with the target square, and the piece actually
+  // attacks the destination. Guards hash-table moves before is_legal(),
+  // which blindly plays the move. Castle moves are rejected — their path
+  // and attack requirements need the full generator.
+  bool is_pseudo_legal(Move m) const;
+  // True when making `m` puts the opponent in check, computed from attack
+  // bitboards (direct checks plus discovered-slider rays) without touching
+  // make/unmake. `m` must be legal in this position.
+  bool gives_check(Move m) const;
+
+  // True when the side to move has a reversible move that transposes back
+  // to a position already on the search path. `path` holds the ancestors'
+  // zobrist keys indexed by ply, `ply` is this node's distance from the
+  // root, and `max_back` caps how far the scan reaches (plies since a null
+  // move). Constant time per candidate distance via cuckoo move tables
+  // keyed on zobrist differences.
+  [[nodiscard]] bool upcoming_repetition(const std::uint64_t* path, int ply,
+                                         int max_back) const;
 
   void make(Move m, Undo& undo);
   void unmake(Move m, const Undo& undo);
@@ -51,6 +109,13 @@ public:
   [[nodiscard]] std::uint16_t fullmove_number() const { return fullmove_number_; }
 
 private:
+  // Color-specialized generation body behind generate_moves: pawn shift
+  // directions, promotion ranks, and castle masks become compile-time
+  // constants so the per-move loops carry no side-to-move branches.
+  template <Color Us>
+  void generate_moves_impl(MoveList& out, GenStage stage, const AttackInfo& info) const;
+  template <Color Us>
+  [[nodiscard]] AttackInfo attack_info_impl() const;
   void clear();
   void put_piece(Piece pc, Square sq);
   void remove_piece(Piece pc, Square sq);
@@ -60,14 +125,11 @@ private:
   void recompute_occupancy();
   void recompute_zobrist();
   [[nodiscard]] std::uint64_t compute_zobrist() const;
+  [[nodiscard]] std::uint64_t compute_pawn_key() const;
   bool is_square_attacked(Square sq, Color by) const;
-  void generate_pseudo_legal_cb(void (*cb)(Move, void*), void* ctx) const;
-  void generate_pseudo_legal(MoveList& out, GenStage stage) const;
   Bitboard pinned_mask(Color us, std::array<Bitboard, 64>& pin_masks) const;
   Bitboard attacked_squares(Color by) const;
   bool in_double_check(Color side, Bitboard& checkers) const;
-  static bool square_attacked_cached(LegalMoveContext& ctx, Square sq);
-  static void legal_move_callback(Move move, void* ctx);
 
   std::array<Piece, 64> squares_{};
   std::array<std::array<Bitboard, 6>, 2> pieces_{{}};
@@ -81,8 +143,25 @@ private:
   std::uint8_t halfmove_clock_{0};
   std::uint16_t fullmove_number_{1};
   std::uint64_t zobrist_{0};
+  std::uint64_t pawn_key_{0};
+  int psqt_mg_{0};
+  int psqt_eg_{0};
+  int phase_{0};
+  mutable NnueAccumulator nnue_{};
 };
 
 std::string move_to_uci(Move move);
 
+// Parses Standard Algebraic Notation against `pos` without running the full
+// move generator: the disambiguation fields mask candidate from-squares via
+// the attack tables and each survivor is verified with is_legal(). Accepts
+// check/mate/annotation suffixes and both O-O and 0-0 castle spellings.
+// Returns the null move when `san` is malformed, illegal, or ambiguous.
+Move move_from_san(const Position& pos, std::string_view san);
+
+// SAN writer counterpart of move_from_san: minimal disambiguation, with the
+// '+'/'#' suffix derived from the resulting position. `move` must be legal
+// in `pos`; the null move renders as "0000".
+std::string move_to_san(const Position& pos, Move move);
+
 }  // namespace bby
@@ -0,0 +1,53 @@
+#pragma once
+/**
+ * @file book.h
+ * @brief Memory-mapped Polyglot (.bin) opening book probing.
+ *
+ * The book file stays mapped read-only for the lifetime of the object and
+ * entries are binary-searched in place, so a probe costs a key computation
+ * plus O(log n) page touches — no parsing or allocation per move. Keys use
+ * the standard Polyglot random table, not the engine zobrist, for
+ * compatibility with books produced by any Polyglot tool.
+ */
+
+#include <cstdint>
+#include <string>
+
+#include "board.h"
+
+namespace bby {
+
+/** Position key under the Polyglot hashing convention. */
+std::uint64_t polyglot_key(const Position& pos);
+
+class PolyglotBook {
+public:
+  PolyglotBook() = default;
+  ~PolyglotBook();
+  PolyglotBook(const PolyglotBook&) = delete;
+  PolyglotBook& operator=(const PolyglotBook&) = delete;
+
+  /**
+   * Map `path`; any previously opened book is released first. Returns false
+   * (leaving the book closed) when the file is missing, unmappable, or not a
+   * multiple of the 16-byte entry size.
+   */
+  bool open(const std::string& path);
+  void close();
+  [[nodiscard]] bool is_open() const { return entries_ != 0; }
+
+  /**
+   * Highest-weighted book move for `pos`, or a null move when the position
+   * is out of book. Decoded moves are matched against the legal move list,
+   * so a corrupt or mismatched entry can never inject an illegal move.
+   */
+  [[nodiscard]] Move probe(const Position& pos) const;
+
+private:
+  const unsigned char* base_{nullptr};
+  std::size_t bytes_{0};
+  std::size_t entries_{0};
+  bool mapped_{false};
+};
+
+}  // namespace bby
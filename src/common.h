@@ -125,7 +125,7 @@ constexpr std::array<PieceType, 13> kPieceTypes = {
     PieceType::King};
 }  // namespace detail
 
-enum class GenStage : std::uint8_t { Captures = 0, Quiets = 1, All = 2 };
+enum class GenStage : std::uint8_t { Captures = 0, Quiets = 1, All = 2, Evasions = 3 };
 
 constexpr Piece make_piece(Color c, PieceType pt) {
   if (pt == PieceType::None) {
@@ -2,10 +2,16 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cctype>
+#include <chrono>
+#include <cstdio>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 namespace bby {
 namespace {
@@ -25,6 +31,88 @@ TraceWriter& trace_writer() {
   return writer;
 }
 
+// 64K records (1.5 MB) per search thread; sized so the drainer keeps up at
+// production node rates with drops only under pathological burst lengths.
+constexpr std::size_t kTraceRingCapacity = std::size_t{1} << 16;
+
+// Single-producer (the owning search thread) / single-consumer (the drain
+// thread) ring. head is only written by the producer, tail only by the
+// consumer; release/acquire pairs order the record payload with the index.
+struct TraceRing {
+  std::unique_ptr<TraceRecord[]> records{new TraceRecord[kTraceRingCapacity]};
+  std::atomic<std::uint64_t> head{0};
+  std::atomic<std::uint64_t> tail{0};
+  std::atomic<std::uint64_t> dropped{0};
+  std::uint8_t thread_index{0};
+};
+
+struct TraceBinaryState {
+  std::mutex registry_mutex;
+  std::vector<std::unique_ptr<TraceRing>> rings;
+  std::atomic<bool> active{false};
+  std::thread drainer;
+  std::FILE* file{nullptr};
+};
+
+TraceBinaryState& binary_state() {
+  static TraceBinaryState state;
+  return state;
+}
+
+TraceRing& thread_trace_ring() {
+  thread_local TraceRing* ring = nullptr;
+  if (ring == nullptr) {
+    TraceBinaryState& state = binary_state();
+    std::lock_guard<std::mutex> lock(state.registry_mutex);
+    state.rings.push_back(std::make_unique<TraceRing>());
+    ring = state.rings.back().get();
+    ring->thread_index = static_cast<std::uint8_t>(
+        std::min<std::size_t>(state.rings.size() - 1, 255));
+  }
+  return *ring;
+}
+
+void drain_ring(TraceRing& ring, std::FILE* file) {
+  const std::uint64_t head = ring.head.load(std::memory_order_acquire);
+  std::uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+  while (tail != head) {
+    const TraceRecord& record = ring.records[tail % kTraceRingCapacity];
+    std::fwrite(&record, sizeof(TraceRecord), 1, file);
+    ++tail;
+  }
+  ring.tail.store(tail, std::memory_order_release);
+}
+
+void drain_loop() {
+  TraceBinaryState& state = binary_state();
+  while (state.active.load(std::memory_order_acquire)) {
+    {
+      std::lock_guard<std::mutex> lock(state.registry_mutex);
+      for (const auto& ring : state.rings) {
+        drain_ring(*ring, state.file);
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+}
+
+std::int16_t clamp16(int value) {
+  return static_cast<std::int16_t>(std::clamp(value, -32768, 32767));
+}
+
+constexpr std::array<const char*, static_cast<std::size_t>(TraceEvent::Count)>
+    kTraceEventNames = {
+        "static futility",       "static futility skip-improving",
+        "razoring",              "razoring skip-improving",
+        "null attempt",          "null verify",
+        "null verify-fail",      "null prune",
+        "multi-cut",             "lmr skip-root",
+        "extend recapture",      "extend check",
+        "lmr reduce",            "pvs narrow",
+        "pvs research",          "node",
+        "candidate",             "result",
+};
+
 std::string lowercase(std::string_view sv) {
   std::string out(sv.begin(), sv.end());
   std::transform(out.begin(), out.end(), out.begin(), [](unsigned char c) {
@@ -102,6 +190,112 @@ void trace_emit(TraceTopic topic, std::string_view message) {
   }
 }
 
+bool trace_binary_active(TraceTopic topic) {
+  return binary_state().active.load(std::memory_order_acquire) &&
+         trace_enabled(topic);
+}
+
+void trace_binary(TraceTopic topic, TraceEvent event, int ply, int depth,
+                  std::uint32_t move, int a, int b, int c, int d) {
+  TraceRing& ring = thread_trace_ring();
+  const std::uint64_t head = ring.head.load(std::memory_order_relaxed);
+  if (head - ring.tail.load(std::memory_order_acquire) >= kTraceRingCapacity) {
+    ring.dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  TraceRecord& record = ring.records[head % kTraceRingCapacity];
+  record.move = move;
+  record.value_a = clamp16(a);
+  record.value_b = clamp16(b);
+  record.value_c = clamp16(c);
+  record.value_d = clamp16(d);
+  record.topic = static_cast<std::uint8_t>(topic);
+  record.event = static_cast<std::uint8_t>(event);
+  record.thread = ring.thread_index;
+  record.ply = static_cast<std::uint8_t>(std::clamp(ply, 0, kMaxPly - 1));
+  record.depth = static_cast<std::int8_t>(std::clamp(depth, -128, 127));
+  record.sequence = static_cast<std::uint32_t>(head);
+  ring.head.store(head + 1, std::memory_order_release);
+}
+
+bool trace_binary_start(const std::string& path) {
+  TraceBinaryState& state = binary_state();
+  if (state.active.load(std::memory_order_acquire)) {
+    trace_binary_stop();
+  }
+  std::FILE* file = std::fopen(path.c_str(), "wb");
+  if (file == nullptr) {
+    return false;
+  }
+  // Header: magic, format version, record size; lets decoders reject files
+  // from a different layout generation.
+  const char magic[8] = {'B', 'B', 'Y', 'T', 'R', 'C', '0', '1'};
+  const std::uint32_t record_size = sizeof(TraceRecord);
+  std::fwrite(magic, sizeof(magic), 1, file);
+  std::fwrite(&record_size, sizeof(record_size), 1, file);
+  {
+    std::lock_guard<std::mutex> lock(state.registry_mutex);
+    state.file = file;
+    for (const auto& ring : state.rings) {
+      // Discard anything left from a previous session.
+      ring->tail.store(ring->head.load(std::memory_order_acquire),
+                       std::memory_order_release);
+      ring->dropped.store(0, std::memory_order_relaxed);
+    }
+  }
+  state.active.store(true, std::memory_order_release);
+  state.drainer = std::thread(drain_loop);
+  return true;
+}
+
+void trace_binary_stop() {
+  TraceBinaryState& state = binary_state();
+  if (!state.active.load(std::memory_order_acquire)) {
+    return;
+  }
+  state.active.store(false, std::memory_order_release);
+  if (state.drainer.joinable()) {
+    state.drainer.join();
+  }
+  std::lock_guard<std::mutex> lock(state.registry_mutex);
+  for (const auto& ring : state.rings) {
+    drain_ring(*ring, state.file);
+  }
+  std::fclose(state.file);
+  state.file = nullptr;
+}
+
+std::uint64_t trace_binary_dropped() {
+  TraceBinaryState& state = binary_state();
+  std::lock_guard<std::mutex> lock(state.registry_mutex);
+  std::uint64_t total = 0;
+  for (const auto& ring : state.rings) {
+    total += ring->dropped.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+std::string decode_trace_record(const TraceRecord& record) {
+  std::ostringstream oss;
+  const auto topic = static_cast<TraceTopic>(record.topic);
+  oss << "trace " << trace_topic_name(topic);
+  if (record.event < static_cast<std::uint8_t>(TraceEvent::Count)) {
+    oss << ' ' << kTraceEventNames[record.event];
+  } else {
+    oss << " event-" << static_cast<int>(record.event);
+  }
+  oss << " thread=" << static_cast<int>(record.thread)
+      << " seq=" << record.sequence
+      << " ply=" << static_cast<int>(record.ply)
+      << " depth=" << static_cast<int>(record.depth);
+  if (record.move != 0) {
+    oss << " move=" << move_to_uci(Move{record.move});
+  }
+  oss << " a=" << record.value_a << " b=" << record.value_b
+      << " c=" << record.value_c << " d=" << record.value_d;
+  return oss.str();
+}
+
 InvariantStatus validate_position(const Position& pos) {
   InvariantStatus status;
   if (!pos.is_sane(&status.message)) {
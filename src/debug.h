@@ -27,6 +27,68 @@ void trace_emit(TraceTopic topic, std::string_view message);
 using TraceWriter = void (*)(TraceTopic topic, std::string_view payload);
 void set_trace_writer(TraceWriter writer);
 
+// Binary hot-path tracing ---------------------------------------------------
+//
+// The string path above formats an ostringstream per event, which costs more
+// than the traced work at production node rates. Hot topics (Search, QSearch)
+// can instead emit fixed-size TraceRecords into a per-thread lock-free ring
+// that a background thread drains to a file; `trace decode` or any offline
+// tool turns the records back into the familiar text. A full ring drops
+// records (counted) rather than ever blocking the search thread.
+
+enum class TraceEvent : std::uint8_t {
+  StaticFutility = 0,
+  StaticFutilitySkip,
+  Razor,
+  RazorSkip,
+  NullAttempt,
+  NullVerify,
+  NullVerifyFail,
+  NullPrune,
+  MultiCut,
+  LmrSkipRoot,
+  ExtendRecapture,
+  ExtendCheck,
+  LmrReduce,
+  PvsNarrow,
+  PvsResearch,
+  QNode,
+  QCandidate,
+  QResult,
+  Count
+};
+
+// 24-byte POD; the a..d payload slots carry the same values the text path
+// prints for the event (scores, margins, reductions), clamped to 16 bits.
+struct TraceRecord {
+  std::uint32_t move{0};
+  std::int16_t value_a{0};
+  std::int16_t value_b{0};
+  std::int16_t value_c{0};
+  std::int16_t value_d{0};
+  std::uint8_t topic{0};
+  std::uint8_t event{0};
+  std::uint8_t thread{0};
+  std::uint8_t ply{0};
+  std::int8_t depth{0};
+  std::uint8_t pad[3]{};
+  std::uint32_t sequence{0};
+};
+static_assert(sizeof(TraceRecord) == 24, "TraceRecord layout drifted");
+
+// True when a binary sink is open and the topic is enabled; hot paths check
+// this once per node and skip string formatting entirely while it holds.
+bool trace_binary_active(TraceTopic topic);
+void trace_binary(TraceTopic topic, TraceEvent event, int ply, int depth,
+                  std::uint32_t move, int a, int b, int c, int d);
+// Opens `path` and starts the drain thread; false when the file cannot be
+// opened. Stop flushes every ring and reports the drop count, if any.
+bool trace_binary_start(const std::string& path);
+void trace_binary_stop();
+std::uint64_t trace_binary_dropped();
+// One record back to the text form the string path would have produced.
+std::string decode_trace_record(const TraceRecord& record);
+
 struct InvariantStatus {
   bool ok{true};
   std::string message{"ok"};
@@ -0,0 +1,636 @@
+#include "distributed.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "bbinit.h"
+#include "board.h"
+#include "epd.h"
+#include "search.h"
+#include "searchparams.h"
+#include "threadpool.h"
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace bby {
+
+namespace {
+
+// The wire protocol is deliberately line-based and human-readable so a
+// misbehaving farm node can be debugged with netcat:
+//   coordinator -> worker   "bbyd 1 depth D movetime MS nodes N\n"
+//   worker -> coordinator   "ok SLOTS\n"
+//   coordinator -> worker   "go INDEX FEN\n"          (up to SLOTS in flight)
+//   worker -> coordinator   "done INDEX {json}\n" or "err INDEX MESSAGE\n"
+// Closing the connection ends the session; the worker returns to accept().
+
+constexpr int kProtocolVersion = 1;
+constexpr int kDefaultPort = 4871;
+
+struct DistributedConfig {
+  bool worker_mode{false};
+  std::string epd_path;
+  std::vector<std::string> hosts;  // host:port endpoints, coordinator side
+  int port{kDefaultPort};
+  int depth{-1};
+  std::int64_t movetime_ms{-1};
+  std::int64_t nodes_limit{-1};
+  int threads{0};
+  std::size_t hash_mb{16};
+};
+
+bool parse_int(std::string_view token, long long& out) {
+  if (token.empty()) {
+    return false;
+  }
+  char* end = nullptr;
+  const std::string copy(token);
+  const long long value = std::strtoll(copy.c_str(), &end, 10);
+  if (end == copy.c_str() || (end && *end != '\0')) {
+    return false;
+  }
+  out = value;
+  return true;
+}
+
+void print_usage() {
+  std::printf("Usage: bby distributed worker [--port P] [--threads N] [--hash MB]\n");
+  std::printf("       bby distributed FILE --host HOST[:PORT] [--host ...]\n");
+  std::printf("                       [--depth N] [--movetime MS] [--nodes LIMIT]\n");
+  std::printf("The coordinator shards the EPD file across the listed workers and\n");
+  std::printf("emits one JSON object per position as results stream back; work\n");
+  std::printf("outstanding on a lost worker is reassigned to the survivors.\n");
+  std::fflush(stdout);
+}
+
+DistributedConfig parse_cli_arguments(int argc, const char* argv[]) {
+  DistributedConfig cfg;
+  for (int idx = 0; idx < argc; ++idx) {
+    std::string_view arg(argv[idx]);
+    auto consume_next = [&](long long& out) -> bool {
+      if (idx + 1 >= argc) {
+        return false;
+      }
+      ++idx;
+      return parse_int(argv[idx], out);
+    };
+
+    if (arg == "worker" && cfg.epd_path.empty()) {
+      cfg.worker_mode = true;
+    } else if (arg == "--port") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.port = static_cast<int>(std::clamp<long long>(value, 1, 65535));
+      }
+    } else if (arg == "--host") {
+      if (idx + 1 < argc) {
+        cfg.hosts.emplace_back(argv[++idx]);
+      }
+    } else if (arg == "--depth") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.depth = static_cast<int>(std::max<long long>(1, value));
+      }
+    } else if (arg == "--movetime") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.movetime_ms = std::max<long long>(1, value);
+      }
+    } else if (arg == "--nodes") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.nodes_limit = std::max<long long>(1, value);
+      }
+    } else if (arg == "--threads") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.threads = static_cast<int>(std::clamp<long long>(value, 1, 512));
+      }
+    } else if (arg == "--hash") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.hash_mb = static_cast<std::size_t>(std::max<long long>(1, value));
+      }
+    } else if (arg == "--help" || arg == "-h") {
+      print_usage();
+      std::exit(0);
+    } else if (cfg.epd_path.empty()) {
+      cfg.epd_path = std::string(arg);
+    }
+  }
+  return cfg;
+}
+
+std::string escape_json(std::string_view text) {
+  std::string out;
+  out.reserve(text.size());
+  for (const char c : text) {
+    if (c == '"' || c == '\\') {
+      out.push_back('\\');
+    }
+    out.push_back(c);
+  }
+  return out;
+}
+
+#if defined(__linux__)
+
+// Blocking line reader over one socket; the buffer persists across calls so
+// short reads and coalesced lines are both handled.
+class LineSocket {
+public:
+  explicit LineSocket(int fd) : fd_(fd) {}
+  ~LineSocket() {
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
+  }
+  LineSocket(const LineSocket&) = delete;
+  LineSocket& operator=(const LineSocket&) = delete;
+
+  bool read_line(std::string& out) {
+    for (;;) {
+      const auto newline = buffer_.find('\n');
+      if (newline != std::string::npos) {
+        out.assign(buffer_, 0, newline);
+        buffer_.erase(0, newline + 1);
+        if (!out.empty() && out.back() == '\r') {
+          out.pop_back();
+        }
+        return true;
+      }
+      char chunk[4096];
+      const ssize_t got = ::recv(fd_, chunk, sizeof(chunk), 0);
+      if (got <= 0) {
+        return false;
+      }
+      buffer_.append(chunk, static_cast<std::size_t>(got));
+    }
+  }
+
+  bool write_line(const std::string& line) {
+    std::string framed = line;
+    framed.push_back('\n');
+    std::size_t sent = 0;
+    while (sent < framed.size()) {
+      // MSG_NOSIGNAL: a vanished peer must surface as an error return, not
+      // SIGPIPE, so the coordinator can reshard.
+      const ssize_t wrote = ::send(fd_, framed.data() + sent,
+                                   framed.size() - sent, MSG_NOSIGNAL);
+      if (wrote <= 0) {
+        return false;
+      }
+      sent += static_cast<std::size_t>(wrote);
+    }
+    return true;
+  }
+
+private:
+  int fd_;
+  std::string buffer_;
+};
+
+// ---------------------------------------------------------------------------
+// Worker: accept one coordinator at a time and run its shard on the local
+// pool, mirroring the analyze pipeline (bounded handoff, per-thread session).
+
+struct WorkerJob {
+  std::size_t index{0};
+  std::string fen;
+};
+
+int run_worker(const DistributedConfig& cfg) {
+  const int listen_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (listen_fd < 0) {
+    std::fprintf(stderr, "distributed: socket: %s\n", std::strerror(errno));
+    return 2;
+  }
+  const int reuse = 1;
+  ::setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(static_cast<std::uint16_t>(cfg.port));
+  if (::bind(listen_fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) < 0 ||
+      ::listen(listen_fd, 1) < 0) {
+    std::fprintf(stderr, "distributed: cannot listen on port %d: %s\n", cfg.port,
+                 std::strerror(errno));
+    ::close(listen_fd);
+    return 2;
+  }
+
+  const int threads =
+      (cfg.threads > 0)
+          ? cfg.threads
+          : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+  // Same re-entrancy rule as the testsuite runner: hash allocation may clear
+  // through worker_pool(), so sessions are built before workers start.
+  std::vector<std::unique_ptr<SearchSession>> sessions;
+  sessions.reserve(static_cast<std::size_t>(threads));
+  for (int idx = 0; idx < threads; ++idx) {
+    sessions.push_back(std::make_unique<SearchSession>());
+    sessions.back()->set_hash_size(cfg.hash_mb);
+  }
+
+  std::fprintf(stderr, "distributed: worker listening on port %d (%d threads)\n",
+               cfg.port, threads);
+
+  for (;;) {
+    const int conn_fd = ::accept(listen_fd, nullptr, nullptr);
+    if (conn_fd < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      std::fprintf(stderr, "distributed: accept: %s\n", std::strerror(errno));
+      ::close(listen_fd);
+      return 2;
+    }
+    LineSocket sock(conn_fd);
+
+    std::string line;
+    if (!sock.read_line(line)) {
+      continue;
+    }
+    std::istringstream handshake(line);
+    std::string magic;
+    int version = 0;
+    Limits limits;
+    handshake >> magic >> version;
+    if (magic != "bbyd" || version != kProtocolVersion) {
+      sock.write_line("error unsupported protocol");
+      continue;
+    }
+    std::string key;
+    long long value = 0;
+    while (handshake >> key >> value) {
+      if (key == "depth" && value > 0) {
+        limits.depth = static_cast<std::int16_t>(value);
+      } else if (key == "movetime" && value > 0) {
+        limits.movetime_ms = value;
+      } else if (key == "nodes" && value > 0) {
+        limits.nodes = value;
+      }
+    }
+    if (limits.depth <= 0 && limits.movetime_ms <= 0 && limits.nodes <= 0) {
+      // An unbounded shard would never return its first result.
+      limits.depth = 10;
+    }
+    if (!sock.write_line("ok " + std::to_string(threads))) {
+      continue;
+    }
+
+    // Searchers drain the queue while this thread keeps reading requests, so
+    // up to `threads` positions run concurrently per the coordinator window.
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    std::deque<WorkerJob> queue;
+    bool closed = false;
+    std::mutex write_mutex;
+
+    ThreadPool& pool = worker_pool();
+    pool.launch(static_cast<std::size_t>(threads), [&](std::size_t worker) {
+      SearchSession& session = *sessions[worker];
+      for (;;) {
+        WorkerJob job;
+        {
+          std::unique_lock<std::mutex> lock(queue_mutex);
+          queue_cv.wait(lock, [&] { return !queue.empty() || closed; });
+          if (queue.empty()) {
+            return;
+          }
+          job = std::move(queue.front());
+          queue.pop_front();
+        }
+        Position pos;
+        try {
+          pos = Position::from_fen(job.fen, false);
+        } catch (const std::exception&) {
+          std::lock_guard<std::mutex> lock(write_mutex);
+          sock.write_line("err " + std::to_string(job.index) + " invalid FEN");
+          continue;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        const SearchResult result = session.run(pos, limits);
+        const auto time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                 std::chrono::steady_clock::now() - start)
+                                 .count();
+        std::string pv;
+        for (const Move m : result.pv) {
+          if (!pv.empty()) {
+            pv.push_back(' ');
+          }
+          pv += move_to_uci(m);
+        }
+        char json[1024];
+        std::snprintf(json, sizeof(json),
+                      "{\"index\": %zu, \"fen\": \"%s\", \"best\": \"%s\", "
+                      "\"eval\": %d, \"depth\": %d, \"seldepth\": %d, "
+                      "\"nodes\": %lld, \"time_ms\": %lld, \"pv\": \"%s\"}",
+                      job.index, escape_json(job.fen).c_str(),
+                      move_to_uci(result.best).c_str(),
+                      static_cast<int>(result.eval), result.depth,
+                      result.seldepth, static_cast<long long>(result.nodes),
+                      static_cast<long long>(time_ms), pv.c_str());
+        std::lock_guard<std::mutex> lock(write_mutex);
+        sock.write_line("done " + std::to_string(job.index) + " " + json);
+      }
+    });
+
+    while (sock.read_line(line)) {
+      std::istringstream request(line);
+      std::string verb;
+      std::size_t index = 0;
+      request >> verb >> index;
+      if (verb != "go") {
+        continue;
+      }
+      std::string fen;
+      std::getline(request, fen);
+      const auto content = fen.find_first_not_of(' ');
+      if (content == std::string::npos) {
+        continue;
+      }
+      fen.erase(0, content);
+      {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        queue.push_back(WorkerJob{index, std::move(fen)});
+      }
+      queue_cv.notify_one();
+    }
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex);
+      closed = true;
+      queue.clear();
+    }
+    queue_cv.notify_all();
+    pool.wait();
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Coordinator: one connection thread per worker pulls from a shared deque,
+// keeps a window of in-flight positions sized to the worker's thread count,
+// and pushes anything outstanding back when the connection dies.
+
+struct ShardState {
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::deque<std::size_t> pending;      // indices not yet assigned
+  std::size_t completed{0};
+  std::size_t total{0};
+  int live_workers{0};
+};
+
+int connect_endpoint(const std::string& endpoint, int default_port) {
+  std::string host = endpoint;
+  std::string port = std::to_string(default_port);
+  const auto colon = endpoint.rfind(':');
+  if (colon != std::string::npos) {
+    host = endpoint.substr(0, colon);
+    port = endpoint.substr(colon + 1);
+  }
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* results = nullptr;
+  if (::getaddrinfo(host.c_str(), port.c_str(), &hints, &results) != 0) {
+    return -1;
+  }
+  int fd = -1;
+  for (const addrinfo* entry = results; entry != nullptr; entry = entry->ai_next) {
+    fd = ::socket(entry->ai_family, entry->ai_socktype, entry->ai_protocol);
+    if (fd < 0) {
+      continue;
+    }
+    if (::connect(fd, entry->ai_addr, entry->ai_addrlen) == 0) {
+      break;
+    }
+    ::close(fd);
+    fd = -1;
+  }
+  ::freeaddrinfo(results);
+  return fd;
+}
+
+void coordinator_connection(const DistributedConfig& cfg, const std::string& endpoint,
+                            const std::vector<std::string_view>& fens,
+                            ShardState& shard, std::mutex& out_mutex) {
+  const int fd = connect_endpoint(endpoint, cfg.port);
+  if (fd < 0) {
+    std::fprintf(stderr, "distributed: cannot reach %s\n", endpoint.c_str());
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    --shard.live_workers;
+    return;
+  }
+  LineSocket sock(fd);
+
+  std::ostringstream handshake;
+  handshake << "bbyd " << kProtocolVersion;
+  if (cfg.depth > 0) {
+    handshake << " depth " << cfg.depth;
+  }
+  if (cfg.movetime_ms > 0) {
+    handshake << " movetime " << cfg.movetime_ms;
+  }
+  if (cfg.nodes_limit > 0) {
+    handshake << " nodes " << cfg.nodes_limit;
+  }
+  std::string line;
+  int slots = 0;
+  if (!sock.write_line(handshake.str()) || !sock.read_line(line) ||
+      line.rfind("ok ", 0) != 0 ||
+      (slots = std::atoi(line.c_str() + 3)) <= 0) {
+    std::fprintf(stderr, "distributed: handshake with %s failed\n",
+                 endpoint.c_str());
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    --shard.live_workers;
+    return;
+  }
+
+  // Double-buffer the window so the worker's searchers never idle between a
+  // result landing and the next request crossing the wire.
+  const std::size_t window = static_cast<std::size_t>(slots) * 2;
+  std::vector<std::size_t> outstanding;
+  outstanding.reserve(window);
+
+  auto abandon = [&] {
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      for (const std::size_t index : outstanding) {
+        shard.pending.push_front(index);
+      }
+      --shard.live_workers;
+    }
+    shard.changed.notify_all();
+  };
+
+  for (;;) {
+    // Top the window up from the shared deque.
+    while (outstanding.size() < window) {
+      std::size_t index = 0;
+      {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.pending.empty()) {
+          break;
+        }
+        index = shard.pending.front();
+        shard.pending.pop_front();
+      }
+      outstanding.push_back(index);
+      if (!sock.write_line("go " + std::to_string(index) + " " +
+                           std::string(fens[index]))) {
+        abandon();
+        return;
+      }
+    }
+    if (outstanding.empty()) {
+      // Drained with nothing in flight. Stay connected until everything is
+      // done: work outstanding on a worker that dies later gets resharded
+      // through the pending deque and must find a live connection here.
+      std::unique_lock<std::mutex> lock(shard.mutex);
+      if (shard.completed == shard.total) {
+        return;
+      }
+      if (shard.pending.empty()) {
+        shard.changed.wait(lock, [&] {
+          return !shard.pending.empty() || shard.completed == shard.total;
+        });
+      }
+      continue;
+    }
+    if (!sock.read_line(line)) {
+      abandon();
+      return;
+    }
+    std::istringstream reply(line);
+    std::string verb;
+    std::size_t index = 0;
+    reply >> verb >> index;
+    const auto slot = std::find(outstanding.begin(), outstanding.end(), index);
+    if (slot == outstanding.end()) {
+      continue;  // stale or duplicate reply; ignore
+    }
+    outstanding.erase(slot);
+    if (verb == "done") {
+      std::string json;
+      std::getline(reply, json);
+      const auto content = json.find_first_not_of(' ');
+      std::lock_guard<std::mutex> lock(out_mutex);
+      std::printf("%s\n", content == std::string::npos ? ""
+                                                       : json.c_str() + content);
+      std::fflush(stdout);
+    } else if (verb == "err") {
+      std::string message;
+      std::getline(reply, message);
+      std::lock_guard<std::mutex> lock(out_mutex);
+      std::printf("{\"index\": %zu, \"fen\": \"%s\", \"error\": \"%s\"}\n", index,
+                  escape_json(fens[index]).c_str(),
+                  escape_json(message).c_str());
+      std::fflush(stdout);
+    } else {
+      continue;
+    }
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      ++shard.completed;
+    }
+    shard.changed.notify_all();
+  }
+}
+
+int run_coordinator(const DistributedConfig& cfg) {
+  if (cfg.hosts.empty()) {
+    std::fprintf(stderr, "distributed: no --host workers given\n");
+    return 2;
+  }
+  EpdMapResult loaded = map_epd_file(cfg.epd_path);
+  for (const EpdLoadError& error : loaded.errors) {
+    std::fprintf(stderr, "distributed: %s:%zu: %s\n", cfg.epd_path.c_str(),
+                 error.line, error.message.c_str());
+  }
+  const auto& records = loaded.file.records();
+  if (records.empty()) {
+    std::fprintf(stderr, "distributed: no positions in %s\n", cfg.epd_path.c_str());
+    return 2;
+  }
+
+  std::vector<std::string_view> fens;
+  fens.reserve(records.size());
+  for (const EpdFile::Record& record : records) {
+    fens.push_back(record.fen);
+  }
+
+  ShardState shard;
+  shard.total = fens.size();
+  shard.live_workers = static_cast<int>(cfg.hosts.size());
+  for (std::size_t index = 0; index < fens.size(); ++index) {
+    shard.pending.push_back(index);
+  }
+
+  std::mutex out_mutex;
+  std::vector<std::thread> connections;
+  connections.reserve(cfg.hosts.size());
+  for (const std::string& endpoint : cfg.hosts) {
+    connections.emplace_back(coordinator_connection, std::cref(cfg),
+                             std::cref(endpoint), std::cref(fens),
+                             std::ref(shard), std::ref(out_mutex));
+  }
+  for (std::thread& connection : connections) {
+    connection.join();
+  }
+
+  if (shard.completed < shard.total) {
+    std::fprintf(stderr,
+                 "distributed: %zu of %zu positions incomplete (all workers lost)\n",
+                 shard.total - shard.completed, shard.total);
+    return 3;
+  }
+  return 0;
+}
+
+#endif  // defined(__linux__)
+
+}  // namespace
+
+int distributed_cli_main(int argc, const char* argv[]) {
+  (void)initialize();
+  const DistributedConfig cfg = parse_cli_arguments(argc, argv);
+#if defined(__linux__)
+  if (cfg.worker_mode) {
+    return run_worker(cfg);
+  }
+  if (cfg.epd_path.empty()) {
+    print_usage();
+    return 2;
+  }
+  return run_coordinator(cfg);
+#else
+  (void)cfg;
+  std::fprintf(stderr, "distributed: mode requires POSIX sockets\n");
+  return 2;
+#endif
+}
+
+}  // namespace bby
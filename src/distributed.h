@@ -0,0 +1,9 @@
+#pragma once
+// distributed.h -- EPD analysis sharded across bby workers over TCP, behind
+// the `distributed` CLI mode.
+
+namespace bby {
+
+int distributed_cli_main(int argc, const char* argv[]);
+
+}  // namespace bby
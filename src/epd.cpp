@@ -1,11 +1,19 @@
 #include "epd.h"
 
+#include <algorithm>
 #include <array>
 #include <cctype>
 #include <exception>
 #include <fstream>
 #include <utility>
 
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace bby {
 namespace {
 
@@ -219,4 +227,254 @@ EpdLoadResult load_epd_file(const std::string& path) {
   return result;
 }
 
+EpdFile::~EpdFile() {
+  release();
+}
+
+EpdFile::EpdFile(EpdFile&& other) noexcept
+    : base_(other.base_),
+      bytes_(other.bytes_),
+      mapped_(other.mapped_),
+      records_(std::move(other.records_)),
+      operations_(std::move(other.operations_)) {
+  other.base_ = nullptr;
+  other.bytes_ = 0;
+  other.mapped_ = false;
+}
+
+EpdFile& EpdFile::operator=(EpdFile&& other) noexcept {
+  if (this != &other) {
+    release();
+    base_ = other.base_;
+    bytes_ = other.bytes_;
+    mapped_ = other.mapped_;
+    records_ = std::move(other.records_);
+    operations_ = std::move(other.operations_);
+    other.base_ = nullptr;
+    other.bytes_ = 0;
+    other.mapped_ = false;
+  }
+  return *this;
+}
+
+void EpdFile::release() noexcept {
+  if (base_ == nullptr) {
+    return;
+  }
+#if defined(__linux__)
+  if (mapped_) {
+    munmap(const_cast<char*>(base_), bytes_);
+    base_ = nullptr;
+    return;
+  }
+#endif
+  delete[] base_;
+  base_ = nullptr;
+}
+
+const EpdFile::Operation* EpdFile::operations_begin(const Record& record) const {
+  return operations_.data() + record.ops_begin;
+}
+
+const EpdFile::Operation* EpdFile::operations_end(const Record& record) const {
+  return operations_.data() + record.ops_begin + record.ops_count;
+}
+
+std::optional<std::string_view> EpdFile::find(const Record& record,
+                                              std::string_view opcode) const {
+  const Operation* begin = operations_begin(record);
+  const Operation* end = operations_end(record);
+  const Operation* it = std::lower_bound(
+      begin, end, opcode,
+      [](const Operation& op, std::string_view key) { return op.opcode < key; });
+  if (it == end || it->opcode != opcode) {
+    return std::nullopt;
+  }
+  return it->value;
+}
+
+Position EpdFile::position(const Record& record) const {
+  return Position::from_fen(record.fen, false);
+}
+
+EpdMapResult map_epd_file(const std::string& path) {
+  EpdMapResult result;
+  EpdFile& file = result.file;
+
+  // Map the file read-only; fall back to a single heap read where mmap is
+  // unavailable or fails (empty files among the failures — nothing to index).
+  std::size_t bytes = 0;
+  const char* base = nullptr;
+  bool mapped = false;
+#if defined(__linux__)
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd >= 0) {
+    struct stat st {};
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      void* mem = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ,
+                       MAP_PRIVATE, fd, 0);
+      if (mem != MAP_FAILED) {
+        base = static_cast<const char*>(mem);
+        bytes = static_cast<std::size_t>(st.st_size);
+        mapped = true;
+      }
+    }
+    ::close(fd);
+  }
+#endif
+  if (base == nullptr) {
+    std::ifstream input(path, std::ios::binary | std::ios::ate);
+    if (!input) {
+      result.errors.push_back(EpdLoadError{0, "Failed to open EPD file: " + path, {}});
+      return result;
+    }
+    const std::streamoff size = input.tellg();
+    input.seekg(0);
+    char* buffer = new char[static_cast<std::size_t>(size > 0 ? size : 1)];
+    if (size > 0 && !input.read(buffer, size)) {
+      delete[] buffer;
+      result.errors.push_back(EpdLoadError{0, "Failed to read EPD file: " + path, {}});
+      return result;
+    }
+    base = buffer;
+    bytes = static_cast<std::size_t>(size > 0 ? size : 0);
+  }
+  file.base_ = base;
+  file.bytes_ = bytes;
+  file.mapped_ = mapped;
+
+  const std::string_view text(base, bytes);
+  std::size_t line_no = 0;
+  std::size_t offset = 0;
+  while (offset < text.size()) {
+    std::size_t newline = text.find('\n', offset);
+    if (newline == std::string_view::npos) {
+      newline = text.size();
+    }
+    ++line_no;
+    const std::string_view raw = text.substr(offset, newline - offset);
+    offset = newline + 1;
+
+    std::string_view cursor = trim_view(raw);
+    if (cursor.empty() || cursor.front() == '#') {
+      continue;
+    }
+
+    const auto fail = [&](std::string message) {
+      result.errors.push_back(EpdLoadError{line_no, std::move(message), std::string(raw)});
+    };
+
+    const char* fen_begin = cursor.data();
+    const char* fen_end = fen_begin;
+    bool fen_ok = true;
+    for (int idx = 0; idx < 4; ++idx) {
+      const std::string_view token = consume_token(cursor);
+      if (token.empty()) {
+        fail("EPD line missing FEN components");
+        fen_ok = false;
+        break;
+      }
+      fen_end = token.data() + token.size();
+    }
+    if (!fen_ok) {
+      continue;
+    }
+
+    EpdFile::Record record;
+    record.fen = std::string_view(fen_begin, static_cast<std::size_t>(fen_end - fen_begin));
+    record.line = line_no;
+    record.ops_begin = static_cast<std::uint32_t>(file.operations_.size());
+
+    // Optional halfmove/fullmove counters between the FEN and operations.
+    for (int skipped = 0; skipped < 2; ++skipped) {
+      std::string_view probe = cursor;
+      const std::string_view token = consume_token(probe);
+      if (token.empty() ||
+          !std::all_of(token.begin(), token.end(), [](char ch) {
+            return std::isdigit(static_cast<unsigned char>(ch)) != 0;
+          })) {
+        break;
+      }
+      cursor = probe;
+    }
+
+    // Split operations on ';', honouring quotes and escapes, without
+    // building any intermediate strings: every opcode and value is a slice
+    // of the mapping.
+    bool parse_ok = true;
+    std::size_t token_start = 0;
+    bool in_quote = false;
+    bool escape = false;
+    const auto flush = [&](std::size_t token_end) {
+      const std::string_view token =
+          trim_view(cursor.substr(token_start, token_end - token_start));
+      if (token.empty()) {
+        return;
+      }
+      std::size_t split = 0;
+      while (split < token.size() && !is_space(token[split])) {
+        ++split;
+      }
+      EpdFile::Operation op;
+      op.opcode = token.substr(0, split);
+      op.value = trim_view(token.substr(split));
+      file.operations_.push_back(op);
+      ++record.ops_count;
+    };
+    for (std::size_t idx = 0; idx < cursor.size(); ++idx) {
+      const char ch = cursor[idx];
+      if (escape) {
+        escape = false;
+        continue;
+      }
+      if (ch == '\\') {
+        escape = true;
+        continue;
+      }
+      if (ch == '"') {
+        in_quote = !in_quote;
+        continue;
+      }
+      if (ch == ';' && !in_quote) {
+        flush(idx);
+        token_start = idx + 1;
+      }
+    }
+    if (escape) {
+      fail("EPD operation terminates with an escape character");
+      parse_ok = false;
+    } else if (in_quote) {
+      fail("EPD operation contains an unterminated quote");
+      parse_ok = false;
+    } else {
+      flush(cursor.size());
+    }
+
+    if (parse_ok && record.ops_count > 0) {
+      const auto begin = file.operations_.begin() +
+                         static_cast<std::ptrdiff_t>(record.ops_begin);
+      std::sort(begin, file.operations_.end(),
+                [](const EpdFile::Operation& lhs, const EpdFile::Operation& rhs) {
+                  return lhs.opcode < rhs.opcode;
+                });
+      const auto dup = std::adjacent_find(
+          begin, file.operations_.end(),
+          [](const EpdFile::Operation& lhs, const EpdFile::Operation& rhs) {
+            return lhs.opcode == rhs.opcode;
+          });
+      if (dup != file.operations_.end()) {
+        fail("Duplicate EPD opcode: " + std::string(dup->opcode));
+        parse_ok = false;
+      }
+    }
+
+    if (!parse_ok) {
+      file.operations_.resize(record.ops_begin);
+      continue;
+    }
+    file.records_.push_back(record);
+  }
+  return result;
+}
+
 }  // namespace bby
@@ -12,7 +12,9 @@
  */
 
 #include <cstddef>
+#include <cstdint>
 #include <map>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -65,5 +67,79 @@ bool parse_epd_line(std::string_view line, EpdRecord& out_record, std::string& e
  */
 EpdLoadResult load_epd_file(const std::string& path);
 
+/**
+ * Zero-copy EPD corpus for large files. The file stays memory-mapped (or in
+ * one heap buffer where mmap is unavailable) and every FEN, opcode and value
+ * is a `string_view` into that mapping; operations live in one flat vector
+ * shared by all records, sorted by opcode per record for binary-search
+ * lookup. FENs are not parsed at load time: `position()` constructs the
+ * `Position` on access, so a malformed FEN surfaces there as
+ * `std::invalid_argument` rather than in the load errors. Structural
+ * problems (missing FEN fields, bad operation syntax, duplicate opcodes)
+ * are still aggregated at load per the `EpdLoadResult` contract.
+ */
+class EpdFile;
+struct EpdMapResult;
+EpdMapResult map_epd_file(const std::string& path);
+
+class EpdFile {
+public:
+  struct Operation {
+    std::string_view opcode;
+    std::string_view value;
+  };
+
+  /** One EPD line; all views reference the file mapping. */
+  struct Record {
+    std::string_view fen;
+    std::size_t line{0};
+    std::uint32_t ops_begin{0};
+    std::uint32_t ops_count{0};
+  };
+
+  EpdFile() = default;
+  ~EpdFile();
+  EpdFile(EpdFile&& other) noexcept;
+  EpdFile& operator=(EpdFile&& other) noexcept;
+  EpdFile(const EpdFile&) = delete;
+  EpdFile& operator=(const EpdFile&) = delete;
+
+  [[nodiscard]] const std::vector<Record>& records() const noexcept { return records_; }
+  /** Operations of `record`, sorted by opcode. */
+  [[nodiscard]] const Operation* operations_begin(const Record& record) const;
+  [[nodiscard]] const Operation* operations_end(const Record& record) const;
+  /** Binary-search lookup; empty optional when the opcode is absent. */
+  [[nodiscard]] std::optional<std::string_view> find(const Record& record,
+                                                     std::string_view opcode) const;
+  /** Parses the record's FEN; throws `std::invalid_argument` when invalid. */
+  [[nodiscard]] Position position(const Record& record) const;
+
+private:
+  friend EpdMapResult map_epd_file(const std::string& path);
+
+  void release() noexcept;
+
+  const char* base_{nullptr};
+  std::size_t bytes_{0};
+  bool mapped_{false};
+  std::vector<Record> records_;
+  std::vector<Operation> operations_;
+};
+
+/** Result of `map_epd_file`: the mapped corpus plus aggregated errors. */
+struct EpdMapResult {
+  EpdFile file;
+  std::vector<EpdLoadError> errors;
+
+  [[nodiscard]] bool ok() const noexcept { return errors.empty(); }
+};
+
+/**
+ * Memory-map an EPD file and index it without copying or FEN parsing; the
+ * allocation cost is two vectors regardless of file size. Never throws; I/O
+ * failures are recorded as a single error entry.
+ */
+EpdMapResult map_epd_file(const std::string& path);
+
 }  // namespace bby
 
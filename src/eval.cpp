@@ -6,144 +6,17 @@
 #include <sstream>
 
 #include "debug.h"
+#include "kpk.h"
+#include "nnue.h"
+#include "psqt.h"
 
 namespace bby {
 namespace {
 
-constexpr int kTotalPhase = 24;
-constexpr std::array<int, 6> kPiecePhase{{0, 1, 1, 2, 4, 0}};
-constexpr std::array<int, 6> kMgPieceValue{{82, 337, 365, 477, 1025, 0}};
-constexpr std::array<int, 6> kEgPieceValue{{94, 281, 297, 512, 936, 0}};
-
-constexpr std::array<std::array<int, 64>, 6> kMgPesto{{
-    {{
-        0,   0,   0,   0,   0,   0,  0,   0,
-       98, 134,  61,  95,  68, 126, 34, -11,
-       -6,   7,  26,  31,  65,  56, 25, -20,
-      -14,  13,   6,  21,  23,  12, 17, -23,
-      -27,  -2,  -5,  12,  17,   6, 10, -25,
-      -26,  -4,  -4, -10,   3,   3, 33, -12,
-      -35,  -1, -20, -23, -15,  24, 38, -22,
-        0,   0,   0,   0,   0,   0,  0,   0,
-    }},
-    {{
-      -167, -89, -34, -49,  61, -97, -15, -107,
-       -73, -41,  72,  36,  23,  62,   7,  -17,
-       -47,  60,  37,  65,  84, 129,  73,   44,
-        -9,  17,  19,  53,  37,  69,  18,   22,
-       -13,   4,  16,  13,  28,  19,  21,   -8,
-       -23,  -9,  12,  10,  19,  17,  25,  -16,
-       -29, -53, -12,  -3,  -1,  18, -14,  -19,
-      -105, -21, -58, -33, -17, -28, -19,  -23,
-    }},
-    {{
-      -29,   4, -82, -37, -25, -42,   7,  -8,
-      -26,  16, -18, -13,  30,  59,  18, -47,
-      -16,  37,  43,  40,  35,  50,  37,  -2,
-        -4,   5,  19,  50,  37,  37,   7,  -2,
-        -6,  13,  13,  26,  34,  12,  10,   4,
-         0,  15,  15,  15,  14,  27,  18,  10,
-         4,  15,  16,   0,   7,  21,  33,   1,
-      -33,  -3, -14, -21, -13, -12, -39, -21,
-    }},
-    {{
-       32,  42,  32,  51,  63,   9,  31,  43,
-       27,  32,  58,  62,  80,  67,  26,  44,
-        -5,  19,  26,  36,  17,  45,  61,  16,
-      -24, -11,   7,  26,  24,  35,  -8, -20,
-      -36, -26, -12,  -1,   9,  -7,   6, -23,
-      -45, -25, -16, -17,   3,   0,  -5, -33,
-      -44, -16, -20,  -9,  -1,  11,  -6, -71,
-      -19, -13,   1,  17,  16,   7, -37, -26,
-    }},
-    {{
-      -28,   0,  29,  12,  59,  44,  43,  45,
-      -24, -39,  -5,   1, -16,  57,  28,  54,
-      -13, -17,   7,   8,  29,  56,  47,  57,
-      -27, -27, -16, -16,  -1,  17,  -2,   1,
-        -9, -26,  -9, -10,  -2,  -4,   3,  -3,
-      -14,   2, -11,  -2,  -5,   2,  14,   5,
-      -35,  -8,  11,   2,   8,  15,  -3,   1,
-        -1, -18,  -9,  10, -15, -25, -31, -50,
-    }},
-    {{
-      -65,  23,  16, -15, -56, -34,   2,  13,
-       29,  -1, -20,  -7,  -8,  -4, -38, -29,
-        -9,  24,   2, -16, -20,   6,  22, -22,
-      -17, -20, -12, -27, -30, -25, -14, -36,
-      -49,  -1, -27, -39, -46, -44, -33, -51,
-      -14, -14, -22, -46, -44, -30, -15, -27,
-         1,   7,  -8, -64, -43, -16,   9,   8,
-      -15,  36,  12, -54,   8, -28,  24,  14,
-    }},
-}};
-
-constexpr std::array<std::array<int, 64>, 6> kEgPesto{{
-    {{
-        0,   0,   0,   0,   0,   0,   0,   0,
-      178, 173, 158, 134, 147, 132, 165, 187,
-       94, 100,  85,  67,  56,  53,  82,  84,
-       32,  24,  13,   5,  -2,   4,  17,  17,
-       13,   9,  -3,  -7,  -7,  -8,   3,  -1,
-         4,   7,  -6,   1,   0,  -5,  -1,  -8,
-       13,   8,   8,  10,  13,   0,   2,  -7,
-        0,   0,   0,   0,   0,   0,   0,   0,
-    }},
-    {{
-      -58, -38, -13, -28, -31, -27, -63, -99,
-      -25,  -8, -25,  -2,  -9, -25, -24, -52,
-      -24, -20,  10,   9,  -1,  -9, -19, -41,
-      -17,   3,  22,  22,  22,  11,   8, -18,
-      -18,  -6,  16,  25,  16,  17,   4, -18,
-      -23,  -3,  -1,  15,  10,  -3, -20, -22,
-      -42, -20, -10,  -5,  -2, -20, -23, -44,
-      -29, -51, -23, -15, -22, -18, -50, -64,
-    }},
-    {{
-      -14, -21, -11,  -8,  -7,  -9, -17, -24,
-        -8,  -4,   7, -12,  -3, -13,  -4, -14,
-         2,  -8,   0,  -1,  -2,   6,   0,   4,
-        -3,   9,  12,   9,  14,  10,   3,   2,
-        -6,   3,  13,  19,   7,  10,  -3,  -9,
-      -12,  -3,   8,  10,  13,   3,  -7, -15,
-      -14, -18,  -7,  -1,   4,  -9, -15, -27,
-      -23,  -9, -23,  -5,  -9, -16,  -5, -17,
-    }},
-    {{
-       13,  10,  18,  15,  12,  12,   8,   5,
-       11,  13,  13,  11,  -3,   3,   8,   3,
-         7,   7,   7,   5,   4,  -3,  -5,  -3,
-         4,   3,  13,   1,   2,   1,  -1,   2,
-         3,   5,   8,   4,  -5,  -6,  -8, -11,
-        -4,   0,  -5,  -1,  -7, -12,  -8, -16,
-        -6,  -6,   0,   2,  -9,  -9, -11,  -3,
-        -9,   2,   3,  -1,  -5, -13,   4, -20,
-    }},
-    {{
-        -9,  22,  22,  27,  27,  19,  10,  20,
-      -17,  20,  32,  41,  58,  25,  30,   0,
-      -20,   6,   9,  49,  47,  35,  19,   9,
-         3,  22,  24,  45,  57,  40,  57,  36,
-      -18,  28,  19,  47,  31,  34,  39,  23,
-      -16, -27,  15,   6,   9,  17,  10,   5,
-      -22, -23, -30, -16, -16, -23, -36, -32,
-      -33, -28, -22, -43,  -5, -32, -20, -41,
-    }},
-    {{
-      -74, -35, -18, -18, -11,  15,   4, -17,
-      -12,  17,  14,  17,  17,  38,  23,  11,
-        10,  17,  23,  15,  20,  45,  44,  13,
-        -8,  22,  24,  27,  26,  33,  26,   3,
-      -18,  -4,  21,  24,  27,  23,   9, -11,
-      -19,  -3,  11,  21,  23,  16,   7,  -9,
-      -27, -11,   4,  13,  14,   4,  -5, -17,
-      -53, -34, -21, -11, -28, -14, -24, -43,
-    }},
-}};
-
-constexpr int mirror_index(int sq) {
-  return sq ^ 56;
-}
+// Exact KPK wins score above any positional eval but below tablebase and
+// mate verdicts in search; a small rank nudge keeps the search pushing the
+// pawn once the win is known.
+constexpr Score kKpkWinScore = 10000;
 
 inline int pop_lsb(Bitboard& bb) {
   BBY_ASSERT(bb != 0ULL);
@@ -152,40 +25,245 @@ inline int pop_lsb(Bitboard& bb) {
   return idx;
 }
 
+// Pawn-structure weights, white point of view, midgame/endgame pairs.
+constexpr int kIsolatedMg = -11;
+constexpr int kIsolatedEg = -15;
+constexpr int kDoubledMg = -8;
+constexpr int kDoubledEg = -14;
+constexpr std::array<int, 8> kPassedMg{{0, 4, 8, 16, 30, 52, 88, 0}};
+constexpr std::array<int, 8> kPassedEg{{0, 10, 18, 32, 56, 92, 140, 0}};
+
+constexpr Bitboard file_mask(int file) {
+  return 0x0101010101010101ULL << file;
+}
+
+constexpr std::array<Bitboard, 8> kAdjacentFiles = [] {
+  std::array<Bitboard, 8> masks{};
+  for (int file = 0; file < 8; ++file) {
+    Bitboard mask = 0ULL;
+    if (file > 0) {
+      mask |= file_mask(file - 1);
+    }
+    if (file < 7) {
+      mask |= file_mask(file + 1);
+    }
+    masks[file] = mask;
+  }
+  return masks;
+}();
+
+// Squares an enemy pawn would have to occupy to stop the pawn on `sq`:
+// everything ahead of it on its own and the two adjacent files.
+constexpr std::array<std::array<Bitboard, 64>, 2> kPassedSpan = [] {
+  std::array<std::array<Bitboard, 64>, 2> spans{};
+  for (int sq = 0; sq < 64; ++sq) {
+    const int file = sq & 7;
+    const Bitboard lanes = file_mask(file) | kAdjacentFiles[file];
+    Bitboard ahead_white = 0ULL;
+    Bitboard ahead_black = 0ULL;
+    for (int rank = (sq >> 3) + 1; rank < 8; ++rank) {
+      ahead_white |= 0xFFULL << (rank * 8);
+    }
+    for (int rank = (sq >> 3) - 1; rank >= 0; --rank) {
+      ahead_black |= 0xFFULL << (rank * 8);
+    }
+    spans[0][sq] = lanes & ahead_white;
+    spans[1][sq] = lanes & ahead_black;
+  }
+  return spans;
+}();
+
+// Recomputes the pawn-structure entry for the current pawn configuration:
+// isolated/doubled penalties, passed-pawn bonuses scaled by relative rank,
+// and the open/half-open file masks reused by later terms.
+void fill_pawn_entry(const Position& pos, PawnEntry& entry) {
+  entry.key = pos.pawn_key();
+  entry.filled = true;
+  entry.passed = {0ULL, 0ULL};
+
+  const Bitboard white_pawns = pos.pieces(Color::White, PieceType::Pawn);
+  const Bitboard black_pawns = pos.pieces(Color::Black, PieceType::Pawn);
+  const std::array<Bitboard, 2> pawns{{white_pawns, black_pawns}};
+
+  Bitboard open = 0ULL;
+  for (int file = 0; file < 8; ++file) {
+    const Bitboard mask = file_mask(file);
+    entry.half_open_files[0] |= (white_pawns & mask) ? 0ULL : mask;
+    entry.half_open_files[1] |= (black_pawns & mask) ? 0ULL : mask;
+    open |= ((white_pawns | black_pawns) & mask) ? 0ULL : mask;
+  }
+  entry.half_open_files[0] &= ~open;
+  entry.half_open_files[1] &= ~open;
+  entry.open_files = open;
+
+  int mg = 0;
+  int eg = 0;
+  for (int color = 0; color < 2; ++color) {
+    const int sign = (color == 0) ? 1 : -1;
+    const Bitboard own = pawns[color];
+    const Bitboard their = pawns[color ^ 1];
+    Bitboard scan = own;
+    while (scan) {
+      const int sq = pop_lsb(scan);
+      const int file = sq & 7;
+      const int rank = sq >> 3;
+      const int relative_rank = (color == 0) ? rank : 7 - rank;
+
+      if ((own & kAdjacentFiles[file]) == 0ULL) {
+        mg += sign * kIsolatedMg;
+        eg += sign * kIsolatedEg;
+      }
+      if (own & kPassedSpan[color][sq] & file_mask(file)) {
+        mg += sign * kDoubledMg;
+        eg += sign * kDoubledEg;
+      }
+      if ((their & kPassedSpan[color][sq]) == 0ULL) {
+        entry.passed[color] |= bit(static_cast<Square>(sq));
+        mg += sign * kPassedMg[relative_rank];
+        eg += sign * kPassedEg[relative_rank];
+      }
+    }
+  }
+  entry.mg = static_cast<Score>(mg);
+  entry.eg = static_cast<Score>(eg);
+}
+
 }  // namespace
 
-Score evaluate(const Position& pos, EvalTrace* trace) {
-  const Color stm = pos.side_to_move();
+PawnTable::PawnTable() : entries_(kEntries) {}
+
+const PawnEntry& PawnTable::probe(const Position& pos) {
+  static_assert((kEntries & (kEntries - 1)) == 0, "kEntries must be a power of two");
+  PawnEntry& entry = entries_[pos.pawn_key() & (kEntries - 1)];
+  if (!entry.filled || entry.key != pos.pawn_key()) {
+    entry = PawnEntry{};
+    fill_pawn_entry(pos, entry);
+  }
+  return entry;
+}
 
-  int mgScore = 0;
-  int egScore = 0;
-  int phase = 0;
+EvalCache::EvalCache() : entries_(kEntries) {}
 
-  for (int pieceIdx = 0; pieceIdx < 6; ++pieceIdx) {
-    const auto piece = static_cast<PieceType>(pieceIdx);
+bool EvalCache::probe(std::uint64_t key, Score& out) const {
+  static_assert((kEntries & (kEntries - 1)) == 0,
+                "kEntries must be a power of two");
+  const Entry& entry = entries_[key & (kEntries - 1)];
+  if (!entry.valid || entry.key != key) {
+    return false;
+  }
+  out = entry.score;
+  return true;
+}
 
-    Bitboard whitePieces = pos.pieces(Color::White, piece);
-    phase += kPiecePhase[pieceIdx] *
-             static_cast<int>(std::popcount(whitePieces));
-    while (whitePieces) {
-      const int sq = pop_lsb(whitePieces);
-      mgScore += kMgPieceValue[pieceIdx] + kMgPesto[pieceIdx][sq];
-      egScore += kEgPieceValue[pieceIdx] + kEgPesto[pieceIdx][sq];
+void EvalCache::store(std::uint64_t key, Score value) {
+  Entry& entry = entries_[key & (kEntries - 1)];
+  entry.key = key;
+  entry.score = value;
+  entry.valid = true;
+}
+
+Score evaluate(const Position& pos, EvalTrace* trace, PawnTable* pawn_table,
+               Score alpha, Score beta) {
+  const Color stm = pos.side_to_move();
+
+  // King-and-pawn-versus-king is solved at compile time: probe the bitbase
+  // instead of estimating, so pawn-endgame leaves return exact verdicts and
+  // the qsearch stand-pat stops spending depth on decided positions.
+  const Bitboard pawns = pos.pieces(Color::White, PieceType::Pawn) |
+                         pos.pieces(Color::Black, PieceType::Pawn);
+  if (pawns != 0ULL && std::popcount(pos.occupancy()) == 3) {
+    const Color strong =
+        pos.pieces(Color::White, PieceType::Pawn) ? Color::White : Color::Black;
+    int strong_king = static_cast<int>(pos.king_square(strong));
+    int weak_king = static_cast<int>(pos.king_square(flip(strong)));
+    int pawn_sq = static_cast<int>(std::countr_zero(pawns));
+    if (strong == Color::Black) {
+      strong_king ^= 56;
+      weak_king ^= 56;
+      pawn_sq ^= 56;
+    }
+    const bool win = kpk_probe(static_cast<Square>(strong_king),
+                               static_cast<Square>(pawn_sq),
+                               static_cast<Square>(weak_king),
+                               stm == strong ? Color::White : Color::Black);
+    Score result = 0;
+    if (win) {
+      const Score white_pov = kKpkWinScore + static_cast<Score>(pawn_sq >> 3);
+      result = (stm == strong) ? white_pov : -white_pov;
     }
+    if (trace) {
+      trace->midgame = 0;
+      trace->endgame = result;
+      trace->phase = 0;
+      trace->blended = result;
+      trace->lazy = false;
+    }
+    if (trace_enabled(TraceTopic::Eval)) {
+      std::ostringstream oss;
+      oss << "stm=" << (stm == Color::White ? "white" : "black")
+          << " kpk=" << (win ? "win" : "draw") << " score=" << result;
+      trace_emit(TraceTopic::Eval, oss.str());
+    }
+    return result;
+  }
 
-    Bitboard blackPieces = pos.pieces(Color::Black, piece);
-    phase += kPiecePhase[pieceIdx] *
-             static_cast<int>(std::popcount(blackPieces));
-    while (blackPieces) {
-      const int sq = pop_lsb(blackPieces);
-      const int mirrored = mirror_index(sq);
-      mgScore -= kMgPieceValue[pieceIdx] + kMgPesto[pieceIdx][mirrored];
-      egScore -= kEgPieceValue[pieceIdx] + kEgPesto[pieceIdx][mirrored];
+  if (nnue_available()) {
+    const Score network = nnue_evaluate(pos);
+    if (trace) {
+      // The hand-crafted mg/eg split has no network counterpart.
+      trace->midgame = 0;
+      trace->endgame = 0;
+      trace->phase = std::min(pos.phase(), kTotalPhase);
+      trace->blended = network;
+      trace->lazy = false;
     }
+    if (trace_enabled(TraceTopic::Eval)) {
+      std::ostringstream oss;
+      oss << "stm=" << (stm == Color::White ? "white" : "black")
+          << " nnue=" << network;
+      trace_emit(TraceTopic::Eval, oss.str());
+    }
+    return network;
   }
 
+  // The PSQT sums and phase are maintained incrementally by Position, so a
+  // leaf evaluation is the pawn-structure lookup plus a tapered blend.
+  int mgScore = pos.psqt_mg();
+  int egScore = pos.psqt_eg();
+  const int phase = pos.phase();
   const int mgPhase = std::min(phase, kTotalPhase);
   const int egPhase = kTotalPhase - mgPhase;
+
+  // Stage one: the incrementally maintained core alone. When it already
+  // sits outside the caller's window by more than the remaining terms can
+  // swing, those terms cannot change the node's outcome, so skip them.
+  const int coreTapered = (mgScore * mgPhase + egScore * egPhase) / kTotalPhase;
+  const Score core =
+      static_cast<Score>(stm == Color::White ? coreTapered : -coreTapered);
+  if (core - kLazyEvalMargin >= beta || core + kLazyEvalMargin <= alpha) {
+    if (trace) {
+      trace->midgame = static_cast<Score>(mgScore);
+      trace->endgame = static_cast<Score>(egScore);
+      trace->phase = mgPhase;
+      trace->blended = core;
+      trace->lazy = true;
+    }
+    if (trace_enabled(TraceTopic::Eval)) {
+      std::ostringstream oss;
+      oss << "stm=" << (stm == Color::White ? "white" : "black")
+          << " lazy core=" << core << " alpha=" << alpha << " beta=" << beta;
+      trace_emit(TraceTopic::Eval, oss.str());
+    }
+    return core;
+  }
+
+  PawnEntry scratch{};
+  const PawnEntry& pawn_entry =
+      pawn_table ? pawn_table->probe(pos)
+                 : (fill_pawn_entry(pos, scratch), scratch);
+  mgScore += pawn_entry.mg;
+  egScore += pawn_entry.eg;
+
   const int taperedWhite =
       (mgScore * mgPhase + egScore * egPhase) / kTotalPhase;
   const Score result =
@@ -199,6 +277,7 @@ Score evaluate(const Position& pos, EvalTrace* trace) {
     trace->endgame = static_cast<Score>(egScore);
     trace->phase = mgPhase;
     trace->blended = result;
+    trace->lazy = false;
   }
 
   if (trace_enabled(TraceTopic::Eval)) {
@@ -2,6 +2,11 @@
 /// @file eval.h
 /// @brief PeSTO-based tapered evaluation and optional tracing hooks.
 /// @details Produces deterministic midgame/endgame scores blended by phase.
+/// Pawn-structure terms are cached in a per-thread PawnTable keyed by the
+/// pawn-only zobrist from Position::pawn_key().
+
+#include <array>
+#include <vector>
 
 #include "board.h"
 
@@ -12,8 +17,74 @@ struct EvalTrace {
   Score endgame{0};
   Score blended{0};
   int phase{0};
+  bool lazy{false};  // true when the material+PSQT core decided the call
+};
+
+// Cached pawn-structure data for one pawn configuration. The masks are kept
+// alongside the scores so later eval terms (rook on open file, king shelter)
+// can reuse them without rescanning the pawn bitboards.
+struct PawnEntry {
+  std::uint64_t key{0};
+  bool filled{false};
+  Score mg{0};  // white minus black, white point of view
+  Score eg{0};
+  Bitboard open_files{0};
+  std::array<Bitboard, 2> half_open_files{};  // own pawns absent, enemy present
+  std::array<Bitboard, 2> passed{};           // passed pawns per color
+};
+
+// Per-thread pawn-structure hash. Pawn structure changes on a small fraction
+// of moves, so probe() hits well over 95% of the time in search; misses
+// recompute the entry in place.
+class PawnTable {
+public:
+  PawnTable();
+
+  const PawnEntry& probe(const Position& pos);
+
+private:
+  static constexpr std::size_t kEntries = 16384;  // power of two, ~1 MiB
+
+  std::vector<PawnEntry> entries_;
 };
 
-Score evaluate(const Position& pos, EvalTrace* trace = nullptr);
+// Direct-mapped per-thread cache of full evaluations keyed by the position
+// zobrist, probed before evaluate() for qsearch stand-pat and pruning
+// margins. Modeled on SeeCache; the caller owns invalidation (it is simply
+// dropped with the rest of the per-thread state).
+class EvalCache {
+public:
+  EvalCache();
+
+  bool probe(std::uint64_t key, Score& out) const;
+  void store(std::uint64_t key, Score value);
+
+private:
+  struct Entry {
+    std::uint64_t key{0};
+    Score score{0};
+    bool valid{false};
+  };
+  static constexpr std::size_t kEntries = 1 << 18;  // 256K entries, ~4 MiB
+
+  std::vector<Entry> entries_;
+};
+
+// Largest swing the staged terms beyond the material+PSQT core can add; the
+// lazy early-out below may only fire when the core already sits further than
+// this outside the caller's window.
+constexpr Score kLazyEvalMargin = 500;
+
+// Window value wide enough that the default call can never take the lazy
+// exit; callers without useful bounds simply omit the last two arguments.
+constexpr Score kEvalNoBound = 32000;
+
+// Evaluates `pos` from the side to move's point of view. When `alpha`/`beta`
+// carry the caller's search window, the cheap material+PSQT core is computed
+// first and returned outright if it lies more than kLazyEvalMargin outside
+// the window — the skipped terms could not change the node's outcome.
+Score evaluate(const Position& pos, EvalTrace* trace = nullptr,
+               PawnTable* pawn_table = nullptr, Score alpha = -kEvalNoBound,
+               Score beta = kEvalNoBound);
 
 }  // namespace bby
@@ -1,8 +1,28 @@
 #include "hash.h"
 
 #include <algorithm>
+#include <cstring>
 #include <iomanip>
+#include <new>
 #include <sstream>
+#include <thread>
+#include <vector>
+
+#include "threadpool.h"
+
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#endif
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <fstream>
 
 #include "debug.h"
 
@@ -10,53 +30,279 @@ namespace bby {
 
 namespace {
 
+constexpr std::uint64_t kTagMask = 0xffff'ffffULL;
+
+std::uint32_t key_tag(std::uint64_t key) {
+  return static_cast<std::uint32_t>(key & kTagMask);
+}
+
+// Packed layout:
+//   data  = move[0:31] | depth[32:39] | generation[40:47] | bound[48:55] |
+//           singular[56:57] | singular_depth[58:63]
+//   score = tag[0:31]  | score[32:47] | static_eval[48:63]
+// The score word is stored XOR-ed with the data word so that a torn pair of
+// words scrambles the tag and validates as a miss.
+std::uint64_t encode_data(const TTEntry& entry) {
+  return static_cast<std::uint64_t>(entry.best_move.value) |
+         (static_cast<std::uint64_t>(entry.depth) << 32) |
+         (static_cast<std::uint64_t>(entry.generation) << 40) |
+         (static_cast<std::uint64_t>(entry.bound) << 48) |
+         (static_cast<std::uint64_t>(entry.singular) << 56) |
+         (static_cast<std::uint64_t>(entry.singular_depth & 0x3f) << 58);
+}
+
+std::uint64_t encode_score(std::uint64_t key, const TTEntry& entry) {
+  const auto score = static_cast<std::uint16_t>(
+      std::clamp(entry.score, -32768, 32767));
+  const auto static_eval = static_cast<std::uint16_t>(
+      std::clamp(entry.static_eval, -32768, 32767));
+  return static_cast<std::uint64_t>(key_tag(key)) |
+         (static_cast<std::uint64_t>(score) << 32) |
+         (static_cast<std::uint64_t>(static_eval) << 48);
+}
+
+void decode(std::uint64_t data, std::uint64_t score_word, std::uint64_t key,
+            TTEntry& out) {
+  out.key = key;
+  out.best_move = Move{static_cast<std::uint32_t>(data & kTagMask)};
+  out.depth = static_cast<std::uint8_t>((data >> 32) & 0xff);
+  out.generation = static_cast<std::uint8_t>((data >> 40) & 0xff);
+  out.bound = static_cast<BoundType>((data >> 48) & 0x03);
+  out.singular = static_cast<SingularResult>((data >> 56) & 0x03);
+  out.singular_depth = static_cast<std::uint8_t>((data >> 58) & 0x3f);
+  out.score = static_cast<std::int16_t>((score_word >> 32) & 0xffff);
+  out.static_eval = static_cast<std::int16_t>((score_word >> 48) & 0xffff);
+}
+
 std::size_t compute_bucket_count(std::size_t megabytes) {
   const std::size_t bytes = megabytes * 1024 * 1024;
-  const std::size_t min_entries = TT::kBucketSize;
-  const std::size_t entry_count =
-      std::max<std::size_t>(min_entries, bytes / sizeof(TTEntry));
-  const std::size_t buckets = std::max<std::size_t>(1, entry_count / TT::kBucketSize);
-  return buckets;
+  constexpr std::size_t kBucketBytes = TT::kBucketSize * 16;
+  return std::max<std::size_t>(1, bytes / kBucketBytes);
 }
 
 std::uint8_t age_difference(std::uint8_t current, std::uint8_t stored) {
   return static_cast<std::uint8_t>(current - stored);
 }
 
+// On-disk dump layout: a page-sized header so the slot data that follows is
+// file-offset aligned for mmap, then the raw bucket array.
+constexpr std::array<char, 8> kDumpMagic = {'b', 'b', 'y', 't', 't', '1', '\0', '\0'};
+constexpr std::uint32_t kDumpVersion = 1;
+constexpr std::size_t kDumpDataOffset = 4096;
+
+struct TTDumpHeader {
+  std::array<char, 8> magic{};
+  std::uint32_t version{0};
+  std::uint32_t slot_bytes{0};
+  std::uint32_t bucket_slots{0};
+  std::uint32_t generation{0};
+  std::uint64_t bucket_count{0};
+};
+
 }  // namespace
 
-TT::TT(std::size_t megabytes)
-    : bucket_count_(compute_bucket_count(megabytes)),
-      entries_(bucket_count_ * kBucketSize) {}
+void TT::TableDeleter::operator()(TTBucket* ptr) const {
+  if (ptr == nullptr) {
+    return;
+  }
+#if defined(__linux__)
+  if (mapped) {
+    munmap(ptr, bytes);
+    return;
+  }
+#endif
+  ::operator delete(ptr, std::align_val_t{alignof(TTBucket)});
+}
+
+TT::TT(std::size_t megabytes) : bucket_count_(compute_bucket_count(megabytes)) {
+  const std::size_t bytes = bucket_count_ * sizeof(TTBucket);
+  TTBucket* base = nullptr;
+  bool mapped = false;
+#if defined(__linux__)
+  void* mem = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (mem != MAP_FAILED) {
+#if defined(MADV_HUGEPAGE)
+    // Large tables back onto 2 MB pages once THP coalesces the range.
+    madvise(mem, bytes, MADV_HUGEPAGE);
+#endif
+#if defined(__NR_mbind)
+    // Interleave pages across every configured NUMA node so no single
+    // memory controller serves the whole table; a no-op on UMA hosts.
+    constexpr int kMpolInterleave = 3;
+    unsigned long node_mask = ~0UL;
+    syscall(__NR_mbind, mem, bytes, kMpolInterleave, &node_mask,
+            sizeof(node_mask) * 8 + 1, 0);
+#endif
+    base = static_cast<TTBucket*>(mem);
+    mapped = true;
+  }
+#endif
+  if (base == nullptr) {
+    base = static_cast<TTBucket*>(
+        ::operator new(bytes, std::align_val_t{alignof(TTBucket)}));
+    std::memset(static_cast<void*>(base), 0, bytes);
+  }
+  // The mmap path skips the explicit zeroing pass: anonymous pages read as
+  // zero on first touch, so construction stays instant even for huge tables
+  // and the NUMA interleave policy applies where pages are first used.
+  buckets_ = std::unique_ptr<TTBucket[], TableDeleter>(base, TableDeleter{bytes, mapped});
+}
+
+void TT::clear(std::size_t thread_count) {
+  if (!buckets_) {
+    return;
+  }
+  if (thread_count == 0) {
+    thread_count = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+  }
+  thread_count = std::min(thread_count, bucket_count_);
+  // The slots are plain packed words behind relaxed atomics and the table is
+  // quiescent while clearing, so a ranged memset per worker is safe.
+  auto zero_range = [this](std::size_t begin, std::size_t end) {
+    std::memset(static_cast<void*>(buckets_.get() + begin), 0,
+                (end - begin) * sizeof(TTBucket));
+  };
+  if (thread_count <= 1) {
+    zero_range(0, bucket_count_);
+    return;
+  }
+  const std::size_t chunk = (bucket_count_ + thread_count - 1) / thread_count;
+  worker_pool().run(thread_count, [&](std::size_t idx) {
+    const std::size_t begin = idx * chunk;
+    const std::size_t end = std::min(bucket_count_, begin + chunk);
+    if (begin < end) {
+      zero_range(begin, end);
+    }
+  });
+}
+
+void TT::resize(std::size_t megabytes, std::size_t thread_count) {
+  const std::size_t new_buckets = compute_bucket_count(megabytes);
+  if (buckets_ && new_buckets * sizeof(TTBucket) <= buckets_.get_deleter().bytes) {
+    bucket_count_ = new_buckets;
+    clear(thread_count);
+    return;
+  }
+  *this = TT(megabytes);
+}
 
 void TT::set_generation(std::uint8_t gen) {
   generation_ = gen;
 }
 
+bool TT::save(const std::string& path) const {
+  if (!buckets_) {
+    return false;
+  }
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    return false;
+  }
+  TTDumpHeader header;
+  header.magic = kDumpMagic;
+  header.version = kDumpVersion;
+  header.slot_bytes = 16;
+  header.bucket_slots = static_cast<std::uint32_t>(kBucketSize);
+  header.generation = generation_;
+  header.bucket_count = bucket_count_;
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  const std::string padding(kDumpDataOffset - sizeof(header), '\0');
+  out.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+  out.write(reinterpret_cast<const char*>(buckets_.get()),
+            static_cast<std::streamsize>(bucket_count_ * sizeof(TTBucket)));
+  return static_cast<bool>(out);
+}
+
+bool TT::load(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return false;
+  }
+  TTDumpHeader header;
+  in.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!in || header.magic != kDumpMagic || header.version != kDumpVersion ||
+      header.slot_bytes != 16 || header.bucket_slots != kBucketSize ||
+      header.bucket_count == 0) {
+    return false;
+  }
+  const std::size_t bytes = header.bucket_count * sizeof(TTBucket);
+  TTBucket* base = nullptr;
+  bool mapped = false;
+#if defined(__linux__)
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd >= 0) {
+    struct stat info {};
+    if (fstat(fd, &info) == 0 &&
+        static_cast<std::uint64_t>(info.st_size) >= kDumpDataOffset + bytes) {
+      // Private mapping: pages fault in lazily and later stores stay
+      // copy-on-write in memory, never dirtying the dump file.
+      void* mem = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_NORESERVE, fd, kDumpDataOffset);
+      if (mem != MAP_FAILED) {
+        base = static_cast<TTBucket*>(mem);
+        mapped = true;
+      }
+    }
+    ::close(fd);
+  }
+#endif
+  if (base == nullptr) {
+    in.seekg(static_cast<std::streamoff>(kDumpDataOffset));
+    base = static_cast<TTBucket*>(
+        ::operator new(bytes, std::align_val_t{alignof(TTBucket)}));
+    in.read(reinterpret_cast<char*>(base), static_cast<std::streamsize>(bytes));
+    if (!in) {
+      ::operator delete(base, std::align_val_t{alignof(TTBucket)});
+      return false;
+    }
+  }
+  bucket_count_ = header.bucket_count;
+  generation_ = static_cast<std::uint8_t>(header.generation);
+  buckets_ = std::unique_ptr<TTBucket[], TableDeleter>(base, TableDeleter{bytes, mapped});
+  return true;
+}
+
 std::size_t TT::bucket_index(std::uint64_t key) const {
   return bucket_count_ == 0 ? 0 : (key % bucket_count_);
 }
 
+void TT::prefetch(std::uint64_t key) const {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(&buckets_[bucket_index(key)]);
+#elif defined(_MSC_VER)
+  _mm_prefetch(reinterpret_cast<const char*>(&buckets_[bucket_index(key)]), _MM_HINT_T0);
+#else
+  (void)key;
+#endif
+}
+
 bool TT::probe(std::uint64_t key, TTEntry& out) const {
   const std::size_t bucket = bucket_index(key);
-  const std::size_t base = bucket * kBucketSize;
+  const TTBucket& slots = buckets_[bucket];
 
   for (std::size_t slot = 0; slot < kBucketSize; ++slot) {
-    const TTEntry& entry = entries_[base + slot];
-    if (entry.key == key) {
-      out = entry;
-      if (trace_enabled(TraceTopic::TT)) {
-        std::ostringstream oss;
-        oss << "probe key=0x" << std::hex << std::setw(16) << std::setfill('0') << key << std::dec
-            << " bucket=" << bucket
-            << " slot=" << slot
-            << " depth=" << static_cast<int>(entry.depth)
-            << " bound=" << static_cast<int>(entry.bound)
-            << " gen=" << static_cast<int>(entry.generation);
-        trace_emit(TraceTopic::TT, oss.str());
-      }
-      return true;
+    const std::uint64_t data = slots.slots[slot].data.load(std::memory_order_relaxed);
+    const std::uint64_t score_word =
+        slots.slots[slot].check.load(std::memory_order_relaxed) ^ data;
+    if ((data | score_word) == 0ULL) {
+      continue;
+    }
+    if (key_tag(score_word) != key_tag(key)) {
+      continue;
+    }
+    decode(data, score_word, key, out);
+    if (trace_enabled(TraceTopic::TT)) {
+      std::ostringstream oss;
+      oss << "probe key=0x" << std::hex << std::setw(16) << std::setfill('0') << key << std::dec
+          << " bucket=" << bucket
+          << " slot=" << slot
+          << " depth=" << static_cast<int>(out.depth)
+          << " bound=" << static_cast<int>(out.bound)
+          << " gen=" << static_cast<int>(out.generation);
+      trace_emit(TraceTopic::TT, oss.str());
     }
+    return true;
   }
 
   if (trace_enabled(TraceTopic::TT)) {
@@ -71,24 +317,32 @@ bool TT::probe(std::uint64_t key, TTEntry& out) const {
 
 void TT::store(std::uint64_t key, const TTEntry& in) {
   const std::size_t bucket = bucket_index(key);
-  const std::size_t base = bucket * kBucketSize;
+  TTBucket& slots = buckets_[bucket];
 
   std::size_t target = kBucketSize;
   std::size_t empty_slot = kBucketSize;
   std::size_t replacement_slot = 0;
   int worst_metric = -1;
+  bool replacing = false;
 
   for (std::size_t slot = 0; slot < kBucketSize; ++slot) {
-    TTEntry& entry = entries_[base + slot];
-    if (entry.key == key) {
+    const std::uint64_t data = slots.slots[slot].data.load(std::memory_order_relaxed);
+    const std::uint64_t score_word =
+        slots.slots[slot].check.load(std::memory_order_relaxed) ^ data;
+    if ((data | score_word) == 0ULL) {
+      if (empty_slot == kBucketSize) {
+        empty_slot = slot;
+      }
+      continue;
+    }
+    if (key_tag(score_word) == key_tag(key)) {
       target = slot;
       break;
     }
-    if (entry.key == 0ULL && empty_slot == kBucketSize) {
-      empty_slot = slot;
-    }
-    const std::uint8_t age = age_difference(generation_, entry.generation);
-    const int metric = (static_cast<int>(age) << 8) + (255 - static_cast<int>(entry.depth));
+    const auto depth = static_cast<std::uint8_t>((data >> 32) & 0xff);
+    const auto generation = static_cast<std::uint8_t>((data >> 40) & 0xff);
+    const std::uint8_t age = age_difference(generation_, generation);
+    const int metric = (static_cast<int>(age) << 8) + (255 - static_cast<int>(depth));
     if (metric > worst_metric) {
       worst_metric = metric;
       replacement_slot = slot;
@@ -100,18 +354,16 @@ void TT::store(std::uint64_t key, const TTEntry& in) {
       target = empty_slot;
     } else {
       target = replacement_slot;
+      replacing = true;
     }
   }
 
-  TTEntry& dest = entries_[base + target];
-  const bool was_empty = dest.key == 0ULL;
-  const bool replacing = dest.key != 0ULL && dest.key != key;
-  dest = in;
-  dest.key = key;
-  dest.generation = generation_;
-  if (was_empty && dest.key != 0ULL) {
-    ++used_slots_;
-  }
+  TTEntry stamped = in;
+  stamped.generation = generation_;
+  const std::uint64_t data = encode_data(stamped);
+  const std::uint64_t score_word = encode_score(key, stamped);
+  slots.slots[target].data.store(data, std::memory_order_relaxed);
+  slots.slots[target].check.store(score_word ^ data, std::memory_order_relaxed);
 
   if (trace_enabled(TraceTopic::TT)) {
     std::ostringstream oss;
@@ -126,12 +378,27 @@ void TT::store(std::uint64_t key, const TTEntry& in) {
 }
 
 int TT::hashfull() const {
-  if (entries_.empty()) {
+  if (!buckets_) {
     return 0;
   }
-  const std::size_t cap = entries_.size();
-  const std::size_t filled = std::min(used_slots_, cap);
-  const std::size_t scaled = (filled * 1000ULL + cap / 2) / cap;
+  // Sample the leading buckets instead of maintaining a shared counter; the
+  // estimate stays contention-free under SMP.
+  const std::size_t sample_buckets = std::min<std::size_t>(bucket_count_, 250);
+  std::size_t sampled = 0;
+  std::size_t filled = 0;
+  for (std::size_t bucket = 0; bucket < sample_buckets; ++bucket) {
+    for (std::size_t slot = 0; slot < kBucketSize; ++slot) {
+      const std::uint64_t data =
+          buckets_[bucket].slots[slot].data.load(std::memory_order_relaxed);
+      const std::uint64_t score_word =
+          buckets_[bucket].slots[slot].check.load(std::memory_order_relaxed) ^ data;
+      ++sampled;
+      if ((data | score_word) != 0ULL) {
+        ++filled;
+      }
+    }
+  }
+  const std::size_t scaled = (filled * 1000ULL + sampled / 2) / sampled;
   return static_cast<int>(std::min<std::size_t>(1000, scaled));
 }
 
@@ -1,9 +1,15 @@
 #pragma once
 // hash.h -- Transposition table storage and probing helpers.
 // Provides 4-way buckets with age/depth-aware replacement and generation tracking.
+// Entries are packed into two 64-bit words accessed with relaxed atomics and
+// XOR validation, so concurrent probes and stores from Lazy SMP workers are
+// race-free without locks and a bucket fits a single 64-byte cache line.
 
+#include <array>
+#include <atomic>
 #include <cstdint>
-#include <vector>
+#include <memory>
+#include <string>
 
 #include "common.h"
 
@@ -11,7 +17,14 @@ namespace bby {
 
 enum class BoundType : std::uint8_t { Exact = 0, Lower = 1, Upper = 2 };
 
-struct alignas(16) TTEntry {
+// Cached verdict of the singular-extension exclusion search (search.cpp).
+// Stored alongside the entry so revisits at the same depth can skip the
+// verification search instead of re-running it.
+enum class SingularResult : std::uint8_t { Unknown = 0, Singular = 1, NotSingular = 2 };
+
+// Decoded view of one table slot used at the probe/store interface. The
+// in-memory representation is the packed TTSlot below.
+struct TTEntry {
   std::uint64_t key{0};
   Move best_move{};
   Score score{0};
@@ -19,7 +32,9 @@ struct alignas(16) TTEntry {
   std::uint8_t depth{0};
   std::uint8_t generation{0};
   BoundType bound{BoundType::Exact};
-  std::uint8_t padding{0};
+  // Exclusion-search verdict for best_move; valid only at singular_depth.
+  SingularResult singular{SingularResult::Unknown};
+  std::uint8_t singular_depth{0};
 };
 
 class TT {
@@ -29,17 +44,57 @@ public:
   static constexpr std::size_t kBucketSize = 4;
 
   void set_generation(std::uint8_t gen);
+  [[nodiscard]] std::uint8_t generation() const { return generation_; }
+  // Streams the table to disk behind a layout-validating header, and adopts
+  // a dump back as a lazily-faulted private mapping so multi-gigabyte loads
+  // do not delay startup. Both return false on I/O or layout mismatch.
+  bool save(const std::string& path) const;
+  bool load(const std::string& path);
+  // Zeroes every slot, splitting the range across worker threads
+  // (0 = one per hardware thread). The table must be quiescent.
+  void clear(std::size_t thread_count = 0);
+  // Adopts the new size, reusing the existing mapping when it is large
+  // enough so tournament-time ucinewgame does not stall on reallocation.
+  void resize(std::size_t megabytes, std::size_t thread_count = 0);
+  // Hints the cache hierarchy to pull the bucket for `key`; issued right
+  // after make() so the line is resident by the time the child probes.
+  void prefetch(std::uint64_t key) const;
   bool probe(std::uint64_t key, TTEntry& out) const;
   void store(std::uint64_t key, const TTEntry& in);
   int hashfull() const;
 
 private:
+  // One packed 16-byte slot. `data` holds the move/depth/generation/bound
+  // word; `check` holds the score word XOR-ed with `data`, so a torn
+  // concurrent update scrambles the 32-bit key tag and reads as a miss.
+  struct TTSlot {
+    std::atomic<std::uint64_t> data{0};
+    std::atomic<std::uint64_t> check{0};
+  };
+
+  struct alignas(64) TTBucket {
+    std::array<TTSlot, kBucketSize> slots{};
+  };
+
   [[nodiscard]] std::size_t bucket_index(std::uint64_t key) const;
 
+  // Releases the table backing, which may be an anonymous mapping (Linux,
+  // transparent-huge-page and NUMA-interleave hinted) or aligned heap memory.
+  struct TableDeleter {
+    // Explicit constructors: default member initializers are not visible to
+    // unique_ptr's constraints until the enclosing class is complete.
+    TableDeleter() noexcept : bytes(0), mapped(false) {}
+    TableDeleter(std::size_t bytes_in, bool mapped_in) noexcept
+        : bytes(bytes_in), mapped(mapped_in) {}
+    void operator()(TTBucket* ptr) const;
+
+    std::size_t bytes;
+    bool mapped;
+  };
+
   std::size_t bucket_count_{1};
-  std::vector<TTEntry> entries_;
+  std::unique_ptr<TTBucket[], TableDeleter> buckets_;
   std::uint8_t generation_{0};
-  std::size_t used_slots_{0};
 };
 
 }  // namespace bby
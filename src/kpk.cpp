@@ -0,0 +1,156 @@
+#include "kpk.h"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+namespace bby {
+namespace {
+
+// The database is one bitboard over the weak king square per
+// (side to move, pawn slot, strong king) row: 2 x 24 x 64 rows of 64 bits.
+// Keeping the weak king as the bit dimension makes each retrograde sweep a
+// handful of shifts and masks per row, which is what keeps the constexpr
+// evaluation inside the same interpreter budget the slider tables use.
+constexpr unsigned kNumRows = 2 * 24 * 64;
+
+constexpr Bitboard kFileA = 0x0101010101010101ULL;
+constexpr Bitboard kFileH = 0x8080808080808080ULL;
+
+// Pawn slots cover files a-d (e-h are mirrored by the probe) and ranks 2-7.
+constexpr int slot_square(unsigned slot) {
+  return static_cast<int>(((slot % 6) + 1) * 8 + slot / 6);
+}
+
+constexpr unsigned kpk_row(unsigned stm, unsigned slot, unsigned king) {
+  return (stm * 24 + slot) * 64 + king;
+}
+
+// Local king/pawn attack sets as pure shift expressions; the tables in
+// attacks.cpp are file-private and carry runtime dispatch machinery this
+// generator does not need.
+constexpr Bitboard king_zone(int sq) {
+  const Bitboard b = 1ULL << sq;
+  const Bitboard h = b | ((b << 1) & ~kFileA) | ((b >> 1) & ~kFileH);
+  return h | (h << 8) | (h >> 8);
+}
+
+constexpr Bitboard king_att(int sq) { return king_zone(sq) & ~(1ULL << sq); }
+
+constexpr Bitboard pawn_att(int psq) {
+  const Bitboard pawn = 1ULL << psq;
+  return ((pawn << 9) & ~kFileA) | ((pawn << 7) & ~kFileH);
+}
+
+// Squares from which a king can step into `targets`: one dilation by the
+// eight king directions. A square inside `targets` qualifies only when it
+// neighbours another target, matching actual move semantics.
+constexpr Bitboard king_reach(Bitboard targets) {
+  const Bitboard h = ((targets << 1) & ~kFileA) | ((targets >> 1) & ~kFileH);
+  const Bitboard hv = targets | h;
+  return h | (hv << 8) | (hv >> 8);
+}
+
+constexpr std::array<Bitboard, kNumRows> build_kpk_bitbase() {
+  std::array<Bitboard, kNumRows> win{};
+
+  // Seed: the strong side to move with the pawn on the seventh promotes on
+  // the spot when the promotion square is free and either defended or out
+  // of the weak king's reach. Everything else starts as a non-win and is
+  // promoted by the fixpoint below.
+  for (unsigned slot = 5; slot < 24; slot += 6) {
+    const int psq = slot_square(slot);
+    const int promo = psq + 8;
+    for (int wk = 0; wk < 64; ++wk) {
+      if (wk == psq || wk == promo) {
+        continue;
+      }
+      const Bitboard safe =
+          (king_att(promo) & (1ULL << wk)) ? ~0ULL : ~king_zone(promo);
+      const Bitboard valid = ~king_zone(wk) & ~(1ULL << psq) & ~pawn_att(psq);
+      win[kpk_row(0, slot, static_cast<unsigned>(wk))] = safe & valid;
+    }
+  }
+
+  // Fixpoint: the strong side wins when some king step or pawn push reaches
+  // a weak-to-move win; the weak side is lost when it has a legal move and
+  // every one of them (including a capture of an undefended pawn, which is
+  // never a win bit) lands inside a strong-to-move win. Both directions are
+  // bitboard expressions over the weak king square, so each row costs a few
+  // dozen word operations per sweep.
+  bool repeat = true;
+  while (repeat) {
+    repeat = false;
+    for (unsigned slot = 0; slot < 24; ++slot) {
+      const int psq = slot_square(slot);
+      const int rank = psq >> 3;
+      for (int wk = 0; wk < 64; ++wk) {
+        if (wk == psq) {
+          continue;
+        }
+        const Bitboard valid_weak = ~king_zone(wk) & ~(1ULL << psq);
+        const Bitboard valid_strong = valid_weak & ~pawn_att(psq);
+
+        // Strong side to move: king steps plus pawn pushes. Rows already
+        // carry their own validity masks, so blocked or illegal successors
+        // contribute nothing.
+        Bitboard reach = 0ULL;
+        Bitboard kings = king_att(wk);
+        while (kings) {
+          const int to = static_cast<int>(std::countr_zero(kings));
+          kings &= kings - 1;
+          if (to != psq) {
+            reach |= win[kpk_row(1, slot, static_cast<unsigned>(to))];
+          }
+        }
+        if (rank < 6 && psq + 8 != wk) {
+          reach |= win[kpk_row(1, slot + 1, static_cast<unsigned>(wk))];
+          if (rank == 1 && psq + 16 != wk) {
+            reach |= win[kpk_row(1, slot + 2, static_cast<unsigned>(wk))] &
+                     ~(1ULL << (psq + 8));
+          }
+        }
+        const unsigned row0 = kpk_row(0, slot, static_cast<unsigned>(wk));
+        const Bitboard next0 = win[row0] | (reach & valid_strong);
+        if (next0 != win[row0]) {
+          win[row0] = next0;
+          repeat = true;
+        }
+
+        // Weak side to move. A defended pawn square sits inside the strong
+        // king's zone and so is never a legal target; an undefended one is,
+        // and its win bit is always clear, making the capture an escape.
+        // Stalemate (no legal target at all) correctly stays a non-win.
+        const Bitboard legal = ~king_zone(wk) & ~pawn_att(psq);
+        const unsigned row1 = kpk_row(1, slot, static_cast<unsigned>(wk));
+        const Bitboard next1 = valid_weak & king_reach(legal) &
+                               ~king_reach(legal & ~win[row0]);
+        if (next1 != win[row1]) {
+          win[row1] = next1;
+          repeat = true;
+        }
+      }
+    }
+  }
+  return win;
+}
+
+constexpr std::array<Bitboard, kNumRows> kKpkBitbase = build_kpk_bitbase();
+
+}  // namespace
+
+bool kpk_probe(Square strong_king, Square pawn, Square weak_king, Color stm) {
+  unsigned sk = static_cast<unsigned>(strong_king);
+  unsigned wk = static_cast<unsigned>(weak_king);
+  unsigned psq = static_cast<unsigned>(pawn);
+  if ((psq & 7) > 3) {
+    sk ^= 7;
+    wk ^= 7;
+    psq ^= 7;
+  }
+  const unsigned slot = (psq & 7) * 6 + ((psq >> 3) - 1);
+  const unsigned row = kpk_row(stm == Color::White ? 0u : 1u, slot, sk);
+  return (kKpkBitbase[row] >> wk) & 1ULL;
+}
+
+}  // namespace bby
@@ -0,0 +1,22 @@
+#pragma once
+/**
+ * @file kpk.h
+ * @brief Compile-time KPK (king and pawn versus king) bitbase.
+ *
+ * The full 2x24x64x64 result table is generated by constexpr retrograde
+ * analysis in kpk.cpp and baked into the binary, the same way the slider
+ * attack tables are; probing is a single bit lookup at runtime.
+ */
+
+#include "common.h"
+
+namespace bby {
+
+// Returns true when the pawn's side wins with best play. Squares are given
+// from the pawn owner's point of view with the pawn moving up the board
+// (the caller mirrors ranks when the pawn is black); `stm` is White when
+// the strong side is to move. Files e-h are mirrored internally. Any
+// non-win is a draw: KPK has no fortress losses for the strong side.
+bool kpk_probe(Square strong_king, Square pawn, Square weak_king, Color stm);
+
+}  // namespace bby
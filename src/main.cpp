@@ -1,13 +1,33 @@
 #include <iostream>
 #include <string_view>
 
+#include "analyze.h"
 #include "bench_cli.h"
+#include "distributed.h"
+#include "selfplay.h"
+#include "testsuite.h"
+#include "tune.h"
 #include "uci.h"
 
 int main(int argc, const char* argv[]) {
   if (argc > 1 && std::string_view(argv[1]) == "bench") {
     return bby::bench_cli_main(argc - 2, argv + 2);
   }
+  if (argc > 1 && std::string_view(argv[1]) == "testsuite") {
+    return bby::testsuite_cli_main(argc - 2, argv + 2);
+  }
+  if (argc > 1 && std::string_view(argv[1]) == "analyze") {
+    return bby::analyze_cli_main(argc - 2, argv + 2);
+  }
+  if (argc > 1 && std::string_view(argv[1]) == "tune") {
+    return bby::tune_cli_main(argc - 2, argv + 2);
+  }
+  if (argc > 1 && std::string_view(argv[1]) == "selfplay") {
+    return bby::selfplay_cli_main(argc - 2, argv + 2);
+  }
+  if (argc > 1 && std::string_view(argv[1]) == "distributed") {
+    return bby::distributed_cli_main(argc - 2, argv + 2);
+  }
   std::cout << bby::engine_name() << " by " << bby::engine_author() << std::endl;
   return bby::uci_main();
 }
@@ -0,0 +1,282 @@
+#include "matesearch.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+#include "common.h"
+
+namespace bby {
+
+namespace {
+
+// Proof/disproof infinity; kept far below the uint32 ceiling so threshold
+// arithmetic can add without overflow checks.
+constexpr std::uint32_t kPnInf = 1u << 30;
+
+// 16 bytes per entry: the position key (salted with remaining depth) and
+// the current proof/disproof pair. Always-replace, single probe.
+struct PnEntry {
+  std::uint64_t key{0};
+  std::uint32_t pn{1};
+  std::uint32_t dn{1};
+};
+
+constexpr std::uint32_t sat_add(std::uint32_t a, std::uint32_t b) {
+  return std::min(kPnInf, a + b);
+}
+
+// The same position at a different remaining depth is a different node:
+// "mate in 3 plies from here" and "mate in 5 plies from here" have
+// independent proof numbers, and salting the key sidesteps the
+// graph-history headaches a shared entry would invite.
+std::uint64_t depth_salt(std::uint64_t zobrist, int remaining) {
+  return zobrist ^ (static_cast<std::uint64_t>(remaining) * 0x9e3779b97f4a7c15ULL);
+}
+
+struct PnSolver {
+  std::vector<PnEntry> table;
+  std::uint64_t mask{0};
+  std::int64_t nodes{0};
+  std::int64_t node_limit{-1};
+  const std::atomic<bool>* stop{nullptr};
+  bool aborted{false};
+
+  explicit PnSolver(std::size_t table_mb) {
+    std::size_t entries = std::max<std::size_t>(
+        1024, table_mb * 1024 * 1024 / sizeof(PnEntry));
+    std::size_t rounded = 1024;
+    while (rounded * 2 <= entries) {
+      rounded *= 2;
+    }
+    table.assign(rounded, PnEntry{});
+    mask = rounded - 1;
+  }
+
+  void lookup(std::uint64_t key, std::uint32_t& pn, std::uint32_t& dn) const {
+    const PnEntry& entry = table[key & mask];
+    if (entry.key == key) {
+      pn = entry.pn;
+      dn = entry.dn;
+    } else {
+      pn = 1;
+      dn = 1;
+    }
+  }
+
+  void store(std::uint64_t key, std::uint32_t pn, std::uint32_t dn) {
+    PnEntry& entry = table[key & mask];
+    entry.key = key;
+    entry.pn = pn;
+    entry.dn = dn;
+  }
+
+  bool should_abort() {
+    if (aborted) {
+      return true;
+    }
+    if ((nodes & 1023) == 0) {
+      if ((node_limit > 0 && nodes >= node_limit) ||
+          (stop != nullptr && stop->load(std::memory_order_relaxed))) {
+        aborted = true;
+      }
+    }
+    return aborted;
+  }
+
+  // Nagai's df-pn MID step. OR nodes belong to the attacker (the side the
+  // root wants mating); proof means "mate within `remaining` plies".
+  void mid(Position& pos, int remaining, bool or_node, std::uint32_t thpn,
+           std::uint32_t thdn) {
+    ++nodes;
+    const std::uint64_t key = depth_salt(pos.zobrist(), remaining);
+    if (should_abort()) {
+      return;
+    }
+
+    const Color stm = pos.side_to_move();
+    const bool in_check = pos.in_check(stm);
+    MoveList moves;
+    // In check the dedicated evasion generator keeps the branching factor
+    // at the handful of legal escapes, which is where df-pn spends most of
+    // its defender time.
+    pos.generate_moves(moves, in_check ? GenStage::Evasions : GenStage::All);
+    MoveList legal;
+    for (const Move move : moves) {
+      if (pos.is_legal(move)) {
+        legal.push_back(move);
+      }
+    }
+
+    if (legal.size() == 0) {
+      if (in_check && !or_node) {
+        // The defender is mated: the attacker's objective holds.
+        store(key, 0, kPnInf);
+      } else {
+        // Attacker mated or any stalemate: the objective fails.
+        store(key, kPnInf, 0);
+      }
+      return;
+    }
+    if (remaining <= 0) {
+      store(key, kPnInf, 0);
+      return;
+    }
+
+    // Checking moves first at attacker nodes: a mate line is all checks at
+    // the end, and trying them first keeps proof numbers small.
+    std::array<Move, kMaxMoves> order{};
+    std::size_t order_count = 0;
+    if (or_node) {
+      for (const Move move : legal) {
+        if (pos.gives_check(move)) {
+          order[order_count++] = move;
+        }
+      }
+      for (const Move move : legal) {
+        if (!pos.gives_check(move)) {
+          order[order_count++] = move;
+        }
+      }
+    } else {
+      for (const Move move : legal) {
+        order[order_count++] = move;
+      }
+    }
+
+    while (true) {
+      // Recompute this node's pn/dn from the children's table entries.
+      std::uint32_t pn = or_node ? kPnInf : 0;
+      std::uint32_t dn = or_node ? 0 : kPnInf;
+      std::uint32_t best_child_pn = kPnInf;
+      std::uint32_t best_child_dn = kPnInf;
+      std::uint32_t second_pn = kPnInf;
+      std::uint32_t second_dn = kPnInf;
+      std::size_t best_index = 0;
+      for (std::size_t idx = 0; idx < order_count; ++idx) {
+        Undo undo;
+        pos.make(order[idx], undo);
+        const std::uint64_t child_key = depth_salt(pos.zobrist(), remaining - 1);
+        pos.unmake(order[idx], undo);
+        std::uint32_t child_pn = 1;
+        std::uint32_t child_dn = 1;
+        lookup(child_key, child_pn, child_dn);
+        if (or_node) {
+          dn = sat_add(dn, child_dn);
+          if (child_pn < best_child_pn) {
+            second_pn = best_child_pn;
+            best_child_pn = child_pn;
+            best_child_dn = child_dn;
+            best_index = idx;
+          } else {
+            second_pn = std::min(second_pn, child_pn);
+          }
+          pn = std::min(pn, child_pn);
+        } else {
+          pn = sat_add(pn, child_pn);
+          if (child_dn < best_child_dn) {
+            second_dn = best_child_dn;
+            best_child_dn = child_dn;
+            best_child_pn = child_pn;
+            best_index = idx;
+          } else {
+            second_dn = std::min(second_dn, child_dn);
+          }
+          dn = std::min(dn, child_dn);
+        }
+      }
+
+      if (pn >= thpn || dn >= thdn || pn == 0 || dn == 0) {
+        store(key, pn, dn);
+        return;
+      }
+      if (should_abort()) {
+        store(key, pn, dn);
+        return;
+      }
+
+      std::uint32_t child_thpn = 0;
+      std::uint32_t child_thdn = 0;
+      if (or_node) {
+        child_thpn = std::min(thpn, sat_add(second_pn, 1));
+        child_thdn = sat_add(thdn - dn, best_child_dn);
+      } else {
+        child_thdn = std::min(thdn, sat_add(second_dn, 1));
+        child_thpn = sat_add(thpn - pn, best_child_pn);
+      }
+      Undo undo;
+      pos.make(order[best_index], undo);
+      mid(pos, remaining - 1, !or_node, child_thpn, child_thdn);
+      pos.unmake(order[best_index], undo);
+    }
+  }
+
+  // Walks the proven tree, always following a child whose proof number is
+  // zero, to recover the mating line.
+  void extract_line(Position& pos, int remaining, bool or_node,
+                    std::vector<Move>& line) {
+    if (remaining <= 0) {
+      return;
+    }
+    const bool in_check = pos.in_check(pos.side_to_move());
+    MoveList moves;
+    pos.generate_moves(moves, in_check ? GenStage::Evasions : GenStage::All);
+    for (const Move move : moves) {
+      if (!pos.is_legal(move)) {
+        continue;
+      }
+      Undo undo;
+      pos.make(move, undo);
+      std::uint32_t child_pn = 1;
+      std::uint32_t child_dn = 1;
+      lookup(depth_salt(pos.zobrist(), remaining - 1), child_pn, child_dn);
+      if (child_pn == 0) {
+        line.push_back(move);
+        extract_line(pos, remaining - 1, !or_node, line);
+        pos.unmake(move, undo);
+        return;
+      }
+      pos.unmake(move, undo);
+    }
+  }
+};
+
+}  // namespace
+
+MateSearchResult mate_search(const Position& root, int mate_in,
+                             std::size_t table_mb, std::int64_t node_limit,
+                             const std::atomic<bool>* stop) {
+  MateSearchResult result;
+  PnSolver solver(std::max<std::size_t>(1, table_mb));
+  solver.node_limit = node_limit;
+  solver.stop = stop;
+
+  // Iterate outward so the first proof is also the shortest mate; entries
+  // are keyed by remaining depth, so earlier iterations seed later ones.
+  for (int n = 1; n <= std::max(1, mate_in); ++n) {
+    const int remaining = 2 * n - 1;
+    Position pos = root;
+    solver.mid(pos, remaining, true, kPnInf - 1, kPnInf - 1);
+    result.nodes = solver.nodes;
+    if (solver.aborted) {
+      result.aborted = true;
+      break;
+    }
+    std::uint32_t pn = 1;
+    std::uint32_t dn = 1;
+    solver.lookup(depth_salt(root.zobrist(), remaining), pn, dn);
+    if (pn == 0) {
+      result.proven = true;
+      result.mate_in = n;
+      Position walk = root;
+      solver.extract_line(walk, remaining, true, result.line);
+      if (!result.line.empty()) {
+        result.best = result.line.front();
+      }
+      break;
+    }
+  }
+  return result;
+}
+
+}  // namespace bby
@@ -0,0 +1,35 @@
+#pragma once
+// matesearch.h -- Depth-first proof-number search for `go mate N`.
+//
+// Alpha-beta refines scores it never needs when the only question is
+// "is there a forced mate within N moves"; df-pn answers exactly that by
+// expanding the child with the cheapest remaining proof (or disproof) and
+// storing proof/disproof numbers in a transposition table of its own.
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "board.h"
+
+namespace bby {
+
+struct MateSearchResult {
+  bool proven{false};
+  // Full moves to mate when proven; the solver iterates outward so this is
+  // the shortest mate within the requested bound.
+  int mate_in{0};
+  Move best{};
+  std::vector<Move> line;
+  std::int64_t nodes{0};
+  bool aborted{false};
+};
+
+// Searches for a forced mate by the side to move in at most `mate_in`
+// full moves. `table_mb` sizes the proof-number transposition table,
+// `node_limit` (<=0 for none) and `stop` bound the effort.
+MateSearchResult mate_search(const Position& root, int mate_in,
+                             std::size_t table_mb, std::int64_t node_limit,
+                             const std::atomic<bool>* stop);
+
+}  // namespace bby
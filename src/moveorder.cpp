@@ -20,6 +20,12 @@ constexpr int kPromotionBase = 90'000;
 constexpr int kKillerPrimary = 80'000;
 constexpr int kKillerSecondary = 60'000;
 constexpr int kBadCapturePenalty = 40'000;
+constexpr int kQuietCheckBonus = 4'000;
+// Root effort scores sit above every heuristic class except the TT move, so
+// a move with any recorded subtree outranks cold captures and quiets alike.
+constexpr int kRootEffortBase = 500'000;
+constexpr int kRootEffortShift = 4;
+constexpr std::int64_t kRootEffortCap = 400'000;
 constexpr int kHistoryScale = 2;
 constexpr int kSeeMarginTrigger = 200;
 
@@ -94,6 +100,18 @@ int promotion_delta(Move m) {
          kPieceValues[static_cast<int>(PieceType::Pawn)];
 }
 
+constexpr int kMaxHistory = 32'000;
+
+// Gravity update shared by the history tables: the step toward the delta's
+// sign shrinks as the entry nears +/-kMaxHistory, so values asymptote at the
+// bound instead of pinning there, and a saturated entry still responds to
+// contrary evidence. The bound makes int16_t storage safe by construction.
+std::int16_t history_gravity(std::int16_t current, int delta) {
+  const int clamped = std::clamp(delta, -kMaxHistory, kMaxHistory);
+  const int value = current + clamped - current * std::abs(clamped) / kMaxHistory;
+  return static_cast<std::int16_t>(value);
+}
+
 int history_score(const HistoryTable* history, const Position& pos, Move m) {
   if (!history) {
     return 0;
@@ -128,6 +146,144 @@ struct SeeState {
   }
 };
 
+// Board state for the SEE swap loop, shared by the exact evaluator and the
+// threshold test. init() plays the initial move; attackers_for() keeps the
+// per-side attacker sets lazily, refreshing slider rays only when a removal
+// can open an x-ray; play() executes one recapture. Cached attacker sets may
+// contain already-removed pieces, so callers must intersect with the live
+// piece bitboards via least_valuable() before trusting a non-empty set.
+struct ExchangePlayout {
+  SeeState state{};
+  Square to{Square::None};
+  std::array<Bitboard, 2> non_sliders{};
+  Bitboard bishop_rays{0ULL};
+  Bitboard rook_rays{0ULL};
+  Bitboard bishop_mask{0ULL};
+  Bitboard rook_mask{0ULL};
+  std::array<Bitboard, 2> attackers{};
+  std::array<bool, 2> dirty{true, true};
+  PieceType current_type{PieceType::None};
+  Color current_color{Color::White};
+
+  // Sets up the exchange after `m` and returns the initial material gain
+  // (victim value plus any promotion delta).
+  int init(const Position& pos, Move m) {
+    const MoveFlag flag = move_flag(m);
+    const Square from = from_square(m);
+    to = to_square(m);
+    const Piece moving_piece = pos.piece_on(from);
+    const Color us = color_of(moving_piece);
+    const Color them = flip(us);
+    const PieceType moving_type = type_of(moving_piece);
+    const PieceType promotion = promotion_type(m);
+
+    const Piece victim_piece = (flag == MoveFlag::EnPassant)
+                                   ? make_piece(them, PieceType::Pawn)
+                                   : pos.piece_on(to);
+
+    for (int color_idx = 0; color_idx < 2; ++color_idx) {
+      const Color color = color_idx == 0 ? Color::White : Color::Black;
+      state.occ_by_color[color_idx] = pos.occupancy(color);
+      for (int type_idx = 0; type_idx < 6; ++type_idx) {
+        state.pieces[color_idx][type_idx] =
+            pos.pieces(color, static_cast<PieceType>(type_idx));
+      }
+    }
+    state.occ = state.occ_by_color[0] | state.occ_by_color[1];
+
+    state.remove_piece(us, moving_type, from);
+    if (flag == MoveFlag::EnPassant) {
+      const int ep_dir = (us == Color::White) ? -8 : 8;
+      const auto ep_sq = static_cast<Square>(static_cast<int>(to) + ep_dir);
+      state.remove_piece(them, PieceType::Pawn, ep_sq);
+    } else if (victim_piece != Piece::None) {
+      state.remove_piece(them, type_of(victim_piece), to);
+    }
+
+    current_type = (promotion != PieceType::None) ? promotion : moving_type;
+    current_color = us;
+    state.place_piece(current_color, current_type, to);
+
+    non_sliders = {compute_non_sliders(Color::White),
+                   compute_non_sliders(Color::Black)};
+    bishop_rays = bishop_attacks(to, 0ULL);
+    rook_rays = rook_attacks(to, 0ULL);
+    bishop_mask = bishop_attacks(to, state.occ);
+    rook_mask = rook_attacks(to, state.occ);
+
+    return material(victim_piece) + promotion_delta(m);
+  }
+
+  [[nodiscard]] Bitboard compute_non_sliders(Color side) const {
+    const int idx = color_index(side);
+    Bitboard attackers_bb = pawn_attacks(flip(side), to) &
+                            state.pieces[idx][piece_index(PieceType::Pawn)];
+    attackers_bb |= knight_attacks(to) &
+                    state.pieces[idx][piece_index(PieceType::Knight)];
+    attackers_bb |= king_attacks(to) &
+                    state.pieces[idx][piece_index(PieceType::King)];
+    return attackers_bb;
+  }
+
+  Bitboard attackers_for(Color side) {
+    const int idx = color_index(side);
+    if (dirty[idx]) {
+      Bitboard attackers_bb = non_sliders[idx];
+      const Bitboard bishop_like =
+          state.pieces[idx][piece_index(PieceType::Bishop)] |
+          state.pieces[idx][piece_index(PieceType::Queen)];
+      const Bitboard rook_like =
+          state.pieces[idx][piece_index(PieceType::Rook)] |
+          state.pieces[idx][piece_index(PieceType::Queen)];
+      attackers_bb |= bishop_mask & bishop_like;
+      attackers_bb |= rook_mask & rook_like;
+      attackers[idx] = attackers_bb;
+      dirty[idx] = false;
+    }
+    return attackers[idx];
+  }
+
+  // Least-valuable live attacker in `pool`; PieceType::None when the pool
+  // holds only stale entries.
+  [[nodiscard]] std::pair<PieceType, Square> least_valuable(Color side,
+                                                            Bitboard pool) const {
+    const int idx = color_index(side);
+    for (const PieceType candidate : kSeeOrder) {
+      const Bitboard subset = state.pieces[idx][piece_index(candidate)] & pool;
+      if (subset != 0ULL) {
+        return {candidate, static_cast<Square>(std::countr_zero(subset))};
+      }
+    }
+    return {PieceType::None, Square::None};
+  }
+
+  void play(Color side, PieceType type, Square sq) {
+    const int idx = color_index(side);
+    state.remove_piece(current_color, current_type, to);
+    const Bitboard from_mask = bit(sq);
+    state.remove_piece(side, type, sq);
+    if (type == PieceType::Pawn || type == PieceType::Knight ||
+        type == PieceType::King) {
+      non_sliders[idx] &= ~from_mask;
+    }
+    current_color = side;
+    current_type = type;
+    state.place_piece(current_color, current_type, to);
+
+    const bool touches_diag = (from_mask & bishop_rays) != 0ULL;
+    const bool touches_orth = (from_mask & rook_rays) != 0ULL;
+    if (touches_diag) {
+      bishop_mask = bishop_attacks(to, state.occ);
+    }
+    if (touches_orth) {
+      rook_mask = rook_attacks(to, state.occ);
+    }
+    if (touches_diag || touches_orth) {
+      dirty = {true, true};
+    }
+  }
+};
+
 }  // namespace
 
 void SeeCache::clear() {
@@ -164,10 +320,7 @@ int HistoryTable::get(Color color, Move move) const {
 
 void HistoryTable::add(Color color, Move move, int delta) {
   const std::size_t idx = index(color, move);
-  int value = values[idx] + delta;
-  constexpr int kMaxHistory = 32'000;
-  value = std::clamp(value, -kMaxHistory, kMaxHistory);
-  values[idx] = value;
+  values[idx] = history_gravity(values[idx], delta);
 }
 
 std::size_t HistoryTable::index(Color color, Move move) {
@@ -180,30 +333,51 @@ std::size_t HistoryTable::index(Color color, Move move) {
   return idx;
 }
 
-int CounterHistory::get(std::size_t previous_index, Move move) const {
-  if (previous_index >= kStride) {
+int CaptureHistory::get(Piece attacker, Square to, PieceType victim) const {
+  if (attacker == Piece::None || victim == PieceType::None || victim == PieceType::King) {
     return 0;
   }
-  const std::size_t idx = index(move);
+  return values[index(attacker, to, victim)];
+}
+
+void CaptureHistory::add(Piece attacker, Square to, PieceType victim, int delta) {
+  if (attacker == Piece::None || victim == PieceType::None || victim == PieceType::King) {
+    return;
+  }
+  const std::size_t idx = index(attacker, to, victim);
+  values[idx] = history_gravity(values[idx], delta);
+}
+
+std::size_t CaptureHistory::index(Piece attacker, Square to, PieceType victim) {
+  BBY_ASSERT(attacker != Piece::None);
+  BBY_ASSERT(victim != PieceType::None && victim != PieceType::King);
+  return ((static_cast<std::size_t>(attacker) - 1) * 64 +
+          static_cast<std::size_t>(to)) *
+             kVictimTypes +
+         static_cast<std::size_t>(victim);
+}
+
+int CounterHistory::get(std::size_t previous_index, Piece piece, Move move) const {
+  if (previous_index >= kSlots || piece == Piece::None) {
+    return 0;
+  }
+  const std::size_t idx = index(piece, move);
   return values[previous_index][idx];
 }
 
-void CounterHistory::add(std::size_t previous_index, Move move, int delta) {
-  if (previous_index >= kStride) {
+void CounterHistory::add(std::size_t previous_index, Piece piece, Move move, int delta) {
+  if (previous_index >= kSlots || piece == Piece::None) {
     return;
   }
-  const std::size_t idx = index(move);
+  const std::size_t idx = index(piece, move);
   auto& table = values[previous_index];
-  int value = table[idx] + delta;
-  constexpr int kMaxHistory = 32'000;
-  value = std::clamp(value, -kMaxHistory, kMaxHistory);
-  table[idx] = value;
+  table[idx] = history_gravity(table[idx], delta);
 }
 
-std::size_t CounterHistory::index(Move move) {
-  const int from = static_cast<int>(from_square(move));
+std::size_t CounterHistory::index(Piece piece, Move move) {
+  BBY_ASSERT(piece != Piece::None);
   const int to = static_cast<int>(to_square(move));
-  return static_cast<std::size_t>(from) * 64 + static_cast<std::size_t>(to);
+  return (static_cast<std::size_t>(piece) - 1) * 64 + static_cast<std::size_t>(to);
 }
 
 int ContinuationHistory::get(Piece piece, Move move) const {
@@ -220,10 +394,7 @@ void ContinuationHistory::add(Piece piece, Move move, int delta) {
   }
   const std::size_t idx = index(piece, move);
   auto& table = values[static_cast<std::size_t>(piece) - 1];
-  int value = table[idx] + delta;
-  constexpr int kMaxHistory = 32'000;
-  value = std::clamp(value, -kMaxHistory, kMaxHistory);
-  table[idx] = value;
+  table[idx] = history_gravity(table[idx], delta);
 }
 
 std::size_t ContinuationHistory::index(Piece piece, Move move) {
@@ -233,6 +404,31 @@ std::size_t ContinuationHistory::index(Piece piece, Move move) {
   return static_cast<std::size_t>(from) * 64 + static_cast<std::size_t>(to);
 }
 
+void RootEffort::clear() {
+  count_ = 0;
+}
+
+void RootEffort::record(Move move, std::int64_t nodes) {
+  for (int idx = 0; idx < count_; ++idx) {
+    if (entries_[static_cast<std::size_t>(idx)].move == move) {
+      entries_[static_cast<std::size_t>(idx)].nodes = nodes;
+      return;
+    }
+  }
+  if (count_ < static_cast<int>(entries_.size())) {
+    entries_[static_cast<std::size_t>(count_++)] = Entry{move, nodes};
+  }
+}
+
+std::int64_t RootEffort::get(Move move) const {
+  for (int idx = 0; idx < count_; ++idx) {
+    if (entries_[static_cast<std::size_t>(idx)].move == move) {
+      return entries_[static_cast<std::size_t>(idx)].nodes;
+    }
+  }
+  return 0;
+}
+
 void score_moves(MoveList& ml, const OrderingContext& ctx, std::array<int, kMaxMoves>& scores,
                  std::array<int, kMaxMoves>* see_results, bool force_see) {
   BBY_ASSERT(ctx.pos != nullptr);
@@ -260,6 +456,12 @@ void score_moves(MoveList& ml, const OrderingContext& ctx, std::array<int, kMaxM
       const int mvv_lva = victim_value * 16 - attacker_value;  // MVV-LVA emphasis
       score += kCaptureBase + mvv_lva;
 
+      if (ctx.capture_history != nullptr) {
+        // Divided down so the learned signal reorders captures within and
+        // near a victim class without overriding MVV/LVA outright.
+        score += ctx.capture_history->get(attacker, to_square(move), type_of(victim)) / 8;
+      }
+
       const int margin = material(victim) - attacker_value;
       const bool needs_see =
           promotion_type(move) != PieceType::None || flag == MoveFlag::EnPassant ||
@@ -268,23 +470,31 @@ void score_moves(MoveList& ml, const OrderingContext& ctx, std::array<int, kMaxM
 
       int see_value = margin;
       bool have_see = false;
+      bool losing = margin < 0;
       if (guaranteed_win) {
         have_see = true;
+        losing = false;
       } else {
         const bool near_margin = std::abs(margin) < kSeeMarginTrigger;
         if (force_see || (needs_see && near_margin)) {
-          see_value = cached_see(pos, move, ctx.see_cache);
-          have_see = true;
+          if (see_results != nullptr) {
+            // The caller wants exact values, so compute once and reuse the
+            // sign below.
+            see_value = cached_see(pos, move, ctx.see_cache);
+            have_see = true;
+            losing = see_value < 0;
+          } else {
+            // Ordering only needs the sign; the threshold test exits the
+            // swap loop as soon as the bound is decided.
+            losing = !see_ge(pos, move, 0);
+          }
         } else if (margin < 0) {
           have_see = true;
         }
       }
 
-      if (!guaranteed_win && needs_see) {
-        const bool losing = have_see ? (see_value < 0) : (margin < 0);
-        if (losing) {
-          score -= kBadCapturePenalty;
-        }
+      if (!guaranteed_win && needs_see && losing) {
+        score -= kBadCapturePenalty;
       }
 
       if (see_results != nullptr) {
@@ -302,19 +512,34 @@ void score_moves(MoveList& ml, const OrderingContext& ctx, std::array<int, kMaxM
       const int hist = history_score(ctx.history, pos, move);
       score += static_cast<int>(std::lround(ctx.history_weight * static_cast<double>(hist)));
       if (!ctx.parent_move.is_null()) {
-        const std::size_t prev_idx = CounterHistory::index(ctx.parent_move);
-        if (ctx.counter_history != nullptr) {
-          const int counter_val = ctx.counter_history->get(prev_idx, move);
+        const Piece parent_piece = pos.piece_on(to_square(ctx.parent_move));
+        if (ctx.counter_history != nullptr && parent_piece != Piece::None) {
+          const std::size_t prev_idx = CounterHistory::index(parent_piece, ctx.parent_move);
+          const int counter_val =
+              ctx.counter_history->get(prev_idx, pos.piece_on(from_square(move)), move);
           score += static_cast<int>(std::lround(ctx.counter_history_weight *
                                                static_cast<double>(counter_val)));
         }
         if (ctx.continuation_history != nullptr) {
-          const Piece parent_piece = pos.piece_on(to_square(ctx.parent_move));
           const int cont_val = ctx.continuation_history->get(parent_piece, move);
           score += static_cast<int>(std::lround(ctx.continuation_history_weight *
                                                static_cast<double>(cont_val)));
         }
       }
+      if (pos.gives_check(move)) {
+        score += kQuietCheckBonus;
+      }
+    }
+
+    if (ctx.root_effort != nullptr) {
+      const std::int64_t effort = ctx.root_effort->get(move);
+      if (effort > 0) {
+        // Effort replaces the heuristics outright: last iteration's subtree
+        // size already folds in everything the heuristics approximate. The
+        // shift trades the low bits for headroom under the score cap.
+        score = kRootEffortBase +
+                static_cast<int>(std::min(effort >> kRootEffortShift, kRootEffortCap));
+      }
     }
 
     scores[idx] = score;
@@ -364,164 +589,225 @@ int see(const Position& pos, Move m) {
     return 0;
   }
 
-  const Square from = from_square(m);
-  const Square to = to_square(m);
-  const Piece moving_piece = pos.piece_on(from);
-  const Color us = color_of(moving_piece);
-  const Color them = flip(us);
-  const PieceType moving_type = type_of(moving_piece);
-  const PieceType promotion = promotion_type(m);
-  const bool promoting = promotion != PieceType::None;
-
-  const Piece victim_piece =
-      (flag == MoveFlag::EnPassant)
-          ? make_piece(them, PieceType::Pawn)
-          : pos.piece_on(to);
-
-  const int initial_gain = material(victim_piece) + promotion_delta(m);
+  ExchangePlayout xp;
   int depth = 0;
   std::array<int, 32> gains{};
-  gains[depth] = initial_gain;
+  gains[depth] = xp.init(pos, m);
 
-  SeeState state{};
-  for (int color_idx = 0; color_idx < 2; ++color_idx) {
-    const Color color = color_idx == 0 ? Color::White : Color::Black;
-    state.occ_by_color[color_idx] = pos.occupancy(color);
-    for (int type_idx = 0; type_idx < 6; ++type_idx) {
-      state.pieces[color_idx][type_idx] =
-          pos.pieces(color, static_cast<PieceType>(type_idx));
+  Color side = flip(xp.current_color);
+  while (true) {
+    const Bitboard side_attackers = xp.attackers_for(side);
+    if (side_attackers == 0ULL) {
+      break;
+    }
+    const auto [attacker_type, attacker_sq] = xp.least_valuable(side, side_attackers);
+    if (attacker_type == PieceType::None) {
+      break;
     }
-  }
-  state.occ = state.occ_by_color[0] | state.occ_by_color[1];
 
-  state.remove_piece(us, moving_type, from);
-  if (flag == MoveFlag::EnPassant) {
-    const int ep_dir = (us == Color::White) ? -8 : 8;
-    const auto ep_sq =
-        static_cast<Square>(static_cast<int>(to) + ep_dir);
-    state.remove_piece(them, PieceType::Pawn, ep_sq);
-  } else if (victim_piece != Piece::None) {
-    state.remove_piece(them, type_of(victim_piece), to);
+    ++depth;
+    gains[depth] = kPieceValues[piece_index(xp.current_type)] - gains[depth - 1];
+    xp.play(side, attacker_type, attacker_sq);
+    side = flip(side);
   }
 
-  PieceType current_type = promoting ? promotion : moving_type;
-  Color current_color = us;
-  state.place_piece(current_color, current_type, to);
-
-  auto slider_attacks = [&](Bitboard occ) {
-    const Bitboard bishops = bishop_attacks(to, occ);
-    const Bitboard rooks = rook_attacks(to, occ);
-    return std::pair{bishops, rooks};
-  };
-
-  auto compute_non_sliders = [&](Color side) {
-    const int idx = color_index(side);
-    Bitboard attackers_bb = pawn_attacks(flip(side), to) &
-                            state.pieces[idx][piece_index(PieceType::Pawn)];
-    attackers_bb |= knight_attacks(to) &
-                    state.pieces[idx][piece_index(PieceType::Knight)];
-    attackers_bb |= king_attacks(to) &
-                    state.pieces[idx][piece_index(PieceType::King)];
-    return attackers_bb;
-  };
-
-  std::array<Bitboard, 2> non_sliders{
-      compute_non_sliders(Color::White),
-      compute_non_sliders(Color::Black),
-  };
-
-  const Bitboard bishop_rays = bishop_attacks(to, 0ULL);
-  const Bitboard rook_rays = rook_attacks(to, 0ULL);
+  for (int idx = depth; idx > 0; --idx) {
+    gains[idx - 1] = -std::max(-gains[idx - 1], gains[idx]);
+  }
 
-  auto compute_attackers = [&](Color side, Bitboard bishop_mask, Bitboard rook_mask) {
-    const int idx = color_index(side);
-    Bitboard attackers_bb = non_sliders[idx];
-    const Bitboard bishop_like =
-        (state.pieces[idx][piece_index(PieceType::Bishop)] |
-         state.pieces[idx][piece_index(PieceType::Queen)]);
-    const Bitboard rook_like =
-        (state.pieces[idx][piece_index(PieceType::Rook)] |
-         state.pieces[idx][piece_index(PieceType::Queen)]);
-    attackers_bb |= bishop_mask & bishop_like;
-    attackers_bb |= rook_mask & rook_like;
-    return attackers_bb;
-  };
+  return gains[0];
+}
 
-  Bitboard bishop_mask{};
-  Bitboard rook_mask{};
-  {
-    const auto masks = slider_attacks(state.occ);
-    bishop_mask = masks.first;
-    rook_mask = masks.second;
+bool see_ge(const Position& pos, Move m, int threshold) {
+  if (m.is_null()) {
+    return 0 >= threshold;
   }
 
-  std::array<Bitboard, 2> attackers{};
-  std::array<bool, 2> dirty{true, true};
+  const MoveFlag flag = move_flag(m);
+  if (!is_capture_like(flag) && promotion_type(m) == PieceType::None) {
+    return 0 >= threshold;
+  }
 
-  Color side = them;
+  ExchangePlayout xp;
+  // Balance after the initial capture; if that already misses the bound no
+  // recapture sequence can recover it.
+  int swap = xp.init(pos, m) - threshold;
+  if (swap < 0) {
+    return false;
+  }
+  // Worst case for the mover: the piece is simply taken back. If the bound
+  // still holds, no further resolution is needed.
+  swap = kPieceValues[piece_index(xp.current_type)] - swap;
+  if (swap <= 0) {
+    return true;
+  }
 
+  // Negamax over the swap sequence with a running balance: `result` flips
+  // ownership of the bound each time the side to move has a recapture, and
+  // the loop exits as soon as a capture cannot restore the balance, so long
+  // exchange chains terminate without being played out.
+  Color side = flip(xp.current_color);
+  int result = 1;
   while (true) {
-    const int side_idx = color_index(side);
-    if (dirty[side_idx]) {
-      attackers[side_idx] = compute_attackers(side, bishop_mask, rook_mask);
-      dirty[side_idx] = false;
-    }
-    Bitboard side_attackers = attackers[side_idx];
+    const Bitboard side_attackers = xp.attackers_for(side);
     if (side_attackers == 0ULL) {
       break;
     }
+    const auto [attacker_type, attacker_sq] = xp.least_valuable(side, side_attackers);
+    if (attacker_type == PieceType::None) {
+      break;
+    }
 
-    PieceType attacker_type = PieceType::None;
-    Square attacker_sq = Square::None;
-
-    for (const PieceType candidate : kSeeOrder) {
-      Bitboard pool = state.pieces[side_idx][piece_index(candidate)] & side_attackers;
-      if (pool != 0ULL) {
-        const int sq_idx = static_cast<int>(std::countr_zero(pool));
-        attacker_sq = static_cast<Square>(sq_idx);
-        attacker_type = candidate;
-        break;
+    result ^= 1;
+    if (attacker_type == PieceType::King) {
+      // The king can only stand on the capture square if the opponent has
+      // no reply; otherwise the recapture never happens.
+      const Color other = flip(side);
+      if (xp.least_valuable(other, xp.attackers_for(other)).first != PieceType::None) {
+        result ^= 1;
       }
+      break;
     }
 
-    if (attacker_type == PieceType::None) {
+    swap = kPieceValues[piece_index(attacker_type)] - swap;
+    if (swap < result) {
       break;
     }
+    xp.play(side, attacker_type, attacker_sq);
+    side = flip(side);
+  }
+  return result != 0;
+}
 
-    ++depth;
-    gains[depth] = kPieceValues[piece_index(current_type)] - gains[depth - 1];
-
-    state.remove_piece(current_color, current_type, to);
-    const Bitboard from_mask = bit(attacker_sq);
-    state.remove_piece(side, attacker_type, attacker_sq);
-    if (attacker_type == PieceType::Pawn || attacker_type == PieceType::Knight ||
-        attacker_type == PieceType::King) {
-      non_sliders[side_idx] &= ~from_mask;
+void MovePicker::generate(GenStage stage) {
+  moves_.clear();
+  const AttackInfo* info = ctx_.attacks;
+  if (info == nullptr) {
+    if (!have_attacks_) {
+      attacks_ = pos_.attack_info();
+      have_attacks_ = true;
     }
+    info = &attacks_;
+  }
+  pos_.generate_moves(moves_, stage, *info);
+  score_moves(moves_, ctx_, scores_);
+  index_ = 0;
+}
 
-    current_color = side;
-    current_type = attacker_type;
-    state.place_piece(current_color, current_type, to);
+MovePicker::MovePicker(const Position& pos, const OrderingContext& ctx)
+    : pos_(pos), ctx_(ctx) {}
 
-    side = flip(side);
-    const bool touches_diag = (from_mask & bishop_rays) != 0ULL;
-    const bool touches_orth = (from_mask & rook_rays) != 0ULL;
-    if (touches_diag) {
-      bishop_mask = bishop_attacks(to, state.occ);
-    }
-    if (touches_orth) {
-      rook_mask = rook_attacks(to, state.occ);
-    }
-    if (touches_diag || touches_orth) {
-      dirty = {true, true};
-    }
+Move MovePicker::next() {
+  if (ctx_.root_effort != nullptr) {
+    return next_root();
   }
-
-  for (int idx = depth; idx > 0; --idx) {
-    gains[idx - 1] = -std::max(-gains[idx - 1], gains[idx]);
+  switch (stage_) {
+    case Stage::TTMove:
+      stage_ = Stage::CaptureGen;
+      if (ctx_.tt != nullptr) {
+        const Move tt_move = ctx_.tt->best_move;
+        if (!tt_move.is_null() && pos_.is_pseudo_legal(tt_move) &&
+            pos_.is_legal(tt_move)) {
+          tt_move_ = tt_move;
+          return tt_move;
+        }
+      }
+      [[fallthrough]];
+    case Stage::CaptureGen:
+      generate(GenStage::Captures);
+      stage_ = Stage::Captures;
+      [[fallthrough]];
+    case Stage::Captures:
+      while (index_ < moves_.size()) {
+        select_best_move(moves_, scores_, index_, moves_.size());
+        const Move move = moves_[index_++];
+        if (move == tt_move_) {
+          continue;
+        }
+        return move;
+      }
+      stage_ = Stage::Killers;
+      [[fallthrough]];
+    case Stage::Killers:
+      while (killer_index_ < static_cast<int>(ctx_.killers.size())) {
+        const Move killer = ctx_.killers[static_cast<std::size_t>(killer_index_++)];
+        if (killer.is_null() || killer == tt_move_) {
+          continue;
+        }
+        const MoveFlag flag = move_flag(killer);
+        if (flag != MoveFlag::Quiet && flag != MoveFlag::DoublePush) {
+          continue;
+        }
+        if (!pos_.is_pseudo_legal(killer) || !pos_.is_legal(killer)) {
+          continue;
+        }
+        yielded_killers_[static_cast<std::size_t>(killer_count_++)] = killer;
+        return killer;
+      }
+      stage_ = Stage::QuietGen;
+      [[fallthrough]];
+    case Stage::QuietGen:
+      generate(GenStage::Quiets);
+      stage_ = Stage::Quiets;
+      [[fallthrough]];
+    case Stage::Quiets:
+      while (index_ < moves_.size()) {
+        select_best_move(moves_, scores_, index_, moves_.size());
+        const Move move = moves_[index_++];
+        if (move == tt_move_) {
+          continue;
+        }
+        bool seen = false;
+        for (int idx = 0; idx < killer_count_; ++idx) {
+          if (yielded_killers_[static_cast<std::size_t>(idx)] == move) {
+            seen = true;
+            break;
+          }
+        }
+        if (seen) {
+          continue;
+        }
+        return move;
+      }
+      stage_ = Stage::Done;
+      [[fallthrough]];
+    case Stage::RootGen:
+    case Stage::Root:
+    case Stage::Done:
+      break;
   }
+  return Move{};
+}
 
-  return gains[0];
+Move MovePicker::next_root() {
+  if (stage_ == Stage::TTMove) {
+    stage_ = Stage::RootGen;
+    if (ctx_.tt != nullptr) {
+      const Move tt_move = ctx_.tt->best_move;
+      if (!tt_move.is_null() && pos_.is_pseudo_legal(tt_move) &&
+          pos_.is_legal(tt_move)) {
+        tt_move_ = tt_move;
+        return tt_move;
+      }
+    }
+  }
+  if (stage_ == Stage::RootGen) {
+    // The root visits nearly every move each iteration, so staged lazy
+    // generation buys nothing there; one scored batch keeps the effort
+    // ordering global across captures and quiets.
+    generate(GenStage::All);
+    stage_ = Stage::Root;
+  }
+  while (index_ < moves_.size()) {
+    select_best_move(moves_, scores_, index_, moves_.size());
+    const Move move = moves_[index_++];
+    if (move == tt_move_) {
+      continue;
+    }
+    return move;
+  }
+  stage_ = Stage::Done;
+  return Move{};
 }
 
 }  // namespace bby
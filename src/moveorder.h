@@ -37,9 +37,14 @@ private:
   std::array<Entry, kSize> entries_{};
 };
 
+// All history tables use the same gravity update in add(): the effective
+// step shrinks as the entry approaches the +/-32'000 saturation bound, so
+// entries decay under contrary evidence instead of pinning at the rail.
+// Long analysis sessions keep a stable ordering signal as a result, and
+// int16_t storage is safe because the bound is enforced by construction.
 struct HistoryTable {
   static constexpr std::size_t kStride = 64 * 64;
-  std::array<int, 2 * kStride> values{};
+  std::array<std::int16_t, 2 * kStride> values{};
 
   [[nodiscard]] int get(Color color, Move move) const;
   void add(Color color, Move move, int delta);
@@ -48,20 +53,43 @@ private:
   [[nodiscard]] static std::size_t index(Color color, Move move);
 };
 
+struct CaptureHistory {
+  // Attacker piece (12 without None) × target square × victim type. Kings
+  // are never captured, so five victim slots (Pawn..Queen) suffice; the
+  // whole table is 7.5 KB and stays cache-resident.
+  static constexpr std::size_t kPieceCount = 12;
+  static constexpr std::size_t kVictimTypes = 5;
+  std::array<std::int16_t, kPieceCount * 64 * kVictimTypes> values{};
+
+  [[nodiscard]] int get(Piece attacker, Square to, PieceType victim) const;
+  void add(Piece attacker, Square to, PieceType victim, int delta);
+
+private:
+  [[nodiscard]] static std::size_t index(Piece attacker, Square to, PieceType victim);
+};
+
 struct CounterHistory {
-  static constexpr std::size_t kStride = HistoryTable::kStride;
-  std::array<std::array<int, kStride>, kStride> values{};
+  // (Previous piece, previous to-square) × (piece, to-square), matching
+  // ContinuationHistory's piece indexing. int16_t cells keep the whole
+  // table near 1 MB — small enough to stay cache-warm — versus the 64 MB
+  // a from×to × from×to layout would cost, with no measurable loss of
+  // ordering signal: the destination square plus the mover identifies a
+  // reply as well as the full move does.
+  static constexpr std::size_t kPieceCount = 12;
+  static constexpr std::size_t kSlots = kPieceCount * 64;
+  std::array<std::array<std::int16_t, kSlots>, kSlots> values{};
 
-  [[nodiscard]] int get(std::size_t previous_index, Move move) const;
-  void add(std::size_t previous_index, Move move, int delta);
+  [[nodiscard]] int get(std::size_t previous_index, Piece piece, Move move) const;
+  void add(std::size_t previous_index, Piece piece, Move move, int delta);
 
-  [[nodiscard]] static std::size_t index(Move move);
+  /// Slot for a (piece, destination) pair; `piece` must not be Piece::None.
+  [[nodiscard]] static std::size_t index(Piece piece, Move move);
 };
 
 struct ContinuationHistory {
   // Piece (12 without None) × destination square.
   static constexpr std::size_t kPieceCount = 12;
-  std::array<std::array<int, HistoryTable::kStride>, kPieceCount> values{};
+  std::array<std::array<std::int16_t, HistoryTable::kStride>, kPieceCount> values{};
 
   [[nodiscard]] int get(Piece piece, Move move) const;
   void add(Piece piece, Move move, int delta);
@@ -70,10 +98,42 @@ private:
   [[nodiscard]] static std::size_t index(Piece piece, Move move);
 };
 
+/**
+ * @brief Per-root-move subtree sizes from the previous search iteration.
+ *
+ * Subtree node counts are the strongest ordering signal the root has: the
+ * move that consumed the most effort last iteration is the one most likely
+ * to matter this iteration. record() overwrites an existing entry for the
+ * same move, so re-search attempts within one iteration stay idempotent.
+ */
+struct RootEffort {
+  void clear();
+  void record(Move move, std::int64_t nodes);
+  [[nodiscard]] std::int64_t get(Move move) const;
+  [[nodiscard]] bool empty() const { return count_ == 0; }
+
+private:
+  struct Entry {
+    Move move{};
+    std::int64_t nodes{0};
+  };
+  std::array<Entry, kMaxMoves> entries_{};
+  int count_{0};
+};
+
 struct OrderingContext {
   const Position* pos{nullptr};
   const TTEntry* tt{nullptr};
+  // Optional precomputed attack picture for this node. When null the
+  // picker computes one lazily on its first generation call; either way a
+  // single AttackInfo is shared across the capture and quiet stages
+  // instead of each redoing the pin/checker/danger computation.
+  const AttackInfo* attacks{nullptr};
+  // Non-null only at the root; switches MovePicker into its single-stage
+  // root mode ordered by previous-iteration effort.
+  const RootEffort* root_effort{nullptr};
   const HistoryTable* history{nullptr};
+  const CaptureHistory* capture_history{nullptr};
   const CounterHistory* counter_history{nullptr};
   const ContinuationHistory* continuation_history{nullptr};
   SeeCache* see_cache{nullptr};
@@ -87,10 +147,57 @@ struct OrderingContext {
 
 constexpr int kSeeUnknown = std::numeric_limits<int>::min();
 
+/**
+ * @brief Staged move picker: TT move, scored captures, killers, then quiets.
+ *
+ * Quiet moves are generated and scored only if the node survives the earlier
+ * stages, so nodes that cut off on the hash move or a capture never pay for
+ * quiet generation. The TT move and killers are validated with
+ * Position::is_pseudo_legal before being played blind.
+ */
+class MovePicker {
+public:
+  MovePicker(const Position& pos, const OrderingContext& ctx);
+
+  /// Next move in search order; a null move once exhausted.
+  Move next();
+
+private:
+  enum class Stage { TTMove, CaptureGen, Captures, Killers, QuietGen, Quiets, RootGen, Root, Done };
+
+  /// Root mode: every move in one stage, previous best (TT move) first,
+  /// the rest ordered by previous-iteration subtree size.
+  Move next_root();
+
+  /// Generates and scores one stage. The node's AttackInfo is taken from
+  /// the context when provided, otherwise computed on the first call and
+  /// cached, so repeated stage calls share one attack computation while
+  /// nodes that cut off before generating never pay for it.
+  void generate(GenStage stage);
+
+  const Position& pos_;
+  const OrderingContext& ctx_;
+  Stage stage_{Stage::TTMove};
+  MoveList moves_;
+  std::array<int, kMaxMoves> scores_{};
+  std::size_t index_{0};
+  Move tt_move_{};
+  std::array<Move, 2> yielded_killers_{};
+  int killer_count_{0};
+  int killer_index_{0};
+  AttackInfo attacks_{};
+  bool have_attacks_{false};
+};
+
 void score_moves(MoveList& ml, const OrderingContext& ctx, std::array<int, kMaxMoves>& scores,
                  std::array<int, kMaxMoves>* see_results = nullptr, bool force_see = false);
 void select_best_move(MoveList& ml, std::array<int, kMaxMoves>& scores, std::size_t start, std::size_t end);
 int see(const Position& pos, Move m);
+// True when the static exchange value of `m` is at least `threshold`. Runs
+// the swap algorithm with early termination as soon as the bound is decided,
+// so callers that only compare SEE against a margin never pay for resolving
+// a long exchange chain exactly.
+bool see_ge(const Position& pos, Move m, int threshold);
 int capture_margin(const Position& pos, Move m);
 int cached_see(const Position& pos, Move move, SeeCache* cache);
 
@@ -0,0 +1,261 @@
+#include "nnue.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#include "board.h"
+#include "debug.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace bby {
+namespace {
+
+constexpr std::array<char, 8> kNnueMagic = {'b', 'b', 'y', 'n', 'n', '0', '1', '\0'};
+// Clipped-ReLU ceiling and the fixed-point divisor taking the int32 output
+// sum back to centipawns.
+constexpr int kClipMax = 127;
+constexpr int kOutputScale = 64;
+constexpr Score kNnueScoreLimit = 20000;
+
+struct Network {
+  alignas(32) std::array<std::int16_t, kNnueHidden> input_bias{};
+  alignas(32) std::array<std::array<std::int16_t, kNnueHidden>, kNnueInputs>
+      input_weights{};
+  alignas(32) std::array<std::int16_t, 2 * kNnueHidden> output_weights{};
+  std::int32_t output_bias{0};
+};
+
+std::unique_ptr<Network> g_network;
+
+// Feature layout per perspective: (own-or-enemy * 6 + piece type) * 64 +
+// square, with the board flipped for the black perspective.
+inline int feature_index(int perspective, Piece pc, Square sq) {
+  const Color own = perspective == 0 ? Color::White : Color::Black;
+  const int side = color_of(pc) == own ? 0 : 1;
+  const int type = static_cast<int>(type_of(pc));
+  const int square = perspective == 0 ? static_cast<int>(sq)
+                                      : static_cast<int>(sq) ^ 56;
+  return (side * 6 + type) * 64 + square;
+}
+
+inline void add_row(std::array<std::int16_t, kNnueHidden>& acc,
+                    const std::array<std::int16_t, kNnueHidden>& row) {
+#if defined(__AVX2__)
+  auto* dst = reinterpret_cast<__m256i*>(acc.data());
+  const auto* src = reinterpret_cast<const __m256i*>(row.data());
+  for (int chunk = 0; chunk < kNnueHidden / 16; ++chunk) {
+    dst[chunk] = _mm256_add_epi16(dst[chunk], src[chunk]);
+  }
+#elif defined(__ARM_NEON)
+  for (int idx = 0; idx < kNnueHidden; idx += 8) {
+    vst1q_s16(&acc[idx],
+              vaddq_s16(vld1q_s16(&acc[idx]), vld1q_s16(&row[idx])));
+  }
+#else
+  for (int idx = 0; idx < kNnueHidden; ++idx) {
+    acc[idx] = static_cast<std::int16_t>(acc[idx] + row[idx]);
+  }
+#endif
+}
+
+inline void sub_row(std::array<std::int16_t, kNnueHidden>& acc,
+                    const std::array<std::int16_t, kNnueHidden>& row) {
+#if defined(__AVX2__)
+  auto* dst = reinterpret_cast<__m256i*>(acc.data());
+  const auto* src = reinterpret_cast<const __m256i*>(row.data());
+  for (int chunk = 0; chunk < kNnueHidden / 16; ++chunk) {
+    dst[chunk] = _mm256_sub_epi16(dst[chunk], src[chunk]);
+  }
+#elif defined(__ARM_NEON)
+  for (int idx = 0; idx < kNnueHidden; idx += 8) {
+    vst1q_s16(&acc[idx],
+              vsubq_s16(vld1q_s16(&acc[idx]), vld1q_s16(&row[idx])));
+  }
+#else
+  for (int idx = 0; idx < kNnueHidden; ++idx) {
+    acc[idx] = static_cast<std::int16_t>(acc[idx] - row[idx]);
+  }
+#endif
+}
+
+inline std::int32_t dot_clipped(
+    const std::array<std::int16_t, kNnueHidden>& acc,
+    const std::int16_t* weights) {
+#if defined(__AVX2__)
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i ceiling = _mm256_set1_epi16(kClipMax);
+  __m256i sum = _mm256_setzero_si256();
+  const auto* values = reinterpret_cast<const __m256i*>(acc.data());
+  const auto* rows = reinterpret_cast<const __m256i*>(weights);
+  for (int chunk = 0; chunk < kNnueHidden / 16; ++chunk) {
+    const __m256i clipped =
+        _mm256_min_epi16(_mm256_max_epi16(values[chunk], zero), ceiling);
+    sum = _mm256_add_epi32(sum,
+                           _mm256_madd_epi16(clipped,
+                                             _mm256_loadu_si256(&rows[chunk])));
+  }
+  alignas(32) std::array<std::int32_t, 8> lanes{};
+  _mm256_store_si256(reinterpret_cast<__m256i*>(lanes.data()), sum);
+  std::int32_t total = 0;
+  for (const std::int32_t lane : lanes) {
+    total += lane;
+  }
+  return total;
+#else
+  std::int32_t total = 0;
+  for (int idx = 0; idx < kNnueHidden; ++idx) {
+    const int clipped = std::clamp<int>(acc[idx], 0, kClipMax);
+    total += clipped * weights[idx];
+  }
+  return total;
+#endif
+}
+
+template <typename T>
+T read_le(const unsigned char*& cursor) {
+  T value;
+  std::memcpy(&value, cursor, sizeof(T));
+  cursor += sizeof(T);
+  return value;
+}
+
+bool parse_network(const unsigned char* data, std::size_t size) {
+  constexpr std::size_t kExpected =
+      sizeof(kNnueMagic) + sizeof(std::uint32_t) +
+      sizeof(std::int16_t) * kNnueHidden +
+      sizeof(std::int16_t) * kNnueInputs * kNnueHidden +
+      sizeof(std::int16_t) * 2 * kNnueHidden + sizeof(std::int32_t);
+  if (data == nullptr || size != kExpected) {
+    return false;
+  }
+  if (std::memcmp(data, kNnueMagic.data(), kNnueMagic.size()) != 0) {
+    return false;
+  }
+  const unsigned char* cursor = data + kNnueMagic.size();
+  if (read_le<std::uint32_t>(cursor) != static_cast<std::uint32_t>(kNnueHidden)) {
+    return false;
+  }
+
+  auto network = std::make_unique<Network>();
+  std::memcpy(network->input_bias.data(), cursor,
+              sizeof(std::int16_t) * kNnueHidden);
+  cursor += sizeof(std::int16_t) * kNnueHidden;
+  std::memcpy(network->input_weights.data(), cursor,
+              sizeof(std::int16_t) * kNnueInputs * kNnueHidden);
+  cursor += sizeof(std::int16_t) * kNnueInputs * kNnueHidden;
+  std::memcpy(network->output_weights.data(), cursor,
+              sizeof(std::int16_t) * 2 * kNnueHidden);
+  cursor += sizeof(std::int16_t) * 2 * kNnueHidden;
+  network->output_bias = read_le<std::int32_t>(cursor);
+
+  g_network = std::move(network);
+  ++g_nnue_generation;
+  return true;
+}
+
+}  // namespace
+
+int g_nnue_generation = 0;
+
+bool nnue_available() {
+  return g_network != nullptr;
+}
+
+bool nnue_load(const std::string& path) {
+  std::ifstream in(path, std::ios::binary | std::ios::ate);
+  if (!in) {
+    return false;
+  }
+  const std::streamoff size = in.tellg();
+  if (size <= 0) {
+    return false;
+  }
+  std::vector<unsigned char> bytes(static_cast<std::size_t>(size));
+  in.seekg(0);
+  if (!in.read(reinterpret_cast<char*>(bytes.data()), size)) {
+    return false;
+  }
+  return parse_network(bytes.data(), bytes.size());
+}
+
+#if defined(BBY_EMBED_EVAL)
+extern "C" const unsigned char g_bby_embedded_eval[];
+extern "C" const unsigned int g_bby_embedded_eval_size;
+#endif
+
+bool nnue_load_embedded() {
+#if defined(BBY_EMBED_EVAL)
+  return parse_network(g_bby_embedded_eval, g_bby_embedded_eval_size);
+#else
+  return false;
+#endif
+}
+
+void nnue_unload() {
+  g_network.reset();
+  // Invalidate outstanding accumulators so stale ones stop applying
+  // incremental updates against a network that is gone.
+  ++g_nnue_generation;
+}
+
+void nnue_add_piece(NnueAccumulator& acc, Piece pc, Square sq) {
+  const Network& net = *g_network;
+  add_row(acc.values[0], net.input_weights[feature_index(0, pc, sq)]);
+  add_row(acc.values[1], net.input_weights[feature_index(1, pc, sq)]);
+}
+
+void nnue_remove_piece(NnueAccumulator& acc, Piece pc, Square sq) {
+  const Network& net = *g_network;
+  sub_row(acc.values[0], net.input_weights[feature_index(0, pc, sq)]);
+  sub_row(acc.values[1], net.input_weights[feature_index(1, pc, sq)]);
+}
+
+void nnue_move_piece(NnueAccumulator& acc, Piece pc, Square from, Square to) {
+  const Network& net = *g_network;
+  for (int perspective = 0; perspective < 2; ++perspective) {
+    sub_row(acc.values[perspective],
+            net.input_weights[feature_index(perspective, pc, from)]);
+    add_row(acc.values[perspective],
+            net.input_weights[feature_index(perspective, pc, to)]);
+  }
+}
+
+void nnue_refresh(const Position& pos, NnueAccumulator& acc) {
+  BBY_ASSERT(nnue_available());
+  const Network& net = *g_network;
+  acc.values[0] = net.input_bias;
+  acc.values[1] = net.input_bias;
+  for (int sq = 0; sq < 64; ++sq) {
+    const Piece pc = pos.piece_on(static_cast<Square>(sq));
+    if (pc != Piece::None) {
+      nnue_add_piece(acc, pc, static_cast<Square>(sq));
+    }
+  }
+  acc.generation = g_nnue_generation;
+}
+
+Score nnue_evaluate(const Position& pos) {
+  BBY_ASSERT(nnue_available());
+  NnueAccumulator& acc = pos.nnue_accumulator();
+  if (acc.generation != g_nnue_generation) {
+    nnue_refresh(pos, acc);
+  }
+  const Network& net = *g_network;
+  const int stm = color_index(pos.side_to_move());
+  std::int32_t sum = net.output_bias;
+  sum += dot_clipped(acc.values[stm], net.output_weights.data());
+  sum += dot_clipped(acc.values[stm ^ 1], net.output_weights.data() + kNnueHidden);
+  const std::int32_t scaled = sum / kOutputScale;
+  return static_cast<Score>(
+      std::clamp<std::int32_t>(scaled, -kNnueScoreLimit, kNnueScoreLimit));
+}
+
+}  // namespace bby
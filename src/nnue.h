@@ -0,0 +1,60 @@
+#pragma once
+// nnue.h -- NNUE-style network evaluation with an incrementally updated
+// accumulator. The network maps 768 piece-square inputs per perspective
+// through one hidden layer; Position keeps the hidden-layer sums fresh in
+// make/unmake so a leaf evaluation is just the clipped-ReLU output pass.
+// Weights come from the blob embedded at build time via the BBY_EVAL_FILE
+// cache variable or from a file set through the EvalFile UCI option; with
+// neither present evaluate() keeps using the PeSTO path.
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include "common.h"
+
+namespace bby {
+
+class Position;
+
+constexpr int kNnueInputs = 768;
+constexpr int kNnueHidden = 128;
+
+// Hidden-layer sums for both perspectives (index 0 = white). Tagged with the
+// network generation it was built against: a stale tag means the accumulator
+// predates the current network and must be refreshed before use, and
+// incremental updates are skipped until then.
+struct NnueAccumulator {
+  alignas(32) std::array<std::array<std::int16_t, kNnueHidden>, 2> values{};
+  int generation{-1};
+};
+
+// Bumped on every successful network (re)load. Loads only happen while the
+// search is idle, so plain reads from the make/unmake hot path are safe.
+extern int g_nnue_generation;
+
+[[nodiscard]] bool nnue_available();
+
+// Loads weights from a "bbynn01" dump: magic, uint32 hidden size, then
+// little-endian int16 input bias, feature-major int16 input weights, int16
+// output weights (side-to-move half first) and an int32 output bias.
+// Returns false on I/O failure or geometry mismatch.
+bool nnue_load(const std::string& path);
+// Adopts the blob compiled in through BBY_EVAL_FILE; false when none was
+// embedded.
+bool nnue_load_embedded();
+// Drops the loaded network and falls back to the hand-crafted evaluation.
+void nnue_unload();
+
+void nnue_add_piece(NnueAccumulator& acc, Piece pc, Square sq);
+void nnue_remove_piece(NnueAccumulator& acc, Piece pc, Square sq);
+void nnue_move_piece(NnueAccumulator& acc, Piece pc, Square from, Square to);
+// Rebuilds the accumulator from the full piece placement and tags it with
+// the current generation.
+void nnue_refresh(const Position& pos, NnueAccumulator& acc);
+
+// Output pass from the side-to-move perspective; refreshes the accumulator
+// first if it is stale. Requires nnue_available().
+[[nodiscard]] Score nnue_evaluate(const Position& pos);
+
+}  // namespace bby
@@ -1,32 +1,148 @@
 #include "perft.h"
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <thread>
+#include <vector>
+
+#include "threadpool.h"
+
 namespace bby {
 
 namespace {
 
-std::uint64_t perft_inner(Position& pos, int depth) {
+// Node counts live in the low 56 bits of the packed slot data, the depth in
+// the top byte. Depth-7 counts stay far below 2^56.
+constexpr int kDepthShift = 56;
+constexpr std::uint64_t kNodesMask = (1ULL << kDepthShift) - 1ULL;
+
+std::uint64_t pack_slot(int depth, std::uint64_t nodes) {
+  return (static_cast<std::uint64_t>(depth) << kDepthShift) |
+         (nodes & kNodesMask);
+}
+
+std::uint64_t perft_inner(Position& pos, int depth, PerftCache* cache) {
   if (depth == 0) {
     return 1ULL;
   }
 
+  std::uint64_t nodes = 0;
+  if (depth >= 2 && cache != nullptr &&
+      cache->probe(pos.zobrist(), depth, nodes)) {
+    return nodes;
+  }
+
   MoveList moves;
   pos.generate_moves(moves, GenStage::All);
-  std::uint64_t nodes = 0;
+  if (depth == 1) {
+    // Generation is legal by construction, so the leaves need no recursion.
+    return moves.size();
+  }
 
   for (const Move move : moves) {
     Undo undo;
     pos.make(move, undo);
-    nodes += perft_inner(pos, depth - 1);
+    nodes += perft_inner(pos, depth - 1, cache);
     pos.unmake(move, undo);
   }
 
+  if (cache != nullptr) {
+    cache->store(pos.zobrist(), depth, nodes);
+  }
   return nodes;
 }
 
+struct PerftTask {
+  Position pos;
+  int depth;
+};
+
+// Expands the position one ply into per-move tasks.
+void expand_tasks(const Position& pos, int depth, std::vector<PerftTask>& out) {
+  MoveList moves;
+  pos.generate_moves(moves, GenStage::All);
+  for (const Move move : moves) {
+    Position child = pos;
+    Undo undo;
+    child.make(move, undo);
+    out.push_back(PerftTask{child, depth - 1});
+  }
+}
+
 }  // namespace
 
-std::uint64_t perft(Position& pos, int depth) {
-  return perft_inner(pos, depth);
+PerftCache::PerftCache(std::size_t megabytes) {
+  std::size_t slots = (std::max<std::size_t>(megabytes, 1) << 20) / sizeof(Slot);
+  slots = std::bit_floor(slots);
+  slots_ = std::make_unique<Slot[]>(slots);
+  mask_ = slots - 1;
+}
+
+bool PerftCache::probe(std::uint64_t key, int depth, std::uint64_t& nodes) const {
+  const Slot& slot = slots_[key & mask_];
+  const std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+  const std::uint64_t check = slot.check.load(std::memory_order_relaxed);
+  if ((check ^ data) != key) {
+    return false;
+  }
+  if (static_cast<int>(data >> kDepthShift) != depth) {
+    return false;
+  }
+  nodes = data & kNodesMask;
+  return true;
+}
+
+void PerftCache::store(std::uint64_t key, int depth, std::uint64_t nodes) {
+  Slot& slot = slots_[key & mask_];
+  const std::uint64_t data = pack_slot(depth, nodes);
+  slot.data.store(data, std::memory_order_relaxed);
+  slot.check.store(key ^ data, std::memory_order_relaxed);
+}
+
+std::uint64_t perft(Position& pos, int depth, PerftCache* cache) {
+  return perft_inner(pos, depth, cache);
+}
+
+std::uint64_t perft_parallel(const Position& pos, int depth, int threads,
+                             PerftCache* cache) {
+  if (threads <= 1 || depth <= 2) {
+    Position root = pos;
+    return perft_inner(root, depth, cache);
+  }
+
+  // Split at the root and again at the first ply so the task count dwarfs
+  // the worker count; idle workers then drain the queue instead of waiting
+  // on one oversized subtree.
+  std::vector<PerftTask> first_ply;
+  expand_tasks(pos, depth, first_ply);
+  std::vector<PerftTask> tasks;
+  for (const PerftTask& task : first_ply) {
+    if (task.depth >= 2) {
+      expand_tasks(task.pos, task.depth, tasks);
+    } else {
+      tasks.push_back(task);
+    }
+  }
+
+  std::atomic<std::size_t> next{0};
+  std::atomic<std::uint64_t> total{0};
+  auto worker = [&]() {
+    std::uint64_t local = 0;
+    for (;;) {
+      const std::size_t idx = next.fetch_add(1, std::memory_order_relaxed);
+      if (idx >= tasks.size()) {
+        break;
+      }
+      local += perft_inner(tasks[idx].pos, tasks[idx].depth, cache);
+    }
+    total.fetch_add(local, std::memory_order_relaxed);
+  };
+
+  const int worker_count = std::min<int>(threads, static_cast<int>(tasks.size()));
+  worker_pool().run(static_cast<std::size_t>(worker_count),
+                    [&](std::size_t) { worker(); });
+  return total.load(std::memory_order_relaxed);
 }
 
 }  // namespace bby
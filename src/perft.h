@@ -1,12 +1,46 @@
 #pragma once
 // perft.h -- Recursive move enumeration helpers for validation and benchmarking.
 
+#include <atomic>
 #include <cstdint>
+#include <memory>
 
 #include "board.h"
 
 namespace bby {
 
-std::uint64_t perft(Position& pos, int depth);
+/**
+ * @brief Lock-free (zobrist, depth) -> node count cache for perft.
+ *
+ * Slots are 16 bytes and XOR-validated like the search TT, so concurrent
+ * workers can share one cache without locking: a torn write fails the
+ * checksum and reads as a miss. Collisions simply overwrite.
+ */
+class PerftCache {
+public:
+  explicit PerftCache(std::size_t megabytes);
+
+  bool probe(std::uint64_t key, int depth, std::uint64_t& nodes) const;
+  void store(std::uint64_t key, int depth, std::uint64_t nodes);
+
+private:
+  struct Slot {
+    std::atomic<std::uint64_t> check{0};
+    std::atomic<std::uint64_t> data{0};
+  };
+  static_assert(sizeof(Slot) == 16, "PerftCache slot must stay 16 bytes");
+
+  std::unique_ptr<Slot[]> slots_;
+  std::uint64_t mask_{0};
+};
+
+std::uint64_t perft(Position& pos, int depth, PerftCache* cache = nullptr);
+
+// Splits the tree at the root and first ply into tasks drained from a shared
+// queue by `threads` workers, each on its own Position copy. Falls back to
+// the serial recursion for a single thread or trivial depths. The cache, if
+// provided, is shared across workers.
+std::uint64_t perft_parallel(const Position& pos, int depth, int threads,
+                             PerftCache* cache = nullptr);
 
 }  // namespace bby
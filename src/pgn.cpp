@@ -1,8 +1,14 @@
 #include "pgn.h"
 
+#include "threadpool.h"
+
+#include <algorithm>
 #include <cctype>
+#include <istream>
+#include <ostream>
 #include <sstream>
 #include <string_view>
+#include <thread>
 #include <utility>
 
 namespace bby {
@@ -311,4 +317,409 @@ bool PgnReader::read_next(PgnGame& out_game, std::string& error) {
   return true;
 }
 
+namespace {
+
+// View-based counterpart of sanitize_token: every adjustment is a prefix
+// strip, so the result stays a window into the chunk arena.
+std::string_view sanitize_token_view(std::string_view token) {
+  std::size_t idx = 0;
+  while (idx < token.size() &&
+         (std::isdigit(static_cast<unsigned char>(token[idx])) ||
+          token[idx] == '.' || token[idx] == '!')) {
+    ++idx;
+  }
+  token.remove_prefix(idx);
+  while (!token.empty() && token.front() == '.') {
+    token.remove_prefix(1);
+  }
+  while (!token.empty() && token.front() == '+') {
+    token.remove_prefix(1);
+  }
+  if (!token.empty() && token.front() == '$') {
+    return {};
+  }
+  return token;
+}
+
+bool parse_tag_view(std::string_view line, PgnTagView& out_tag) {
+  line = trim_view(line);
+  if (line.size() < 4 || line.front() != '[' || line.back() != ']') {
+    return false;
+  }
+  line.remove_prefix(1);
+  line.remove_suffix(1);
+  const auto first_space = line.find_first_of(" \t");
+  if (first_space == std::string_view::npos) {
+    return false;
+  }
+  out_tag.name = trim_view(line.substr(0, first_space));
+  const auto quote_begin = line.find('"', first_space);
+  if (quote_begin == std::string_view::npos) {
+    return false;
+  }
+  const auto quote_end = line.find('"', quote_begin + 1);
+  if (quote_end == std::string_view::npos) {
+    return false;
+  }
+  out_tag.value = line.substr(quote_begin + 1, quote_end - (quote_begin + 1));
+  return true;
+}
+
+void parse_moves_view(std::string_view block, PgnGameView& game) {
+  constexpr std::size_t kNone = std::string_view::npos;
+  std::size_t token_begin = kNone;
+  std::size_t comment_begin = 0;
+  std::string_view staged_comment;
+  bool in_comment = false;
+  bool line_comment = false;
+  int variation_depth = 0;
+
+  auto flush_token_at = [&](std::size_t end) {
+    if (token_begin == kNone) {
+      return;
+    }
+    const std::string_view token = trim_view(block.substr(token_begin, end - token_begin));
+    token_begin = kNone;
+    if (token.empty()) {
+      return;
+    }
+    if (is_result_token(token)) {
+      game.result = token;
+      return;
+    }
+    const std::string_view san = sanitize_token_view(token);
+    if (san.empty()) {
+      return;
+    }
+    PgnMoveView move;
+    move.san = san;
+    if (!staged_comment.empty()) {
+      move.comment = staged_comment;
+      staged_comment = {};
+    }
+    game.moves.push_back(move);
+  };
+
+  auto attach_comment = [&](std::string_view comment) {
+    comment = trim_view(comment);
+    if (comment.empty()) {
+      return;
+    }
+    if (!game.moves.empty()) {
+      if (game.moves.back().comment.empty()) {
+        game.moves.back().comment = comment;
+      }
+    } else if (staged_comment.empty()) {
+      staged_comment = comment;
+    }
+  };
+
+  for (std::size_t idx = 0; idx < block.size(); ++idx) {
+    const char ch = block[idx];
+    if (line_comment) {
+      if (ch == '\n') {
+        line_comment = false;
+      }
+      continue;
+    }
+    if (in_comment) {
+      if (ch == '}') {
+        in_comment = false;
+        attach_comment(block.substr(comment_begin, idx - comment_begin));
+      }
+      continue;
+    }
+
+    if (ch == '{') {
+      flush_token_at(idx);
+      in_comment = true;
+      comment_begin = idx + 1;
+      continue;
+    }
+    if (ch == ';') {
+      flush_token_at(idx);
+      line_comment = true;
+      continue;
+    }
+    if (ch == '(') {
+      flush_token_at(idx);
+      ++variation_depth;
+      continue;
+    }
+    if (ch == ')') {
+      if (variation_depth > 0) {
+        --variation_depth;
+      }
+      continue;
+    }
+    if (variation_depth > 0) {
+      continue;
+    }
+
+    if (is_whitespace(ch)) {
+      flush_token_at(idx);
+      continue;
+    }
+
+    if (token_begin == kNone) {
+      token_begin = idx;
+    }
+  }
+
+  flush_token_at(block.size());
+}
+
+// Parses every game in the chunk's arena; runs concurrently on the pool, so
+// it may only touch the chunk it was handed.
+void parse_chunk(PgnChunk& chunk) {
+  const std::string_view text = chunk.text;
+  std::size_t cursor = 0;
+
+  auto take_line = [&](std::size_t at, std::size_t& next) {
+    const std::size_t end = text.find('\n', at);
+    next = (end == std::string_view::npos) ? text.size() : end + 1;
+    std::string_view line = text.substr(at, ((end == std::string_view::npos) ? text.size() : end) - at);
+    if (!line.empty() && line.back() == '\r') {
+      line.remove_suffix(1);
+    }
+    return line;
+  };
+
+  while (cursor < text.size()) {
+    std::size_t next = 0;
+    std::string_view line = take_line(cursor, next);
+    if (trim_view(line).empty()) {
+      cursor = next;
+      continue;
+    }
+
+    PgnGameView game;
+    bool tag_error = false;
+    while (!trim_view(line).empty() && trim_view(line).front() == '[') {
+      PgnTagView tag;
+      if (!parse_tag_view(line, tag)) {
+        chunk.errors.emplace_back("invalid PGN tag line");
+        tag_error = true;
+        break;
+      }
+      game.tags.push_back(tag);
+      cursor = next;
+      if (cursor >= text.size()) {
+        line = {};
+        break;
+      }
+      line = take_line(cursor, next);
+    }
+    if (tag_error) {
+      // Resynchronize at the next blank line so one bad header does not
+      // swallow the rest of the chunk.
+      while (cursor < text.size()) {
+        line = take_line(cursor, next);
+        cursor = next;
+        if (trim_view(line).empty()) {
+          break;
+        }
+      }
+      continue;
+    }
+    // Keep the first value for duplicate tag names, matching map::emplace in
+    // the streaming reader.
+    std::stable_sort(game.tags.begin(), game.tags.end(),
+                     [](const PgnTagView& a, const PgnTagView& b) { return a.name < b.name; });
+
+    std::size_t moves_begin = 0;
+    std::size_t moves_end = 0;
+    bool saw_moves = false;
+    while (cursor < text.size()) {
+      line = take_line(cursor, next);
+      const std::string_view trimmed = trim_view(line);
+      if (trimmed.empty()) {
+        cursor = next;
+        if (saw_moves) {
+          break;
+        }
+        continue;
+      }
+      if (trimmed.front() == '[') {
+        break;
+      }
+      if (!saw_moves) {
+        moves_begin = cursor;
+      }
+      moves_end = next;
+      saw_moves = true;
+      cursor = next;
+    }
+
+    if (!saw_moves) {
+      chunk.errors.emplace_back("no moves section found in PGN game");
+      continue;
+    }
+
+    parse_moves_view(text.substr(moves_begin, moves_end - moves_begin), game);
+    if (game.result.empty()) {
+      game.result = "*";
+    }
+    if (game.moves.empty() && game.result == "*") {
+      chunk.errors.emplace_back("PGN game contains neither moves nor result");
+      continue;
+    }
+    chunk.games.push_back(std::move(game));
+  }
+}
+
+// Offset of the last '[' that opens a tag section (a line start preceded by a
+// blank line), or npos. Splitting only at such offsets keeps games whole.
+std::size_t find_last_game_boundary(std::string_view text) {
+  const std::size_t plain = text.rfind("\n\n[");
+  const std::size_t crlf = text.rfind("\n\r\n[");
+  if (plain == std::string_view::npos && crlf == std::string_view::npos) {
+    return std::string_view::npos;
+  }
+  const std::size_t plain_at = (plain == std::string_view::npos) ? 0 : plain + 2;
+  const std::size_t crlf_at = (crlf == std::string_view::npos) ? 0 : crlf + 3;
+  return std::max(plain_at, crlf_at);
+}
+
+// Accumulates stream data until at least `chunk_bytes` are buffered, then cuts
+// at the last game boundary; the tail carries over into the next chunk. Only
+// at end of input is the remainder emitted unsplit.
+bool next_chunk_text(std::istream& input, std::string& carry, std::size_t chunk_bytes,
+                     std::string& out_text) {
+  constexpr std::size_t kReadBlock = 1u << 20;
+  while (true) {
+    const bool exhausted = !input.good();
+    if (carry.size() >= chunk_bytes || exhausted) {
+      const std::size_t boundary = find_last_game_boundary(carry);
+      if (boundary != std::string_view::npos && boundary > 0) {
+        out_text = carry.substr(0, boundary);
+        carry.erase(0, boundary);
+        return true;
+      }
+      if (exhausted) {
+        if (carry.empty()) {
+          return false;
+        }
+        out_text = std::move(carry);
+        carry.clear();
+        return true;
+      }
+      // No boundary buffered yet: keep reading so the game stays whole.
+    }
+    const std::size_t old_size = carry.size();
+    carry.resize(old_size + kReadBlock);
+    input.read(carry.data() + old_size, static_cast<std::streamsize>(kReadBlock));
+    carry.resize(old_size + static_cast<std::size_t>(input.gcount()));
+  }
+}
+
+}  // namespace
+
+std::optional<std::string_view> PgnGameView::tag(std::string_view name) const {
+  const auto it = std::lower_bound(
+      tags.begin(), tags.end(), name,
+      [](const PgnTagView& entry, std::string_view key) { return entry.name < key; });
+  if (it == tags.end() || it->name != name) {
+    return std::nullopt;
+  }
+  return it->value;
+}
+
+std::size_t ingest_pgn_stream(std::istream& input, const PgnChunkSink& sink,
+                              std::size_t chunk_bytes) {
+  const std::size_t lanes =
+      std::max<std::size_t>(1, std::thread::hardware_concurrency());
+  ThreadPool& pool = worker_pool();
+
+  std::string carry;
+  auto fill = [&](std::vector<PgnChunk>& batch) {
+    batch.clear();
+    while (batch.size() < lanes) {
+      std::string chunk_text;
+      if (!next_chunk_text(input, carry, chunk_bytes, chunk_text)) {
+        break;
+      }
+      PgnChunk chunk;
+      chunk.text = std::move(chunk_text);
+      batch.push_back(std::move(chunk));
+    }
+  };
+
+  std::size_t total_games = 0;
+  std::vector<PgnChunk> current;
+  fill(current);
+  while (!current.empty()) {
+    // Helpers parse the tail of the batch while this thread parses the head
+    // and then reads ahead, so decoding overlaps the next round of I/O.
+    const std::size_t helpers = current.size() - 1;
+    if (helpers > 0) {
+      pool.launch(helpers, [&](std::size_t idx) { parse_chunk(current[idx + 1]); });
+    }
+    parse_chunk(current[0]);
+    std::vector<PgnChunk> next_batch;
+    fill(next_batch);
+    if (helpers > 0) {
+      pool.wait();
+    }
+    for (PgnChunk& chunk : current) {
+      total_games += chunk.games.size();
+      sink(std::move(chunk));
+    }
+    current = std::move(next_batch);
+  }
+  return total_games;
+}
+
+void write_pgn_game(std::ostream& out,
+                    const std::vector<std::pair<std::string, std::string>>& tags,
+                    const std::vector<std::string>& moves,
+                    std::string_view result,
+                    int first_fullmove, bool black_to_move) {
+  for (const auto& [name, value] : tags) {
+    out << '[' << name << " \"";
+    for (const char c : value) {
+      if (c == '"' || c == '\\') {
+        out << '\\';
+      }
+      out << c;
+    }
+    out << "\"]\n";
+  }
+  out << '\n';
+
+  std::string line;
+  auto emit_token = [&](const std::string& token) {
+    // Export format wraps the movetext at 80 columns.
+    if (!line.empty() && line.size() + 1 + token.size() > 79) {
+      out << line << '\n';
+      line.clear();
+    }
+    if (!line.empty()) {
+      line += ' ';
+    }
+    line += token;
+  };
+
+  int fullmove = first_fullmove;
+  bool black = black_to_move;
+  for (std::size_t idx = 0; idx < moves.size(); ++idx) {
+    if (!black) {
+      emit_token(std::to_string(fullmove) + ". " + moves[idx]);
+    } else if (idx == 0) {
+      emit_token(std::to_string(fullmove) + "... " + moves[idx]);
+    } else {
+      emit_token(moves[idx]);
+    }
+    if (black) {
+      ++fullmove;
+    }
+    black = !black;
+  }
+  emit_token(std::string(result));
+  if (!line.empty()) {
+    out << line << '\n';
+  }
+  out << '\n';
+}
+
 }  // namespace bby
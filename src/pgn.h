@@ -9,9 +9,14 @@
  * glyphs; complexity is linear in the input size with a single pass over the data.
  */
 
+#include <cstddef>
+#include <functional>
 #include <iosfwd>
 #include <map>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 namespace bby {
@@ -42,4 +47,66 @@ private:
   bool have_pending_{false};
 };
 
+/**
+ * Zero-copy game representation for bulk ingestion. Every view references the
+ * `text` arena of the owning `PgnChunk`; tags are kept in a flat vector sorted
+ * by name for binary-search lookup instead of a node-based map, and each SAN
+ * token is a view instead of its own allocation. At most one brace comment is
+ * attached per move; the streaming `PgnReader` remains the reference for
+ * comment concatenation.
+ */
+struct PgnTagView {
+  std::string_view name;
+  std::string_view value;
+};
+
+struct PgnMoveView {
+  std::string_view san;
+  std::string_view comment;
+};
+
+struct PgnGameView {
+  std::vector<PgnTagView> tags;
+  std::vector<PgnMoveView> moves;
+  std::string_view result{"*"};
+
+  /** Binary-search tag lookup; empty optional when the tag is absent. */
+  [[nodiscard]] std::optional<std::string_view> tag(std::string_view name) const;
+};
+
+/** A run of whole games; `text` is the arena every view in `games` points into. */
+struct PgnChunk {
+  std::string text;
+  std::vector<PgnGameView> games;
+  std::vector<std::string> errors;
+};
+
+/** Receives parsed chunks strictly in input order; the sink owns each chunk. */
+using PgnChunkSink = std::function<void(PgnChunk&&)>;
+
+/**
+ * Parallel PGN ingestion: the calling thread scans the stream and splits it at
+ * game boundaries while `worker_pool()` threads parse whole chunks into
+ * `PgnGameView` records concurrently; completed chunks are handed to `sink` in
+ * input order. Per-game syntax problems are aggregated into `PgnChunk::errors`
+ * and do not stop the pipeline. Returns the total number of parsed games.
+ * `chunk_bytes` tunes work granularity; chunks grow past it as needed so a
+ * game is never split.
+ */
+std::size_t ingest_pgn_stream(std::istream& input, const PgnChunkSink& sink,
+                              std::size_t chunk_bytes = 4u << 20);
+
+/**
+ * Writer counterpart of `PgnReader`: emits one game in export format. Tags
+ * are written in the order given (the Seven Tag Roster should come first),
+ * the movetext is wrapped at 80 columns and numbered from the starting
+ * position's move counter, and `result` terminates the game. `moves` are
+ * SAN tokens as produced by `move_to_san`.
+ */
+void write_pgn_game(std::ostream& out,
+                    const std::vector<std::pair<std::string, std::string>>& tags,
+                    const std::vector<std::string>& moves,
+                    std::string_view result,
+                    int first_fullmove = 1, bool black_to_move = false);
+
 }  // namespace bby
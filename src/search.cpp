@@ -5,19 +5,57 @@
 #include <atomic>
 #include <bit>
 #include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <cmath>
 #include <iomanip>
 #include <memory>
+#include <cstring>
+#include <mutex>
+#include <new>
 #include <numeric>
+#include <optional>
 #include <sstream>
+#include <thread>
 #include <vector>
 
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
 #include "debug.h"
+#include "matesearch.h"
 #include "qsearch_probe.h"
 #include "search_stack.h"
+#include "syzygy/tbprobe.h"
+#include "threadpool.h"
 
 namespace bby {
+
+std::size_t SearchStats::tt_depth_band(int depth) {
+  const int clamped = std::clamp(depth, 0, kTTDepthBands * 4 - 1);
+  return static_cast<std::size_t>(clamped / 4);
+}
+
+void SearchStats::add(const SearchStats& other) {
+  interior_nodes += other.interior_nodes;
+  qsearch_nodes += other.qsearch_nodes;
+  for (std::size_t band = 0; band < tt_probes.size(); ++band) {
+    tt_probes[band] += other.tt_probes[band];
+    tt_hits[band] += other.tt_hits[band];
+    tt_cutoffs[band] += other.tt_cutoffs[band];
+  }
+  beta_cutoffs += other.beta_cutoffs;
+  cutoff_first_move += other.cutoff_first_move;
+  cutoff_moves_2_to_4 += other.cutoff_moves_2_to_4;
+  cutoff_late_moves += other.cutoff_late_moves;
+  null_prunes += other.null_prunes;
+  static_futility_prunes += other.static_futility_prunes;
+  razor_prunes += other.razor_prunes;
+  multi_cut_prunes += other.multi_cut_prunes;
+  lmr_reductions += other.lmr_reductions;
+}
+
 namespace {
 
 constexpr std::size_t kDefaultTTMegabytes = 16;
@@ -29,6 +67,15 @@ constexpr int kQuietHistoryBonus = 128;
 constexpr Score kAspirationBase = 64;
 constexpr Score kAspirationScale = 16;
 constexpr Score kStaticFutilitySlack = 128;
+// Tablebase scores sit above any eval but below real mate scores, so a found
+// mate still outranks a tablebase win. Win/loss verdicts ignore the 50-move
+// counter; kTbRule50Guard keeps enough clock headroom to convert a 3-man win
+// (at most ~30 moves) before trusting one.
+constexpr Score kTbWinScore = 28000;
+constexpr int kTbRule50Guard = 40;
+// Probing every leaf-adjacent node would dominate runtime in pawn endgames;
+// at depth 2+ a verdict still cuts off a meaningful subtree.
+constexpr int kTbProbeMinDepth = 2;
 constexpr Score kRazoringSlack = 512;
 constexpr int kMaxLmrDepth = 64;
 constexpr int kMaxLmrMoves = 64;
@@ -118,25 +165,66 @@ struct PvTable {
     length[ply] = child_length + 1;
   }
 
-  void extract(int ply, std::vector<Move>& out) const {
+  void extract(int ply, PV& out) const {
+    out.clear();
     if (ply < 0 || ply >= kMaxPly) {
-      out.clear();
       return;
     }
     const int count = std::clamp(length[ply], 0, kMaxPly - ply);
-    out.assign(moves[ply].begin() + ply, moves[ply].begin() + ply + count);
+    for (int idx = 0; idx < count; ++idx) {
+      out.push_back(moves[ply][ply + idx]);
+    }
+  }
+};
+
+// Running average of (searched score - static eval) per pawn structure and
+// side. Systematic eval bias tracks the pawn skeleton more than anything
+// else cheap to key on, so nudging the static eval by this average before
+// the pruning gates and the improving trend damps the fail-high/fail-low
+// cascades such bias causes. Values are stored in kGrain-ths of a pawn
+// centipoint so small per-node deltas accumulate instead of rounding away.
+struct CorrectionHistory {
+  static constexpr std::size_t kSize = 16384;
+  static constexpr int kGrain = 256;
+  static constexpr int kLimit = 32 * kGrain;
+  std::array<std::array<std::int16_t, kSize>, 2> values{};
+
+  [[nodiscard]] Score correction(Color side, std::uint64_t pawn_key) const {
+    const auto& table = values[static_cast<std::size_t>(color_index(side))];
+    return static_cast<Score>(table[pawn_key & (kSize - 1)] / kGrain);
+  }
+
+  void update(Color side, std::uint64_t pawn_key, int depth, Score diff) {
+    auto& entry =
+        values[static_cast<std::size_t>(color_index(side))][pawn_key & (kSize - 1)];
+    // Deeper results are more trustworthy, so they pull the average harder;
+    // the 256 denominator makes the entry an exponential moving average.
+    const int weight = std::min(depth + 1, 16);
+    const int scaled = std::clamp(static_cast<int>(diff) * kGrain, -kLimit, kLimit);
+    const int blended = (static_cast<int>(entry) * (256 - weight) + scaled * weight) / 256;
+    entry = static_cast<std::int16_t>(std::clamp(blended, -kLimit, kLimit));
   }
 };
 
 struct SearchState {
   HistoryTable history;
-  std::array<std::array<Move, 2>, kMaxPly> killers{};
   SeeCache see_cache;
-  std::unique_ptr<CounterHistory> counter_history;
-  std::unique_ptr<ContinuationHistory> continuation_history;
+  syzygy::TbCache tb_cache;
+  PawnTable pawn_table;
+  EvalCache eval_cache;
+  // Non-owning: the tables live alongside this state in its ThreadArena
+  // slab, which also controls their lifetime.
+  CaptureHistory* capture_history{nullptr};
+  CorrectionHistory* correction_history{nullptr};
+  CounterHistory* counter_history{nullptr};
+  ContinuationHistory* continuation_history{nullptr};
   double history_weight{1.0};
   double counter_history_weight{0.5};
   double continuation_history_weight{0.5};
+  // Zobrist keys of the positions on the current search path, indexed by
+  // ply; negamax records each node's key on entry so the upcoming-
+  // repetition scan can reach its ancestors without walking undo state.
+  std::array<std::uint64_t, kMaxPly> path_keys{};
   SearchStack stack;
   bool enable_null_move{true};
   int null_min_depth{2};
@@ -155,11 +243,27 @@ struct SearchState {
   int recapture_extensions{0};
   int check_extensions{0};
   int quiet_penalties{0};
+  int tb_hits{0};
   std::int64_t nodes{0};
   std::int64_t node_cap{-1};
+  // Cumulative across searches; only SearchSession::clear() resets it.
+  SearchStats stats;
   bool aborted{false};
   std::array<Move, kMaxMoves> root_excludes{};
   int root_exclude_count{0};
+  // Root move ordering signal: subtree sizes from the last completed
+  // iteration. The move loop records into root_effort_next and search_root
+  // promotes it once an iteration finishes, so a half-done iteration never
+  // feeds the picker skewed counts.
+  RootEffort root_effort;
+  RootEffort root_effort_next;
+  // Aspiration volatility trail: absolute primary-line score changes of the
+  // most recent completed iterations (ring-indexed by the count) plus the
+  // re-search count of the last one. adaptive_aspiration_margin reads these
+  // to seed the next window; reset per search.
+  std::array<Score, 4> aspiration_deltas{};
+  int aspiration_delta_count{0};
+  int aspiration_last_researches{0};
   int lmr_min_depth{kLmrMinDepthDefault};
   int lmr_min_move{kLmrMinMoveDefault};
   bool enable_static_futility{true};
@@ -177,10 +281,20 @@ struct SearchState {
   int multi_cut_threshold{3};
   int multi_cut_prunes{0};
   std::atomic<bool>* stop_flag{nullptr};
+  const std::atomic<bool>* ponder_flag{nullptr};
+  bool pondering{false};
   std::chrono::steady_clock::time_point start_time{};
   std::int64_t soft_time_ms{0};
+  // compute_time_budget's prediction; soft_time_ms is rescaled around it
+  // between iterations from best-move stability and root node distribution.
+  std::int64_t base_soft_time_ms{0};
+  std::int64_t root_nodes_total{0};
+  std::int64_t root_nodes_best{0};
   std::int64_t hard_time_ms{0};
   bool use_time{false};
+  // Set by the watchdog timer when hard_time_ms expires; the node loop only
+  // ever tests this and the stop flag, never the clock.
+  std::atomic<bool> time_expired{false};
   const SearchProgressFn* progress{nullptr};
   const CurrmoveFn* currmove{nullptr};
   int seldepth{0};
@@ -223,6 +337,35 @@ bool has_sufficient_material_for_null(const Position& pos) {
   return true;
 }
 
+// Stand-pat and pruning margins re-evaluate transposed positions constantly;
+// the per-thread cache short-circuits evaluate() on repeat zobrists.
+Score cached_evaluate(const Position& pos, SearchState& state) {
+  Score score = 0;
+  if (state.eval_cache.probe(pos.zobrist(), score)) {
+    return score;
+  }
+  score = evaluate(pos, nullptr, &state.pawn_table);
+  state.eval_cache.store(pos.zobrist(), score);
+  return score;
+}
+
+// Qsearch stand-pat variant: forwards the node window so evaluate() can stop
+// after its material+PSQT core once the verdict is decided. Scores that may
+// have taken the lazy exit are window-dependent and stay out of the shared
+// cache; the detection condition mirrors the early-out in evaluate().
+Score lazy_evaluate(const Position& pos, SearchState& state, Score alpha,
+                    Score beta) {
+  Score score = 0;
+  if (state.eval_cache.probe(pos.zobrist(), score)) {
+    return score;
+  }
+  score = evaluate(pos, nullptr, &state.pawn_table, alpha, beta);
+  if (score - kLazyEvalMargin < beta && score + kLazyEvalMargin > alpha) {
+    state.eval_cache.store(pos.zobrist(), score);
+  }
+  return score;
+}
+
 bool is_quiet_move(Move move) {
   const MoveFlag flag = move_flag(move);
   return flag == MoveFlag::Quiet || flag == MoveFlag::DoublePush;
@@ -238,7 +381,7 @@ void update_killers(SearchState& state, int ply, Move move) {
   if (move.is_null() || ply < 0 || ply >= kMaxPly) {
     return;
   }
-  auto& slots = state.killers[static_cast<std::size_t>(ply)];
+  auto& slots = state.stack.frame(ply).killers;
   if (slots[0] == move) {
     return;
   }
@@ -253,15 +396,26 @@ void update_history(SearchState& state, Color side, Move move, int bonus) {
   state.history.add(side, move, bonus);
 }
 
-void update_counter_history(SearchState& state, Move parent_move, Move move, int bonus) {
-  if (parent_move.is_null() || move.is_null()) {
+void update_capture_history(SearchState& state, Piece attacker, Square to,
+                            PieceType victim, int bonus) {
+  if (!state.capture_history || attacker == Piece::None ||
+      victim == PieceType::None) {
+    return;
+  }
+  state.capture_history->add(attacker, to, victim, bonus);
+}
+
+void update_counter_history(SearchState& state, Piece parent_piece, Move parent_move, Piece piece,
+                            Move move, int bonus) {
+  if (parent_move.is_null() || move.is_null() || parent_piece == Piece::None ||
+      piece == Piece::None) {
     return;
   }
   if (!state.counter_history) {
     return;
   }
-  const std::size_t prev_idx = CounterHistory::index(parent_move);
-  state.counter_history->add(prev_idx, move, bonus);
+  const std::size_t prev_idx = CounterHistory::index(parent_piece, parent_move);
+  state.counter_history->add(prev_idx, piece, move, bonus);
 }
 
 void update_continuation_history(SearchState& state, Piece parent_piece, Move move, int bonus) {
@@ -303,20 +457,28 @@ void emit_search_trace_finish(const SearchResult& result) {
   } else {
     oss << " best=0000";
   }
-  if (!result.pv.line.empty()) {
+  if (!result.pv.empty()) {
     oss << " pv=";
-    for (std::size_t idx = 0; idx < result.pv.line.size(); ++idx) {
+    for (std::size_t idx = 0; idx < result.pv.size(); ++idx) {
       if (idx > 0) {
         oss << ',';
       }
-      oss << move_to_uci(result.pv.line[idx]);
+      oss << move_to_uci(result.pv[idx]);
     }
   }
   trace_emit(TraceTopic::Search, oss.str());
 }
 
+// Compile-time node flavor for negamax. Non-PV nodes are the overwhelming
+// majority of the tree, so their instantiation drops the PV-table writes,
+// currmove callbacks, and root-only bookkeeping as statically dead code
+// instead of paying a runtime branch per node. qsearch stays a single
+// function: it carries no PV- or root-dependent logic to specialize away.
+enum class NodeType { Root, PV, NonPV };
+
 Score qsearch(Position& pos, Score alpha, Score beta, SearchTables& tables,
               SearchState& state, int ply);
+template <NodeType node_type>
 Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& tables,
               SearchState& state, int ply, PvTable* pv_table, bool previous_null);
 
@@ -325,8 +487,41 @@ Score aspiration_margin(int depth) {
   return std::clamp<Score>(margin, 32, kEvalInfinity);
 }
 
-bool should_extend_singular(Position& pos, const MoveList& moves, Move tt_move,
-                            int depth, const TTEntry& tt_entry,
+// Seeds the aspiration window from the volatility of the recent iteration
+// scores instead of depth alone. The adjustment only ever widens: when the
+// score trail is swinging, a schedule-sized window loops through three and
+// four re-searches per iteration, and pre-widening toward the observed
+// deltas skips most of those. Tightening below the schedule on quiet
+// trails was measured as a net node regression (deltas between consecutive
+// iterations underestimate the jump when extra depth uncovers a tactic, and
+// every mis-seeded window costs a whole root re-search), so stable
+// positions just keep aspiration_margin. An iteration that itself needed
+// multiple re-searches makes the trail untrustworthy; fall back to the
+// static schedule until the scores settle again.
+Score adaptive_aspiration_margin(const SearchState& state, int depth) {
+  const Score static_margin = aspiration_margin(depth);
+  if (state.aspiration_delta_count < 2 ||
+      state.aspiration_last_researches >= 2) {
+    return static_margin;
+  }
+  const int count =
+      std::min(state.aspiration_delta_count,
+               static_cast<int>(state.aspiration_deltas.size()));
+  Score sum = 0;
+  Score max_delta = 0;
+  for (int i = 0; i < count; ++i) {
+    const Score delta = state.aspiration_deltas[static_cast<std::size_t>(i)];
+    sum += delta;
+    max_delta = std::max(max_delta, delta);
+  }
+  // Average plus the worst swing covers the next delta with headroom.
+  const Score seed = static_cast<Score>(sum / count + max_delta + 16);
+  return std::clamp<Score>(seed, static_margin,
+                           static_cast<Score>(static_margin * 2));
+}
+
+bool should_extend_singular(Position& pos, Move tt_move,
+                            int depth, TTEntry& tt_entry,
                             SearchTables& tables, SearchState& state, int ply,
                             bool previous_null) {
   if (previous_null) {
@@ -338,13 +533,6 @@ bool should_extend_singular(Position& pos, const MoveList& moves, Move tt_move,
   if (depth < 3) {
     return false;
   }
-  if (moves.size() <= 1) {
-    return false;
-  }
-  constexpr std::size_t kMaxSingularWidth = 24;
-  if (moves.size() > kMaxSingularWidth) {
-    return false;
-  }
   const MoveFlag tt_flag = move_flag(tt_move);
   if ((tt_flag == MoveFlag::Quiet || tt_flag == MoveFlag::DoublePush) && depth < 5) {
     return false;
@@ -356,6 +544,15 @@ bool should_extend_singular(Position& pos, const MoveList& moves, Move tt_move,
   if (margin <= 0) {
     return false;
   }
+  // A previous visit already ran the exclusion search for this move at this
+  // depth; its verdict is cached in the entry, so reuse it instead of
+  // re-searching. The depth must match exactly: singularity is not monotone
+  // in depth, so a verdict from another depth says nothing about this one.
+  const auto cache_depth = static_cast<std::uint8_t>(std::min(depth, 63));
+  if (tt_entry.singular != SingularResult::Unknown &&
+      tt_entry.singular_depth == cache_depth) {
+    return tt_entry.singular == SingularResult::Singular;
+  }
   const SearchStack::Frame& frame = state.stack.frame(ply);
   if (frame.captured != PieceType::None) {
     margin = (margin * 3) / 4;
@@ -370,59 +567,136 @@ bool should_extend_singular(Position& pos, const MoveList& moves, Move tt_move,
     return false;
   }
 
+  MoveList moves;
+  pos.generate_moves(moves, GenStage::All);
+  if (moves.size() <= 1) {
+    return false;
+  }
+  constexpr std::size_t kMaxSingularWidth = 24;
+  if (moves.size() > kMaxSingularWidth) {
+    return false;
+  }
+
   const int reduced_depth = std::max(0, depth - 2);
   const auto history_snapshot = state.history;
-  const auto killers_snapshot = state.killers;
+  const auto killers_snapshot = state.stack.save_killers();
 
   for (std::size_t idx = 0; idx < moves.size(); ++idx) {
     const Move move = moves[idx];
     if (move == tt_move) {
       continue;
     }
-    Undo undo;
+    Undo& undo = state.stack.frame(ply + 1).undo;
     pos.make(move, undo);
     const PieceType captured_type =
         (undo.captured != Piece::None) ? type_of(undo.captured) : PieceType::None;
-    state.stack.prepare_child(ply, ply + 1, move, captured_type);
+    state.stack.prepare_child(ply, ply + 1, move, pos.piece_on(to_square(move)),
+                              captured_type);
     const Score score =
-        -negamax(pos, reduced_depth, -singular_beta, -singular_alpha, tables, state,
-                 ply + 1, nullptr, previous_null);
+        -negamax<NodeType::NonPV>(pos, reduced_depth, -singular_beta, -singular_alpha, tables,
+                                  state, ply + 1, nullptr, previous_null);
     pos.unmake(move, undo);
     if (score >= singular_beta) {
       state.history = history_snapshot;
-      state.killers = killers_snapshot;
+      state.stack.restore_killers(killers_snapshot);
+      if (!state.aborted) {
+        tt_entry.singular = SingularResult::NotSingular;
+        tt_entry.singular_depth = cache_depth;
+        tables.tt.store(pos.zobrist(), tt_entry);
+      }
       return false;
     }
   }
   state.history = history_snapshot;
-  state.killers = killers_snapshot;
+  state.stack.restore_killers(killers_snapshot);
+  if (state.aborted) {
+    // Children returned garbage scores; do not cache a verdict built on them.
+    return false;
+  }
+  tt_entry.singular = SingularResult::Singular;
+  tt_entry.singular_depth = cache_depth;
+  tables.tt.store(pos.zobrist(), tt_entry);
   return true;
 }
 
+// Watchdog armed once per timed search. It owns the only clock reads on the
+// hard-limit path: the node loop just tests the time_expired atomic, so a
+// poll costs one relaxed load instead of a vDSO call, and the movetime
+// cutoff lands at the deadline rather than quantized by the poll interval.
+class AbortTimer {
+public:
+  AbortTimer(std::atomic<bool>& expired, std::int64_t hard_ms,
+             const std::atomic<bool>* ponder_flag)
+      : expired_(expired), hard_ms_(hard_ms), ponder_flag_(ponder_flag),
+        thread_(&AbortTimer::run, this) {}
+
+  ~AbortTimer() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      cancelled_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+  }
+
+private:
+  void run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    // Hold the deadline while the GUI ponders; the clock starts on the hit.
+    while (!cancelled_ && ponder_flag_ != nullptr &&
+           ponder_flag_->load(std::memory_order_acquire)) {
+      cv_.wait_for(lock, std::chrono::milliseconds(1));
+    }
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(hard_ms_);
+    while (!cancelled_) {
+      if (cv_.wait_until(lock, deadline) == std::cv_status::timeout) {
+        expired_.store(true, std::memory_order_release);
+        return;
+      }
+    }
+  }
+
+  std::atomic<bool>& expired_;
+  std::int64_t hard_ms_;
+  const std::atomic<bool>* ponder_flag_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool cancelled_{false};
+  std::thread thread_;
+};
+
 bool should_abort(SearchState& state) {
   if (state.stop_flag != nullptr && state.stop_flag->load(std::memory_order_acquire)) {
     state.aborted = true;
     return true;
   }
-  if (state.use_time && state.hard_time_ms > 0) {
-    const auto now = std::chrono::steady_clock::now();
-    const auto elapsed_ms =
-        std::chrono::duration_cast<std::chrono::milliseconds>(now - state.start_time).count();
-    if (state.soft_time_ms > 0 && elapsed_ms >= state.soft_time_ms &&
-        state.stop_flag != nullptr && !state.aborted) {
-      state.stop_flag->store(true, std::memory_order_release);
-    }
-    if (elapsed_ms >= state.hard_time_ms) {
-      state.aborted = true;
-      return true;
+  if (state.pondering) {
+    if (state.ponder_flag->load(std::memory_order_acquire)) {
+      // Still pondering on the opponent's time: only stop can end us.
+      return false;
     }
+    // Ponderhit: our clock started when the flag flipped, not at go.
+    state.pondering = false;
+    state.start_time = std::chrono::steady_clock::now();
+  }
+  if (state.time_expired.load(std::memory_order_relaxed)) {
+    state.aborted = true;
+    return true;
   }
   return false;
 }
 
+template <NodeType node_type>
 Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& tables,
               SearchState& state, int ply, PvTable* pv_table, bool previous_null) {
+  constexpr bool root_node = (node_type == NodeType::Root);
+  constexpr bool in_pv = (node_type != NodeType::NonPV);
+  // Full-window children of a PV node stay on the PV path; everything else
+  // drops to the lean non-PV instantiation.
+  constexpr NodeType child_type = in_pv ? NodeType::PV : NodeType::NonPV;
   state.nodes++;
+  ++state.stats.interior_nodes;
   if (state.node_cap >= 0 && state.nodes > state.node_cap) {
     state.aborted = true;
     return alpha;
@@ -431,15 +705,31 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
   if (should_abort(state)) {
     return alpha;
   }
-  const bool in_pv = (pv_table != nullptr);
-  const bool trace_search = trace_enabled(TraceTopic::Search);
+  BBY_ASSERT(in_pv == (pv_table != nullptr));
+  BBY_ASSERT(root_node == (ply == 0));
+  // With a binary sink open the string path is bypassed entirely: hot events
+  // become 24-byte ring writes and the ostringstream cost disappears.
+  const bool trace_search_bin = trace_binary_active(TraceTopic::Search);
+  const bool trace_search = !trace_search_bin && trace_enabled(TraceTopic::Search);
   BBY_ASSERT(ply >= 0 && ply < kMaxPly);
+  // Record this node's key so descendants can run the constant-time
+  // upcoming-repetition scan against their ancestors.
+  state.path_keys[static_cast<std::size_t>(ply)] = pos.zobrist();
   Score static_eval = 0;
   bool have_static_eval = false;
   SearchStack::Frame& stack_frame = state.stack.frame(ply);
   auto ensure_static_eval = [&]() {
     if (!have_static_eval) {
-      static_eval = evaluate(pos);
+      static_eval = cached_evaluate(pos, state);
+      // Correct the raw eval by the learned bias for this pawn structure
+      // before anything consumes it, so the pruning gates and the improving
+      // trend in set_static_eval both see the adjusted value.
+      if (state.correction_history) {
+        const Score corrected =
+            static_eval + state.correction_history->correction(
+                              pos.side_to_move(), pos.pawn_key());
+        static_eval = std::clamp<Score>(corrected, -kTbWinScore + 1, kTbWinScore - 1);
+      }
       have_static_eval = true;
     }
     if (!stack_frame.has_static_eval) {
@@ -452,31 +742,79 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
     ensure_static_eval();
     return state.stack.is_improving(ply);
   };
-  if (in_pv) {
+  if constexpr (in_pv) {
     pv_table->reset_row(ply);
   }
 
   if (ply >= kMaxPly - 1) {
-    return evaluate(pos);
+    return cached_evaluate(pos, state);
   }
 
   const Score alpha_orig = alpha;
   TTEntry tt_entry{};
   const bool tt_hit = tables.tt.probe(pos.zobrist(), tt_entry);
-  const bool root_with_exclusions = (ply == 0 && state.root_exclude_count > 0);
+  const std::size_t tt_band = SearchStats::tt_depth_band(depth);
+  ++state.stats.tt_probes[tt_band];
+  if (tt_hit) {
+    ++state.stats.tt_hits[tt_band];
+  }
+  const bool root_with_exclusions = (root_node && state.root_exclude_count > 0);
   if (tt_hit && tt_entry.depth >= depth && !root_with_exclusions) {
     const Score tt_score = tt_entry.score;
     if (tt_entry.bound == BoundType::Exact) {
+      ++state.stats.tt_cutoffs[tt_band];
       return tt_score;
     }
     if (tt_entry.bound == BoundType::Lower && tt_score >= beta) {
+      ++state.stats.tt_cutoffs[tt_band];
       return tt_score;
     }
     if (tt_entry.bound == BoundType::Upper && tt_score <= alpha) {
+      ++state.stats.tt_cutoffs[tt_band];
       return tt_score;
     }
   }
 
+  // Endgame tablebase probe: exact WDL for covered material. Draws are always
+  // trusted; wins and losses only while the halfmove clock leaves room to
+  // convert under the 50-move rule. The per-thread cache answers repeat
+  // probes of transposed positions; the depth gate keeps probes out of the
+  // leaf-adjacent region where qsearch resolves the position anyway.
+  if (!root_node && depth >= kTbProbeMinDepth &&
+      std::popcount(pos.occupancy()) <= syzygy::max_pieces()) {
+    syzygy::Wdl wdl{};
+    bool known = state.tb_cache.probe(pos.zobrist(), wdl);
+    if (!known) {
+      if (const auto probed = syzygy::probe_wdl(pos)) {
+        wdl = *probed;
+        known = true;
+        state.tb_cache.store(pos.zobrist(), wdl);
+      }
+    }
+    if (known) {
+      ++state.tb_hits;
+      if (wdl == syzygy::Wdl::Draw) {
+        return 0;
+      }
+      if (pos.halfmove_clock() < kTbRule50Guard) {
+        return wdl == syzygy::Wdl::Win ? kTbWinScore - ply : -kTbWinScore + ply;
+      }
+    }
+  }
+
+  // Upcoming repetition: when the side to move can slide back into a
+  // position already on the search path, a draw is always in hand, so the
+  // score is bounded below by zero. The cuckoo lookup is constant time per
+  // candidate distance and prunes shuffle lines without searching them.
+  if (!root_node && alpha < 0 &&
+      pos.upcoming_repetition(state.path_keys.data(), ply,
+                              state.stack.frame(ply).plies_from_null)) {
+    alpha = 0;
+    if (alpha >= beta) {
+      return alpha;
+    }
+  }
+
   if (depth <= 0) {
     return qsearch(pos, alpha, beta, tables, state, ply);
   }
@@ -484,7 +822,7 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
   const bool in_check = pos.in_check(pos.side_to_move());
 
   if (!in_check && state.enable_static_futility && state.static_futility_depth > 0 &&
-      ply > 0 && !in_pv && !previous_null && depth <= state.static_futility_depth) {
+      !in_pv && !previous_null && depth <= state.static_futility_depth) {
     const bool improving = improving_now();
     if (!improving) {
       const Score margin =
@@ -493,7 +831,10 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
       futility_value = std::clamp(futility_value, static_cast<Score>(-kEvalInfinity),
                                   static_cast<Score>(kEvalInfinity));
       if (futility_value <= alpha) {
-        if (trace_search) {
+        if (trace_search_bin) {
+          trace_binary(TraceTopic::Search, TraceEvent::StaticFutility, ply, depth,
+                       0, alpha, static_eval, margin, futility_value);
+        } else if (trace_search) {
           std::ostringstream oss;
           oss << "trace search static futility"
               << " ply=" << ply
@@ -507,6 +848,9 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
         ++state.static_futility_prunes;
         return futility_value;
       }
+    } else if (trace_search_bin) {
+      trace_binary(TraceTopic::Search, TraceEvent::StaticFutilitySkip, ply, depth,
+                   0, 0, 0, 0, 0);
     } else if (trace_search) {
       std::ostringstream oss;
       oss << "trace search static futility skip-improving"
@@ -516,7 +860,7 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
     }
   }
 
-  if (!in_check && state.enable_razoring && state.razor_depth > 0 && ply > 0 &&
+  if (!in_check && state.enable_razoring && state.razor_depth > 0 &&
       !in_pv && !previous_null && depth <= state.razor_depth) {
     const bool improving = improving_now();
     if (!improving) {
@@ -526,7 +870,10 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
           std::clamp(static_eval + margin - kRazoringSlack, static_cast<Score>(-kEvalInfinity),
                      static_cast<Score>(kEvalInfinity));
       if (threshold <= alpha) {
-        if (trace_search) {
+        if (trace_search_bin) {
+          trace_binary(TraceTopic::Search, TraceEvent::Razor, ply, depth, 0,
+                       alpha, static_eval, margin, 0);
+        } else if (trace_search) {
           std::ostringstream oss;
           oss << "trace search razoring"
               << " ply=" << ply
@@ -545,6 +892,9 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
           return razor_score;
         }
       }
+    } else if (trace_search_bin) {
+      trace_binary(TraceTopic::Search, TraceEvent::RazorSkip, ply, depth, 0, 0,
+                   0, 0, 0);
     } else if (trace_search) {
       std::ostringstream oss;
       oss << "trace search razoring skip-improving"
@@ -554,8 +904,12 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
     }
   }
 
-  if (state.enable_null_move && !in_check && !previous_null && depth >= state.null_min_depth &&
-      has_sufficient_material_for_null(pos)) {
+  // Never at the root: the root must always yield a move, and MultiPV
+  // exclusion passes run with a finite aspirated beta there, so a null
+  // cutoff would hand an empty line back to search_root and silently
+  // truncate the line count.
+  if (!root_node && state.enable_null_move && !in_check && !previous_null &&
+      depth >= state.null_min_depth && has_sufficient_material_for_null(pos)) {
     ensure_static_eval();
     const Score eval_margin = static_eval - beta;
     int reduction = state.null_base_reduction;
@@ -569,7 +923,10 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
     const int null_depth = depth - 1 - reduction;
     if (null_depth >= 0) {
       ++state.null_attempts;
-      if (trace_search) {
+      if (trace_search_bin) {
+        trace_binary(TraceTopic::Search, TraceEvent::NullAttempt, ply, depth, 0,
+                     reduction, null_depth, eval_margin, 0);
+      } else if (trace_search) {
         std::ostringstream oss;
         oss << "trace search null attempt"
             << " ply=" << ply
@@ -579,11 +936,12 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
             << " margin=" << eval_margin;
         trace_emit(TraceTopic::Search, oss.str());
       }
-      Undo null_undo;
-      state.stack.prepare_child(ply, ply + 1, Move{}, PieceType::None);
+      state.stack.prepare_child(ply, ply + 1, Move{}, Piece::None, PieceType::None);
+      Undo& null_undo = state.stack.frame(ply + 1).undo;
       pos.make_null(null_undo);
-      const Score null_score = -negamax(pos, null_depth, -beta, -beta + 1, tables, state, ply + 1,
-                                        nullptr, true);
+      tables.tt.prefetch(pos.zobrist());
+      const Score null_score = -negamax<NodeType::NonPV>(pos, null_depth, -beta, -beta + 1,
+                                                         tables, state, ply + 1, nullptr, true);
       pos.unmake_null(null_undo);
       if (state.aborted) {
         return beta;
@@ -594,7 +952,10 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
                                         null_depth >= state.null_verification_depth;
         if (allow_verification) {
           ++state.null_verifications;
-          if (trace_search) {
+          if (trace_search_bin) {
+            trace_binary(TraceTopic::Search, TraceEvent::NullVerify, ply, depth,
+                         0, null_depth, beta, 0, 0);
+          } else if (trace_search) {
             std::ostringstream oss;
             oss << "trace search null verify"
                 << " ply=" << ply
@@ -603,13 +964,16 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
                 << " beta=" << beta;
             trace_emit(TraceTopic::Search, oss.str());
           }
-          const Score verify_score =
-              negamax(pos, null_depth, beta - 1, beta, tables, state, ply, nullptr, true);
+          const Score verify_score = negamax<NodeType::NonPV>(pos, null_depth, beta - 1, beta,
+                                                              tables, state, ply, nullptr, true);
           if (state.aborted) {
             return beta;
           }
           if (verify_score >= beta) {
             verified = true;
+          } else if (trace_search_bin) {
+            trace_binary(TraceTopic::Search, TraceEvent::NullVerifyFail, ply,
+                         depth, 0, verify_score, beta, 0, 0);
           } else if (trace_search) {
             std::ostringstream oss;
             oss << "trace search null verify-fail"
@@ -624,7 +988,10 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
         }
         if (verified) {
           ++state.null_prunes;
-          if (trace_search) {
+          if (trace_search_bin) {
+            trace_binary(TraceTopic::Search, TraceEvent::NullPrune, ply, depth,
+                         0, reduction, null_depth, beta, null_score);
+          } else if (trace_search) {
             std::ostringstream oss;
             oss << "trace search null prune"
                 << " ply=" << ply
@@ -647,41 +1014,38 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
   }
   const bool improving_lmr = state.stack.is_improving(ply);
 
-  MoveList moves;
-  pos.generate_moves(moves, GenStage::All);
-  if (moves.size() == 0) {
-    if (in_check) {
-      return mated_score(ply);
-    }
-    return 0;
-  }
-
   OrderingContext ordering{};
   ordering.pos = &pos;
   ordering.ply = ply;
   ordering.history = &state.history;
-  ordering.counter_history = state.counter_history.get();
-  ordering.continuation_history = state.continuation_history.get();
+  ordering.capture_history = state.capture_history;
+  ordering.counter_history = state.counter_history;
+  ordering.continuation_history = state.continuation_history;
   ordering.history_weight = state.history_weight;
   ordering.counter_history_weight = state.counter_history_weight;
   ordering.continuation_history_weight = state.continuation_history_weight;
   ordering.see_cache = &state.see_cache;
-  if (static_cast<std::size_t>(ply) < state.killers.size()) {
-    ordering.killers = state.killers[static_cast<std::size_t>(ply)];
+  if (ply >= 0 && ply < kMaxPly) {
+    ordering.killers = state.stack.frame(ply).killers;
   }
   ordering.parent_move = stack_frame.parent_move;
+  if constexpr (root_node) {
+    ordering.root_effort = &state.root_effort;
+  }
   if (tt_hit) {
     ordering.tt = &tt_entry;
   }
-  std::array<int, kMaxMoves> move_scores{};
-  score_moves(moves, ordering, move_scores);
 
   if (!in_check && state.enable_multi_cut && state.multi_cut_threshold > 0 &&
       state.multi_cut_candidates > 0 && state.multi_cut_min_depth > 0 &&
-      !in_pv && !previous_null && ply > 0 && depth >= state.multi_cut_min_depth) {
+      !in_pv && !previous_null && depth >= state.multi_cut_min_depth) {
     const int reduced_depth = depth - 1 - state.multi_cut_reduction;
     if (reduced_depth >= 0) {
-      const std::size_t move_count = moves.size();
+      MoveList mc_moves;
+      pos.generate_moves(mc_moves, GenStage::All);
+      std::array<int, kMaxMoves> mc_scores{};
+      score_moves(mc_moves, ordering, mc_scores);
+      const std::size_t move_count = mc_moves.size();
       const int candidates = std::min<int>(state.multi_cut_candidates,
                                            static_cast<int>(move_count));
       if (candidates > 0) {
@@ -689,40 +1053,41 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
         std::iota(order.begin(), order.end(), std::size_t{0});
         std::partial_sort(order.begin(), order.begin() + candidates, order.end(),
                           [&](std::size_t lhs, std::size_t rhs) {
-                            return move_scores[lhs] > move_scores[rhs];
+                            return mc_scores[lhs] > mc_scores[rhs];
                           });
         const auto history_snapshot = state.history;
-        const auto killers_snapshot = state.killers;
+        const auto killers_snapshot = state.stack.save_killers();
         int cut_count = 0;
         for (int idx = 0; idx < candidates; ++idx) {
           if (should_abort(state)) {
             state.history = history_snapshot;
-            state.killers = killers_snapshot;
+            state.stack.restore_killers(killers_snapshot);
             return beta;
           }
-          const Move move = moves[order[static_cast<std::size_t>(idx)]];
-          if (is_root_excluded(state, move, ply)) {
-            continue;
-          }
-          Undo undo;
+          const Move move = mc_moves[order[static_cast<std::size_t>(idx)]];
+          Undo& undo = state.stack.frame(ply + 1).undo;
           pos.make(move, undo);
           const PieceType captured_type =
               (undo.captured != Piece::None) ? type_of(undo.captured) : PieceType::None;
-          state.stack.prepare_child(ply, ply + 1, move, captured_type);
-          const Score cut_score = -negamax(pos, reduced_depth, -beta, -beta + 1, tables, state,
-                                           ply + 1, nullptr, false);
+          state.stack.prepare_child(ply, ply + 1, move,
+                                    pos.piece_on(to_square(move)), captured_type);
+          const Score cut_score = -negamax<NodeType::NonPV>(pos, reduced_depth, -beta, -beta + 1,
+                                                            tables, state, ply + 1, nullptr, false);
           pos.unmake(move, undo);
           if (state.aborted) {
             state.history = history_snapshot;
-            state.killers = killers_snapshot;
+            state.stack.restore_killers(killers_snapshot);
             return beta;
           }
           if (cut_score >= beta) {
             ++cut_count;
             if (cut_count >= state.multi_cut_threshold) {
               state.history = history_snapshot;
-              state.killers = killers_snapshot;
-              if (trace_search) {
+              state.stack.restore_killers(killers_snapshot);
+              if (trace_search_bin) {
+                trace_binary(TraceTopic::Search, TraceEvent::MultiCut, ply,
+                             depth, 0, beta, reduced_depth, cut_count, 0);
+              } else if (trace_search) {
                 std::ostringstream oss;
                 oss << "trace search multi-cut"
                     << " ply=" << ply
@@ -738,12 +1103,12 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
           }
         }
         state.history = history_snapshot;
-        state.killers = killers_snapshot;
+        state.stack.restore_killers(killers_snapshot);
       }
     }
   }
 
-  const bool singular_extension = tt_hit && should_extend_singular(pos, moves, tt_entry.best_move,
+  const bool singular_extension = tt_hit && should_extend_singular(pos, tt_entry.best_move,
                                                                    depth, tt_entry, tables,
                                                                    state, ply, previous_null);
 
@@ -751,36 +1116,45 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
   Score best_score = -kEvalInfinity;
   std::array<Move, kMaxMoves> failed_quiets{};
   int failed_quiet_count = 0;
-
-  const std::size_t move_count = moves.size();
+  // Captures tried before a cutoff, with the victim recorded at make time so
+  // the penalty loop does not have to re-derive en-passant victims.
+  std::array<Move, kMaxMoves> failed_captures{};
+  std::array<PieceType, kMaxMoves> failed_capture_victims{};
+  int failed_capture_count = 0;
+
+  MovePicker picker(pos, ordering);
+  std::size_t yielded_moves = 0;
   std::size_t processed_moves = 0;
-  for (std::size_t move_index = 0; move_index < move_count; ++move_index) {
+  for (Move move = picker.next(); !move.is_null(); move = picker.next()) {
     if (should_abort(state)) {
       break;
     }
-    select_best_move(moves, move_scores, move_index, move_count);
-    const Move move = moves[move_index];
-    if (is_root_excluded(state, move, ply)) {
-      continue;
-    }
-    if (ply == 0 && state.currmove != nullptr) {
-      const int move_number = static_cast<int>(processed_moves) + 1;
-      (*state.currmove)(move, move_number);
+    ++yielded_moves;
+    if constexpr (root_node) {
+      if (is_root_excluded(state, move, ply)) {
+        continue;
+      }
+      if (state.currmove != nullptr) {
+        const int move_number = static_cast<int>(processed_moves) + 1;
+        (*state.currmove)(move, move_number);
+      }
     }
     const bool is_primary_move = (processed_moves == 0);
+    const std::int64_t nodes_before_move = state.nodes;
     const Color moving_side = pos.side_to_move();
     const bool quiet = is_quiet_move(move);
     const Score alpha_before_move = alpha;
     const bool cut_node = alpha > alpha_orig;
     const Move parent_move = stack_frame.parent_move;
-    const Piece parent_piece = parent_move.is_null() ? Piece::None : pos.piece_on(to_square(parent_move));
+    const Piece parent_piece = stack_frame.parent_piece;
     const PieceType parent_capture = stack_frame.captured;
     const bool singular_hit = singular_extension && move == tt_entry.best_move;
-    Undo undo;
+    const bool gives_check = pos.gives_check(move);
+    Undo& undo = state.stack.frame(ply + 1).undo;
     pos.make(move, undo);
+    tables.tt.prefetch(pos.zobrist());
     const PieceType captured_type =
         (undo.captured != Piece::None) ? type_of(undo.captured) : PieceType::None;
-    const bool gives_check = pos.in_check(pos.side_to_move());
     bool recapture_extension = false;
     bool check_extension = false;
     int extension = 0;
@@ -800,7 +1174,6 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
     extension = std::min(extension, 2);
     const int next_depth = depth - 1 + extension;
     int reduction = 0;
-    const bool root_node = (ply == 0);
     const bool allow_lmr = !is_primary_move && !in_check && extension == 0 &&
                            (!in_pv || root_node);
     const bool allow_reduction = allow_lmr && !root_node && quiet;
@@ -825,6 +1198,9 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
       }
       base = std::clamp(base, 0, next_depth - 1);
       reduction = base;
+    } else if (allow_lmr && root_node && trace_search_bin) {
+      trace_binary(TraceTopic::Search, TraceEvent::LmrSkipRoot, ply, depth,
+                   move.value, 0, 0, 0, 0);
     } else if (allow_lmr && root_node && trace_search) {
       std::ostringstream oss;
       oss << "trace search lmr skip-root"
@@ -835,7 +1211,10 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
 
     if (recapture_extension) {
       ++state.recapture_extensions;
-      if (trace_search) {
+      if (trace_search_bin) {
+        trace_binary(TraceTopic::Search, TraceEvent::ExtendRecapture, ply,
+                     depth, move.value, 0, 0, 0, 0);
+      } else if (trace_search) {
         std::ostringstream oss;
         oss << "trace search extend recapture"
             << " ply=" << ply
@@ -846,7 +1225,10 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
     }
     if (check_extension) {
       ++state.check_extensions;
-      if (trace_search) {
+      if (trace_search_bin) {
+        trace_binary(TraceTopic::Search, TraceEvent::ExtendCheck, ply, depth,
+                     move.value, 0, 0, 0, 0);
+      } else if (trace_search) {
         std::ostringstream oss;
         oss << "trace search extend check"
             << " ply=" << ply
@@ -855,7 +1237,8 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
         trace_emit(TraceTopic::Search, oss.str());
       }
     }
-    state.stack.prepare_child(ply, ply + 1, move, captured_type);
+    state.stack.prepare_child(ply, ply + 1, move, pos.piece_on(to_square(move)),
+                              captured_type);
     if (gives_check) {
       reduction = 0;
     }
@@ -865,7 +1248,10 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
     if (lmr_used) {
       search_depth = std::max(1, next_depth - reduction);
       ++state.lmr_reductions;
-      if (trace_search) {
+      if (trace_search_bin) {
+        trace_binary(TraceTopic::Search, TraceEvent::LmrReduce, ply, depth,
+                     move.value, reduction, search_depth, 0, 0);
+      } else if (trace_search) {
         std::ostringstream oss;
         oss << "trace search lmr reduce"
             << " ply=" << ply
@@ -880,12 +1266,15 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
     bool searched_full_window = false;
     if (is_primary_move) {
       PvTable* child_pv = in_pv ? pv_table : nullptr;
-      score = -negamax(pos, search_depth, -beta, -alpha, tables, state,
-                       ply + 1, child_pv, false);
+      score = -negamax<child_type>(pos, search_depth, -beta, -alpha, tables, state,
+                                   ply + 1, child_pv, false);
       searched_full_window = true;
     } else {
       const Score null_window_beta = std::min<Score>(alpha + 1, kEvalInfinity);
-      if (trace_search) {
+      if (trace_search_bin) {
+        trace_binary(TraceTopic::Search, TraceEvent::PvsNarrow, ply, depth,
+                     move.value, alpha, beta, null_window_beta, 0);
+      } else if (trace_search) {
         std::ostringstream oss;
         oss << "trace search pvs narrow"
             << " ply=" << ply
@@ -895,14 +1284,17 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
             << " window=[" << null_window_beta << ',' << alpha << ']';
         trace_emit(TraceTopic::Search, oss.str());
       }
-      score = -negamax(pos, search_depth, -null_window_beta, -alpha, tables, state,
-                       ply + 1, nullptr, false);
+      score = -negamax<NodeType::NonPV>(pos, search_depth, -null_window_beta, -alpha, tables,
+                                        state, ply + 1, nullptr, false);
       if (lmr_used && !state.aborted && score > alpha) {
-        score = -negamax(pos, next_depth, -null_window_beta, -alpha, tables, state,
-                         ply + 1, nullptr, false);
+        score = -negamax<NodeType::NonPV>(pos, next_depth, -null_window_beta, -alpha, tables,
+                                          state, ply + 1, nullptr, false);
       }
       if (!state.aborted && score > alpha && score < beta) {
-        if (trace_search) {
+        if (trace_search_bin) {
+          trace_binary(TraceTopic::Search, TraceEvent::PvsResearch, ply, depth,
+                       move.value, alpha, beta, score, 0);
+        } else if (trace_search) {
           std::ostringstream oss;
           oss << "trace search pvs research"
               << " ply=" << ply
@@ -913,17 +1305,23 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
           trace_emit(TraceTopic::Search, oss.str());
         }
         PvTable* child_pv = in_pv ? pv_table : nullptr;
-        score = -negamax(pos, next_depth, -beta, -alpha, tables, state,
-                         ply + 1, child_pv, false);
+        score = -negamax<child_type>(pos, next_depth, -beta, -alpha, tables, state,
+                                     ply + 1, child_pv, false);
         searched_full_window = true;
       }
     }
     pos.unmake(move, undo);
     ++processed_moves;
+    stack_frame.move_count = static_cast<int>(processed_moves);
 
     if (quiet && score <= alpha_before_move &&
         failed_quiet_count < static_cast<int>(failed_quiets.size())) {
       failed_quiets[static_cast<std::size_t>(failed_quiet_count++)] = move;
+    } else if (captured_type != PieceType::None && score <= alpha_before_move &&
+               failed_capture_count < static_cast<int>(failed_captures.size())) {
+      failed_captures[static_cast<std::size_t>(failed_capture_count)] = move;
+      failed_capture_victims[static_cast<std::size_t>(failed_capture_count)] = captured_type;
+      ++failed_capture_count;
     }
 
     if (state.aborted) {
@@ -933,8 +1331,23 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
     if (score > best_score) {
       best_score = score;
       best_move = move;
-      if (searched_full_window && in_pv) {
-        pv_table->set(ply, move);
+      if constexpr (in_pv) {
+        if (searched_full_window) {
+          pv_table->set(ply, move);
+        }
+      }
+    }
+
+    if constexpr (root_node) {
+      if (state.root_exclude_count == 0) {
+        // Per-root-move node accounting for the time manager: how much of the
+        // tree the eventual best move absorbed says how settled the choice is.
+        const std::int64_t spent = state.nodes - nodes_before_move;
+        state.root_nodes_total += spent;
+        if (best_move == move) {
+          state.root_nodes_best = spent;
+        }
+        state.root_effort_next.record(move, spent);
       }
     }
 
@@ -945,7 +1358,8 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
         update_history(state, pos.side_to_move(), move, bonus);
         if (!parent_move.is_null()) {
           const int scaled_bonus = std::max(1, bonus / 2);
-          update_counter_history(state, parent_move, move, scaled_bonus);
+          update_counter_history(state, parent_piece, parent_move,
+                                 pos.piece_on(from_square(move)), move, scaled_bonus);
           if (parent_piece != Piece::None) {
             update_continuation_history(state, parent_piece, move, scaled_bonus);
           }
@@ -954,26 +1368,47 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
     }
 
     if (alpha >= beta) {
+      ++state.stats.beta_cutoffs;
+      if (processed_moves <= 1) {
+        ++state.stats.cutoff_first_move;
+      } else if (processed_moves <= 4) {
+        ++state.stats.cutoff_moves_2_to_4;
+      } else {
+        ++state.stats.cutoff_late_moves;
+      }
       if (quiet) {
         update_killers(state, ply, move);
         const int bonus = kQuietHistoryBonus * depth * depth;
         update_history(state, pos.side_to_move(), move, bonus);
         if (!parent_move.is_null()) {
           const int scaled_bonus = std::max(1, bonus / 2);
-          update_counter_history(state, parent_move, move, scaled_bonus);
+          update_counter_history(state, parent_piece, parent_move,
+                                 pos.piece_on(from_square(move)), move, scaled_bonus);
           if (parent_piece != Piece::None) {
             update_continuation_history(state, parent_piece, move, scaled_bonus);
           }
         }
+      } else if (captured_type != PieceType::None) {
+        const int bonus = kQuietHistoryBonus * depth * depth;
+        update_capture_history(state, pos.piece_on(from_square(move)),
+                               to_square(move), captured_type, bonus);
       }
       const int penalty = kQuietHistoryBonus * depth;
+      for (int idx = 0; idx < failed_capture_count; ++idx) {
+        const Move failed = failed_captures[static_cast<std::size_t>(idx)];
+        update_capture_history(state, pos.piece_on(from_square(failed)),
+                               to_square(failed),
+                               failed_capture_victims[static_cast<std::size_t>(idx)],
+                               -penalty);
+      }
       for (int idx = 0; idx < failed_quiet_count; ++idx) {
         update_history(state, moving_side, failed_quiets[static_cast<std::size_t>(idx)],
                        -penalty);
         if (!parent_move.is_null()) {
           const int scaled_penalty = std::max(1, penalty / 2);
-          update_counter_history(state, parent_move, failed_quiets[static_cast<std::size_t>(idx)],
-                                 -scaled_penalty);
+          update_counter_history(state, parent_piece, parent_move,
+                                 pos.piece_on(from_square(failed_quiets[static_cast<std::size_t>(idx)])),
+                                 failed_quiets[static_cast<std::size_t>(idx)], -scaled_penalty);
           if (parent_piece != Piece::None) {
             update_continuation_history(state, parent_piece,
                                         failed_quiets[static_cast<std::size_t>(idx)], -scaled_penalty);
@@ -985,13 +1420,20 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
     }
   }
 
+  if (yielded_moves == 0 && !state.aborted) {
+    if (in_check) {
+      return mated_score(ply);
+    }
+    return 0;
+  }
+
   if (best_score == -kEvalInfinity) {
     if (!have_static_eval) {
-      static_eval = evaluate(pos);
+      static_eval = cached_evaluate(pos, state);
       have_static_eval = true;
     }
     best_score = static_eval;
-    if (pv_table != nullptr) {
+    if constexpr (in_pv) {
       pv_table->reset_row(ply);
     }
   }
@@ -1007,20 +1449,59 @@ Score negamax(Position& pos, int depth, Score alpha, Score beta, SearchTables& t
     return best_score;
   }
 
+  // Feed the correction history with how far the search landed from the
+  // (already corrected) static eval. Fail-soft bounds that merely confirm
+  // the eval's side of the window carry no bias signal, and mate/tablebase
+  // scores would poison the average, so both are skipped.
+  if (state.correction_history && have_static_eval &&
+      std::abs(best_score) < kTbWinScore &&
+      !(bound == BoundType::Lower && best_score <= static_eval) &&
+      !(bound == BoundType::Upper && best_score >= static_eval)) {
+    state.correction_history->update(pos.side_to_move(), pos.pawn_key(), depth,
+                                     static_cast<Score>(best_score - static_eval));
+  }
+
   TTEntry store{};
   store.best_move = best_move;
   store.score = best_score;
   store.static_eval = have_static_eval ? static_eval : best_score;
   store.depth = static_cast<std::uint8_t>(std::clamp(depth, 0, 255));
   store.bound = bound;
+  // Keep the cached exclusion-search verdict alive across the overwrite, but
+  // only while it still describes the move being stored.
+  if (tt_hit && best_move == tt_entry.best_move) {
+    store.singular = tt_entry.singular;
+    store.singular_depth = tt_entry.singular_depth;
+  }
   tables.tt.store(pos.zobrist(), store);
 
   return best_score;
 }
 
+// Depth-0 store shared by the qsearch exit points; the fail-soft score plus
+// the original window decide the bound exactly as in negamax.
+void store_qsearch_entry(SearchTables& tables, std::uint64_t key, Score best,
+                         Score alpha_orig, Score beta, Move best_move,
+                         Score static_eval) {
+  TTEntry store{};
+  store.best_move = best_move;
+  store.score = best;
+  store.static_eval = static_eval;
+  store.depth = 0;
+  if (best <= alpha_orig) {
+    store.bound = BoundType::Upper;
+  } else if (best >= beta) {
+    store.bound = BoundType::Lower;
+  } else {
+    store.bound = BoundType::Exact;
+  }
+  tables.tt.store(key, store);
+}
+
 Score qsearch(Position& pos, Score alpha, Score beta, SearchTables& tables,
               SearchState& state, int ply) {
   state.nodes++;
+  ++state.stats.qsearch_nodes;
   if (state.node_cap >= 0 && state.nodes > state.node_cap) {
     state.aborted = true;
     return alpha;
@@ -1029,21 +1510,50 @@ Score qsearch(Position& pos, Score alpha, Score beta, SearchTables& tables,
   if (should_abort(state)) {
     return alpha;
   }
+
+  // Capture sequences transpose heavily, so qsearch probes the shared table
+  // like negamax does. Every stored entry is at least depth 0, so any hit
+  // with a usable bound answers this node.
+  const Score alpha_orig = alpha;
+  TTEntry tt_entry{};
+  const bool tt_hit = tables.tt.probe(pos.zobrist(), tt_entry);
+  const std::size_t tt_band = SearchStats::tt_depth_band(0);
+  ++state.stats.tt_probes[tt_band];
+  if (tt_hit) {
+    ++state.stats.tt_hits[tt_band];
+    const Score tt_score = tt_entry.score;
+    if (tt_entry.bound == BoundType::Exact) {
+      ++state.stats.tt_cutoffs[tt_band];
+      return tt_score;
+    }
+    if (tt_entry.bound == BoundType::Lower && tt_score >= beta) {
+      ++state.stats.tt_cutoffs[tt_band];
+      return tt_score;
+    }
+    if (tt_entry.bound == BoundType::Upper && tt_score <= alpha) {
+      ++state.stats.tt_cutoffs[tt_band];
+      return tt_score;
+    }
+  }
+
   const bool in_check = pos.in_check(pos.side_to_move());
   if (in_check) {
     MoveList evasions;
-    pos.generate_moves(evasions, GenStage::All);
+    pos.generate_moves(evasions, GenStage::Evasions);
     if (evasions.size() == 0) {
       return mated_score(ply);
     }
     Score best = -kEvalInfinity;
+    Move best_move{};
     for (const Move move : evasions) {
       Undo undo;
       pos.make(move, undo);
+      tables.tt.prefetch(pos.zobrist());
       const Score score = -qsearch(pos, -beta, -alpha, tables, state, ply + 1);
       pos.unmake(move, undo);
       if (score > best) {
         best = score;
+        best_move = move;
       }
       if (score > alpha) {
         alpha = score;
@@ -1055,12 +1565,23 @@ Score qsearch(Position& pos, Score alpha, Score beta, SearchTables& tables,
         break;
       }
     }
+    if (!state.aborted) {
+      store_qsearch_entry(tables, pos.zobrist(), best, alpha_orig, beta,
+                          best_move, best);
+    }
     return best;
   }
 
-  const Score stand_pat = evaluate(pos);
-  const bool trace_q = trace_enabled(TraceTopic::QSearch);
-  if (trace_q) {
+  // A hit carries the static eval from the earlier visit; reuse it and skip
+  // the evaluator entirely.
+  const Score stand_pat = tt_hit ? tt_entry.static_eval
+                                 : lazy_evaluate(pos, state, alpha, beta);
+  const bool trace_q_bin = trace_binary_active(TraceTopic::QSearch);
+  const bool trace_q = !trace_q_bin && trace_enabled(TraceTopic::QSearch);
+  if (trace_q_bin) {
+    trace_binary(TraceTopic::QSearch, TraceEvent::QNode, ply, 0, 0, stand_pat,
+                 alpha, beta, pos.side_to_move() == Color::White ? 1 : 0);
+  } else if (trace_q) {
     std::ostringstream oss;
     oss << "trace qsearch node"
         << " ply=" << ply
@@ -1072,9 +1593,12 @@ Score qsearch(Position& pos, Score alpha, Score beta, SearchTables& tables,
     trace_emit(TraceTopic::QSearch, oss.str());
   }
   if (stand_pat >= beta) {
+    store_qsearch_entry(tables, pos.zobrist(), stand_pat, alpha_orig, beta,
+                        Move{}, stand_pat);
     return stand_pat;
   }
   Score best = stand_pat;
+  Move best_move{};
   if (stand_pat > alpha) {
     alpha = stand_pat;
   }
@@ -1082,6 +1606,8 @@ Score qsearch(Position& pos, Score alpha, Score beta, SearchTables& tables,
   MoveList moves;
   pos.generate_moves(moves, GenStage::Captures);
   if (moves.size() == 0) {
+    store_qsearch_entry(tables, pos.zobrist(), stand_pat, alpha_orig, beta,
+                        Move{}, stand_pat);
     return stand_pat;
   }
 
@@ -1089,9 +1615,10 @@ Score qsearch(Position& pos, Score alpha, Score beta, SearchTables& tables,
   ordering.pos = &pos;
   ordering.ply = ply;
   ordering.history = &state.history;
+  ordering.capture_history = state.capture_history;
   ordering.see_cache = &state.see_cache;
-  if (static_cast<std::size_t>(ply) < state.killers.size()) {
-    ordering.killers = state.killers[static_cast<std::size_t>(ply)];
+  if (ply >= 0 && ply < kMaxPly) {
+    ordering.killers = state.stack.frame(ply).killers;
   }
   std::array<int, kMaxMoves> move_scores{};
   score_moves(moves, ordering, move_scores);
@@ -1102,26 +1629,24 @@ Score qsearch(Position& pos, Score alpha, Score beta, SearchTables& tables,
     select_best_move(moves, move_scores, move_index, move_count);
     const Move move = moves[move_index];
     const int margin = capture_margin(pos, move);
-    const int see_gain = cached_see(pos, move, ordering.see_cache);
-    bool delta_pruned = false;
-    if (see_gain < 0) {
-      if (stand_pat + see_gain + kDeltaMargin < alpha) {
-        delta_pruned = true;
-      }
-    } else if (stand_pat + see_gain + kDeltaMargin < alpha) {
-      delta_pruned = true;
-    }
+    // Threshold form of the delta prune: keep the move only when the
+    // exchange can bring the score within kDeltaMargin of alpha. see_ge
+    // stops as soon as the bound is decided instead of resolving the chain.
+    const int see_floor = alpha - stand_pat - kDeltaMargin;
+    const bool delta_pruned = !see_ge(pos, move, see_floor);
     qsearch_delta_prune_probe(pos, move, stand_pat, alpha, margin, kDeltaMargin, ply,
                               delta_pruned);
-    if (trace_q) {
+    if (trace_q_bin) {
+      trace_binary(TraceTopic::QSearch, TraceEvent::QCandidate, ply, 0,
+                   move.value, margin, see_floor, alpha, delta_pruned ? 1 : 0);
+    } else if (trace_q) {
       std::ostringstream oss;
       oss << "trace qsearch candidate"
           << " ply=" << ply
           << " move=" << move_to_uci(move)
           << " margin=" << margin
-          << " see=" << see_gain
+          << " seefloor=" << see_floor
           << " delta=" << kDeltaMargin
-          << " threshold=" << (stand_pat + see_gain + kDeltaMargin)
           << " alpha=" << alpha
           << " pruned=" << (delta_pruned ? 1 : 0);
       trace_emit(TraceTopic::QSearch, oss.str());
@@ -1131,11 +1656,13 @@ Score qsearch(Position& pos, Score alpha, Score beta, SearchTables& tables,
     }
     Undo undo;
     pos.make(move, undo);
+    tables.tt.prefetch(pos.zobrist());
     const Score score = -qsearch(pos, -beta, -alpha, tables, state, ply + 1);
     pos.unmake(move, undo);
     const Score alpha_before = alpha;
     if (score > best) {
       best = score;
+      best_move = move;
     }
     if (score > alpha) {
       alpha = score;
@@ -1146,7 +1673,10 @@ Score qsearch(Position& pos, Score alpha, Score beta, SearchTables& tables,
     if (alpha >= beta) {
       break;
     }
-    if (trace_q) {
+    if (trace_q_bin) {
+      trace_binary(TraceTopic::QSearch, TraceEvent::QResult, ply, 0, move.value,
+                   score, best, alpha, beta);
+    } else if (trace_q) {
       std::ostringstream oss;
       oss << "trace qsearch result"
           << " ply=" << ply
@@ -1160,23 +1690,33 @@ Score qsearch(Position& pos, Score alpha, Score beta, SearchTables& tables,
     }
   }
 
+  if (!state.aborted) {
+    store_qsearch_entry(tables, pos.zobrist(), best, alpha_orig, beta,
+                        best_move, stand_pat);
+  }
   return best;
 }
 
-}  // namespace
-
-SearchResult search(Position& root, const Limits& limits, std::atomic<bool>* stop_flag,
-                    const SearchProgressFn* progress, const CurrmoveFn* currmove) {
-  SearchTables tables;
-  SearchState state;
-  seed_opening_history(state.history);
-  state.counter_history = std::make_unique<CounterHistory>();
-  state.continuation_history = std::make_unique<ContinuationHistory>();
-  state.see_cache.clear();
+constexpr int kMaxSearchThreads = 512;
+
+// One Lazy SMP worker: runs the full iterative-deepening loop over the shared
+// tables with its own history/killer/counter state. Helper workers
+// (depth_offset > 0) start one ply deeper on odd ids so the pool explores
+// staggered horizons, and report through no callbacks.
+SearchResult search_root(Position& root, const Limits& limits, SearchTables& tables,
+                         SearchState& state, std::atomic<bool>* stop_flag,
+                         const SearchProgressFn* progress, const CurrmoveFn* currmove,
+                         int depth_offset,
+                         const std::atomic<bool>* ponder_flag = nullptr) {
+  state.seldepth = 0;
   state.nodes = 0;
   state.node_cap = limits.nodes;
   state.aborted = false;
   state.root_exclude_count = 0;
+  state.root_effort.clear();
+  state.root_effort_next.clear();
+  state.aspiration_delta_count = 0;
+  state.aspiration_last_researches = 0;
   state.lmr_min_depth = std::max(1, limits.lmr_min_depth);
   state.lmr_min_move = std::max(1, limits.lmr_min_move);
   state.enable_static_futility = limits.enable_static_futility;
@@ -1214,25 +1754,69 @@ SearchResult search(Position& root, const Limits& limits, std::atomic<bool>* sto
   state.recapture_extensions = 0;
   state.check_extensions = 0;
   state.quiet_penalties = 0;
+  state.tb_hits = 0;
   state.start_time = std::chrono::steady_clock::now();
   const TimeBudget time_budget = compute_time_budget(limits, root.side_to_move());
   state.hard_time_ms = time_budget.hard_ms;
   state.soft_time_ms = std::min<std::int64_t>(time_budget.soft_ms, time_budget.hard_ms);
+  state.base_soft_time_ms = state.soft_time_ms;
+  state.root_nodes_total = 0;
+  state.root_nodes_best = 0;
   state.use_time = state.hard_time_ms > 0;
   if (!state.use_time) {
     state.soft_time_ms = 0;
   }
   state.stop_flag = stop_flag;
+  state.ponder_flag = ponder_flag;
+  state.pondering =
+      ponder_flag != nullptr && ponder_flag->load(std::memory_order_acquire);
+  state.time_expired.store(false, std::memory_order_relaxed);
+  std::optional<AbortTimer> abort_timer;
+  if (state.use_time) {
+    abort_timer.emplace(state.time_expired, state.hard_time_ms, ponder_flag);
+  }
   state.progress = progress;
   state.currmove = currmove;
 
-  emit_search_trace_start(root, limits);
-
   const int max_depth =
       (limits.depth > 0) ? limits.depth : (limits.depth == 0 ? 1 : kMaxPly);
   const int requested_multipv = std::clamp(limits.multipv > 0 ? limits.multipv : 1, 1,
                                           static_cast<int>(kMaxMoves));
 
+  // Tablebase-covered roots return the converting move immediately instead of
+  // burning the clock on a search. Skipped for infinite analysis, pondering
+  // (bestmove may not appear before ponderhit), MultiPV and helper workers,
+  // which should keep producing lines as usual.
+  if (depth_offset == 0 && !limits.infinite && !state.pondering &&
+      requested_multipv == 1 &&
+      std::popcount(root.occupancy()) <= syzygy::max_pieces()) {
+    if (const auto tb = syzygy::probe_root(root)) {
+      ++state.tb_hits;
+      SearchResult tb_result;
+      tb_result.best = tb->move;
+      tb_result.pv.push_back(tb->move);
+      Score tb_eval = 0;
+      if (tb->wdl == syzygy::Wdl::Win) {
+        tb_eval = kTbWinScore - tb->dtm;
+      } else if (tb->wdl == syzygy::Wdl::Loss) {
+        tb_eval = -kTbWinScore + tb->dtm;
+      }
+      tb_result.eval = tb_eval;
+      tb_result.depth = 1;
+      tb_result.seldepth = 1;
+      tb_result.tb_hits = state.tb_hits;
+      tb_result.lines.push_back(PVLine{tb->move, tb_result.pv, tb_eval});
+      tb_result.hashfull = tables.tt.hashfull();
+      tb_result.elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                 std::chrono::steady_clock::now() - state.start_time)
+                                 .count();
+      if (state.progress != nullptr) {
+        (*state.progress)(tb_result);
+      }
+      return tb_result;
+    }
+  }
+
   SearchResult result;
   result.best = Move{};
   result.eval = 0;
@@ -1242,19 +1826,21 @@ SearchResult search(Position& root, const Limits& limits, std::atomic<bool>* sto
 
   PvTable pv_table{};
   pv_table.clear();
-  std::vector<Move> root_line;
+  PV root_line;
   std::vector<PVLine> multipv_lines(static_cast<std::size_t>(requested_multipv));
   std::vector<Score> previous_scores(static_cast<std::size_t>(requested_multipv), 0);
   std::vector<bool> have_previous(static_cast<std::size_t>(requested_multipv), false);
   int active_multipv = requested_multipv;
+  Move stable_best{};
+  bool have_stable_best = false;
+  int best_stability = 0;
 
-  for (int current_depth = 1; current_depth <= max_depth; ++current_depth) {
-    ++tables.generation;
-    tables.tt.set_generation(tables.generation);
-
+  const int start_depth = std::min(1 + (depth_offset & 1), max_depth);
+  for (int current_depth = start_depth; current_depth <= max_depth; ++current_depth) {
     result.depth = current_depth;
     const bool trace_search_enabled = trace_enabled(TraceTopic::Search);
     bool aborted_depth = false;
+    bool iteration_fail_low = false;
     int produced_lines = 0;
 
     if (state.stop_flag != nullptr &&
@@ -1275,7 +1861,11 @@ SearchResult search(Position& root, const Limits& limits, std::atomic<bool>* sto
 
       Score alpha = -kEvalInfinity;
       Score beta = kEvalInfinity;
-      Score window = aspiration_margin(current_depth);
+      // Only the primary line has a volatility trail; excluded-move lines
+      // keep the static schedule.
+      Score window = pv_index == 0
+                         ? adaptive_aspiration_margin(state, current_depth)
+                         : aspiration_margin(current_depth);
       Score score = 0;
       bool use_aspiration = have_previous[static_cast<std::size_t>(pv_index)];
       const Score previous_score = previous_scores[static_cast<std::size_t>(pv_index)];
@@ -1316,12 +1906,11 @@ SearchResult search(Position& root, const Limits& limits, std::atomic<bool>* sto
           trace_emit(TraceTopic::Search, oss.str());
         }
 
+        state.root_nodes_total = 0;
+        state.root_nodes_best = 0;
         state.stack.prepare_root();
-        score = negamax(root, current_depth, alpha, beta, tables, state, 0, &pv_table, false);
-        if (state.aborted) {
-          aborted_depth = true;
-          break;
-        }
+        score = negamax<NodeType::Root>(root, current_depth, alpha, beta, tables, state, 0,
+                                        &pv_table, false);
         if (state.aborted) {
           aborted_depth = true;
           break;
@@ -1331,6 +1920,7 @@ SearchResult search(Position& root, const Limits& limits, std::atomic<bool>* sto
         }
 
         if (score <= alpha) {
+          iteration_fail_low = true;
           if (trace_search_enabled) {
             std::ostringstream oss;
             oss << "aspiration fail-low depth=" << current_depth
@@ -1340,16 +1930,16 @@ SearchResult search(Position& root, const Limits& limits, std::atomic<bool>* sto
                 << " beta=" << beta;
             trace_emit(TraceTopic::Search, oss.str());
           }
-          if (alpha <= -kEvalInfinity) {
+          if (alpha <= -kEvalInfinity || attempt >= 3) {
             use_aspiration = false;
             alpha = -kEvalInfinity;
             beta = kEvalInfinity;
             continue;
           }
+          // Widen only the failing side: the upper bound held, so keep it
+          // and drop alpha below the fail-low score.
           window = std::min<Score>(static_cast<Score>(window * 2), kEvalInfinity);
-          const Score center = score;
-          alpha = std::max(center - window, -kEvalInfinity);
-          beta = std::min(center + window, kEvalInfinity);
+          alpha = std::max(score - window, -kEvalInfinity);
           if (alpha >= beta || (alpha <= -kEvalInfinity && beta >= kEvalInfinity)) {
             use_aspiration = false;
             alpha = -kEvalInfinity;
@@ -1368,16 +1958,16 @@ SearchResult search(Position& root, const Limits& limits, std::atomic<bool>* sto
                 << " beta=" << beta;
             trace_emit(TraceTopic::Search, oss.str());
           }
-          if (beta >= kEvalInfinity) {
+          if (beta >= kEvalInfinity || attempt >= 3) {
             use_aspiration = false;
             alpha = -kEvalInfinity;
             beta = kEvalInfinity;
             continue;
           }
+          // Mirror of the fail-low case: the lower bound held, so keep
+          // alpha and raise beta above the fail-high score.
           window = std::min<Score>(static_cast<Score>(window * 2), kEvalInfinity);
-          const Score center = score;
-          alpha = std::max(center - window, -kEvalInfinity);
-          beta = std::min(center + window, kEvalInfinity);
+          beta = std::min(score + window, kEvalInfinity);
           if (alpha >= beta || (alpha <= -kEvalInfinity && beta >= kEvalInfinity)) {
             use_aspiration = false;
             alpha = -kEvalInfinity;
@@ -1389,13 +1979,28 @@ SearchResult search(Position& root, const Limits& limits, std::atomic<bool>* sto
         break;
       }
 
+      if (aborted_depth) {
+        // An aborted attempt has no trustworthy line; leave the previous
+        // iteration's result in place rather than publishing a partial PV.
+        break;
+      }
+
       root_line.clear();
       pv_table.extract(0, root_line);
       PVLine line;
-      line.pv.line = root_line;
+      line.pv = root_line;
       line.best = root_line.empty() ? Move{} : root_line.front();
       line.eval = score;
       multipv_lines[static_cast<std::size_t>(pv_index)] = line;
+      if (pv_index == 0) {
+        if (have_previous[0]) {
+          const auto slot = static_cast<std::size_t>(
+              state.aspiration_delta_count % static_cast<int>(state.aspiration_deltas.size()));
+          state.aspiration_deltas[slot] = std::abs(score - previous_score);
+          ++state.aspiration_delta_count;
+        }
+        state.aspiration_last_researches = attempt - 1;
+      }
       previous_scores[static_cast<std::size_t>(pv_index)] = score;
       have_previous[static_cast<std::size_t>(pv_index)] = true;
       ++produced_lines;
@@ -1448,6 +2053,7 @@ SearchResult search(Position& root, const Limits& limits, std::atomic<bool>* sto
       }
       last_completed = result;
       have_completed = true;
+      state.root_effort = state.root_effort_next;
       if (state.progress != nullptr) {
         const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
                             std::chrono::steady_clock::now() - state.start_time)
@@ -1457,9 +2063,56 @@ SearchResult search(Position& root, const Limits& limits, std::atomic<bool>* sto
       }
     }
 
+    // Feedback-driven soft limit: the budget from compute_time_budget is a
+    // prediction made before any search evidence existed. A best move that
+    // stays put across iterations and absorbs the bulk of the root tree is
+    // settled, so spend less; fail-lows and best-move flips mean the position
+    // is still contested, so spend more. The hard limit never moves.
+    if (available > 0 && state.use_time && state.base_soft_time_ms > 0 &&
+        requested_multipv == 1) {
+      std::int64_t factor_pct = 100;
+      if (have_stable_best && result.best == stable_best) {
+        ++best_stability;
+      } else {
+        if (have_stable_best) {
+          factor_pct += 30;  // best-move flip
+        }
+        best_stability = 0;
+        stable_best = result.best;
+        have_stable_best = true;
+      }
+      factor_pct -= 5 * std::min(best_stability, 8);
+      if (state.root_nodes_total > 0) {
+        const std::int64_t best_share_pct =
+            state.root_nodes_best * 100 / state.root_nodes_total;
+        if (best_share_pct >= 90) {
+          factor_pct -= 15;
+        } else if (best_share_pct < 30) {
+          factor_pct += 20;
+        }
+      }
+      if (iteration_fail_low) {
+        factor_pct += 40;
+      }
+      factor_pct = std::clamp<std::int64_t>(factor_pct, 50, 200);
+      state.soft_time_ms = std::min(state.hard_time_ms,
+                                    state.base_soft_time_ms * factor_pct / 100);
+    }
+
     if (state.aborted || aborted_depth) {
       break;
     }
+
+    // Soft limit is only consulted here, between iterations; mid-iteration
+    // the watchdog's hard deadline is the sole clock authority.
+    if (state.use_time && state.soft_time_ms > 0 && !state.pondering) {
+      const auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                  std::chrono::steady_clock::now() - state.start_time)
+                                  .count();
+      if (elapsed_ms >= state.soft_time_ms) {
+        break;
+      }
+    }
   }
 
   if (state.aborted && have_completed) {
@@ -1467,7 +2120,7 @@ SearchResult search(Position& root, const Limits& limits, std::atomic<bool>* sto
   }
 
   result.nodes = state.nodes;
-  result.primary_killer = state.killers[0][0];
+  result.primary_killer = state.stack.frame(0).killers[0];
   result.history_bonus = result.best.is_null()
                              ? 0
                              : state.history.get(root.side_to_move(), result.best);
@@ -1481,6 +2134,14 @@ SearchResult search(Position& root, const Limits& limits, std::atomic<bool>* sto
   result.recapture_extensions = state.recapture_extensions;
   result.check_extensions = state.check_extensions;
   result.quiet_penalties = state.quiet_penalties;
+  result.tb_hits = state.tb_hits;
+  // Roll the per-search pruning tallies into the persistent counter block;
+  // the node and TT counters above accumulate there directly.
+  state.stats.null_prunes += state.null_prunes;
+  state.stats.static_futility_prunes += state.static_futility_prunes;
+  state.stats.razor_prunes += state.razor_prunes;
+  state.stats.multi_cut_prunes += state.multi_cut_prunes;
+  state.stats.lmr_reductions += state.lmr_reductions;
   const auto finish_time = std::chrono::steady_clock::now();
   const auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
                               finish_time - state.start_time)
@@ -1499,18 +2160,18 @@ SearchResult search(Position& root, const Limits& limits, std::atomic<bool>* sto
       root.unmake(move, undo);
       if (legal) {
         result.best = move;
-        result.pv.line.clear();
-        result.pv.line.push_back(move);
+        result.pv.clear();
+        result.pv.push_back(move);
         if (result.lines.empty()) {
           PVLine line;
           line.best = move;
-          line.pv.line = result.pv.line;
+          line.pv = result.pv;
           line.eval = result.eval;
           result.lines.push_back(line);
         } else {
           result.lines.front().best = move;
-          if (result.lines.front().pv.line.empty()) {
-            result.lines.front().pv.line = result.pv.line;
+          if (result.lines.front().pv.empty()) {
+            result.lines.front().pv = result.pv;
           }
         }
         break;
@@ -1522,27 +2183,337 @@ SearchResult search(Position& root, const Limits& limits, std::atomic<bool>* sto
   result.tt_hit = tables.tt.probe(root.zobrist(), root_entry);
   if (result.best.is_null() && !root_entry.best_move.is_null()) {
     result.best = root_entry.best_move;
-    result.pv.line.clear();
-    result.pv.line.push_back(root_entry.best_move);
+    result.pv.clear();
+    result.pv.push_back(root_entry.best_move);
     if (result.lines.empty()) {
       PVLine line;
       line.best = root_entry.best_move;
-      line.pv.line = result.pv.line;
+      line.pv = result.pv;
       line.eval = result.eval;
       result.lines.push_back(line);
     } else {
       result.lines.front().best = root_entry.best_move;
-      if (result.lines.front().pv.line.empty()) {
-        result.lines.front().pv.line = result.pv.line;
+      if (result.lines.front().pv.empty()) {
+        result.lines.front().pv = result.pv;
       }
     }
   }
   result.aborted = state.aborted;
 
+  return result;
+}
+
+// All of one worker's persistent search state in a single slab: the
+// SearchState block and the four pointer-attached history tables, carved
+// from one anonymous mapping (transparent-huge-page hinted on Linux,
+// cache-line-aligned heap memory elsewhere). Co-locating a thread's hot
+// tables keeps them out of allocator-scattered pages, and because the slab
+// faults in on the thread that constructs it, the kernel's default local
+// policy places it on that worker's NUMA node — reserve_threads() builds
+// each helper's arena on the pool worker that will use it for exactly this
+// reason. Per-node scratch (move lists, score arrays) stays on the worker's
+// C stack, which is already thread-private and cache-hot.
+class ThreadArena {
+public:
+  ThreadArena() {
+    std::size_t bytes = 0;
+    const std::size_t state_off = carve(bytes, sizeof(SearchState), alignof(SearchState));
+    const std::size_t capture_off =
+        carve(bytes, sizeof(CaptureHistory), alignof(CaptureHistory));
+    const std::size_t correction_off =
+        carve(bytes, sizeof(CorrectionHistory), alignof(CorrectionHistory));
+    const std::size_t counter_off =
+        carve(bytes, sizeof(CounterHistory), alignof(CounterHistory));
+    const std::size_t continuation_off =
+        carve(bytes, sizeof(ContinuationHistory), alignof(ContinuationHistory));
+    allocate(bytes);
+
+    state_ = new (base_ + state_off) SearchState();
+    state_->capture_history = new (base_ + capture_off) CaptureHistory();
+    state_->correction_history = new (base_ + correction_off) CorrectionHistory();
+    state_->counter_history = new (base_ + counter_off) CounterHistory();
+    state_->continuation_history = new (base_ + continuation_off) ContinuationHistory();
+    seed_opening_history(state_->history);
+    state_->see_cache.clear();
+    state_->tb_cache.clear();
+  }
+
+  ~ThreadArena() {
+    if (state_ == nullptr) {
+      return;
+    }
+    CaptureHistory* capture = state_->capture_history;
+    CorrectionHistory* correction = state_->correction_history;
+    CounterHistory* counter = state_->counter_history;
+    ContinuationHistory* continuation = state_->continuation_history;
+    state_->~SearchState();
+    capture->~CaptureHistory();
+    correction->~CorrectionHistory();
+    counter->~CounterHistory();
+    continuation->~ContinuationHistory();
+#if defined(__linux__)
+    if (mapped_) {
+      munmap(base_, bytes_);
+      return;
+    }
+#endif
+    ::operator delete(base_, std::align_val_t{kCacheLine});
+  }
+
+  ThreadArena(const ThreadArena&) = delete;
+  ThreadArena& operator=(const ThreadArena&) = delete;
+
+  [[nodiscard]] SearchState& state() { return *state_; }
+  [[nodiscard]] const SearchState& state() const { return *state_; }
+
+private:
+  static constexpr std::size_t kCacheLine = 64;
+
+  // Reserves a cache-line-aligned block of `size` bytes at the end of the
+  // slab being laid out and returns its offset.
+  static std::size_t carve(std::size_t& bytes, std::size_t size, std::size_t align) {
+    const std::size_t boundary = std::max(align, kCacheLine);
+    const std::size_t offset = (bytes + boundary - 1) & ~(boundary - 1);
+    bytes = offset + size;
+    return offset;
+  }
+
+  void allocate(std::size_t bytes) {
+    bytes_ = bytes;
+#if defined(__linux__)
+    void* mem = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem != MAP_FAILED) {
+#if defined(MADV_HUGEPAGE)
+      madvise(mem, bytes_, MADV_HUGEPAGE);
+#endif
+      base_ = static_cast<unsigned char*>(mem);
+      mapped_ = true;
+      return;
+    }
+#endif
+    base_ = static_cast<unsigned char*>(
+        ::operator new(bytes_, std::align_val_t{kCacheLine}));
+    std::memset(base_, 0, bytes_);
+  }
+
+  unsigned char* base_{nullptr};
+  std::size_t bytes_{0};
+  bool mapped_{false};
+  SearchState* state_{nullptr};
+};
+
+}  // namespace
+
+struct SearchSession::Impl {
+  SearchTables tables;
+  std::vector<std::unique_ptr<ThreadArena>> thread_arenas;
+  std::size_t hash_mb{kDefaultTTMegabytes};
+
+  SearchState& thread_state(std::size_t idx) {
+    if (thread_arenas.size() <= idx) {
+      thread_arenas.resize(idx + 1);
+    }
+    if (thread_arenas[idx] == nullptr) {
+      thread_arenas[idx] = std::make_unique<ThreadArena>();
+    }
+    return thread_arenas[idx]->state();
+  }
+};
+
+SearchSession::SearchSession() : impl_(std::make_unique<Impl>()) {}
+
+SearchSession::~SearchSession() = default;
+
+void SearchSession::reserve_threads(std::size_t thread_count) {
+  thread_count = std::clamp<std::size_t>(thread_count, 1,
+                                         static_cast<std::size_t>(kMaxSearchThreads));
+  impl_->thread_state(0);
+  if (thread_count <= 1) {
+    return;
+  }
+  if (impl_->thread_arenas.size() < thread_count) {
+    impl_->thread_arenas.resize(thread_count);
+  }
+  // Build each helper's arena on the pool worker that will use it: the slab
+  // pages fault in on that worker's (pinned) core, so the kernel's local
+  // policy places them on its NUMA node, and the first go pays no arena
+  // page faults. Every worker writes only its own slot.
+  worker_pool().run(thread_count - 1, [this](std::size_t idx) {
+    if (impl_->thread_arenas[idx + 1] == nullptr) {
+      impl_->thread_arenas[idx + 1] = std::make_unique<ThreadArena>();
+    }
+  });
+}
+
+void SearchSession::set_hash_size(std::size_t megabytes) {
+  impl_->hash_mb = std::max<std::size_t>(1, megabytes);
+  impl_->tables.tt.resize(impl_->hash_mb);
+  impl_->tables.generation = 0;
+  impl_->tables.tt.set_generation(0);
+}
+
+void SearchSession::clear() {
+  impl_->tables.tt.clear();
+  impl_->tables.generation = 0;
+  impl_->tables.tt.set_generation(0);
+  impl_->thread_arenas.clear();
+}
+
+SearchStats SearchSession::stats() const {
+  SearchStats total;
+  for (const auto& arena : impl_->thread_arenas) {
+    if (arena != nullptr) {
+      total.add(arena->state().stats);
+    }
+  }
+  return total;
+}
+
+bool SearchSession::save_hash(const std::string& path) const {
+  return impl_->tables.tt.save(path);
+}
+
+bool SearchSession::load_hash(const std::string& path) {
+  if (!impl_->tables.tt.load(path)) {
+    return false;
+  }
+  impl_->tables.generation = impl_->tables.tt.generation();
+  return true;
+}
+
+SearchResult SearchSession::run(Position& root, const Limits& limits,
+                                std::atomic<bool>* stop_flag,
+                                const SearchProgressFn* progress,
+                                const CurrmoveFn* currmove,
+                                const std::atomic<bool>* ponder_flag) {
+  if (limits.mate > 0) {
+    // `go mate N` is a proof problem, not a scoring one: hand it to the
+    // df-pn solver instead of the iterative-deepening loop. The solver's
+    // proof-number table takes over this session's hash budget.
+    const auto mate_start = std::chrono::steady_clock::now();
+    const MateSearchResult mate = mate_search(
+        root, limits.mate, impl_->hash_mb, limits.nodes, stop_flag);
+    SearchResult result;
+    result.nodes = mate.nodes;
+    result.depth = 2 * limits.mate - 1;
+    result.aborted = mate.aborted;
+    result.elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::steady_clock::now() - mate_start)
+                            .count();
+    if (mate.proven) {
+      result.best = mate.best;
+      result.eval = mate_score(2 * mate.mate_in - 1);
+      result.depth = 2 * mate.mate_in - 1;
+      for (const Move move : mate.line) {
+        result.pv.push_back(move);
+      }
+    }
+    result.lines.push_back(PVLine{result.best, result.pv, result.eval});
+    if (progress != nullptr) {
+      (*progress)(result);
+    }
+    return result;
+  }
+
+  SearchTables& tables = impl_->tables;
+  ++tables.generation;
+  tables.tt.set_generation(tables.generation);
+
+  emit_search_trace_start(root, limits);
+
+  int thread_count = std::clamp(limits.threads, 1, kMaxSearchThreads);
+  // Deterministic node-limited mode: Lazy SMP helpers share the
+  // transposition table, so any helper write can redirect the main worker's
+  // search and two runs diverge — per-thread quotas or iteration barriers
+  // cannot close that hole while the table is shared. The only schedule
+  // whose result is a function of the node budget alone is the main worker
+  // running the full budget by itself, so that is what the mode does; 'go
+  // nodes N' then returns bit-identical results at any configured thread
+  // count.
+  // Clock limits are also dropped: a wall-time abort landing mid-iteration
+  // would make the node budget moot.
+  Limits det_limits;
+  const Limits* active_limits = &limits;
+  if (limits.deterministic && limits.nodes >= 0) {
+    thread_count = 1;
+    det_limits = limits;
+    det_limits.movetime_ms = -1;
+    det_limits.wtime_ms = -1;
+    det_limits.btime_ms = -1;
+    active_limits = &det_limits;
+  }
+  SearchResult result;
+  if (thread_count <= 1) {
+    result = search_root(root, *active_limits, tables, impl_->thread_state(0), stop_flag,
+                         progress, currmove, 0, ponder_flag);
+  } else {
+    // Lazy SMP: helper threads iterate over the same transposition table with
+    // private move-ordering state. Helpers carry no node cap and no clock of
+    // their own; the main worker owns time management and stops them when it
+    // returns.
+    std::atomic<bool> helper_stop{false};
+    // Size the arena vector up front so the workers never mutate it; each
+    // worker then builds its own arena in its slot if reserve_threads() has
+    // not already done so, which first-touches the slab on the right core.
+    if (impl_->thread_arenas.size() < static_cast<std::size_t>(thread_count)) {
+      impl_->thread_arenas.resize(static_cast<std::size_t>(thread_count));
+    }
+    Limits helper_limits = limits;
+    helper_limits.nodes = -1;
+    helper_limits.movetime_ms = -1;
+    helper_limits.wtime_ms = -1;
+    helper_limits.btime_ms = -1;
+
+    const int helper_count = thread_count - 1;
+    std::vector<Position> helper_roots(static_cast<std::size_t>(helper_count), root);
+    std::vector<SearchResult> helper_results(static_cast<std::size_t>(helper_count));
+    // Helpers run on the persistent pool: the workers were spawned at
+    // setoption Threads time and merely wake here, so go pays no thread
+    // create/join and the workers' caches stay warm between searches.
+    ThreadPool& pool = worker_pool();
+    pool.launch(static_cast<std::size_t>(helper_count), [&](std::size_t idx) {
+      helper_results[idx] =
+          search_root(helper_roots[idx], helper_limits, tables,
+                      impl_->thread_state(idx + 1), &helper_stop, nullptr, nullptr,
+                      static_cast<int>(idx) + 1);
+    });
+
+    result = search_root(root, limits, tables, impl_->thread_state(0), stop_flag,
+                         progress, currmove, 0, ponder_flag);
+    helper_stop.store(true, std::memory_order_release);
+    pool.wait();
+
+    std::int64_t total_nodes = result.nodes;
+    for (const SearchResult& helper_result : helper_results) {
+      total_nodes += helper_result.nodes;
+      const bool deeper = helper_result.depth > result.depth;
+      const bool equal_but_better =
+          helper_result.depth == result.depth && helper_result.eval > result.eval;
+      if (!helper_result.best.is_null() &&
+          (result.best.is_null() || deeper || equal_but_better)) {
+        result.best = helper_result.best;
+        result.pv = helper_result.pv;
+        result.lines = helper_result.lines;
+        result.depth = helper_result.depth;
+        result.eval = helper_result.eval;
+      }
+      result.seldepth = std::max(result.seldepth, helper_result.seldepth);
+    }
+    result.nodes = total_nodes;
+  }
+
   emit_search_trace_finish(result);
   return result;
 }
 
+SearchResult search(Position& root, const Limits& limits, std::atomic<bool>* stop_flag,
+                    const SearchProgressFn* progress, const CurrmoveFn* currmove,
+                    const std::atomic<bool>* ponder_flag) {
+  SearchSession session;
+  return session.run(root, limits, stop_flag, progress, currmove, ponder_flag);
+}
+
 void set_singular_margin(int margin) {
   const int clamped = std::clamp(margin, 0, 10000);
   g_singular_margin.store(clamped, std::memory_order_relaxed);
@@ -2,8 +2,12 @@
 // search.h -- Principal variation search driver and shared search result struct.
 // Provides the public entry point used by the UCI front-end and tools.
 
+#include <array>
 #include <atomic>
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "board.h"
@@ -15,8 +19,27 @@
 
 namespace bby {
 
+// Fixed-capacity principal variation. Mirrors MoveList's array-plus-count
+// shape so SearchResult copies — including the per-iteration progress
+// callback — are plain memcpys with no allocator traffic; anything needing
+// a vector builds one at the UCI boundary from begin()/end().
 struct PV {
-  std::vector<Move> line;
+  void clear() { count_ = 0; }
+  void push_back(Move m) {
+    if (count_ < static_cast<std::size_t>(kMaxPly)) {
+      moves_[count_++] = m;
+    }
+  }
+  [[nodiscard]] bool empty() const { return count_ == 0; }
+  [[nodiscard]] std::size_t size() const { return count_; }
+  [[nodiscard]] Move operator[](std::size_t idx) const { return moves_[idx]; }
+  [[nodiscard]] Move front() const { return moves_[0]; }
+  [[nodiscard]] const Move* begin() const { return moves_.data(); }
+  [[nodiscard]] const Move* end() const { return moves_.data() + count_; }
+
+private:
+  std::array<Move, kMaxPly> moves_{};
+  std::size_t count_{0};
 };
 
 struct PVLine {
@@ -43,6 +66,7 @@ struct SearchResult {
   int recapture_extensions{0};
   int check_extensions{0};
   int quiet_penalties{0};
+  int tb_hits{0};
   std::int64_t elapsed_ms{0};
   int hashfull{0};
   bool tt_hit{false};
@@ -51,13 +75,90 @@ struct SearchResult {
   bool aborted{false};
 };
 
+// Cumulative hot-path counters that survive across searches. Every worker
+// thread owns a private block and bumps it with plain increments, so the
+// per-node cost is a handful of cache-resident adds; SearchSession::stats()
+// sums the blocks on demand for the searchstats UCI command. Transposition
+// table rates are bucketed by remaining depth so shallow and deep probe
+// behaviour stay distinguishable.
+struct SearchStats {
+  static constexpr int kTTDepthBands = 4;
+  // Bands cover remaining depth 0-3, 4-7, 8-11, and 12+.
+  static std::size_t tt_depth_band(int depth);
+
+  std::int64_t interior_nodes{0};
+  std::int64_t qsearch_nodes{0};
+  std::array<std::int64_t, kTTDepthBands> tt_probes{};
+  std::array<std::int64_t, kTTDepthBands> tt_hits{};
+  std::array<std::int64_t, kTTDepthBands> tt_cutoffs{};
+  // Where the move loop stopped on a fail-high: first move tried, moves
+  // two through four, or later.
+  std::int64_t beta_cutoffs{0};
+  std::int64_t cutoff_first_move{0};
+  std::int64_t cutoff_moves_2_to_4{0};
+  std::int64_t cutoff_late_moves{0};
+  std::int64_t null_prunes{0};
+  std::int64_t static_futility_prunes{0};
+  std::int64_t razor_prunes{0};
+  std::int64_t multi_cut_prunes{0};
+  std::int64_t lmr_reductions{0};
+
+  void add(const SearchStats& other);
+};
+
 using SearchProgressFn = std::function<void(const SearchResult&)>;
 using CurrmoveFn = std::function<void(Move, int)>;
 
+// Persistent searcher state that survives across go commands: the
+// transposition table, per-thread history/counter tables, and SEE cache all
+// stay warm so move-to-move tree reuse works. Generation-based aging in the
+// TT keeps stale entries replaceable without clearing.
+class SearchSession {
+public:
+  SearchSession();
+  ~SearchSession();
+  SearchSession(const SearchSession&) = delete;
+  SearchSession& operator=(const SearchSession&) = delete;
+
+  // Reallocates the transposition table; existing entries are discarded.
+  void set_hash_size(std::size_t megabytes);
+  // Drops all accumulated state (ucinewgame).
+  void clear();
+
+  // Streams the transposition table to/from disk so an analysis session can
+  // resume at full hashfull after a restart. Both return false on failure.
+  bool save_hash(const std::string& path) const;
+  bool load_hash(const std::string& path);
+
+  // Sums the per-thread counter blocks; cheap enough to call between moves.
+  [[nodiscard]] SearchStats stats() const;
+
+  // Pre-builds the per-thread state arenas for `thread_count` workers, each
+  // constructed on the pool worker that will use it so its pages land on
+  // that worker's NUMA node. Called when the Threads option resizes the
+  // pool; a go with more threads than reserved still works, the late
+  // arenas just fault in during the first search.
+  void reserve_threads(std::size_t thread_count);
+
+  // ponder_flag, when non-null and true at the start of the search, keeps
+  // the clock suspended until the UCI layer clears it on ponderhit.
+  SearchResult run(Position& root, const Limits& limits,
+                   std::atomic<bool>* stop_flag = nullptr,
+                   const SearchProgressFn* progress = nullptr,
+                   const CurrmoveFn* currmove = nullptr,
+                   const std::atomic<bool>* ponder_flag = nullptr);
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+// Convenience wrapper running a one-shot search over a fresh session.
 SearchResult search(Position& root, const Limits& limits,
                     std::atomic<bool>* stop_flag = nullptr,
                     const SearchProgressFn* progress = nullptr,
-                    const CurrmoveFn* currmove = nullptr);
+                    const CurrmoveFn* currmove = nullptr,
+                    const std::atomic<bool>* ponder_flag = nullptr);
 void set_singular_margin(int margin);
 int singular_margin();
 
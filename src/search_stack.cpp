@@ -11,6 +11,7 @@ SearchStack::Frame make_frame() {
   frame.captured = PieceType::None;
   frame.static_eval = 0;
   frame.previous_static_eval = 0;
+  frame.plies_from_null = kMaxPly;
   frame.has_static_eval = false;
   frame.has_previous_eval = false;
   frame.improving = false;
@@ -39,23 +40,55 @@ auto SearchStack::frame(int ply) const -> const Frame& {
 }
 
 void SearchStack::prepare_root() {
-  reset();
-  frames_[0] = make_frame();
+  // Killers persist across iterations of the deepening loop; everything
+  // else starts fresh.
+  for (auto& frame : frames_) {
+    const auto killers = frame.killers;
+    frame = make_frame();
+    frame.killers = killers;
+  }
 }
 
-void SearchStack::prepare_child(int parent_ply, int child_ply, Move move, PieceType captured) {
+void SearchStack::prepare_child(int parent_ply, int child_ply, Move move, Piece moved,
+                                PieceType captured) {
   BBY_ASSERT(parent_ply >= -1 && parent_ply < kMaxPly);
   BBY_ASSERT(child_ply >= 0 && child_ply < kMaxPly);
   Frame& frame = frames_[static_cast<std::size_t>(child_ply)];
+  const auto killers = frame.killers;
+  const Undo undo = frame.undo;
   frame = make_frame();
+  frame.killers = killers;
+  frame.undo = undo;
   frame.parent_move = move;
+  frame.parent_piece = moved;
   frame.captured = captured;
+  if (move.is_null()) {
+    frame.plies_from_null = 0;
+  } else if (parent_ply >= 0) {
+    const int parent_plies =
+        frames_[static_cast<std::size_t>(parent_ply)].plies_from_null;
+    frame.plies_from_null = parent_plies < kMaxPly ? parent_plies + 1 : kMaxPly;
+  }
   if (child_ply >= 2 && frames_[static_cast<std::size_t>(child_ply - 2)].has_static_eval) {
     frame.previous_static_eval = frames_[static_cast<std::size_t>(child_ply - 2)].static_eval;
     frame.has_previous_eval = true;
   }
 }
 
+auto SearchStack::save_killers() const -> KillerSnapshot {
+  KillerSnapshot snapshot;
+  for (std::size_t ply = 0; ply < frames_.size(); ++ply) {
+    snapshot[ply] = frames_[ply].killers;
+  }
+  return snapshot;
+}
+
+void SearchStack::restore_killers(const KillerSnapshot& snapshot) {
+  for (std::size_t ply = 0; ply < frames_.size(); ++ply) {
+    frames_[ply].killers = snapshot[ply];
+  }
+}
+
 void SearchStack::set_static_eval(int ply, Score eval) {
   BBY_ASSERT(ply >= 0 && ply < kMaxPly);
   Frame& frame = frames_[static_cast<std::size_t>(ply)];
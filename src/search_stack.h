@@ -18,16 +18,38 @@ namespace bby {
 
 class SearchStack {
 public:
-  struct Frame {
+  // One cache-aligned block per ply so a node's bookkeeping — eval trend,
+  // parent-move context, killers, and the undo record for the move that
+  // reached it — lands on one or two lines instead of four scattered
+  // structures. Killers and undo survive prepare_child's reset: killers
+  // persist across siblings and iterations, undo is written by make()
+  // before the frame is prepared.
+  struct alignas(64) Frame {
     Move parent_move{};
+    // Piece standing on parent_move's target after it was played (the
+    // promoted piece for promotions); feeds counter/continuation history.
+    Piece parent_piece{Piece::None};
     PieceType captured{PieceType::None};
     Score static_eval{0};
     Score previous_static_eval{0};
+    // Plies since the last null move on the path (kMaxPly when none);
+    // bounds how far repetition scans may reach back.
+    int plies_from_null{kMaxPly};
+    // Legal moves searched at this node so far; exposed for move-count
+    // aware heuristics and SMP introspection.
+    int move_count{0};
+    std::array<Move, 2> killers{};
+    Undo undo{};
     bool has_static_eval{false};
     bool has_previous_eval{false};
     bool improving{false};
   };
 
+  // Snapshot of every ply's killer slots; probe searches (singular,
+  // multi-cut) save and restore one so their speculative subtrees do not
+  // pollute the real move ordering.
+  using KillerSnapshot = std::array<std::array<Move, 2>, kMaxPly>;
+
   SearchStack();
 
   void reset();
@@ -37,7 +59,11 @@ public:
 
   void prepare_root();
 
-  void prepare_child(int parent_ply, int child_ply, Move move, PieceType captured);
+  void prepare_child(int parent_ply, int child_ply, Move move, Piece moved,
+                     PieceType captured);
+
+  [[nodiscard]] KillerSnapshot save_killers() const;
+  void restore_killers(const KillerSnapshot& snapshot);
 
   void set_static_eval(int ply, Score eval);
 
@@ -10,6 +10,7 @@ inline constexpr int kLmrMinDepthDefault = 2;
 inline constexpr int kLmrMinMoveDefault = 2;
 
 struct Limits {
+  int threads{1};
   std::int64_t movetime_ms{-1};
   std::int64_t nodes{-1};
   std::int16_t depth{-1};
@@ -47,6 +48,13 @@ struct Limits {
   int recapture_extension_depth{4};
   int check_extension_depth{3};
   bool infinite{false};
+  // This go is a ponder search: clock rules are suspended until ponderhit
+  // flips the session's ponder flag, and the budget gets a ponder-hit bonus.
+  bool ponder{false};
+  // Node-limited searches must return bit-identical results at any thread
+  // count, for reproducible A/B comparisons; SearchSession::run documents
+  // how the mode enforces this.
+  bool deterministic{false};
 };
 
 struct SearchKnobs {
@@ -0,0 +1,551 @@
+#include "selfplay.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bbinit.h"
+#include "board.h"
+#include "epd.h"
+#include "pgn.h"
+#include "search.h"
+#include "searchparams.h"
+#include "threadpool.h"
+#include "tune.h"
+
+namespace bby {
+
+namespace {
+
+constexpr const char* kStartFen =
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// Past this many plies an undecided game scores as a draw.
+constexpr int kMaxGamePlies = 400;
+
+struct MatchConfig {
+  std::string book_path;
+  std::string profile_a;
+  std::string profile_b;
+  std::string pgn_path;
+  int games{100};
+  std::int64_t tc_ms{1000};
+  std::int64_t inc_ms{10};
+  std::int64_t nodes_per_move{-1};
+  int threads{0};
+  std::size_t hash_mb{16};
+  std::uint64_t seed{0x9e3779b97f4a7c15ULL};
+  bool sprt{false};
+  int elo0{0};
+  int elo1{5};
+};
+
+struct GameRecord {
+  // 1, 0.5 or 0 from profile A's perspective; <0 while unplayed.
+  double score_a{-1.0};
+  bool a_is_white{true};
+  bool time_forfeit{false};
+  std::size_t opening_line{0};
+  std::string start_fen;
+  int first_fullmove{1};
+  bool black_to_move{false};
+  std::vector<std::string> san;
+  std::string result{"*"};
+  std::string termination;
+};
+
+bool parse_int(std::string_view token, long long& out) {
+  if (token.empty()) {
+    return false;
+  }
+  char* end = nullptr;
+  const std::string copy(token);
+  const long long value = std::strtoll(copy.c_str(), &end, 10);
+  if (end == copy.c_str() || (end && *end != '\0')) {
+    return false;
+  }
+  out = value;
+  return true;
+}
+
+MatchConfig parse_cli_arguments(int argc, const char* argv[]) {
+  MatchConfig cfg;
+  for (int idx = 0; idx < argc; ++idx) {
+    std::string_view arg(argv[idx]);
+    auto consume_next = [&](long long& out) -> bool {
+      if (idx + 1 >= argc) {
+        return false;
+      }
+      ++idx;
+      return parse_int(argv[idx], out);
+    };
+
+    if (arg == "--games") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.games = static_cast<int>(std::max<long long>(2, value));
+      }
+    } else if (arg == "--tc") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.tc_ms = std::max<long long>(10, value);
+      }
+    } else if (arg == "--inc") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.inc_ms = std::max<long long>(0, value);
+      }
+    } else if (arg == "--nodes") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.nodes_per_move = std::max<long long>(64, value);
+      }
+    } else if (arg == "--threads") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.threads = static_cast<int>(std::clamp<long long>(value, 1, 512));
+      }
+    } else if (arg == "--hash") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.hash_mb = static_cast<std::size_t>(std::max<long long>(1, value));
+      }
+    } else if (arg == "--seed") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.seed = static_cast<std::uint64_t>(value);
+      }
+    } else if (arg == "--elo0") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.elo0 = static_cast<int>(value);
+      }
+    } else if (arg == "--elo1") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.elo1 = static_cast<int>(value);
+      }
+    } else if (arg == "--sprt") {
+      cfg.sprt = true;
+    } else if (arg == "--profile-a") {
+      if (idx + 1 < argc) {
+        cfg.profile_a = argv[++idx];
+      }
+    } else if (arg == "--profile-b") {
+      if (idx + 1 < argc) {
+        cfg.profile_b = argv[++idx];
+      }
+    } else if (arg == "--pgn") {
+      if (idx + 1 < argc) {
+        cfg.pgn_path = argv[++idx];
+      }
+    } else if (arg == "--help" || arg == "-h") {
+      std::printf("Usage: bby selfplay BOOK.epd [--games N] [--tc MS] [--inc MS]\n");
+      std::printf("                    [--nodes PER-MOVE] [--threads N] [--hash MB]\n");
+      std::printf("                    [--profile-a FILE] [--profile-b FILE]\n");
+      std::printf("                    [--sprt] [--elo0 E] [--elo1 E]\n");
+      std::printf("                    [--pgn FILE] [--seed S]\n");
+      std::fflush(stdout);
+      std::exit(0);
+    } else if (cfg.book_path.empty()) {
+      cfg.book_path = std::string(arg);
+    }
+  }
+  return cfg;
+}
+
+// Applies a profile of `setoption name <Name> value <int>` lines (the format
+// the tuner snapshots) on top of `limits`. Bare `<Name> = <int>` lines are
+// accepted too; blank lines and '#' comments are skipped.
+bool load_profile(const std::string& path, Limits& limits) {
+  std::ifstream in(path);
+  if (!in) {
+    std::fprintf(stderr, "selfplay: cannot open profile %s\n", path.c_str());
+    return false;
+  }
+  std::string line;
+  std::size_t line_no = 0;
+  while (std::getline(in, line)) {
+    ++line_no;
+    while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) {
+      line.pop_back();
+    }
+    if (line.empty() || line.front() == '#') {
+      continue;
+    }
+    std::string name;
+    std::string value_text;
+    const std::string_view view(line);
+    if (view.rfind("setoption name ", 0) == 0) {
+      const std::size_t value_at = view.rfind(" value ");
+      if (value_at == std::string_view::npos || value_at <= 15) {
+        std::fprintf(stderr, "selfplay: %s:%zu: malformed setoption line\n",
+                     path.c_str(), line_no);
+        return false;
+      }
+      name = std::string(view.substr(15, value_at - 15));
+      value_text = std::string(view.substr(value_at + 7));
+    } else {
+      const std::size_t eq = view.find('=');
+      if (eq == std::string_view::npos) {
+        std::fprintf(stderr, "selfplay: %s:%zu: expected NAME = VALUE\n",
+                     path.c_str(), line_no);
+        return false;
+      }
+      name = std::string(view.substr(0, eq));
+      value_text = std::string(view.substr(eq + 1));
+      while (!name.empty() && name.back() == ' ') {
+        name.pop_back();
+      }
+      while (!value_text.empty() && value_text.front() == ' ') {
+        value_text.erase(value_text.begin());
+      }
+    }
+    long long value = 0;
+    if (!parse_int(value_text, value)) {
+      std::fprintf(stderr, "selfplay: %s:%zu: non-integer value '%s'\n",
+                   path.c_str(), line_no, value_text.c_str());
+      return false;
+    }
+    bool matched = false;
+    for (const TunableSpec& spec : limits_tunables()) {
+      if (name == spec.name) {
+        limits.*(spec.field) = static_cast<int>(
+            std::clamp<long long>(value, spec.min, spec.max));
+        matched = true;
+        break;
+      }
+    }
+    if (!matched) {
+      std::fprintf(stderr, "selfplay: %s:%zu: unknown parameter '%s'\n",
+                   path.c_str(), line_no, name.c_str());
+      return false;
+    }
+  }
+  return true;
+}
+
+// Fishtest-style trinomial SPRT: the draw rate is folded into a BayesElo
+// draw parameter estimated from the observed results, and the LLR compares
+// H1 (elo = elo1) against H0 (elo = elo0) on the logistic scale.
+double sprt_llr(int wins, int draws, int losses, double elo0, double elo1) {
+  const int total = wins + draws + losses;
+  if (wins == 0 || draws == 0 || losses == 0 || total == 0) {
+    return 0.0;
+  }
+  const double w = static_cast<double>(wins) / total;
+  const double l = static_cast<double>(losses) / total;
+  const double drawelo = 200.0 * std::log10((1.0 - l) / l * (1.0 - w) / w);
+  const double x = std::pow(10.0, -drawelo / 400.0);
+  const double scale = 4.0 * x / ((1.0 + x) * (1.0 + x));
+  const auto probs = [drawelo](double belo, double& pw, double& pd, double& pl) {
+    pw = 1.0 / (1.0 + std::pow(10.0, (drawelo - belo) / 400.0));
+    pl = 1.0 / (1.0 + std::pow(10.0, (drawelo + belo) / 400.0));
+    pd = 1.0 - pw - pl;
+  };
+  double pw0 = 0.0;
+  double pd0 = 0.0;
+  double pl0 = 0.0;
+  double pw1 = 0.0;
+  double pd1 = 0.0;
+  double pl1 = 0.0;
+  probs(elo0 / scale, pw0, pd0, pl0);
+  probs(elo1 / scale, pw1, pd1, pl1);
+  return wins * std::log(pw1 / pw0) + draws * std::log(pd1 / pd0) +
+         losses * std::log(pl1 / pl0);
+}
+
+// Plays one timed game, recording SAN as it goes. `record.a_is_white`
+// decides which profile drives which clock; the score lands in
+// `record.score_a`.
+void play_game(Position pos, SearchSession& white, SearchSession& black,
+               const Limits& white_limits, const Limits& black_limits,
+               const MatchConfig& cfg, GameRecord& record) {
+  record.start_fen = pos.to_fen();
+  record.first_fullmove = pos.fullmove_number();
+  record.black_to_move = pos.side_to_move() == Color::Black;
+
+  std::int64_t white_clock = cfg.tc_ms;
+  std::int64_t black_clock = cfg.tc_ms;
+  std::vector<std::uint64_t> history;
+  history.reserve(kMaxGamePlies + 1);
+  history.push_back(pos.zobrist());
+
+  const auto finish = [&](double white_score, const char* why) {
+    record.score_a = record.a_is_white ? white_score : 1.0 - white_score;
+    record.result = (white_score == 1.0)   ? "1-0"
+                    : (white_score == 0.0) ? "0-1"
+                                           : "1/2-1/2";
+    record.termination = why;
+  };
+
+  for (int game_ply = 0; game_ply < kMaxGamePlies; ++game_ply) {
+    MoveList moves;
+    pos.generate_moves(moves, GenStage::All);
+    bool any_legal = false;
+    for (std::size_t idx = 0; idx < moves.size(); ++idx) {
+      if (pos.is_legal(moves[idx])) {
+        any_legal = true;
+        break;
+      }
+    }
+    const Color stm = pos.side_to_move();
+    if (!any_legal) {
+      if (pos.in_check(stm)) {
+        finish(stm == Color::White ? 0.0 : 1.0, "checkmate");
+      } else {
+        finish(0.5, "stalemate");
+      }
+      return;
+    }
+    if (pos.halfmove_clock() >= 100) {
+      finish(0.5, "50-move rule");
+      return;
+    }
+    int repeats = 0;
+    for (const std::uint64_t key : history) {
+      repeats += (key == pos.zobrist()) ? 1 : 0;
+    }
+    if (repeats >= 3) {
+      finish(0.5, "threefold repetition");
+      return;
+    }
+
+    SearchSession& session = (stm == Color::White) ? white : black;
+    Limits limits = (stm == Color::White) ? white_limits : black_limits;
+    if (cfg.nodes_per_move > 0) {
+      limits.nodes = cfg.nodes_per_move;
+    } else {
+      limits.wtime_ms = std::max<std::int64_t>(1, white_clock);
+      limits.btime_ms = std::max<std::int64_t>(1, black_clock);
+      limits.winc_ms = cfg.inc_ms;
+      limits.binc_ms = cfg.inc_ms;
+    }
+
+    const auto move_start = std::chrono::steady_clock::now();
+    Position search_pos = pos;
+    const SearchResult result = session.run(search_pos, limits);
+    const std::int64_t spent =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - move_start)
+            .count();
+    if (cfg.nodes_per_move <= 0) {
+      std::int64_t& clock = (stm == Color::White) ? white_clock : black_clock;
+      clock -= spent;
+      if (clock < 0) {
+        record.time_forfeit = true;
+        finish(stm == Color::White ? 0.0 : 1.0, "time forfeit");
+        return;
+      }
+      clock += cfg.inc_ms;
+    }
+    if (result.best.is_null()) {
+      finish(0.5, "no move returned");
+      return;
+    }
+    record.san.push_back(move_to_san(pos, result.best));
+    Undo undo;
+    pos.make(result.best, undo);
+    history.push_back(pos.zobrist());
+  }
+  finish(0.5, "move limit");
+}
+
+void dump_pgn(std::ostream& out, const MatchConfig& cfg,
+              const std::vector<GameRecord>& games) {
+  for (std::size_t idx = 0; idx < games.size(); ++idx) {
+    const GameRecord& game = games[idx];
+    if (game.score_a < 0.0) {
+      continue;
+    }
+    std::vector<std::pair<std::string, std::string>> tags;
+    tags.emplace_back("Event", "bby selfplay gate");
+    tags.emplace_back("Site", "in-process");
+    tags.emplace_back("Round", std::to_string(idx + 1));
+    tags.emplace_back("White", game.a_is_white ? "bby-a" : "bby-b");
+    tags.emplace_back("Black", game.a_is_white ? "bby-b" : "bby-a");
+    tags.emplace_back("Result", game.result);
+    if (game.start_fen != kStartFen) {
+      tags.emplace_back("SetUp", "1");
+      tags.emplace_back("FEN", game.start_fen);
+    }
+    if (cfg.nodes_per_move > 0) {
+      tags.emplace_back("TimeControl", "nodes=" + std::to_string(cfg.nodes_per_move));
+    } else {
+      std::ostringstream tc;
+      tc << static_cast<double>(cfg.tc_ms) / 1000.0 << '+'
+         << static_cast<double>(cfg.inc_ms) / 1000.0;
+      tags.emplace_back("TimeControl", tc.str());
+    }
+    tags.emplace_back("Termination", game.termination);
+    write_pgn_game(out, tags, game.san, game.result, game.first_fullmove,
+                   game.black_to_move);
+  }
+}
+
+}  // namespace
+
+int selfplay_cli_main(int argc, const char* argv[]) {
+  (void)initialize();
+  const MatchConfig cfg = parse_cli_arguments(argc, argv);
+  if (cfg.book_path.empty()) {
+    std::fprintf(stderr, "selfplay: missing opening book EPD argument\n");
+    return 2;
+  }
+
+  const EpdMapResult book = map_epd_file(cfg.book_path);
+  for (const EpdLoadError& error : book.errors) {
+    std::fprintf(stderr, "selfplay: line %zu: %s\n", error.line,
+                 error.message.c_str());
+  }
+  const auto& openings = book.file.records();
+  if (openings.empty()) {
+    std::fprintf(stderr, "selfplay: no openings in %s\n", cfg.book_path.c_str());
+    return 2;
+  }
+
+  Limits limits_a;
+  limits_a.threads = 1;
+  Limits limits_b;
+  limits_b.threads = 1;
+  if (!cfg.profile_a.empty() && !load_profile(cfg.profile_a, limits_a)) {
+    return 2;
+  }
+  if (!cfg.profile_b.empty() && !load_profile(cfg.profile_b, limits_b)) {
+    return 2;
+  }
+
+  const int threads =
+      (cfg.threads > 0)
+          ? cfg.threads
+          : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+  // Two sessions per worker, one per profile. Built on this thread because
+  // resizing a transposition table clears it through worker_pool(), which
+  // must not be re-entered from a pool worker.
+  std::vector<std::unique_ptr<SearchSession>> sessions;
+  sessions.reserve(static_cast<std::size_t>(threads) * 2);
+  for (int idx = 0; idx < threads * 2; ++idx) {
+    sessions.push_back(std::make_unique<SearchSession>());
+    sessions.back()->set_hash_size(cfg.hash_mb);
+  }
+
+  // Games come in color-swapped pairs on the same opening so book bias
+  // cancels; an even total keeps the pairs whole.
+  const int total_games = cfg.games + (cfg.games % 2);
+  std::vector<GameRecord> games(static_cast<std::size_t>(total_games));
+  std::atomic<int> next_game{0};
+  std::atomic<bool> stop{false};
+  std::atomic<int> wins{0};
+  std::atomic<int> draws{0};
+  std::atomic<int> losses{0};
+  std::mutex report_mutex;
+  const double llr_lower = std::log(0.05 / 0.95);
+  const double llr_upper = std::log(0.95 / 0.05);
+  const auto wall_start = std::chrono::steady_clock::now();
+
+  worker_pool().run(static_cast<std::size_t>(threads), [&](std::size_t worker) {
+    SearchSession& session_a = *sessions[worker * 2];
+    SearchSession& session_b = *sessions[worker * 2 + 1];
+    while (!stop.load(std::memory_order_relaxed)) {
+      const int game_index = next_game.fetch_add(1);
+      if (game_index >= total_games) {
+        break;
+      }
+      GameRecord& record = games[static_cast<std::size_t>(game_index)];
+      record.a_is_white = (game_index % 2) == 0;
+      const std::size_t opening_index =
+          (cfg.seed + static_cast<std::size_t>(game_index / 2)) % openings.size();
+      const EpdFile::Record& opening = openings[opening_index];
+      record.opening_line = opening.line;
+      Position start;
+      try {
+        start = book.file.position(opening);
+      } catch (const std::exception& ex) {
+        std::lock_guard<std::mutex> lock(report_mutex);
+        std::fprintf(stderr, "selfplay: opening line %zu: %s\n", opening.line,
+                     ex.what());
+        continue;
+      }
+      if (record.a_is_white) {
+        play_game(start, session_a, session_b, limits_a, limits_b, cfg, record);
+      } else {
+        play_game(start, session_b, session_a, limits_b, limits_a, cfg, record);
+      }
+      if (record.score_a > 0.75) {
+        wins.fetch_add(1);
+      } else if (record.score_a < 0.25) {
+        losses.fetch_add(1);
+      } else {
+        draws.fetch_add(1);
+      }
+
+      const int w = wins.load();
+      const int d = draws.load();
+      const int l = losses.load();
+      const double llr = sprt_llr(w, d, l, cfg.elo0, cfg.elo1);
+      if (cfg.sprt && (llr <= llr_lower || llr >= llr_upper)) {
+        stop.store(true, std::memory_order_relaxed);
+      }
+      {
+        std::lock_guard<std::mutex> lock(report_mutex);
+        std::printf("game %d/%d %s (%s) score A %d-%d-%d llr=%.2f\n",
+                    w + d + l, total_games, record.result.c_str(),
+                    record.termination.c_str(), w, l, d, llr);
+        std::fflush(stdout);
+      }
+    }
+  });
+
+  const auto wall_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::steady_clock::now() - wall_start)
+                           .count();
+  const int w = wins.load();
+  const int d = draws.load();
+  const int l = losses.load();
+  const int played = w + d + l;
+  const double score =
+      (played > 0) ? (w + 0.5 * d) / static_cast<double>(played) : 0.5;
+  const double llr = sprt_llr(w, d, l, cfg.elo0, cfg.elo1);
+  double elo = 0.0;
+  if (score > 0.0 && score < 1.0) {
+    elo = -400.0 * std::log10(1.0 / score - 1.0);
+  }
+  std::printf("finished %d games in %lld ms on %d threads\n", played,
+              static_cast<long long>(wall_ms), threads);
+  std::printf("score A vs B: %d-%d-%d (%.1f%%) elo %+.1f llr %.2f\n", w, l, d,
+              score * 100.0, elo, llr);
+  if (cfg.sprt) {
+    const char* verdict = (llr >= llr_upper)   ? "H1 accepted"
+                          : (llr <= llr_lower) ? "H0 accepted"
+                                               : "inconclusive";
+    std::printf("sprt elo0=%d elo1=%d: %s\n", cfg.elo0, cfg.elo1, verdict);
+  }
+  std::fflush(stdout);
+
+  if (!cfg.pgn_path.empty()) {
+    std::ofstream pgn(cfg.pgn_path);
+    if (pgn) {
+      dump_pgn(pgn, cfg, games);
+    } else {
+      std::fprintf(stderr, "selfplay: failed to open %s for writing\n",
+                   cfg.pgn_path.c_str());
+    }
+  }
+  return 0;
+}
+
+}  // namespace bby
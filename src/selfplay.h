@@ -0,0 +1,10 @@
+#pragma once
+// selfplay.h -- In-process parallel match runner for regression gating.
+
+namespace bby {
+
+// Entry point for `bby selfplay BOOK.epd [flags]`. argv excludes the
+// program name and the mode token. Returns a process exit code.
+int selfplay_cli_main(int argc, const char* argv[]);
+
+}  // namespace bby
@@ -1,11 +1,462 @@
 #include "syzygy/tbprobe.h"
 
-#include "syzygy/tbcore.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+#include "attacks.h"
 
 namespace bby::syzygy {
+namespace {
+
+// Values are distance-to-mate from the side to move: kMateBase - plies for a
+// win, the negation for a loss, zero for a draw. Invalid states (overlapping
+// squares, touching kings, side not to move in check) keep kInvalidValue.
+constexpr std::int16_t kMateBase = 30000;
+constexpr std::int16_t kUnknownValue = std::numeric_limits<std::int16_t>::min();
+constexpr std::int16_t kInvalidValue = kUnknownValue + 1;
+constexpr int kStatesPerTable = 2 * 64 * 64 * 64;
+constexpr int kMaxResolutionPlies = 160;
+
+// White is always the strong side in the generated tables; probes mirror
+// black-strong positions vertically before the lookup.
+enum TableId : int { kTableQ = 0, kTableR, kTableB, kTableN, kTableP, kTableCount };
+
+std::array<std::vector<std::int16_t>, kTableCount> g_tables;
+std::once_flag g_build_once;
+
+int table_index(int stm, int wk, int bk, int psq) {
+  return ((stm * 64 + wk) * 64 + bk) * 64 + psq;
+}
+
+Square sq(int s) { return static_cast<Square>(s); }
+
+int pop_square(Bitboard& bb) {
+  const int s = std::countr_zero(bb);
+  bb &= bb - 1;
+  return s;
+}
+
+Bitboard piece_attack_set(int table, int from, Bitboard occ) {
+  switch (table) {
+    case kTableQ:
+      return rook_attacks(sq(from), occ) | bishop_attacks(sq(from), occ);
+    case kTableR:
+      return rook_attacks(sq(from), occ);
+    case kTableB:
+      return bishop_attacks(sq(from), occ);
+    case kTableN:
+      return knight_attacks(sq(from));
+    default:
+      return pawn_attacks(Color::White, sq(from));
+  }
+}
+
+bool black_in_check(int table, int wk, int bk, int psq) {
+  const Bitboard occ = bit(sq(wk)) | bit(sq(bk)) | bit(sq(psq));
+  return (piece_attack_set(table, psq, occ) & bit(sq(bk))) != 0ULL;
+}
+
+// stm: 0 = white (strong side) to move, 1 = black to move. A state is valid
+// when the squares are distinct, the kings do not touch, pawns sit on ranks
+// 2-7, and the side that is not on move is not in check (with a bare black
+// king, only white to move can violate that).
+bool valid_state(int table, int stm, int wk, int bk, int psq) {
+  if (wk == bk || wk == psq || bk == psq) {
+    return false;
+  }
+  if ((king_attacks(sq(wk)) & bit(sq(bk))) != 0ULL) {
+    return false;
+  }
+  if (table == kTableP) {
+    const int rank = psq >> 3;
+    if (rank == 0 || rank == 7) {
+      return false;
+    }
+  }
+  if (stm == 0 && black_in_check(table, wk, bk, psq)) {
+    return false;
+  }
+  return true;
+}
+
+// Value of making a move into a child state whose (opponent-perspective)
+// value is known: wins shorten by a ply, losses lengthen by a ply.
+std::int16_t move_value(std::int16_t child) {
+  if (child == 0) {
+    return 0;
+  }
+  return child > 0 ? static_cast<std::int16_t>(-(child - 1))
+                   : static_cast<std::int16_t>(-(child + 1));
+}
+
+int plies_of(std::int16_t value) {
+  return value == 0 ? 0 : kMateBase - (value < 0 ? -value : value);
+}
+
+// Retrograde generation. Terminal states seed per-ply buckets, then every
+// resolved state relaxes its predecessors in distance-to-mate order.
+// Promotions and king-takes-piece captures leave the table and are folded in
+// as pre-resolved "external" children during initialisation (the non-pawn
+// tables are built first so promotion lookups read final values).
+void build_table(int table) {
+  auto& value = g_tables[static_cast<std::size_t>(table)];
+  value.assign(kStatesPerTable, kUnknownValue);
+  std::vector<std::uint8_t> pending(kStatesPerTable, 0);
+  std::vector<std::int16_t> loss_acc(kStatesPerTable, kUnknownValue);
+  std::vector<std::uint8_t> has_draw(kStatesPerTable, 0);
+  std::vector<std::vector<std::int32_t>> buckets(kMaxResolutionPlies);
+
+  const auto resolve = [&](int idx, std::int16_t v) {
+    value[static_cast<std::size_t>(idx)] = v;
+    const int plies = plies_of(v);
+    BBY_ASSERT(plies >= 0 && plies < kMaxResolutionPlies);
+    buckets[static_cast<std::size_t>(plies)].push_back(idx);
+  };
+
+  for (int stm = 0; stm < 2; ++stm) {
+    for (int wk = 0; wk < 64; ++wk) {
+      for (int bk = 0; bk < 64; ++bk) {
+        for (int psq = 0; psq < 64; ++psq) {
+          const int idx = table_index(stm, wk, bk, psq);
+          if (!valid_state(table, stm, wk, bk, psq)) {
+            value[static_cast<std::size_t>(idx)] = kInvalidValue;
+            continue;
+          }
+
+          int internal = 0;
+          int total = 0;
+          std::int16_t win_ext = kUnknownValue;
+          std::int16_t loss_ext = kUnknownValue;
+          bool draw_ext = false;
+          const auto external = [&](std::int16_t child) {
+            ++total;
+            const std::int16_t mv = move_value(child);
+            if (mv > 0) {
+              win_ext = std::max(win_ext, mv);
+            } else if (mv == 0) {
+              draw_ext = true;
+            } else {
+              loss_ext = std::max(loss_ext, mv);
+            }
+          };
+
+          if (stm == 0) {
+            // White king steps that keep the kings apart and skip the piece.
+            const Bitboard king_to = king_attacks(sq(wk)) & ~bit(sq(psq)) &
+                                     ~bit(sq(bk)) & ~king_attacks(sq(bk));
+            internal += std::popcount(king_to);
+            if (table == kTableP) {
+              const int rank = psq >> 3;
+              const int push = psq + 8;
+              if (push != wk && push != bk) {
+                if (rank == 6) {
+                  for (int promo = kTableQ; promo <= kTableN; ++promo) {
+                    external(g_tables[static_cast<std::size_t>(promo)]
+                                     [static_cast<std::size_t>(
+                                         table_index(1, wk, bk, push))]);
+                  }
+                } else {
+                  ++internal;
+                  if (rank == 1) {
+                    const int jump = psq + 16;
+                    if (jump != wk && jump != bk) {
+                      ++internal;
+                    }
+                  }
+                }
+              }
+            } else {
+              const Bitboard occ = bit(sq(wk)) | bit(sq(bk)) | bit(sq(psq));
+              const Bitboard piece_to =
+                  piece_attack_set(table, psq, occ) & ~bit(sq(wk)) & ~bit(sq(bk));
+              internal += std::popcount(piece_to);
+            }
+          } else {
+            // Black has only the king: steps away from the white king that
+            // dodge the piece's attacks, plus capturing an undefended piece.
+            Bitboard king_to =
+                king_attacks(sq(bk)) & ~bit(sq(wk)) & ~king_attacks(sq(wk));
+            while (king_to != 0ULL) {
+              const int to = pop_square(king_to);
+              if (to == psq) {
+                external(0);  // piece captured; KvK is drawn
+                continue;
+              }
+              const Bitboard occ = bit(sq(wk)) | bit(sq(psq));
+              if ((piece_attack_set(table, psq, occ) & bit(sq(to))) != 0ULL) {
+                continue;  // stepping into check
+              }
+              ++internal;
+            }
+          }
+          total += internal;
+
+          if (total == 0) {
+            const bool mated = stm == 1 && black_in_check(table, wk, bk, psq);
+            resolve(idx, mated ? static_cast<std::int16_t>(-kMateBase)
+                               : static_cast<std::int16_t>(0));
+            continue;
+          }
+          pending[static_cast<std::size_t>(idx)] =
+              static_cast<std::uint8_t>(internal);
+          loss_acc[static_cast<std::size_t>(idx)] = loss_ext;
+          has_draw[static_cast<std::size_t>(idx)] = draw_ext ? 1 : 0;
+          if (win_ext != kUnknownValue) {
+            resolve(idx, win_ext);
+          } else if (internal == 0 && !draw_ext) {
+            resolve(idx, loss_ext);
+          }
+        }
+      }
+    }
+  }
+
+  // Relax predecessors in resolution order. A losing child makes the parent
+  // a win immediately; winning children only decide the parent once every
+  // move is known to lose and no drawing escape exists.
+  const auto relax = [&](int pred, std::int16_t child_value) {
+    if (value[static_cast<std::size_t>(pred)] != kUnknownValue) {
+      return;
+    }
+    const std::int16_t mv = move_value(child_value);
+    if (mv > 0) {
+      resolve(pred, mv);
+    } else if (mv == 0) {
+      has_draw[static_cast<std::size_t>(pred)] = 1;
+    } else {
+      loss_acc[static_cast<std::size_t>(pred)] =
+          std::max(loss_acc[static_cast<std::size_t>(pred)], mv);
+      BBY_ASSERT(pending[static_cast<std::size_t>(pred)] > 0);
+      if (--pending[static_cast<std::size_t>(pred)] == 0 &&
+          has_draw[static_cast<std::size_t>(pred)] == 0) {
+        resolve(pred, loss_acc[static_cast<std::size_t>(pred)]);
+      }
+    }
+  };
+
+  for (int ply = 0; ply < kMaxResolutionPlies; ++ply) {
+    auto& bucket = buckets[static_cast<std::size_t>(ply)];
+    for (std::size_t qi = 0; qi < bucket.size(); ++qi) {
+      const int idx = bucket[qi];
+      const std::int16_t v = value[static_cast<std::size_t>(idx)];
+      const int stm = idx >> 18;
+      const int wk = (idx >> 12) & 63;
+      const int bk = (idx >> 6) & 63;
+      const int psq = idx & 63;
+      if (stm == 1) {
+        // White moved into this state: king from an adjacent square, or the
+        // piece back along its attack lines (pawns retract pushes).
+        Bitboard from = king_attacks(sq(wk)) & ~bit(sq(bk)) & ~bit(sq(psq));
+        while (from != 0ULL) {
+          const int f = pop_square(from);
+          if (valid_state(table, 0, f, bk, psq)) {
+            relax(table_index(0, f, bk, psq), v);
+          }
+        }
+        if (table == kTableP) {
+          const int rank = psq >> 3;
+          if (rank >= 2) {
+            const int f = psq - 8;
+            if (f != wk && f != bk && valid_state(table, 0, wk, bk, f)) {
+              relax(table_index(0, wk, bk, f), v);
+            }
+            if (rank == 3) {
+              const int f2 = psq - 16;
+              const int mid = psq - 8;
+              if (f2 != wk && f2 != bk && mid != wk && mid != bk &&
+                  valid_state(table, 0, wk, bk, f2)) {
+                relax(table_index(0, wk, bk, f2), v);
+              }
+            }
+          }
+        } else {
+          const Bitboard occ = bit(sq(wk)) | bit(sq(bk));
+          Bitboard from_piece = piece_attack_set(table, psq, occ) & ~occ;
+          while (from_piece != 0ULL) {
+            const int f = pop_square(from_piece);
+            if (valid_state(table, 0, wk, bk, f)) {
+              relax(table_index(0, wk, bk, f), v);
+            }
+          }
+        }
+      } else {
+        // Black moved into this state: only the bare king could have moved.
+        Bitboard from = king_attacks(sq(bk)) & ~bit(sq(wk)) & ~bit(sq(psq));
+        while (from != 0ULL) {
+          const int f = pop_square(from);
+          if (valid_state(table, 1, wk, f, psq)) {
+            relax(table_index(1, wk, f, psq), v);
+          }
+        }
+      }
+    }
+  }
+
+  // States the relaxation never reached can always steer into a repetition.
+  for (auto& v : value) {
+    if (v == kUnknownValue) {
+      v = 0;
+    }
+  }
+}
+
+void build_all_tables() {
+  build_table(kTableQ);
+  build_table(kTableR);
+  build_table(kTableB);
+  build_table(kTableN);
+  build_table(kTableP);
+}
+
+void ensure_built() {
+  std::call_once(g_build_once, build_all_tables);
+}
+
+int mirror_vertical(int s) { return s ^ 56; }
+
+int table_for(PieceType type) {
+  switch (type) {
+    case PieceType::Queen:
+      return kTableQ;
+    case PieceType::Rook:
+      return kTableR;
+    case PieceType::Bishop:
+      return kTableB;
+    case PieceType::Knight:
+      return kTableN;
+    case PieceType::Pawn:
+      return kTableP;
+    default:
+      return -1;
+  }
+}
+
+// Raw table value for the side to move, mirroring so the strong side plays
+// White. nullopt when the position is outside coverage.
+std::optional<std::int16_t> probe_value(const Position& pos) {
+  // An en-passant square is irrelevant here: a capture would need a second
+  // pawn, and the covered material has at most one.
+  const int men = std::popcount(pos.occupancy());
+  if (men > 3 || pos.castling_rights() != 0) {
+    return std::nullopt;
+  }
+  if (men == 2) {
+    return std::int16_t{0};
+  }
+
+  const Color strong =
+      std::popcount(pos.occupancy(Color::White)) == 2 ? Color::White : Color::Black;
+  int table = -1;
+  int psq = -1;
+  for (PieceType type : {PieceType::Queen, PieceType::Rook, PieceType::Bishop,
+                         PieceType::Knight, PieceType::Pawn}) {
+    const Bitboard pieces = pos.pieces(strong, type);
+    if (pieces != 0ULL) {
+      table = table_for(type);
+      psq = std::countr_zero(pieces);
+      break;
+    }
+  }
+  if (table < 0) {
+    return std::nullopt;
+  }
+
+  int wk = static_cast<int>(pos.king_square(strong));
+  int bk = static_cast<int>(pos.king_square(flip(strong)));
+  const int stm = pos.side_to_move() == strong ? 0 : 1;
+  if (strong == Color::Black) {
+    wk = mirror_vertical(wk);
+    bk = mirror_vertical(bk);
+    psq = mirror_vertical(psq);
+  }
+
+  ensure_built();
+  const std::int16_t v =
+      g_tables[static_cast<std::size_t>(table)]
+              [static_cast<std::size_t>(table_index(stm, wk, bk, psq))];
+  if (v == kInvalidValue) {
+    return std::nullopt;
+  }
+  return v;
+}
+
+Wdl wdl_of(std::int16_t value) {
+  if (value > 0) {
+    return Wdl::Win;
+  }
+  return value < 0 ? Wdl::Loss : Wdl::Draw;
+}
+
+}  // namespace
+
+void TbCache::clear() {
+  entries_.fill(Entry{});
+}
+
+bool TbCache::probe(std::uint64_t key, Wdl& out) const {
+  const Entry& entry = entries_[key & (kSize - 1)];
+  if (!entry.valid || entry.key != key) {
+    return false;
+  }
+  out = entry.wdl;
+  return true;
+}
+
+void TbCache::store(std::uint64_t key, Wdl wdl) {
+  Entry& entry = entries_[key & (kSize - 1)];
+  entry.key = key;
+  entry.wdl = wdl;
+  entry.valid = true;
+}
 
 void initialize() {
-  bby_syzygy_touch_symbol();
+  ensure_built();
+}
+
+int max_pieces() {
+  return 3;
+}
+
+std::optional<Wdl> probe_wdl(const Position& pos) {
+  const auto value = probe_value(pos);
+  if (!value) {
+    return std::nullopt;
+  }
+  return wdl_of(*value);
+}
+
+std::optional<RootMove> probe_root(Position& pos) {
+  if (!probe_value(pos)) {
+    return std::nullopt;
+  }
+  MoveList moves;
+  pos.generate_moves(moves, GenStage::All);
+  if (moves.size() == 0) {
+    return std::nullopt;
+  }
+
+  std::optional<RootMove> best;
+  std::int16_t best_value = kUnknownValue;
+  for (const Move move : moves) {
+    Undo undo;
+    pos.make(move, undo);
+    const auto child = probe_value(pos);
+    pos.unmake(move, undo);
+    if (!child) {
+      return std::nullopt;
+    }
+    const std::int16_t mv = move_value(*child);
+    if (best_value == kUnknownValue || mv > best_value) {
+      best_value = mv;
+      best = RootMove{move, wdl_of(mv), plies_of(mv)};
+    }
+  }
+  return best;
 }
 
 }  // namespace bby::syzygy
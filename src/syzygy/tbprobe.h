@@ -1,8 +1,63 @@
 #pragma once
 // tbprobe.h -- C++ wrapper for tablebase probing entry points.
+//
+// The current backend generates exact 3-man bitbases (KQK, KRK, KBK, KNK and
+// KPK) in memory by retrograde analysis instead of decoding Syzygy files from
+// disk. The probing surface matches what a file-backed core needs, so the
+// search integration does not change when one lands; until then the values
+// carry distance-to-mate, which is stronger than DTZ for the material covered.
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+#include "board.h"
 
 namespace bby::syzygy {
 
+enum class Wdl : std::int8_t { Loss = -1, Draw = 0, Win = 1 };
+
+struct RootMove {
+  Move move{};
+  Wdl wdl{Wdl::Draw};
+  int dtm{0};  // plies to mate along optimal play; 0 when drawn
+};
+
+// Direct-mapped probe-result cache, one per search thread. Follows the
+// SeeCache pattern from moveorder.h but sized for interior-node probe rates;
+// a file-backed core would touch cold table pages on every miss, so search
+// consults this before calling probe_wdl.
+class TbCache {
+public:
+  void clear();
+  bool probe(std::uint64_t key, Wdl& out) const;
+  void store(std::uint64_t key, Wdl wdl);
+
+private:
+  struct Entry {
+    std::uint64_t key{0};
+    Wdl wdl{Wdl::Draw};
+    bool valid{false};
+  };
+  static constexpr std::size_t kSize = 8192;
+  static_assert((kSize & (kSize - 1)) == 0, "TbCache size must be power of two");
+
+  std::array<Entry, kSize> entries_{};
+};
+
+// Builds the bitbases; idempotent and safe from any thread. Probes trigger
+// the build lazily, so calling this up front is optional.
 void initialize();
 
+// Largest total piece count the probe layer can answer for.
+int max_pieces();
+
+// Exact WDL for the side to move, or nullopt when the material, castling
+// rights or an en-passant square fall outside table coverage.
+std::optional<Wdl> probe_wdl(const Position& pos);
+
+// Best root move by WDL, breaking ties on distance-to-mate so winning lines
+// always make progress. nullopt when the position cannot be probed.
+std::optional<RootMove> probe_root(Position& pos);
+
 }  // namespace bby::syzygy
@@ -0,0 +1,391 @@
+#include "testsuite.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "bbinit.h"
+#include "board.h"
+#include "epd.h"
+#include "search.h"
+#include "searchparams.h"
+#include "threadpool.h"
+
+namespace bby {
+
+namespace {
+
+struct SuiteConfig {
+  std::string path;
+  int depth{-1};
+  std::int64_t movetime_ms{1000};
+  std::int64_t nodes_limit{-1};
+  int threads{0};
+  std::size_t hash_mb{16};
+  std::string json_path;
+  bool quiet{false};
+};
+
+struct PositionOutcome {
+  std::string id;
+  bool scored{false};
+  bool solved{false};
+  // Earliest elapsed time after which the reported best move stayed a
+  // solution through the end of the search; -1 when unsolved.
+  std::int64_t solve_ms{-1};
+  std::int64_t time_ms{0};
+  std::int64_t nodes{0};
+  int depth{0};
+  std::string best_uci;
+  std::string expected;
+};
+
+bool parse_int(std::string_view token, long long& out) {
+  if (token.empty()) {
+    return false;
+  }
+  char* end = nullptr;
+  const std::string copy(token);
+  const long long value = std::strtoll(copy.c_str(), &end, 10);
+  if (end == copy.c_str() || (end && *end != '\0')) {
+    return false;
+  }
+  out = value;
+  return true;
+}
+
+SuiteConfig parse_cli_arguments(int argc, const char* argv[]) {
+  SuiteConfig cfg;
+  for (int idx = 0; idx < argc; ++idx) {
+    std::string_view arg(argv[idx]);
+    auto consume_next = [&](long long& out) -> bool {
+      if (idx + 1 >= argc) {
+        return false;
+      }
+      ++idx;
+      return parse_int(argv[idx], out);
+    };
+
+    if (arg == "--depth") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.depth = static_cast<int>(std::max<long long>(1, value));
+      }
+    } else if (arg == "--movetime") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.movetime_ms = std::max<long long>(1, value);
+      }
+    } else if (arg == "--nodes") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.nodes_limit = std::max<long long>(1, value);
+      }
+    } else if (arg == "--threads") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.threads = static_cast<int>(std::clamp<long long>(value, 1, 512));
+      }
+    } else if (arg == "--hash") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.hash_mb = static_cast<std::size_t>(std::max<long long>(1, value));
+      }
+    } else if (arg == "--json") {
+      if (idx + 1 < argc) {
+        cfg.json_path = argv[++idx];
+      }
+    } else if (arg == "--quiet") {
+      cfg.quiet = true;
+    } else if (arg == "--help" || arg == "-h") {
+      std::printf("Usage: bby testsuite FILE.epd [--depth N] [--movetime MS]\n");
+      std::printf("                     [--nodes LIMIT] [--threads N] [--hash MB]\n");
+      std::printf("                     [--json FILE] [--quiet]\n");
+      std::fflush(stdout);
+      std::exit(0);
+    } else if (cfg.path.empty()) {
+      cfg.path = std::string(arg);
+    }
+  }
+  return cfg;
+}
+
+// True when `move` matches one of the whitespace-separated SAN tokens in an
+// opcode value; bm/am lists name alternatives this way.
+bool move_listed(const Position& pos, Move move, std::string_view value) {
+  std::size_t at = 0;
+  while (at < value.size()) {
+    while (at < value.size() && value[at] == ' ') {
+      ++at;
+    }
+    std::size_t end = at;
+    while (end < value.size() && value[end] != ' ') {
+      ++end;
+    }
+    if (end > at && move_from_san(pos, value.substr(at, end - at)) == move) {
+      return true;
+    }
+    at = end;
+  }
+  return false;
+}
+
+// Scores `move` against the record's bm/am opcodes. Returns false via
+// `scored` when the record carries neither, in which case the position is
+// searched but excluded from the solved rate.
+bool move_solves(const Position& pos, Move move, std::optional<std::string_view> bm,
+                 std::optional<std::string_view> am, bool& scored) {
+  scored = bm.has_value() || am.has_value();
+  if (move.is_null()) {
+    return false;
+  }
+  if (bm && !move_listed(pos, move, *bm)) {
+    return false;
+  }
+  if (am && move_listed(pos, move, *am)) {
+    return false;
+  }
+  return scored;
+}
+
+// Strips the surrounding quotes an EPD string operand carries.
+std::string unquote(std::string_view value) {
+  if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+    value = value.substr(1, value.size() - 2);
+  }
+  return std::string(value);
+}
+
+std::string escape_json(std::string_view text) {
+  std::string out;
+  out.reserve(text.size());
+  for (const char c : text) {
+    if (c == '"' || c == '\\') {
+      out.push_back('\\');
+    }
+    out.push_back(c);
+  }
+  return out;
+}
+
+void run_position(SearchSession& session, const SuiteConfig& cfg, const EpdFile& file,
+                  const EpdFile::Record& record, std::size_t index,
+                  PositionOutcome& outcome) {
+  const auto bm = file.find(record, "bm");
+  const auto am = file.find(record, "am");
+  if (const auto id = file.find(record, "id")) {
+    outcome.id = unquote(*id);
+  } else {
+    outcome.id = "#" + std::to_string(index + 1);
+  }
+  if (bm) {
+    outcome.expected = std::string(*bm);
+  }
+
+  Position pos = file.position(record);
+  Limits limits;
+  limits.movetime_ms = cfg.movetime_ms;
+  if (cfg.depth > 0) {
+    limits.depth = static_cast<std::int16_t>(cfg.depth);
+  }
+  if (cfg.nodes_limit > 0) {
+    limits.nodes = cfg.nodes_limit;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto elapsed_ms = [&start]() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+  };
+
+  // Track the earliest iteration whose best move then stays a solution; a
+  // later iteration switching away resets the clock.
+  std::int64_t solve_ms = -1;
+  bool scored = false;
+  const SearchProgressFn progress = [&](const SearchResult& iteration) {
+    if (move_solves(pos, iteration.best, bm, am, scored)) {
+      if (solve_ms < 0) {
+        solve_ms = elapsed_ms();
+      }
+    } else {
+      solve_ms = -1;
+    }
+  };
+
+  const SearchResult result = session.run(pos, limits, nullptr, &progress);
+  outcome.time_ms = elapsed_ms();
+  outcome.nodes = result.nodes;
+  outcome.depth = result.depth;
+  outcome.best_uci = move_to_uci(result.best);
+  outcome.solved = move_solves(pos, result.best, bm, am, scored);
+  outcome.scored = scored;
+  if (outcome.solved) {
+    outcome.solve_ms = (solve_ms >= 0) ? solve_ms : outcome.time_ms;
+  }
+}
+
+std::int64_t percentile(const std::vector<std::int64_t>& sorted, int pct) {
+  if (sorted.empty()) {
+    return -1;
+  }
+  const std::size_t idx = std::min(
+      sorted.size() - 1, (sorted.size() * static_cast<std::size_t>(pct)) / 100);
+  return sorted[idx];
+}
+
+void write_json(const SuiteConfig& cfg, const std::vector<PositionOutcome>& outcomes,
+                std::size_t scored, std::size_t solved, std::int64_t wall_ms,
+                int threads, std::ostream& out) {
+  std::vector<std::int64_t> times;
+  for (const PositionOutcome& outcome : outcomes) {
+    if (outcome.solved) {
+      times.push_back(outcome.solve_ms);
+    }
+  }
+  std::sort(times.begin(), times.end());
+
+  const double rate =
+      (scored > 0) ? static_cast<double>(solved) / static_cast<double>(scored) : 0.0;
+  out << "{\n";
+  out << "  \"suite\": \"" << escape_json(cfg.path) << "\",\n";
+  out << "  \"positions\": " << outcomes.size() << ",\n";
+  out << "  \"scored\": " << scored << ",\n";
+  out << "  \"solved\": " << solved << ",\n";
+  char rate_buf[32];
+  std::snprintf(rate_buf, sizeof(rate_buf), "%.4f", rate);
+  out << "  \"solved_rate\": " << rate_buf << ",\n";
+  out << "  \"threads\": " << threads << ",\n";
+  out << "  \"wall_ms\": " << wall_ms << ",\n";
+  out << "  \"tts_ms\": {\"p50\": " << percentile(times, 50)
+      << ", \"p90\": " << percentile(times, 90)
+      << ", \"p99\": " << percentile(times, 99) << "},\n";
+  out << "  \"results\": [\n";
+  for (std::size_t idx = 0; idx < outcomes.size(); ++idx) {
+    const PositionOutcome& outcome = outcomes[idx];
+    out << "    {\"id\": \"" << escape_json(outcome.id) << "\", \"solved\": "
+        << (outcome.solved ? "true" : "false") << ", \"tts_ms\": " << outcome.solve_ms
+        << ", \"time_ms\": " << outcome.time_ms << ", \"nodes\": " << outcome.nodes
+        << ", \"depth\": " << outcome.depth << ", \"best\": \"" << outcome.best_uci
+        << "\", \"expected\": \"" << escape_json(outcome.expected) << "\"}";
+    out << (idx + 1 < outcomes.size() ? ",\n" : "\n");
+  }
+  out << "  ]\n";
+  out << "}\n";
+}
+
+}  // namespace
+
+int testsuite_cli_main(int argc, const char* argv[]) {
+  (void)initialize();
+  const SuiteConfig cfg = parse_cli_arguments(argc, argv);
+  if (cfg.path.empty()) {
+    std::fprintf(stderr, "testsuite: missing EPD file argument\n");
+    return 2;
+  }
+
+  const EpdMapResult suite = map_epd_file(cfg.path);
+  for (const EpdLoadError& error : suite.errors) {
+    std::fprintf(stderr, "testsuite: line %zu: %s\n", error.line,
+                 error.message.c_str());
+  }
+  const auto& records = suite.file.records();
+  if (records.empty()) {
+    std::fprintf(stderr, "testsuite: no positions in %s\n", cfg.path.c_str());
+    return 2;
+  }
+
+  const int threads =
+      (cfg.threads > 0)
+          ? cfg.threads
+          : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+  // Sessions are built on this thread: resizing a large transposition table
+  // clears it through worker_pool(), which must not be re-entered from a
+  // pool worker. Each worker then owns one session, so history, counters and
+  // the TT stay warm across the positions it drains from the queue.
+  std::vector<std::unique_ptr<SearchSession>> sessions;
+  sessions.reserve(static_cast<std::size_t>(threads));
+  for (int idx = 0; idx < threads; ++idx) {
+    sessions.push_back(std::make_unique<SearchSession>());
+    sessions.back()->set_hash_size(cfg.hash_mb);
+  }
+
+  std::vector<PositionOutcome> outcomes(records.size());
+  std::atomic<std::size_t> next_position{0};
+  std::mutex report_mutex;
+  const auto wall_start = std::chrono::steady_clock::now();
+
+  worker_pool().run(static_cast<std::size_t>(threads), [&](std::size_t worker) {
+    SearchSession& session = *sessions[worker];
+    while (true) {
+      const std::size_t index = next_position.fetch_add(1);
+      if (index >= records.size()) {
+        break;
+      }
+      PositionOutcome& outcome = outcomes[index];
+      try {
+        run_position(session, cfg, suite.file, records[index], index, outcome);
+      } catch (const std::exception& ex) {
+        outcome.id = "#" + std::to_string(index + 1);
+        outcome.best_uci = "0000";
+        std::lock_guard<std::mutex> lock(report_mutex);
+        std::fprintf(stderr, "testsuite: %s: %s\n", outcome.id.c_str(), ex.what());
+        continue;
+      }
+      if (!cfg.quiet) {
+        std::lock_guard<std::mutex> lock(report_mutex);
+        std::printf("%-12s %s best=%s depth=%d time=%lldms%s\n", outcome.id.c_str(),
+                    outcome.solved ? "solved" : (outcome.scored ? "FAILED" : "nobm"),
+                    outcome.best_uci.c_str(), outcome.depth,
+                    static_cast<long long>(outcome.time_ms),
+                    outcome.solved
+                        ? (" tts=" + std::to_string(outcome.solve_ms) + "ms").c_str()
+                        : "");
+        std::fflush(stdout);
+      }
+    }
+  });
+
+  const std::int64_t wall_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                   std::chrono::steady_clock::now() - wall_start)
+                                   .count();
+
+  std::size_t scored = 0;
+  std::size_t solved = 0;
+  for (const PositionOutcome& outcome : outcomes) {
+    scored += outcome.scored ? 1 : 0;
+    solved += outcome.solved ? 1 : 0;
+  }
+
+  std::printf("solved %zu/%zu in %lld ms on %d threads\n", solved, scored,
+              static_cast<long long>(wall_ms), threads);
+  std::fflush(stdout);
+
+  if (!cfg.json_path.empty()) {
+    std::ofstream json(cfg.json_path);
+    if (json) {
+      write_json(cfg, outcomes, scored, solved, wall_ms, threads, json);
+    } else {
+      std::fprintf(stderr, "testsuite: failed to open %s for writing\n",
+                   cfg.json_path.c_str());
+    }
+  } else {
+    write_json(cfg, outcomes, scored, solved, wall_ms, threads, std::cout);
+  }
+  return 0;
+}
+
+}  // namespace bby
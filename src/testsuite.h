@@ -0,0 +1,8 @@
+#pragma once
+// testsuite.h -- Parallel EPD testsuite runner behind the `testsuite` CLI mode.
+
+namespace bby {
+
+int testsuite_cli_main(int argc, const char* argv[]);
+
+}  // namespace bby
@@ -0,0 +1,135 @@
+#include "threadpool.h"
+
+#include <utility>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace bby {
+
+namespace {
+
+// Best-effort pinning: worker i lands on core i+1 so the main thread keeps
+// core 0 to itself. A failed set_affinity call is ignored — taskset or a
+// container cpuset may have narrowed the mask already.
+void pin_to_core([[maybe_unused]] std::thread& thread,
+                 [[maybe_unused]] std::size_t worker_index) {
+#if defined(__linux__)
+  const unsigned int cores = std::thread::hardware_concurrency();
+  if (cores == 0) {
+    return;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET((worker_index + 1) % cores, &set);
+  (void)pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#endif
+}
+
+}  // namespace
+
+ThreadPool::~ThreadPool() {
+  stop_and_join();
+}
+
+void ThreadPool::resize(std::size_t count) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    work_done_.wait(lock, [&] { return running_ == 0; });
+    if (workers_.size() == count) {
+      return;
+    }
+  }
+  // Shrinking mid-vector would need per-worker stop plumbing; a full
+  // respawn is just as correct and resize only runs on setoption.
+  stop_and_join();
+  std::unique_lock<std::mutex> lock(mutex_);
+  stopping_ = false;
+  workers_.reserve(count);
+  for (std::size_t idx = 0; idx < count; ++idx) {
+    workers_.emplace_back(&ThreadPool::worker_loop, this, idx);
+    pin_to_core(workers_.back(), idx);
+  }
+}
+
+std::size_t ThreadPool::size() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return workers_.size();
+}
+
+void ThreadPool::launch(std::size_t count, std::function<void(std::size_t)> job) {
+  if (count == 0) {
+    return;
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    work_done_.wait(lock, [&] { return running_ == 0; });
+  }
+  if (size() < count) {
+    resize(count);
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    job_ = std::move(job);
+    active_ = count;
+    running_ = count;
+    ++sequence_;
+  }
+  work_ready_.notify_all();
+}
+
+void ThreadPool::wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  work_done_.wait(lock, [&] { return running_ == 0; });
+  job_ = nullptr;
+}
+
+void ThreadPool::run(std::size_t count, const std::function<void(std::size_t)>& job) {
+  launch(count, job);
+  wait();
+}
+
+void ThreadPool::worker_loop(std::size_t index) {
+  std::uint64_t seen = 0;
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    work_ready_.wait(lock, [&] { return stopping_ || sequence_ != seen; });
+    if (stopping_) {
+      return;
+    }
+    seen = sequence_;
+    if (index >= active_) {
+      continue;
+    }
+    lock.unlock();
+    job_(index);
+    lock.lock();
+    if (--running_ == 0) {
+      work_done_.notify_all();
+    }
+  }
+}
+
+void ThreadPool::stop_and_join() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_ready_.notify_all();
+  for (auto& worker : workers_) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  workers_.clear();
+}
+
+ThreadPool& worker_pool() {
+  static ThreadPool pool;
+  return pool;
+}
+
+}  // namespace bby
@@ -0,0 +1,61 @@
+#pragma once
+// threadpool.h -- Persistent worker pool shared by search, TT clearing and
+// parallel perft. Workers are spawned when the pool is sized (setoption
+// Threads), pinned to cores on platforms that support it, and parked on a
+// condition variable between jobs, so a go command reuses warm threads
+// instead of paying create/join — and losing allocator warmth — per search.
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bby {
+
+class ThreadPool {
+public:
+  ThreadPool() = default;
+  ~ThreadPool();
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // Grows or shrinks the pool to exactly `count` parked workers. Safe to
+  // call repeatedly with the same count; must not be called while a job is
+  // in flight.
+  void resize(std::size_t count);
+  [[nodiscard]] std::size_t size() const;
+
+  // Hands job(index) for indices [0, count) to the workers and returns
+  // immediately; the pool grows if it is smaller than `count`. The caller
+  // is free to do its own slice of work before wait().
+  void launch(std::size_t count, std::function<void(std::size_t)> job);
+  // Blocks until every index of the launched job has finished.
+  void wait();
+  // launch() plus wait() for callers with no work of their own.
+  void run(std::size_t count, const std::function<void(std::size_t)>& job);
+
+private:
+  void worker_loop(std::size_t index);
+  void stop_and_join();
+
+  mutable std::mutex mutex_;
+  std::condition_variable work_ready_;
+  std::condition_variable work_done_;
+  std::vector<std::thread> workers_;
+  std::function<void(std::size_t)> job_;
+  // Bumped per launch; each worker tracks the last sequence it saw so a
+  // spurious wakeup never re-runs a finished job.
+  std::uint64_t sequence_{0};
+  std::size_t active_{0};
+  std::size_t running_{0};
+  bool stopping_{false};
+};
+
+// Process-wide pool. Sized by the UCI Threads option; jobs that need more
+// workers than the pool holds grow it on demand.
+ThreadPool& worker_pool();
+
+}  // namespace bby
@@ -57,6 +57,11 @@ TimeBudget compute_time_budget(const Limits& limits, Color stm) {
                                                         0);
   const std::int64_t inc_time = std::max<std::int64_t>(increment / 2, 0);
   std::int64_t allocate = base_time + inc_time;
+  if (limits.ponder) {
+    // Pondered time is free on a hit, so this budget can run a quarter
+    // longer than a cold search; the clamps below still protect the clock.
+    allocate += allocate / 4;
+  }
 
   const std::int64_t safety_margin =
       std::min<std::int64_t>(kSafetyMarginMs, std::max<std::int64_t>(time_left / 10, 0));
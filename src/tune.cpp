@@ -0,0 +1,431 @@
+#include "tune.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "bbinit.h"
+#include "board.h"
+#include "epd.h"
+#include "search.h"
+#include "searchparams.h"
+#include "threadpool.h"
+
+namespace bby {
+
+namespace {
+
+constexpr TunableSpec kTunables[] = {
+    {"LMR Minimum Depth", &Limits::lmr_min_depth, 1, 8},
+    {"LMR Minimum Move", &Limits::lmr_min_move, 1, 12},
+    {"Static Futility Margin", &Limits::static_futility_margin, 32, 512},
+    {"Static Futility Depth", &Limits::static_futility_depth, 0, 3},
+    {"Razoring Margin", &Limits::razor_margin, 64, 1024},
+    {"Razoring Depth", &Limits::razor_depth, 0, 3},
+    {"Multi-Cut Min Depth", &Limits::multi_cut_min_depth, 2, 10},
+    {"Multi-Cut Reduction", &Limits::multi_cut_reduction, 0, 4},
+    {"Multi-Cut Candidates", &Limits::multi_cut_candidates, 2, 16},
+    {"Multi-Cut Threshold", &Limits::multi_cut_threshold, 1, 8},
+    {"History Weight (x100)", &Limits::history_weight_scale, 0, 400},
+    {"Counter History Weight (x100)", &Limits::counter_history_weight_scale, 0, 400},
+    {"Continuation History Weight (x100)",
+     &Limits::continuation_history_weight_scale, 0, 400},
+    {"Null Min Depth", &Limits::null_min_depth, 1, 6},
+    {"Null Base Reduction", &Limits::null_base_reduction, 1, 4},
+    {"Null Depth Scale", &Limits::null_depth_scale, 1, 8},
+    {"Null Eval Margin", &Limits::null_eval_margin, 32, 400},
+    {"Null Verification Depth", &Limits::null_verification_depth, 0, 6},
+    {"Recapture Extension Depth", &Limits::recapture_extension_depth, 1, 8},
+    {"Check Extension Depth", &Limits::check_extension_depth, 1, 8},
+};
+
+constexpr std::size_t kTunableCount = std::size(kTunables);
+
+// Past this many plies an undecided game scores as a draw; ultra-fast games
+// that last this long are almost always dead drawn anyway.
+constexpr int kMaxGamePlies = 300;
+
+struct TuneConfig {
+  std::string book_path;
+  std::string out_path;
+  int iterations{200};
+  std::int64_t nodes_per_move{4000};
+  int threads{0};
+  std::size_t hash_mb{8};
+  std::uint64_t seed{0x9e3779b97f4a7c15ULL};
+  int snapshot_every{25};
+  // Empty means tune everything; otherwise only the named parameters move.
+  std::vector<std::string> only;
+};
+
+bool parse_int(std::string_view token, long long& out) {
+  if (token.empty()) {
+    return false;
+  }
+  char* end = nullptr;
+  const std::string copy(token);
+  const long long value = std::strtoll(copy.c_str(), &end, 10);
+  if (end == copy.c_str() || (end && *end != '\0')) {
+    return false;
+  }
+  out = value;
+  return true;
+}
+
+TuneConfig parse_cli_arguments(int argc, const char* argv[]) {
+  TuneConfig cfg;
+  for (int idx = 0; idx < argc; ++idx) {
+    std::string_view arg(argv[idx]);
+    auto consume_next = [&](long long& out) -> bool {
+      if (idx + 1 >= argc) {
+        return false;
+      }
+      ++idx;
+      return parse_int(argv[idx], out);
+    };
+
+    if (arg == "--iterations") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.iterations = static_cast<int>(std::max<long long>(1, value));
+      }
+    } else if (arg == "--nodes") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.nodes_per_move = std::max<long long>(64, value);
+      }
+    } else if (arg == "--threads") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.threads = static_cast<int>(std::clamp<long long>(value, 1, 512));
+      }
+    } else if (arg == "--hash") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.hash_mb = static_cast<std::size_t>(std::max<long long>(1, value));
+      }
+    } else if (arg == "--seed") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.seed = static_cast<std::uint64_t>(value);
+      }
+    } else if (arg == "--snapshot") {
+      long long value = 0;
+      if (consume_next(value)) {
+        cfg.snapshot_every = static_cast<int>(std::max<long long>(1, value));
+      }
+    } else if (arg == "--out") {
+      if (idx + 1 < argc) {
+        cfg.out_path = argv[++idx];
+      }
+    } else if (arg == "--param") {
+      if (idx + 1 < argc) {
+        cfg.only.emplace_back(argv[++idx]);
+      }
+    } else if (arg == "--help" || arg == "-h") {
+      std::printf("Usage: bby tune BOOK.epd [--iterations N] [--nodes PER-MOVE]\n");
+      std::printf("                [--threads N] [--hash MB] [--seed S]\n");
+      std::printf("                [--snapshot N] [--out FILE] [--param NAME]...\n");
+      std::fflush(stdout);
+      std::exit(0);
+    } else if (cfg.book_path.empty()) {
+      cfg.book_path = std::string(arg);
+    }
+  }
+  return cfg;
+}
+
+// Plays one game to completion and scores it from White's perspective
+// (1 win, 0.5 draw, 0 loss). Each side searches with its own session and
+// its own perturbed Limits; sessions keep their tables across moves the
+// way a real engine process would.
+double play_game(Position pos, SearchSession& white, SearchSession& black,
+                 const Limits& white_limits, const Limits& black_limits) {
+  std::vector<std::uint64_t> history;
+  history.reserve(kMaxGamePlies + 1);
+  history.push_back(pos.zobrist());
+  for (int game_ply = 0; game_ply < kMaxGamePlies; ++game_ply) {
+    MoveList moves;
+    pos.generate_moves(moves, GenStage::All);
+    bool any_legal = false;
+    for (std::size_t idx = 0; idx < moves.size(); ++idx) {
+      if (pos.is_legal(moves[idx])) {
+        any_legal = true;
+        break;
+      }
+    }
+    const Color stm = pos.side_to_move();
+    if (!any_legal) {
+      if (pos.in_check(stm)) {
+        return stm == Color::White ? 0.0 : 1.0;
+      }
+      return 0.5;
+    }
+    if (pos.halfmove_clock() >= 100) {
+      return 0.5;
+    }
+    int repeats = 0;
+    for (const std::uint64_t key : history) {
+      repeats += (key == pos.zobrist()) ? 1 : 0;
+    }
+    if (repeats >= 3) {
+      return 0.5;
+    }
+
+    SearchSession& session = (stm == Color::White) ? white : black;
+    const Limits& limits = (stm == Color::White) ? white_limits : black_limits;
+    Position search_pos = pos;
+    const SearchResult result = session.run(search_pos, limits);
+    if (result.best.is_null()) {
+      return 0.5;
+    }
+    Undo undo;
+    pos.make(result.best, undo);
+    history.push_back(pos.zobrist());
+  }
+  return 0.5;
+}
+
+void apply_theta(Limits& limits, const std::vector<double>& theta) {
+  for (std::size_t idx = 0; idx < kTunableCount; ++idx) {
+    const TunableSpec& spec = kTunables[idx];
+    const int value = static_cast<int>(std::lround(
+        std::clamp(theta[idx], static_cast<double>(spec.min),
+                   static_cast<double>(spec.max))));
+    limits.*(spec.field) = value;
+  }
+}
+
+void write_snapshot(std::ostream& out, int iteration,
+                    const std::vector<double>& theta) {
+  out << "# iteration " << iteration << '\n';
+  for (std::size_t idx = 0; idx < kTunableCount; ++idx) {
+    const TunableSpec& spec = kTunables[idx];
+    out << "setoption name " << spec.name << " value "
+        << static_cast<int>(std::lround(theta[idx])) << '\n';
+  }
+  out.flush();
+}
+
+}  // namespace
+
+std::span<const TunableSpec> limits_tunables() {
+  return {kTunables, kTunableCount};
+}
+
+int tune_cli_main(int argc, const char* argv[]) {
+  (void)initialize();
+  const TuneConfig cfg = parse_cli_arguments(argc, argv);
+  if (cfg.book_path.empty()) {
+    std::fprintf(stderr, "tune: missing opening book EPD argument\n");
+    return 2;
+  }
+
+  const EpdMapResult book = map_epd_file(cfg.book_path);
+  for (const EpdLoadError& error : book.errors) {
+    std::fprintf(stderr, "tune: line %zu: %s\n", error.line, error.message.c_str());
+  }
+  const auto& openings = book.file.records();
+  if (openings.empty()) {
+    std::fprintf(stderr, "tune: no openings in %s\n", cfg.book_path.c_str());
+    return 2;
+  }
+
+  // Which parameters are free to move; --param restricts the set while the
+  // rest stay pinned at their defaults.
+  std::vector<bool> active(kTunableCount, cfg.only.empty());
+  for (const std::string& name : cfg.only) {
+    bool matched = false;
+    for (std::size_t idx = 0; idx < kTunableCount; ++idx) {
+      if (name == kTunables[idx].name) {
+        active[idx] = true;
+        matched = true;
+      }
+    }
+    if (!matched) {
+      std::fprintf(stderr, "tune: unknown parameter '%s'\n", name.c_str());
+      return 2;
+    }
+  }
+
+  const int threads =
+      (cfg.threads > 0)
+          ? cfg.threads
+          : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+  // Two sessions per worker, one for each side of a perturbation pair. All
+  // are built on this thread: resizing a transposition table clears it
+  // through worker_pool(), which must not be re-entered from a pool worker.
+  std::vector<std::unique_ptr<SearchSession>> sessions;
+  sessions.reserve(static_cast<std::size_t>(threads) * 2);
+  for (int idx = 0; idx < threads * 2; ++idx) {
+    sessions.push_back(std::make_unique<SearchSession>());
+    sessions.back()->set_hash_size(cfg.hash_mb);
+  }
+
+  const Limits defaults;
+  Limits base;
+  base.threads = 1;
+  base.nodes = cfg.nodes_per_move;
+
+  // SPSA state: theta in continuous space, rounded into Limits per game.
+  // Per-parameter perturbation radius c is a twentieth of the range; the
+  // step gain a = r*c^2 with the classic k^-0.602 / k^-0.101 decay schedule.
+  std::vector<double> theta(kTunableCount);
+  std::vector<double> c_scale(kTunableCount);
+  for (std::size_t idx = 0; idx < kTunableCount; ++idx) {
+    theta[idx] = static_cast<double>(defaults.*(kTunables[idx].field));
+    c_scale[idx] = std::max(
+        1.0, static_cast<double>(kTunables[idx].max - kTunables[idx].min) / 20.0);
+  }
+  constexpr double kRate = 0.02;
+  constexpr double kAlpha = 0.602;
+  constexpr double kGamma = 0.101;
+  const double stability = std::max(1.0, cfg.iterations / 10.0);
+
+  std::mutex theta_mutex;
+  std::mutex report_mutex;
+  std::atomic<int> next_iteration{0};
+  std::atomic<std::int64_t> games_played{0};
+
+  std::ofstream out_file;
+  if (!cfg.out_path.empty()) {
+    out_file.open(cfg.out_path);
+    if (!out_file) {
+      std::fprintf(stderr, "tune: failed to open %s for writing\n",
+                   cfg.out_path.c_str());
+      return 2;
+    }
+  }
+
+  const auto wall_start = std::chrono::steady_clock::now();
+
+  worker_pool().run(static_cast<std::size_t>(threads), [&](std::size_t worker) {
+    SearchSession& plus_session = *sessions[worker * 2];
+    SearchSession& minus_session = *sessions[worker * 2 + 1];
+    while (true) {
+      const int k = next_iteration.fetch_add(1) + 1;
+      if (k > cfg.iterations) {
+        break;
+      }
+      std::mt19937_64 rng(cfg.seed + static_cast<std::uint64_t>(k) * 0x2545f4914f6cdd1dULL);
+
+      std::vector<double> local;
+      {
+        std::lock_guard<std::mutex> lock(theta_mutex);
+        local = theta;
+      }
+      const double ck_decay = std::pow(static_cast<double>(k), kGamma);
+      const double ak_decay = std::pow(stability + static_cast<double>(k), kAlpha);
+
+      std::vector<int> delta(kTunableCount, 0);
+      Limits plus = base;
+      Limits minus = base;
+      apply_theta(plus, local);
+      apply_theta(minus, local);
+      for (std::size_t idx = 0; idx < kTunableCount; ++idx) {
+        if (!active[idx]) {
+          continue;
+        }
+        const TunableSpec& spec = kTunables[idx];
+        delta[idx] = (rng() & 1) ? 1 : -1;
+        const double ck = c_scale[idx] / ck_decay;
+        const double lo = static_cast<double>(spec.min);
+        const double hi = static_cast<double>(spec.max);
+        plus.*(spec.field) = static_cast<int>(
+            std::lround(std::clamp(local[idx] + ck * delta[idx], lo, hi)));
+        minus.*(spec.field) = static_cast<int>(
+            std::lround(std::clamp(local[idx] - ck * delta[idx], lo, hi)));
+      }
+
+      const EpdFile::Record& opening =
+          openings[rng() % openings.size()];
+      Position start;
+      try {
+        start = book.file.position(opening);
+      } catch (const std::exception& ex) {
+        std::lock_guard<std::mutex> lock(report_mutex);
+        std::fprintf(stderr, "tune: opening line %zu: %s\n", opening.line, ex.what());
+        continue;
+      }
+
+      // One pair per iteration: the same opening with colors swapped, so
+      // opening bias cancels out of the gradient estimate.
+      const double as_white = play_game(start, plus_session, minus_session, plus, minus);
+      const double as_black = play_game(start, minus_session, plus_session, minus, plus);
+      games_played.fetch_add(2);
+      const double plus_score = as_white + (1.0 - as_black);
+      const double pair_diff = 2.0 * plus_score - 2.0;
+
+      {
+        std::lock_guard<std::mutex> lock(theta_mutex);
+        for (std::size_t idx = 0; idx < kTunableCount; ++idx) {
+          if (!active[idx] || delta[idx] == 0) {
+            continue;
+          }
+          const double ck = c_scale[idx] / ck_decay;
+          const double ak = kRate * c_scale[idx] * c_scale[idx] / ak_decay;
+          theta[idx] += ak * pair_diff * delta[idx] / (2.0 * ck);
+          theta[idx] = std::clamp(theta[idx],
+                                  static_cast<double>(kTunables[idx].min),
+                                  static_cast<double>(kTunables[idx].max));
+        }
+      }
+
+      if (k % cfg.snapshot_every == 0) {
+        std::vector<double> snapshot;
+        {
+          std::lock_guard<std::mutex> lock(theta_mutex);
+          snapshot = theta;
+        }
+        std::lock_guard<std::mutex> lock(report_mutex);
+        const auto elapsed_ms =
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - wall_start)
+                .count();
+        std::printf("iteration %d/%d games=%lld elapsed=%llds\n", k,
+                    cfg.iterations,
+                    static_cast<long long>(games_played.load()),
+                    static_cast<long long>(elapsed_ms / 1000));
+        std::fflush(stdout);
+        if (out_file) {
+          write_snapshot(out_file, k, snapshot);
+        }
+      }
+      (void)worker;
+    }
+  });
+
+  const auto wall_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::steady_clock::now() - wall_start)
+                           .count();
+  std::printf("tuned %d iterations (%lld games) in %lld ms on %d threads\n",
+              cfg.iterations, static_cast<long long>(games_played.load()),
+              static_cast<long long>(wall_ms), threads);
+  for (std::size_t idx = 0; idx < kTunableCount; ++idx) {
+    if (!active[idx]) {
+      continue;
+    }
+    std::printf("setoption name %s value %d\n", kTunables[idx].name,
+                static_cast<int>(std::lround(theta[idx])));
+  }
+  std::fflush(stdout);
+  if (out_file) {
+    write_snapshot(out_file, cfg.iterations, theta);
+  }
+  return 0;
+}
+
+}  // namespace bby
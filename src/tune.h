@@ -0,0 +1,28 @@
+#pragma once
+// tune.h -- In-process SPSA self-play tuning over the Limits tunables.
+
+#include <span>
+
+#include "searchparams.h"
+
+namespace bby {
+
+// One tunable Limits field with its feasible range. Names match the UCI
+// options where one exists so snapshots and profiles round-trip through
+// setoption syntax.
+struct TunableSpec {
+  const char* name;
+  int Limits::*field;
+  int min;
+  int max;
+};
+
+// The table of tunable search parameters, shared by the SPSA tuner and the
+// selfplay profile loader.
+std::span<const TunableSpec> limits_tunables();
+
+// Entry point for `bby tune BOOK.epd [flags]`. argv excludes the program
+// name and the mode token. Returns a process exit code.
+int tune_cli_main(int argc, const char* argv[]);
+
+}  // namespace bby
@@ -8,8 +8,11 @@
 #include <cmath>
 #include <condition_variable>
 #include <cstdint>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <cctype>
+#include <deque>
 #include <iomanip>
 #include <iostream>
 #include <mutex>
@@ -23,28 +26,66 @@
 #include "bbinit.h"
 #include "bench.h"
 #include "board.h"
+#include "book.h"
+#include "nnue.h"
 #include "debug.h"
 #include "perft.h"
 #include "search.h"
 #include "searchparams.h"
+#include "syzygy/tbprobe.h"
+#include "threadpool.h"
 namespace bby {
 namespace {
 
 struct UciIo {
   std::mutex mutex;
   UciWriter writer{nullptr};
+  // Coalescing buffer for info bursts: a deep MultiPV iteration emits dozens
+  // of lines, and flushing each one separately shows up as pipe-write stalls
+  // in GUI traces. Lines queue here and leave stdout in a single write.
+  std::string pending;
 };
 
-void write_line(UciIo& io, const std::string& text) {
+// Queues one protocol line without flushing. In-process writers (tests,
+// fuzzing harnesses) still see individual lines; only the stdout path
+// coalesces.
+void buffer_line(UciIo& io, const std::string& text) {
   std::lock_guard<std::mutex> lock(io.mutex);
   if (const UciWriter writer = io.writer) {
     writer(text);
-  } else {
-    std::cout << text << '\n';
+    return;
+  }
+  io.pending += text;
+  io.pending += '\n';
+}
+
+// Flushes any queued burst as one write.
+void flush_lines(UciIo& io) {
+  std::lock_guard<std::mutex> lock(io.mutex);
+  if (!io.pending.empty()) {
+    std::cout.write(io.pending.data(),
+                    static_cast<std::streamsize>(io.pending.size()));
     std::cout.flush();
+    io.pending.clear();
   }
 }
 
+// Immediate-delivery path (bestmove, readyok, option traffic): folds any
+// queued info lines in front so ordering is preserved, then flushes once.
+void write_line(UciIo& io, const std::string& text) {
+  std::lock_guard<std::mutex> lock(io.mutex);
+  if (const UciWriter writer = io.writer) {
+    writer(text);
+    return;
+  }
+  io.pending += text;
+  io.pending += '\n';
+  std::cout.write(io.pending.data(),
+                  static_cast<std::streamsize>(io.pending.size()));
+  std::cout.flush();
+  io.pending.clear();
+}
+
 UciWriter& thread_local_writer() {
   thread_local UciWriter writer = nullptr;
   return writer;
@@ -227,10 +268,10 @@ void append_score_info(std::ostringstream& oss, Score eval) {
   }
 }
 
-enum class WorkerCommandType { Start, Stop, Quit };
+enum class WorkerCommandType { Start, Quit };
 
 struct SearchCommand {
-  WorkerCommandType type{WorkerCommandType::Stop};
+  WorkerCommandType type{WorkerCommandType::Quit};
   Position position{};
   Limits limits{};
 };
@@ -251,7 +292,16 @@ class SearchWorker {
     io_ = io;
   }
 
+  void bind_session(SearchSession* session) {
+    session_ = session;
+  }
+
   void start_search(const Position& pos, const Limits& limits) {
+    // Clearing the flag here, on the producer side, orders it against any
+    // stop issued before this go; a stop arriving afterwards is meant for
+    // the new search and must survive until it polls the flag.
+    stop_flag_.store(false, std::memory_order_release);
+    ponder_flag_.store(limits.ponder, std::memory_order_release);
     busy_.store(true, std::memory_order_release);
     SearchCommand cmd;
     cmd.type = WorkerCommandType::Start;
@@ -260,14 +310,16 @@ class SearchWorker {
     push(cmd);
   }
 
+  // Flag-only and therefore safe from any thread; the command queue stays
+  // single-producer. The search polls the flag and aborts on its own.
   void request_stop() {
     stop_flag_.store(true, std::memory_order_release);
-    if (!busy_.load(std::memory_order_acquire)) {
-      return;
-    }
-    SearchCommand cmd;
-    cmd.type = WorkerCommandType::Stop;
-    push(cmd);
+  }
+
+  // Converts a running ponder search into a normal timed one; the search
+  // notices the flag at its next abort poll and starts its clock there.
+  void ponderhit() {
+    ponder_flag_.store(false, std::memory_order_release);
   }
 
   void wait_idle() {
@@ -320,7 +372,6 @@ class SearchWorker {
       switch (cmd.type) {
         case WorkerCommandType::Start: {
           busy_.store(true, std::memory_order_release);
-          stop_flag_.store(false, std::memory_order_release);
 
           Position local = cmd.position;
           Limits limits = cmd.limits;
@@ -343,15 +394,19 @@ class SearchWorker {
                      << " nps " << nps;
               }
               info << " hashfull " << partial.hashfull;
+              if (partial.tb_hits > 0) {
+                info << " tbhits " << partial.tb_hits;
+              }
               append_score_info(info, line.eval);
-              if (!line.pv.line.empty()) {
+              if (!line.pv.empty()) {
                 info << " pv";
-                for (const Move move : line.pv.line) {
+                for (const Move move : line.pv) {
                   info << ' ' << format_move(move);
                 }
           }
-          write_line(*io_, info.str());
+          buffer_line(*io_, info.str());
         }
+        flush_lines(*io_);
       };
 
       CurrmoveFn currmove = [this](Move move, int number) {
@@ -364,7 +419,12 @@ class SearchWorker {
         write_line(*io_, info.str());
       };
 
-      SearchResult result = search(local, limits, &stop_flag_, &progress, &currmove);
+      SearchResult result =
+          session_ != nullptr
+              ? session_->run(local, limits, &stop_flag_, &progress, &currmove,
+                              &ponder_flag_)
+              : search(local, limits, &stop_flag_, &progress, &currmove,
+                       &ponder_flag_);
 
           const bool stopped = stop_flag_.load(std::memory_order_acquire);
           {
@@ -397,15 +457,26 @@ class SearchWorker {
                 info << " nps " << nps;
               }
               info << " hashfull " << result.hashfull;
+              if (result.tb_hits > 0) {
+                info << " tbhits " << result.tb_hits;
+              }
               append_score_info(info, line.eval);
-              if (!line.pv.line.empty()) {
+              if (!line.pv.empty()) {
                 info << " pv";
-                for (const Move move : line.pv.line) {
+                for (const Move move : line.pv) {
                   info << ' ' << format_move(move);
                 }
               }
-              write_line(*io_, info.str());
+              buffer_line(*io_, info.str());
             }
+            flush_lines(*io_);
+          }
+
+          // A ponder search that exhausts its depth must hold bestmove until
+          // the GUI resolves the ponder with ponderhit or stop.
+          while (ponder_flag_.load(std::memory_order_acquire) &&
+                 !stop_flag_.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
           }
 
           const bool have_move = !result.best.is_null();
@@ -413,16 +484,17 @@ class SearchWorker {
             write_line(*io_, "bestmove 0000");
           } else {
             const Move best = have_move ? result.best : Move{};
-            write_line(*io_, std::string("bestmove ") + format_move(best));
+            std::string bestmove_line = std::string("bestmove ") + format_move(best);
+            if (have_move && result.pv.size() >= 2) {
+              bestmove_line += std::string(" ponder ") + format_move(result.pv[1]);
+            }
+            write_line(*io_, bestmove_line);
           }
 
           busy_.store(false, std::memory_order_release);
           ready_cv_.notify_all();
           break;
         }
-        case WorkerCommandType::Stop:
-          stop_flag_.store(true, std::memory_order_release);
-          break;
         case WorkerCommandType::Quit:
           return;
       }
@@ -433,6 +505,7 @@ class SearchWorker {
   std::thread thread_;
   std::atomic<bool> shutdown_requested_{false};
   std::atomic<bool> stop_flag_{false};
+  std::atomic<bool> ponder_flag_{false};
   std::atomic<bool> busy_{false};
   std::mutex mutex_;
   std::condition_variable ready_cv_;
@@ -440,10 +513,72 @@ class SearchWorker {
   SearchSnapshot last_snapshot_{};
   bool has_snapshot_{false};
   UciIo* io_{nullptr};
+  SearchSession* session_{nullptr};
+};
+
+// Reads stdin on a dedicated thread feeding the main loop through the same
+// lock-free queue the worker uses, so protocol handling never waits behind a
+// blocked getline. "stop" and "quit" flip the worker's stop flag the moment
+// they are read, before the main loop ever sees the line, which keeps search
+// abort latency at the search's own poll interval regardless of what the
+// dispatcher is doing.
+class InputReader {
+ public:
+  explicit InputReader(SearchWorker& worker)
+      : worker_(worker), thread_(&InputReader::run, this) {}
+
+  ~InputReader() {
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+  // Blocks until a line is available; false once stdin is exhausted and the
+  // queue has drained.
+  bool next_line(std::string& out) {
+    while (true) {
+      if (queue_.pop(out)) {
+        return true;
+      }
+      if (eof_.load(std::memory_order_acquire)) {
+        // Re-check after the flag: the reader publishes its last line before
+        // setting eof_, so one more pop may still succeed.
+        return queue_.pop(out);
+      }
+      std::this_thread::yield();
+    }
+  }
+
+ private:
+  void run() {
+    std::string line;
+    while (std::getline(std::cin, line)) {
+      std::string_view view = line;
+      const std::string command = consume_token(view);
+      if (command == "stop" || command == "quit") {
+        worker_.request_stop();
+      }
+      while (!queue_.push(line)) {
+        std::this_thread::yield();
+      }
+      if (command == "quit") {
+        // The main loop exits on quit; reading past it would strand this
+        // thread inside getline with nobody left to join it.
+        break;
+      }
+    }
+    eof_.store(true, std::memory_order_release);
+  }
+
+  SearchWorker& worker_;
+  SpscQueue<std::string, 64> queue_{};
+  std::atomic<bool> eof_{false};
+  std::thread thread_;
 };
 
 struct UciState {
   mutable UciIo io{};
+  SearchSession session{};
   SearchWorker worker{};
   Position pos{Position::from_fen(kStartPositionFen, false)};
   Limits last_limits{};
@@ -451,6 +586,9 @@ struct UciState {
   int hash_mb{128};
   int singular_margin{50};
   int multipv{1};
+  // Advertised so GUIs enable `go ponder`; the search itself keys off the
+  // per-go ponder flag rather than this switch.
+  bool ponder_option{false};
   int lmr_min_depth{kLmrMinDepthDefault};
   int lmr_min_move{kLmrMinMoveDefault};
   std::int64_t bench_nodes_limit{0};
@@ -469,15 +607,35 @@ struct UciState {
   int history_weight_scale{100};
   int counter_history_weight_scale{50};
   int continuation_history_weight_scale{50};
+  std::string eval_file;
+  // Opening book: probed in handle_go when Own Book is set; a failed or
+  // absent Book File simply leaves every position out of book.
+  PolyglotBook book;
+  std::string book_file;
+  bool own_book{false};
+  // Bit-identical node-limited searches at any thread count; see
+  // Limits::deterministic.
+  bool deterministic{false};
   InitState init;
   bool have_last_limits{false};
   bool analysis_auto_restart{false};
+  // Replay cache for the position command: when a new command names the same
+  // base ("startpos" or the FEN text) and extends the previously applied move
+  // list, only the suffix moves are made on top of `pos`. GUIs resend the
+  // whole game every move, so this turns the per-update cost from O(game
+  // length) into O(new moves) right before `go`.
+  std::string replay_base;
+  std::vector<std::string> replay_moves;
+  bool replay_valid{false};
 
   explicit UciState(const InitState& init_state)
       : init(init_state) {
     worker.bind_io(&io);
+    worker.bind_session(&session);
+    session.set_hash_size(static_cast<std::size_t>(hash_mb));
     io.writer = thread_local_writer();
     set_singular_margin(singular_margin);
+    nnue_load_embedded();
   }
 };
 
@@ -495,6 +653,8 @@ void emit_options(const UciState& state) {
                              std::to_string(state.singular_margin));
   write_line(state.io, "option name MultiPV type spin default 1 min 1 max 32 value " +
                              std::to_string(state.multipv));
+  write_line(state.io, std::string("option name Ponder type check default false value ") +
+                             (state.ponder_option ? "true" : "false"));
   write_line(state.io, "option name LMR Minimum Depth type spin default 4 min 1 max 64 value " +
                              std::to_string(state.lmr_min_depth));
   write_line(state.io, "option name LMR Minimum Move type spin default 3 min 1 max 64 value " +
@@ -529,6 +689,16 @@ void emit_options(const UciState& state) {
                              std::to_string(state.continuation_history_weight_scale));
   write_line(state.io, "option name Bench Nodes Limit type spin default 0 min 0 max 10000000 value " +
                              std::to_string(state.bench_nodes_limit));
+  write_line(state.io, "option name EvalFile type string default <empty> value " +
+                             (state.eval_file.empty() ? std::string("<empty>")
+                                                      : state.eval_file));
+  write_line(state.io, "option name Book File type string default <empty> value " +
+                             (state.book_file.empty() ? std::string("<empty>")
+                                                      : state.book_file));
+  write_line(state.io, std::string("option name Own Book type check default false value ") +
+                             (state.own_book ? "true" : "false"));
+  write_line(state.io, std::string("option name Deterministic type check default false value ") +
+                             (state.deterministic ? "true" : "false"));
 }
 
 void send_readyok(UciIo& io) {
@@ -544,7 +714,13 @@ void handle_register(UciState& state, std::string_view) {
 }
 
 void handle_ponderhit(UciState& state) {
-  send_info(state.io, "ponderhit acknowledged (pondering not implemented)");
+  if (state.worker.is_busy()) {
+    state.worker.ponderhit();
+  } else {
+    // The ponder search already printed bestmove (or never started); the
+    // GUI's position/go pair that follows will proceed as usual.
+    send_info(state.io, "ponderhit with no search running");
+  }
 }
 
 void handle_position(UciState& state, std::string_view args) {
@@ -555,9 +731,10 @@ void handle_position(UciState& state, std::string_view args) {
   }
 
   std::string_view view = args;
+  std::string base;
   std::string token = consume_token(view);
   if (token == "startpos" || token.empty()) {
-    state.pos = Position::from_fen(kStartPositionFen, false);
+    base = "startpos";
     token = consume_token(view);
   } else if (token == "fen") {
     std::vector<std::string> fen_fields;
@@ -583,12 +760,7 @@ void handle_position(UciState& state, std::string_view args) {
       if (i > 0) fen_string.push_back(' ');
       fen_string += fen_fields[i];
     }
-    try {
-      state.pos = Position::from_fen(fen_string, false);
-    } catch (const std::exception& ex) {
-      send_info(state.io, std::string("FEN error: ") + ex.what());
-      return;
-    }
+    base = std::move(fen_string);
   } else {
     send_info(state.io, "unknown token after position: " + token);
     return;
@@ -598,28 +770,62 @@ void handle_position(UciState& state, std::string_view args) {
     token = consume_token(view);
   }
 
-  bool applied_all_moves = true;
+  std::vector<std::string> moves;
   if (token == "moves") {
     while (true) {
-      const std::string move_token = consume_token(view);
+      std::string move_token = consume_token(view);
       if (move_token.empty()) {
         break;
       }
-      const Move mv = find_uci_move(state.pos, move_token);
-      if (mv.is_null()) {
-        send_info(state.io, "illegal move '" + move_token + "'");
-        applied_all_moves = false;
-        break;
-      }
-      Undo undo;
-      state.pos.make(mv, undo);
+      moves.push_back(std::move(move_token));
     }
   }
 
+  // Replay-cache hit: same base, and the previous move list is a prefix of
+  // the new one, so `pos` already sits after `first_new` of these moves.
+  const bool extends =
+      state.replay_valid && base == state.replay_base &&
+      moves.size() >= state.replay_moves.size() &&
+      std::equal(state.replay_moves.begin(), state.replay_moves.end(), moves.begin());
+  std::size_t first_new = 0;
+  if (extends) {
+    first_new = state.replay_moves.size();
+  } else if (base == "startpos") {
+    state.pos = Position::from_fen(kStartPositionFen, false);
+  } else {
+    try {
+      state.pos = Position::from_fen(base, false);
+    } catch (const std::exception& ex) {
+      state.replay_valid = false;
+      send_info(state.io, std::string("FEN error: ") + ex.what());
+      return;
+    }
+  }
+  state.replay_valid = false;
+
+  bool applied_all_moves = true;
+  for (std::size_t idx = first_new; idx < moves.size(); ++idx) {
+    const Move mv = find_uci_move(state.pos, moves[idx]);
+    if (mv.is_null()) {
+      send_info(state.io, "illegal move '" + moves[idx] + "'");
+      applied_all_moves = false;
+      break;
+    }
+    Undo undo;
+    state.pos.make(mv, undo);
+  }
+  if (applied_all_moves) {
+    state.replay_base = std::move(base);
+    state.replay_moves = std::move(moves);
+    state.replay_valid = true;
+  }
+
   if (state.analysis_auto_restart && state.have_last_limits && applied_all_moves &&
       was_busy) {
     Limits limits = state.last_limits;
+    limits.threads = state.threads;
     limits.multipv = state.multipv;
+    limits.deterministic = state.deterministic;
     limits.lmr_min_depth = state.lmr_min_depth;
     limits.lmr_min_move = state.lmr_min_move;
     limits.enable_static_futility = state.enable_static_futility;
@@ -678,10 +884,19 @@ void handle_setoption(UciState& state, std::string_view args) {
   if (name == "Hash") {
     if (auto parsed = parse_int(value)) {
       state.hash_mb = static_cast<int>(std::clamp<std::int64_t>(*parsed, 1, 8192));
+      if (state.worker.is_busy()) {
+        state.worker.request_stop();
+        state.worker.wait_idle();
+      }
+      state.session.set_hash_size(static_cast<std::size_t>(state.hash_mb));
     }
   } else if (name == "Threads") {
     if (auto parsed = parse_int(value)) {
       state.threads = static_cast<int>(std::clamp<std::int64_t>(*parsed, 1, 512));
+      // Spawn and pin the workers now so go never pays thread start-up, and
+      // build each worker's state arena on its own core while we are at it.
+      worker_pool().resize(static_cast<std::size_t>(state.threads - 1));
+      state.session.reserve_threads(static_cast<std::size_t>(state.threads));
     }
   } else if (name == "Singular Margin") {
     if (auto parsed = parse_double(value)) {
@@ -690,6 +905,34 @@ void handle_setoption(UciState& state, std::string_view args) {
       state.singular_margin = clamped;
       set_singular_margin(clamped);
     }
+  } else if (name == "EvalFile") {
+    if (!value.empty() && value != "<empty>") {
+      if (state.worker.is_busy()) {
+        state.worker.request_stop();
+        state.worker.wait_idle();
+      }
+      if (nnue_load(value)) {
+        state.eval_file = value;
+        // Cached evaluations from the previous network are stale.
+        state.session.clear();
+        send_info(state.io, "EvalFile loaded " + value);
+      } else {
+        send_info(state.io, "EvalFile load failed " + value);
+      }
+    }
+  } else if (name == "Book File") {
+    if (!value.empty() && value != "<empty>") {
+      if (state.book.open(value)) {
+        state.book_file = value;
+        send_info(state.io, "Book File loaded " + value);
+      } else {
+        send_info(state.io, "Book File load failed " + value);
+      }
+    }
+  } else if (name == "Own Book") {
+    state.own_book = (value == "true");
+  } else if (name == "Deterministic") {
+    state.deterministic = (value == "true");
   } else if (name == "Bench Nodes Limit") {
     if (auto parsed = parse_double(value)) {
       const std::int64_t rounded = static_cast<std::int64_t>(std::llround(*parsed));
@@ -726,6 +969,16 @@ void handle_setoption(UciState& state, std::string_view args) {
       state.continuation_history_weight_scale =
           static_cast<int>(std::clamp<std::int64_t>(rounded, 0, 400));
     }
+  } else if (name == "Ponder") {
+    std::string lowered = value;
+    std::transform(lowered.begin(), lowered.end(), lowered.begin(), [](unsigned char c) {
+      return static_cast<char>(std::tolower(c));
+    });
+    if (lowered == "true" || lowered == "1") {
+      state.ponder_option = true;
+    } else if (lowered == "false" || lowered == "0") {
+      state.ponder_option = false;
+    }
   } else if (name == "Static Futility") {
     std::string lowered = value;
     std::transform(lowered.begin(), lowered.end(), lowered.begin(), [](unsigned char c) {
@@ -858,11 +1111,13 @@ void handle_go(UciState& state, std::string_view args) {
     } else if (token == "infinite") {
       limits.infinite = true;
     } else if (token == "ponder") {
-      // TODO: implement ponder support
+      limits.ponder = true;
     }
   }
 
+  limits.threads = state.threads;
   limits.multipv = state.multipv;
+  limits.deterministic = state.deterministic;
   limits.lmr_min_depth = state.lmr_min_depth;
   limits.lmr_min_move = state.lmr_min_move;
   limits.enable_static_futility = state.enable_static_futility;
@@ -884,6 +1139,17 @@ void handle_go(UciState& state, std::string_view args) {
   state.have_last_limits = true;
   state.analysis_auto_restart = limits.infinite;
 
+  // Book probe: only for normal game searches. Analysis forms (infinite,
+  // mate, ponder) always search so the GUI gets the lines it asked for.
+  if (state.own_book && state.book.is_open() && !limits.infinite &&
+      !limits.ponder && limits.mate == 0) {
+    const Move book_move = state.book.probe(state.pos);
+    if (book_move != Move{}) {
+      write_line(state.io, "bestmove " + format_move(book_move));
+      return;
+    }
+  }
+
   if (state.worker.is_busy()) {
     state.worker.request_stop();
     state.worker.wait_idle();
@@ -903,8 +1169,11 @@ void handle_debug(UciState& state, std::string_view args) {
 
 void handle_ucinewgame(UciState& state) {
   state.pos = Position::from_fen(kStartPositionFen, false);
+  state.session.clear();
   state.have_last_limits = false;
   state.analysis_auto_restart = false;
+  state.replay_valid = false;
+  state.replay_moves.clear();
 }
 
 void handle_trace(UciState& state, std::string_view args) {
@@ -922,13 +1191,71 @@ void handle_trace(UciState& state, std::string_view args) {
     return;
   }
 
+  if (command == "binary") {
+    const std::string target = consume_token(args);
+    if (target.empty()) {
+      send_info(state.io, "trace binary usage: trace binary <path>|off");
+      return;
+    }
+    if (target == "off") {
+      const std::uint64_t dropped = trace_binary_dropped();
+      trace_binary_stop();
+      std::string message = "trace binary off";
+      if (dropped > 0) {
+        message += " dropped=" + std::to_string(dropped);
+      }
+      send_info(state.io, message);
+      return;
+    }
+    if (trace_binary_start(target)) {
+      send_info(state.io, "trace binary " + target);
+    } else {
+      send_info(state.io, "trace binary: cannot open '" + target + "'");
+    }
+    return;
+  }
+
+  if (command == "decode") {
+    const std::string target = consume_token(args);
+    if (target.empty()) {
+      send_info(state.io, "trace decode usage: trace decode <path>");
+      return;
+    }
+    std::FILE* file = std::fopen(target.c_str(), "rb");
+    if (file == nullptr) {
+      send_info(state.io, "trace decode: cannot open '" + target + "'");
+      return;
+    }
+    char magic[8] = {};
+    std::uint32_t record_size = 0;
+    if (std::fread(magic, sizeof(magic), 1, file) != 1 ||
+        std::fread(&record_size, sizeof(record_size), 1, file) != 1 ||
+        std::memcmp(magic, "BBYTRC01", sizeof(magic)) != 0 ||
+        record_size != sizeof(TraceRecord)) {
+      std::fclose(file);
+      send_info(state.io, "trace decode: '" + target + "' is not a trace file");
+      return;
+    }
+    TraceRecord record;
+    std::uint64_t count = 0;
+    while (std::fread(&record, sizeof(record), 1, file) == 1) {
+      send_info(state.io, decode_trace_record(record));
+      ++count;
+    }
+    std::fclose(file);
+    send_info(state.io, "trace decode: " + std::to_string(count) + " records");
+    return;
+  }
+
   bool enable = false;
   if (command == "on") {
     enable = true;
   } else if (command == "off") {
     enable = false;
   } else {
-    send_info(state.io, "trace usage: trace [status|on|off] <topic>");
+    send_info(state.io,
+              "trace usage: trace [status|on|off <topic>|binary <path>|off|"
+              "decode <path>]");
     return;
   }
 
@@ -978,13 +1305,13 @@ void handle_repropack(const UciState& state) {
     oss << " depth=" << snapshot.result.depth
         << " nodes=" << snapshot.result.nodes
         << " stopped=" << (snapshot.stopped ? "true" : "false");
-    if (!snapshot.result.pv.line.empty()) {
+    if (!snapshot.result.pv.empty()) {
       oss << " pv=";
-      for (std::size_t idx = 0; idx < snapshot.result.pv.line.size(); ++idx) {
+      for (std::size_t idx = 0; idx < snapshot.result.pv.size(); ++idx) {
         if (idx > 0) {
           oss << ',';
         }
-        oss << move_to_uci(snapshot.result.pv.line[idx]);
+        oss << move_to_uci(snapshot.result.pv[idx]);
       }
     }
     const Limits& limits = snapshot.limits;
@@ -1076,13 +1403,13 @@ void handle_bench(UciState& state, std::string_view args) {
           static_cast<std::uint64_t>((result.nodes * 1000LL) / elapsed_ms);
       oss << " nps=" << nps;
     }
-    if (!result.pv.line.empty()) {
+    if (!result.pv.empty()) {
       oss << " pv=";
-      for (std::size_t pv_idx = 0; pv_idx < result.pv.line.size(); ++pv_idx) {
+      for (std::size_t pv_idx = 0; pv_idx < result.pv.size(); ++pv_idx) {
         if (pv_idx > 0) {
           oss << ',';
         }
-        oss << move_to_uci(result.pv.line[pv_idx]);
+        oss << move_to_uci(result.pv[pv_idx]);
       }
     }
     if (result.aborted) {
@@ -1108,6 +1435,141 @@ void handle_bench(UciState& state, std::string_view args) {
   send_info(state.io, signature.str());
 }
 
+std::string consume_path(std::string_view& view) {
+  const auto first = view.find_first_not_of(' ');
+  if (first == std::string_view::npos) {
+    return {};
+  }
+  view.remove_prefix(first);
+  const auto last = view.find_last_not_of(' ');
+  std::string path(view.substr(0, last + 1));
+  view = std::string_view{};
+  return path;
+}
+
+void handle_ttsave(UciState& state, std::string_view args) {
+  const std::string path = consume_path(args);
+  if (path.empty()) {
+    send_info(state.io, "ttsave requires a file path");
+    return;
+  }
+  if (state.worker.is_busy()) {
+    state.worker.request_stop();
+    state.worker.wait_idle();
+  }
+  if (state.session.save_hash(path)) {
+    send_info(state.io, "ttsave wrote " + path);
+  } else {
+    send_info(state.io, "ttsave failed for " + path);
+  }
+}
+
+void handle_ttload(UciState& state, std::string_view args) {
+  const std::string path = consume_path(args);
+  if (path.empty()) {
+    send_info(state.io, "ttload requires a file path");
+    return;
+  }
+  if (state.worker.is_busy()) {
+    state.worker.request_stop();
+    state.worker.wait_idle();
+  }
+  if (state.session.load_hash(path)) {
+    send_info(state.io, "ttload restored " + path);
+  } else {
+    send_info(state.io, "ttload failed for " + path);
+  }
+}
+
+double stats_percent(std::int64_t part, std::int64_t whole) {
+  if (whole <= 0) {
+    return 0.0;
+  }
+  return 100.0 * static_cast<double>(part) / static_cast<double>(whole);
+}
+
+// Reports the persistent hot-path counters accumulated by every search since
+// the last ucinewgame. "searchstats json" emits one machine-readable line;
+// the default form prints human-oriented info strings with derived rates.
+void handle_searchstats(UciState& state, std::string_view args) {
+  const std::string mode = consume_token(args);
+  if (!mode.empty() && mode != "json") {
+    send_info(state.io, "searchstats usage: searchstats [json]");
+    return;
+  }
+  const SearchStats stats = state.session.stats();
+  const std::int64_t total_nodes = stats.interior_nodes + stats.qsearch_nodes;
+  static constexpr std::array<const char*, SearchStats::kTTDepthBands> kBandLabels = {
+      "0-3", "4-7", "8-11", "12+"};
+
+  if (mode == "json") {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2);
+    oss << "{\"nodes\":" << total_nodes
+        << ",\"interior_nodes\":" << stats.interior_nodes
+        << ",\"qsearch_nodes\":" << stats.qsearch_nodes
+        << ",\"qsearch_share_pct\":" << stats_percent(stats.qsearch_nodes, total_nodes)
+        << ",\"tt_bands\":[";
+    for (std::size_t band = 0; band < stats.tt_probes.size(); ++band) {
+      if (band > 0) {
+        oss << ',';
+      }
+      oss << "{\"depth\":\"" << kBandLabels[band] << '"'
+          << ",\"probes\":" << stats.tt_probes[band]
+          << ",\"hits\":" << stats.tt_hits[band]
+          << ",\"cutoffs\":" << stats.tt_cutoffs[band] << '}';
+    }
+    oss << "],\"beta_cutoffs\":{\"total\":" << stats.beta_cutoffs
+        << ",\"first_move\":" << stats.cutoff_first_move
+        << ",\"moves_2_4\":" << stats.cutoff_moves_2_to_4
+        << ",\"move_5_plus\":" << stats.cutoff_late_moves << '}'
+        << ",\"prunes\":{\"null\":" << stats.null_prunes
+        << ",\"static_futility\":" << stats.static_futility_prunes
+        << ",\"razor\":" << stats.razor_prunes
+        << ",\"multi_cut\":" << stats.multi_cut_prunes
+        << ",\"lmr\":" << stats.lmr_reductions << "}}";
+    write_line(state.io, oss.str());
+    return;
+  }
+
+  {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1);
+    oss << "searchstats nodes=" << total_nodes
+        << " interior=" << stats.interior_nodes
+        << " qsearch=" << stats.qsearch_nodes
+        << " qsearch_share=" << stats_percent(stats.qsearch_nodes, total_nodes) << '%';
+    send_info(state.io, oss.str());
+  }
+  for (std::size_t band = 0; band < stats.tt_probes.size(); ++band) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1);
+    oss << "searchstats tt depth " << kBandLabels[band]
+        << " probes=" << stats.tt_probes[band]
+        << " hit=" << stats_percent(stats.tt_hits[band], stats.tt_probes[band]) << '%'
+        << " cutoff=" << stats_percent(stats.tt_cutoffs[band], stats.tt_probes[band]) << '%';
+    send_info(state.io, oss.str());
+  }
+  {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1);
+    oss << "searchstats cutoffs total=" << stats.beta_cutoffs
+        << " first=" << stats_percent(stats.cutoff_first_move, stats.beta_cutoffs) << '%'
+        << " moves2-4=" << stats_percent(stats.cutoff_moves_2_to_4, stats.beta_cutoffs) << '%'
+        << " late=" << stats_percent(stats.cutoff_late_moves, stats.beta_cutoffs) << '%';
+    send_info(state.io, oss.str());
+  }
+  {
+    std::ostringstream oss;
+    oss << "searchstats prunes null=" << stats.null_prunes
+        << " static_futility=" << stats.static_futility_prunes
+        << " razor=" << stats.razor_prunes
+        << " multi_cut=" << stats.multi_cut_prunes
+        << " lmr=" << stats.lmr_reductions;
+    send_info(state.io, oss.str());
+  }
+}
+
 void handle_uci(UciState& state) {
   emit_id_block(state.io);
   emit_options(state);
@@ -1125,8 +1587,17 @@ bool dispatch_command(UciState& state, std::string_view line, bool allow_shutdow
   if (command == "uci") {
     handle_uci(state);
   } else if (command == "isready") {
-    state.worker.wait_idle();
-    send_readyok(state.io);
+    if (state.worker.is_busy()) {
+      // Mid-search the GUI is pinging for liveness, not completion; answer
+      // at once rather than blocking until bestmove.
+      send_readyok(state.io);
+    } else {
+      state.worker.wait_idle();
+      // Blocking here is what the protocol expects; building the endgame
+      // tables now keeps the first tablebase probe off the game clock.
+      syzygy::initialize();
+      send_readyok(state.io);
+    }
   } else if (command == "ucinewgame") {
     if (state.worker.is_busy()) {
       state.worker.request_stop();
@@ -1153,13 +1624,21 @@ bool dispatch_command(UciState& state, std::string_view line, bool allow_shutdow
     handle_assert(state);
   } else if (command == "repropack") {
     handle_repropack(state);
+  } else if (command == "ttsave") {
+    handle_ttsave(state, view);
+  } else if (command == "ttload") {
+    handle_ttload(state, view);
+  } else if (command == "searchstats") {
+    handle_searchstats(state, view);
   } else if (command == "quit") {
     if (allow_shutdown) {
+      state.worker.request_stop();
       state.worker.shutdown();
     } else {
       state.worker.request_stop();
       state.worker.wait_idle();
     }
+    trace_binary_stop();
     return false;
   } else if (command == "setoption") {
     handle_setoption(state, view);
@@ -1190,9 +1669,10 @@ int uci_main() {
   const InitState init_state = initialize();
 
   UciState state(init_state);
+  InputReader reader(state.worker);
   std::string line;
 
-  while (std::getline(std::cin, line)) {
+  while (reader.next_line(line)) {
     if (!dispatch_command(state, line, true)) {
       break;
     }
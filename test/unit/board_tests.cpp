@@ -92,4 +92,297 @@ TEST_CASE("capture and quiet stages partition pseudo moves", "[board]") {
   }
 }
 
+TEST_CASE("PSQT accumulators survive captures, promotion and en passant", "[board]") {
+  // Promotion with capture plus an en-passant option on the other wing.
+  auto pos = Position::from_fen(
+      "rn2k3/1P6/8/3pP3/8/8/8/4K3 w - d6 0 1", false);
+  REQUIRE(pos.is_sane());
+  const int start_mg = pos.psqt_mg();
+  const int start_phase = pos.phase();
+
+  const Move promo = make_move(Square::B7, Square::A8,
+                               MoveFlag::PromotionCapture, PieceType::Queen);
+  Undo undo{};
+  pos.make(promo, undo);
+  // is_sane() cross-checks the incremental sums against a full rebuild.
+  REQUIRE(pos.is_sane());
+  REQUIRE(pos.phase() > start_phase);  // pawn became a queen, rook left
+  pos.unmake(promo, undo);
+  REQUIRE(pos.is_sane());
+  REQUIRE(pos.psqt_mg() == start_mg);
+  REQUIRE(pos.phase() == start_phase);
+
+  const Move ep = make_move(Square::E5, Square::D6, MoveFlag::EnPassant);
+  pos.make(ep, undo);
+  REQUIRE(pos.is_sane());
+  pos.unmake(ep, undo);
+  REQUIRE(pos.is_sane());
+  REQUIRE(pos.psqt_mg() == start_mg);
+  REQUIRE(pos.phase() == start_phase);
+}
+
+TEST_CASE("Pawn key tracks pawn moves and ignores piece moves", "[board]") {
+  auto pos = Position::from_fen(
+      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", false);
+  const std::uint64_t start_key = pos.pawn_key();
+
+  // Knight moves leave the pawn configuration untouched.
+  Undo undo{};
+  pos.make(make_move(Square::G1, Square::F3), undo);
+  REQUIRE(pos.pawn_key() == start_key);
+  pos.unmake(make_move(Square::G1, Square::F3), undo);
+  REQUIRE(pos.pawn_key() == start_key);
+
+  // Pawn pushes change it, and unmake restores it exactly.
+  pos.make(make_move(Square::E2, Square::E4, MoveFlag::DoublePush), undo);
+  const std::uint64_t pushed_key = pos.pawn_key();
+  REQUIRE(pushed_key != start_key);
+  pos.unmake(make_move(Square::E2, Square::E4, MoveFlag::DoublePush), undo);
+  REQUIRE(pos.pawn_key() == start_key);
+
+  // The incremental key must match a from-scratch rebuild of the position.
+  pos.make(make_move(Square::E2, Square::E4, MoveFlag::DoublePush), undo);
+  const auto rebuilt = Position::from_fen(pos.to_fen(), false);
+  REQUIRE(pos.pawn_key() == rebuilt.pawn_key());
+  REQUIRE(pos.pawn_key() == pushed_key);
+}
+
+TEST_CASE("is_pseudo_legal matches the generator", "[board]") {
+  const auto check = [](std::string_view fen) {
+    Position pos = Position::from_fen(fen, false);
+    MoveList moves;
+    pos.generate_moves(moves, GenStage::All);
+    for (const Move m : moves) {
+      // Castle moves are deliberately rejected; everything else generated
+      // here must pass.
+      const MoveFlag flag = move_flag(m);
+      if (flag == MoveFlag::KingCastle || flag == MoveFlag::QueenCastle) {
+        REQUIRE_FALSE(pos.is_pseudo_legal(m));
+      } else {
+        REQUIRE(pos.is_pseudo_legal(m));
+      }
+    }
+  };
+  check("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+  check("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+  check("rn2k3/1P6/8/3pP3/8/8/8/4K3 w - d6 0 1");
+}
+
+TEST_CASE("is_pseudo_legal rejects structurally invalid moves", "[board]") {
+  Position pos = Position::from_fen(
+      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", true);
+
+  REQUIRE_FALSE(pos.is_pseudo_legal(Move{}));
+  // Wrong mover: black knight while white is to move.
+  REQUIRE_FALSE(pos.is_pseudo_legal(make_move(Square::B8, Square::C6)));
+  // Empty from-square.
+  REQUIRE_FALSE(pos.is_pseudo_legal(make_move(Square::E4, Square::E5)));
+  // Knight cannot reach e4 from g1.
+  REQUIRE_FALSE(pos.is_pseudo_legal(make_move(Square::G1, Square::E4)));
+  // Capture flag with no victim on the target square.
+  REQUIRE_FALSE(
+      pos.is_pseudo_legal(make_move(Square::G1, Square::F3, MoveFlag::Capture)));
+  // Rook is blocked by its own pawn.
+  REQUIRE_FALSE(pos.is_pseudo_legal(make_move(Square::A1, Square::A4)));
+  // Double push from the wrong rank.
+  Position mid = Position::from_fen("4k3/8/8/8/8/4P3/8/4K3 w - - 0 1", true);
+  REQUIRE_FALSE(
+      mid.is_pseudo_legal(make_move(Square::E3, Square::E5, MoveFlag::DoublePush)));
+  REQUIRE(mid.is_pseudo_legal(make_move(Square::E3, Square::E4)));
+}
+
+TEST_CASE("Evasion stage matches full generation under check", "[board]") {
+  const auto check = [](std::string_view fen) {
+    Position pos = Position::from_fen(fen, false);
+    REQUIRE(pos.in_check(pos.side_to_move()));
+    MoveList all;
+    MoveList evasions;
+    pos.generate_moves(all, GenStage::All);
+    pos.generate_moves(evasions, GenStage::Evasions);
+    REQUIRE(evasions.size() == all.size());
+    for (const Move m : all) {
+      bool found = false;
+      for (const Move e : evasions) {
+        if (e == m) {
+          found = true;
+          break;
+        }
+      }
+      REQUIRE(found);
+    }
+  };
+  // Slider check: king moves, rook captures, and interpositions.
+  check("4k3/8/8/8/4r3/8/3N4/4K3 w - - 0 1");
+  // Knight check: no interposition squares exist.
+  check("4k3/8/8/8/8/5n2/8/4K2R w - - 0 1");
+  // Double check leaves king moves only.
+  check("4k3/8/8/8/7b/5n2/8/4K2R w - - 0 1");
+  // Check resolved by an en passant capture of the checking pawn.
+  check("8/8/8/2k5/3Pp3/8/8/4K3 b - d3 0 1");
+}
+
+TEST_CASE("Precomputed AttackInfo reproduces plain generation", "[board]") {
+  const auto check = [](std::string_view fen) {
+    Position pos = Position::from_fen(fen, false);
+    const AttackInfo info = pos.attack_info();
+    REQUIRE(info.in_check() == pos.in_check(pos.side_to_move()));
+    for (const GenStage stage :
+         {GenStage::All, GenStage::Captures, GenStage::Quiets}) {
+      MoveList plain;
+      MoveList shared;
+      pos.generate_moves(plain, stage);
+      pos.generate_moves(shared, stage, info);
+      REQUIRE(shared.size() == plain.size());
+      for (std::size_t idx = 0; idx < plain.size(); ++idx) {
+        REQUIRE(shared[idx] == plain[idx]);
+      }
+    }
+  };
+  check(kStartFen);
+  // Pins, castling rights and an available en passant square.
+  check("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+  // Side to move in check: the info carries the evasion masks.
+  check("4k3/8/8/8/4r3/8/3N4/4K3 w - - 0 1");
+}
+
+TEST_CASE("upcoming_repetition flags a reachable shuffle", "[board]") {
+  // After Rh1-h2, Ka8-b8, Rh2-h1 the rook is home again; black to move can
+  // slide the king back to a8 and repeat the starting position.
+  Position pos = Position::from_fen("k7/8/8/8/8/8/8/K6R w - - 10 1", false);
+  std::array<std::uint64_t, 8> path{};
+  Undo u1;
+  Undo u2;
+  Undo u3;
+  path[0] = pos.zobrist();
+  pos.make(make_move(Square::H1, Square::H2), u1);
+  path[1] = pos.zobrist();
+  pos.make(make_move(Square::A8, Square::B8), u2);
+  path[2] = pos.zobrist();
+  pos.make(make_move(Square::H2, Square::H1), u3);
+  path[3] = pos.zobrist();
+  REQUIRE(pos.upcoming_repetition(path.data(), 3, 64));
+  // A null move two plies up fences off the ancestor: no detection.
+  REQUIRE_FALSE(pos.upcoming_repetition(path.data(), 3, 2));
+}
+
+TEST_CASE("gives_check agrees with make and in_check", "[board]") {
+  const auto verify = [](std::string_view fen) {
+    Position pos = Position::from_fen(fen, false);
+    MoveList moves;
+    pos.generate_moves(moves, GenStage::All);
+    for (const Move m : moves) {
+      const bool predicted = pos.gives_check(m);
+      Undo undo;
+      pos.make(m, undo);
+      const bool actual = pos.in_check(pos.side_to_move());
+      pos.unmake(m, undo);
+      INFO("move=" << move_to_uci(m));
+      REQUIRE(predicted == actual);
+    }
+  };
+  // Direct checks, discovered checks, promotions and castling rook checks.
+  verify("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+  verify("5k2/8/8/8/8/8/4R3/4K2R w K - 0 1");
+  verify("rn2k3/1P6/8/3pP3/8/8/8/4K3 w - d6 0 1");
+  // En passant clears two squares at once and can discover a rank check.
+  verify("8/8/8/1k1Pp2R/8/8/8/4K3 w - e6 0 1");
+}
+
+TEST_CASE("from_fen hashes side to move once", "[board]") {
+  // A black-to-move FEN must round-trip to the same key that incremental
+  // updates produce; the side key used to be applied twice on this path.
+  Position white = Position::from_fen(
+      "r1bqkbnr/pppp1ppp/2n5/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 3 3", false);
+  Position black = Position::from_fen(
+      "r1bqkbnr/pppp1ppp/2n5/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R b KQkq - 3 3", false);
+  REQUIRE(white.is_sane());
+  REQUIRE(black.is_sane());
+  REQUIRE(white.zobrist() != black.zobrist());
+}
+
+TEST_CASE("move_from_san resolves moves against the generator", "[board]") {
+  // Every legal move must round-trip through its minimal SAN spelling; the
+  // generator supplies the oracle and the disambiguation requirements.
+  const auto verify = [](const char* fen, const char* san, const char* uci) {
+    const Position pos = Position::from_fen(fen, false);
+    const Move m = move_from_san(pos, san);
+    INFO("san=" << san);
+    REQUIRE_FALSE(m.is_null());
+    REQUIRE(move_to_uci(m) == uci);
+    REQUIRE(pos.is_legal(m));
+  };
+
+  const char* kStart = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+  verify(kStart, "e4", "e2e4");
+  verify(kStart, "e3", "e2e3");
+  verify(kStart, "Nf3", "g1f3");
+  const char* kKiwipete =
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPB1PPP/R3K2R w KQkq - 0 1";
+  verify(kKiwipete, "O-O", "e1g1");
+  verify(kKiwipete, "O-O-O", "e1c1");
+  verify(kKiwipete, "dxe6", "d5e6");
+  verify(kKiwipete, "Nxg6+", "e5g6");
+  verify("rn2k3/1P6/8/8/8/8/8/4K3 w - - 0 1", "bxa8=Q", "b7a8q");
+  verify("4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", "exd6", "e5d6");
+  // File, rank, and full disambiguation.
+  verify("4k3/8/8/8/8/8/1K6/R6R w - - 0 1", "Rad1", "a1d1");
+  verify("4k3/8/R7/8/8/8/1K6/R7 w - - 0 1", "R6a3", "a6a3");
+  verify("4k3/8/8/8/3Q3Q/8/1K6/7Q w - - 0 1", "Qh4e1", "h4e1");
+}
+
+TEST_CASE("move_from_san rejects illegal and ambiguous input", "[board]") {
+  const Position two_rooks = Position::from_fen("4k3/8/8/8/8/8/1K6/R6R w - - 0 1", false);
+  // Both rooks reach d1, so the file is mandatory.
+  REQUIRE(move_from_san(two_rooks, "Rd1").is_null());
+  REQUIRE_FALSE(move_from_san(two_rooks, "Rhd1").is_null());
+
+  const Position start = Position::from_fen(
+      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", false);
+  REQUIRE(move_from_san(start, "e5").is_null());
+  REQUIRE(move_from_san(start, "Nd4").is_null());
+  REQUIRE(move_from_san(start, "O-O").is_null());
+  REQUIRE(move_from_san(start, "exd3").is_null());
+  REQUIRE(move_from_san(start, "garbage").is_null());
+
+  // A pinned candidate drops out of the ambiguity check.
+  const Position pinned =
+      Position::from_fen("4k3/8/8/8/7b/8/3N1N2/4K3 w - - 0 1", false);
+  const Move m = move_from_san(pinned, "Ne4");
+  REQUIRE_FALSE(m.is_null());
+  REQUIRE(move_to_uci(m) == "d2e4");
+}
+
+TEST_CASE("move_to_san round-trips through move_from_san", "[board]") {
+  const char* fens[] = {
+      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+      "2kr3r/ppp2ppp/8/4P3/8/8/PPP2PPP/R3K2R w KQ - 0 1",
+      "4k3/1P4P1/8/3pP3/8/8/8/4K3 w - d6 0 1",
+  };
+  for (const char* fen : fens) {
+    const Position pos = Position::from_fen(fen, false);
+    MoveList moves;
+    pos.generate_moves(moves, GenStage::All);
+    for (const Move move : moves) {
+      if (!pos.is_legal(move)) {
+        continue;
+      }
+      const std::string san = move_to_san(pos, move);
+      REQUIRE(move_from_san(pos, san) == move);
+    }
+  }
+
+  // Disambiguation picks file first, rank when files collide, both as a
+  // last resort; mate gets '#'.
+  const Position rooks =
+      Position::from_fen("4k3/8/8/8/8/8/1K6/R6R w - - 0 1", false);
+  REQUIRE(move_to_san(rooks, move_from_san(rooks, "Rad1")) == "Rad1");
+  const Position stacked =
+      Position::from_fen("7k/R7/8/R7/8/8/1K6/8 w - - 0 1", false);
+  REQUIRE(move_to_san(stacked, move_from_san(stacked, "R7a6")) == "R7a6");
+  const Position mate =
+      Position::from_fen("6k1/5ppp/8/8/8/8/1K6/R7 w - - 0 1", false);
+  REQUIRE(move_to_san(mate, move_from_san(mate, "Ra8+")) == "Ra8#");
+}
+
 }  // namespace bby::test
@@ -0,0 +1,114 @@
+#include "book.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace bby::test {
+
+namespace {
+
+void append_be64(std::vector<unsigned char>& out, std::uint64_t value) {
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    out.push_back(static_cast<unsigned char>((value >> shift) & 0xFF));
+  }
+}
+
+void append_be16(std::vector<unsigned char>& out, std::uint16_t value) {
+  out.push_back(static_cast<unsigned char>(value >> 8));
+  out.push_back(static_cast<unsigned char>(value & 0xFF));
+}
+
+// One 16-byte Polyglot entry: key, move, weight, learn.
+void append_entry(std::vector<unsigned char>& out, std::uint64_t key,
+                  std::uint16_t move, std::uint16_t weight) {
+  append_be64(out, key);
+  append_be16(out, move);
+  append_be16(out, weight);
+  out.insert(out.end(), 4, 0);  // learn
+}
+
+std::uint16_t encode(int from, int to) {
+  return static_cast<std::uint16_t>((from << 6) | to);
+}
+
+}  // namespace
+
+TEST_CASE("Polyglot keys match the reference vectors", "[book]") {
+  struct Vector {
+    const char* fen;
+    std::uint64_t key;
+  };
+  // Key/position pairs published with the Polyglot book format spec.
+  const std::array<Vector, 5> vectors{{
+      {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+       0x463b96181691fc9cULL},
+      {"rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1",
+       0x823c9b50fd114196ULL},
+      {"rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 2",
+       0x0756b94461c50fb0ULL},
+      // En-passant file hashes only when a capture is actually possible.
+      {"rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+       0x22a48b5a8e47ff78ULL},
+      // Castling rights lost by a king move change the key.
+      {"rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR b kq - 0 3",
+       0x652a607ca3f242c1ULL},
+  }};
+  for (const Vector& vector : vectors) {
+    auto pos = Position::from_fen(vector.fen, false);
+    REQUIRE(polyglot_key(pos) == vector.key);
+  }
+}
+
+TEST_CASE("Book probe returns the heaviest legal entry", "[book]") {
+  const auto temp_path =
+      std::filesystem::temp_directory_path() / "bby-book-tests.bin";
+
+  constexpr std::uint64_t start_key = 0x463b96181691fc9cULL;
+  // e2=12, e4=28, d2=11, d4=27 in rank*8+file numbering.
+  std::vector<unsigned char> book_bytes;
+  append_entry(book_bytes, start_key, encode(12, 28), 50);   // e2e4
+  append_entry(book_bytes, start_key, encode(11, 27), 120);  // d2d4
+  {
+    std::ofstream out(temp_path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(book_bytes.data()),
+              static_cast<std::streamsize>(book_bytes.size()));
+  }
+
+  PolyglotBook book;
+  REQUIRE(book.open(temp_path.string()));
+
+  auto start =
+      Position::from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+                         false);
+  const Move move = book.probe(start);
+  REQUIRE(move != Move{});
+  REQUIRE(move_to_uci(move) == "d2d4");
+
+  // Positions without entries are out of book.
+  auto other = Position::from_fen("4k3/8/8/8/8/8/8/4K3 w - - 0 1", false);
+  REQUIRE(book.probe(other) == Move{});
+
+  std::error_code ec;
+  std::filesystem::remove(temp_path, ec);
+}
+
+TEST_CASE("Book open rejects files that are not whole entries", "[book]") {
+  const auto temp_path =
+      std::filesystem::temp_directory_path() / "bby-book-truncated.bin";
+  {
+    std::ofstream out(temp_path, std::ios::binary);
+    out.write("short", 5);
+  }
+  PolyglotBook book;
+  REQUIRE_FALSE(book.open(temp_path.string()));
+  REQUIRE_FALSE(book.is_open());
+
+  std::error_code ec;
+  std::filesystem::remove(temp_path, ec);
+}
+
+}  // namespace bby::test
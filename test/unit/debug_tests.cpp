@@ -1,6 +1,7 @@
 #include "debug.h"
 
 #include <catch2/catch_test_macros.hpp>
+#include <cstdio>
 #include <string>
 #include <vector>
 
@@ -33,6 +34,53 @@ void test_trace_writer(TraceTopic, std::string_view payload) {
 
 }  // namespace
 
+TEST_CASE("Binary trace sink round-trips records through a file", "[debug]") {
+  set_trace_topic(TraceTopic::Search, true);
+  REQUIRE_FALSE(trace_binary_active(TraceTopic::Search));
+
+  const std::string path = "debug_trace_test.bin";
+  REQUIRE(trace_binary_start(path));
+  REQUIRE(trace_binary_active(TraceTopic::Search));
+  REQUIRE_FALSE(trace_binary_active(TraceTopic::Eval));
+
+  const Move move = make_move(Square::E2, Square::E4, MoveFlag::DoublePush);
+  trace_binary(TraceTopic::Search, TraceEvent::LmrReduce, 3, 7, move.value,
+               2, 5, 0, 0);
+  trace_binary_stop();
+  set_trace_topic(TraceTopic::Search, false);
+  REQUIRE(trace_binary_dropped() == 0);
+
+  std::FILE* file = std::fopen(path.c_str(), "rb");
+  REQUIRE(file != nullptr);
+  char magic[8] = {};
+  std::uint32_t record_size = 0;
+  REQUIRE(std::fread(magic, sizeof(magic), 1, file) == 1);
+  REQUIRE(std::fread(&record_size, sizeof(record_size), 1, file) == 1);
+  REQUIRE(std::string(magic, sizeof(magic)) == "BBYTRC01");
+  REQUIRE(record_size == sizeof(TraceRecord));
+
+  bool found = false;
+  TraceRecord record;
+  while (std::fread(&record, sizeof(record), 1, file) == 1) {
+    if (record.event == static_cast<std::uint8_t>(TraceEvent::LmrReduce) &&
+        record.move == move.value) {
+      found = true;
+      break;
+    }
+  }
+  std::fclose(file);
+  std::remove(path.c_str());
+  REQUIRE(found);
+
+  const std::string text = decode_trace_record(record);
+  REQUIRE(text.find("trace search lmr reduce") == 0);
+  REQUIRE(text.find("move=e2e4") != std::string::npos);
+  REQUIRE(text.find("ply=3") != std::string::npos);
+  REQUIRE(text.find("depth=7") != std::string::npos);
+  REQUIRE(text.find("a=2") != std::string::npos);
+  REQUIRE(text.find("b=5") != std::string::npos);
+}
+
 TEST_CASE("Custom trace writer captures payloads", "[debug]") {
   set_trace_topic(TraceTopic::Search, true);
   std::vector<std::string> payloads;
@@ -62,6 +62,55 @@ TEST_CASE("load_epd_file aggregates parse errors", "[epd]") {
   std::filesystem::remove(temp_path, ec);
 }
 
+TEST_CASE("map_epd_file indexes records without copying", "[epd]") {
+  const auto temp_path = std::filesystem::temp_directory_path() / "bby-epd-map-tests.epd";
+  std::error_code ec;
+  std::filesystem::remove(temp_path, ec);
+  {
+    std::ofstream out(temp_path);
+    REQUIRE(out.good());
+    out << "# comment\n";
+    out << "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1 "
+           "bm e2e4; id \"start\"; c0 \"foo;bar\";\n";
+    out << "too few\n";
+    out << "8/8/8/8/8/8/8/8 w - - dm 4; dm 5;\n";
+  }
+
+  const auto result = map_epd_file(temp_path.string());
+  REQUIRE(result.file.records().size() == 1);
+  REQUIRE(result.errors.size() == 2);
+  REQUIRE(result.errors[0].line == 3);
+  REQUIRE(result.errors[1].message == "Duplicate EPD opcode: dm");
+
+  const auto& record = result.file.records().front();
+  REQUIRE(record.ops_count == 3);
+  REQUIRE(result.file.find(record, "bm") == "e2e4");
+  REQUIRE(result.file.find(record, "id") == "\"start\"");
+  REQUIRE(result.file.find(record, "c0") == "\"foo;bar\"");
+  REQUIRE_FALSE(result.file.find(record, "am").has_value());
+
+  // FENs parse lazily: the Position is built on access, not at load time.
+  MoveList moves;
+  result.file.position(record).generate_moves(moves, GenStage::All);
+  REQUIRE(moves.size() == 20);
+
+  std::filesystem::remove(temp_path, ec);
+}
+
+TEST_CASE("map_epd_file matches the copying loader on WAC", "[epd][wac]") {
+  const auto base = std::filesystem::path(__FILE__).parent_path().parent_path().parent_path();
+  const auto path = base / "tests/positions/wacnew.epd";
+  const auto mapped = map_epd_file(path.string());
+  const auto loaded = load_epd_file(path.string());
+  REQUIRE(mapped.ok());
+  REQUIRE(mapped.file.records().size() == loaded.records.size());
+  for (std::size_t idx = 0; idx < loaded.records.size(); ++idx) {
+    const auto& record = mapped.file.records()[idx];
+    REQUIRE(mapped.file.position(record).to_fen() == loaded.records[idx].position.to_fen());
+    REQUIRE(mapped.file.find(record, "bm") == loaded.records[idx].operations.at("bm"));
+  }
+}
+
 TEST_CASE("WAC EPD exposes best-move operations", "[epd][wac]") {
   const auto base = std::filesystem::path(__FILE__).parent_path().parent_path().parent_path();
   const auto path = base / "tests/positions/wacnew.epd";
@@ -177,4 +177,85 @@ TEST_CASE("Color-flipped mirror negates evaluation", "[eval]") {
   REQUIRE(mirrored_score == -original_score);
 }
 
+TEST_CASE("Pawn table caches pawn-structure terms", "[eval]") {
+  // White has a protected passer on e5; black has doubled, isolated h-pawns.
+  auto pos = Position::from_fen("4k3/8/7p/4P2p/8/8/8/4K3 w - - 0 1", false);
+
+  PawnTable table;
+  const PawnEntry& entry = table.probe(pos);
+  REQUIRE(entry.key == pos.pawn_key());
+  REQUIRE((entry.passed[0] & bit(Square::E5)) != 0ULL);
+  REQUIRE(entry.passed[1] == 0ULL);
+  // Files a-d and f-g have no pawns at all.
+  REQUIRE((entry.open_files & bit(Square::B4)) != 0ULL);
+  REQUIRE((entry.open_files & bit(Square::E4)) == 0ULL);
+  REQUIRE((entry.open_files & bit(Square::H4)) == 0ULL);
+  // The e-file is half-open for black, the h-file half-open for white.
+  REQUIRE((entry.half_open_files[1] & bit(Square::E4)) != 0ULL);
+  REQUIRE((entry.half_open_files[0] & bit(Square::H4)) != 0ULL);
+
+  // Cached and scratch paths must agree.
+  const Score cached = evaluate(pos, nullptr, &table);
+  const Score scratch = evaluate(pos);
+  REQUIRE(cached == scratch);
+
+  // A second probe hits the same entry without refilling.
+  const PawnEntry& again = table.probe(pos);
+  REQUIRE(&again == &entry);
+  REQUIRE(again.key == pos.pawn_key());
+}
+
+TEST_CASE("Eval cache stores and recalls scores by zobrist", "[eval]") {
+  EvalCache cache;
+  Score out = 0;
+  REQUIRE_FALSE(cache.probe(0x1234ULL, out));
+
+  cache.store(0x1234ULL, 77);
+  REQUIRE(cache.probe(0x1234ULL, out));
+  REQUIRE(out == 77);
+
+  // A colliding key evicts the previous occupant of the slot.
+  const std::uint64_t colliding = 0x1234ULL + (1ULL << 18);
+  cache.store(colliding, -5);
+  REQUIRE(cache.probe(colliding, out));
+  REQUIRE(out == -5);
+  REQUIRE_FALSE(cache.probe(0x1234ULL, out));
+}
+
+TEST_CASE("Lazy early-out fires only when the window is far away", "[eval]") {
+  // White is a queen up; the PSQT core alone clears a low beta by more
+  // than the staged terms could swing.
+  auto pos = Position::from_fen("4k3/8/8/8/8/8/8/QQQ1K3 w - - 0 1", false);
+
+  EvalTrace full{};
+  const auto full_score = evaluate(pos, &full);
+  REQUIRE_FALSE(full.lazy);
+
+  EvalTrace lazy{};
+  const auto lazy_score = evaluate(pos, &lazy, nullptr, -100, 100);
+  REQUIRE(lazy.lazy);
+  REQUIRE(lazy_score - kLazyEvalMargin >= 100);
+
+  // The skipped terms are pawn terms; with no pawns on the board the core
+  // and the full evaluation agree exactly.
+  REQUIRE(lazy_score == full_score);
+}
+
+TEST_CASE("KPK bitbase decides bare pawn endings exactly", "[eval]") {
+  // King ahead of the pawn on the sixth rank wins with either side to move.
+  auto win_wtm = Position::from_fen("4k3/8/4K3/4P3/8/8/8/8 w - - 0 1", false);
+  REQUIRE(evaluate(win_wtm) > 9000);
+  auto win_btm = Position::from_fen("4k3/8/4K3/4P3/8/8/8/8 b - - 0 1", false);
+  REQUIRE(evaluate(win_btm) < -9000);
+
+  // Rook pawn with the defender in the corner is a dead draw.
+  auto draw = Position::from_fen("k7/8/1K6/P7/8/8/8/8 w - - 0 1", false);
+  REQUIRE(evaluate(draw) == 0);
+
+  // Mirrored colors: the strong side to move still sees the win as positive.
+  auto black_strong =
+      Position::from_fen("8/8/8/8/4p3/4k3/8/4K3 b - - 0 1", false);
+  REQUIRE(evaluate(black_strong) > 9000);
+}
+
 }  // namespace bby::test
@@ -1,6 +1,7 @@
 #include "hash.h"
 
 #include <catch2/catch_test_macros.hpp>
+#include <filesystem>
 
 namespace bby::test {
 
@@ -13,6 +14,8 @@ TEST_CASE("TT stores and probes entries", "[hash]") {
   entry.depth = 8;
   entry.bound = BoundType::Exact;
   entry.best_move = make_move(Square::E2, Square::E4);
+  entry.singular = SingularResult::Singular;
+  entry.singular_depth = 11;
   table.store(1234ULL, entry);
 
   TTEntry out{};
@@ -22,6 +25,8 @@ TEST_CASE("TT stores and probes entries", "[hash]") {
   REQUIRE(out.best_move == make_move(Square::E2, Square::E4));
   REQUIRE(out.bound == BoundType::Exact);
   REQUIRE(out.generation == 7);
+  REQUIRE(out.singular == SingularResult::Singular);
+  REQUIRE(out.singular_depth == 11);
 }
 
 TEST_CASE("TT replacement prefers oldest generation then shallow depth", "[hash]") {
@@ -79,4 +84,64 @@ TEST_CASE("TT updates entry in place when key matches", "[hash]") {
   REQUIRE(out.generation == 3);
 }
 
+TEST_CASE("TT clear drops entries and resize keeps the table usable", "[hash]") {
+  TT table(1);
+  TTEntry entry{};
+  entry.score = 17;
+  entry.depth = 4;
+  table.store(4321ULL, entry);
+
+  TTEntry out{};
+  REQUIRE(table.probe(4321ULL, out));
+
+  table.clear(2);
+  REQUIRE_FALSE(table.probe(4321ULL, out));
+
+  // Shrinking reuses the existing mapping; growing reallocates. Both must
+  // leave an empty, probe-able table behind.
+  table.resize(1);
+  REQUIRE_FALSE(table.probe(4321ULL, out));
+  table.store(4321ULL, entry);
+  REQUIRE(table.probe(4321ULL, out));
+  REQUIRE(out.score == 17);
+
+  table.resize(2);
+  REQUIRE_FALSE(table.probe(4321ULL, out));
+  table.store(999ULL, entry);
+  REQUIRE(table.probe(999ULL, out));
+}
+
+TEST_CASE("TT save and load round-trips entries and generation", "[hash]") {
+  const auto path =
+      (std::filesystem::temp_directory_path() / "bby_tt_dump_test.bin").string();
+
+  TT table(1);
+  table.set_generation(9);
+  TTEntry entry{};
+  entry.score = -123;
+  entry.static_eval = 45;
+  entry.depth = 11;
+  entry.bound = BoundType::Lower;
+  entry.best_move = make_move(Square::D2, Square::D4, MoveFlag::DoublePush);
+  table.store(0xfeedbeefULL, entry);
+  REQUIRE(table.save(path));
+
+  TT restored(1);
+  REQUIRE(restored.load(path));
+  REQUIRE(restored.generation() == 9);
+  TTEntry out{};
+  REQUIRE(restored.probe(0xfeedbeefULL, out));
+  REQUIRE(out.score == -123);
+  REQUIRE(out.static_eval == 45);
+  REQUIRE(out.depth == 11);
+  REQUIRE(out.bound == BoundType::Lower);
+  REQUIRE(out.best_move == make_move(Square::D2, Square::D4, MoveFlag::DoublePush));
+
+  // A truncated or foreign file must be rejected.
+  TT empty(1);
+  REQUIRE_FALSE(empty.load(path + ".missing"));
+
+  std::filesystem::remove(path);
+}
+
 }  // namespace bby::test
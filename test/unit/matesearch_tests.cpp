@@ -0,0 +1,44 @@
+#include "matesearch.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+
+namespace bby::test {
+
+TEST_CASE("df-pn proves a back-rank mate in one", "[matesearch]") {
+  const Position pos =
+      Position::from_fen("6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1", false);
+  const MateSearchResult result = mate_search(pos, 3, 1, -1, nullptr);
+  REQUIRE(result.proven);
+  REQUIRE(result.mate_in == 1);
+  REQUIRE(move_to_uci(result.best) == "a1a8");
+  REQUIRE(result.line.size() == 1);
+}
+
+TEST_CASE("df-pn finds the ladder mate and rejects the short claim", "[matesearch]") {
+  const Position pos =
+      Position::from_fen("4k3/8/8/8/8/8/R7/1R4K1 w - - 0 1", false);
+
+  const MateSearchResult short_claim = mate_search(pos, 1, 1, -1, nullptr);
+  REQUIRE_FALSE(short_claim.proven);
+  REQUIRE_FALSE(short_claim.aborted);
+
+  const MateSearchResult ladder = mate_search(pos, 2, 1, -1, nullptr);
+  REQUIRE(ladder.proven);
+  REQUIRE(ladder.mate_in == 2);
+  REQUIRE(ladder.line.size() == 3);
+  // Both rook lifts mate in two; either proof is a legal ladder.
+  const std::string first = move_to_uci(ladder.best);
+  REQUIRE((first == "b1b7" || first == "a2a7"));
+}
+
+TEST_CASE("df-pn respects the node limit", "[matesearch]") {
+  const Position pos = Position::from_fen(
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+      false);
+  const MateSearchResult result = mate_search(pos, 8, 1, 2048, nullptr);
+  REQUIRE(result.aborted);
+  REQUIRE(result.nodes <= 4096);
+}
+
+}  // namespace bby::test
@@ -52,6 +52,28 @@ TEST_CASE("score_moves prioritizes TT move", "[moveorder]") {
   REQUIRE(moves[0] == tt_move);
 }
 
+TEST_CASE("MovePicker orders the root by recorded subtree effort", "[moveorder][root]") {
+  Position pos = Position::from_fen(kStartFen, true);
+  const Move big = make_move(Square::A2, Square::A3);
+  const Move small = make_move(Square::H2, Square::H3);
+  RootEffort effort;
+  effort.record(big, 50'000);
+  effort.record(small, 2'000);
+
+  TTEntry tt_entry{};
+  tt_entry.best_move = make_move(Square::G1, Square::F3);
+  OrderingContext ctx{};
+  ctx.pos = &pos;
+  ctx.tt = &tt_entry;
+  ctx.root_effort = &effort;
+
+  MovePicker picker(pos, ctx);
+  // Previous best first, then descending effort ahead of cold moves.
+  REQUIRE(picker.next() == tt_entry.best_move);
+  REQUIRE(picker.next() == big);
+  REQUIRE(picker.next() == small);
+}
+
 TEST_CASE("score_moves ranks higher value captures first", "[moveorder]") {
   Position pos = Position::from_fen("4k3/8/4n3/3p4/4Q3/8/8/4K3 w - - 0 1", true);
   MoveList moves;
@@ -111,6 +133,70 @@ TEST_CASE("score_moves boosts killer and history moves", "[moveorder]") {
   REQUIRE(moves[0] == killer);
 }
 
+TEST_CASE("history gravity saturates and recovers", "[moveorder]") {
+  HistoryTable history{};
+  const Move move = make_move(Square::E2, Square::E4, MoveFlag::DoublePush);
+  for (int iter = 0; iter < 1'000; ++iter) {
+    history.add(Color::White, move, 5'000);
+  }
+  const int saturated = history.get(Color::White, move);
+  REQUIRE(saturated <= 32'000);
+  REQUIRE(saturated > 30'000);
+
+  // A single contrary result must pull a saturated entry back into play.
+  history.add(Color::White, move, -5'000);
+  REQUIRE(history.get(Color::White, move) < saturated);
+}
+
+TEST_CASE("score_moves boosts counter-history replies", "[moveorder]") {
+  // Position after 1.e4: black to move, parent move is the pawn push.
+  Position pos = Position::from_fen(
+      "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1", true);
+  MoveList moves;
+  pos.generate_moves(moves, GenStage::All);
+  const Move parent = make_move(Square::E2, Square::E4, MoveFlag::DoublePush);
+  const Move reply = make_move(Square::G8, Square::F6);
+
+  CounterHistory counters{};
+  const Piece parent_piece = pos.piece_on(to_square(parent));
+  REQUIRE(parent_piece == Piece::WPawn);
+  const std::size_t prev_idx = CounterHistory::index(parent_piece, parent);
+  counters.add(prev_idx, pos.piece_on(from_square(reply)), reply, 800);
+
+  OrderingContext ctx{};
+  ctx.pos = &pos;
+  ctx.counter_history = &counters;
+  ctx.parent_move = parent;
+  ctx.counter_history_weight = 1.0;
+
+  std::array<int, kMaxMoves> scores{};
+  score_moves(moves, ctx, scores);
+  select_best_move(moves, scores, 0, moves.size());
+  REQUIRE(moves[0] == reply);
+}
+
+TEST_CASE("score_moves blends capture history into capture ordering", "[moveorder]") {
+  // The e4 pawn can take either knight; MVV/LVA scores the two captures
+  // identically, so the learned signal must break the tie.
+  Position pos = Position::from_fen("4k3/8/8/3n1n2/4P3/8/8/4K3 w - - 0 1", true);
+  MoveList moves;
+  pos.generate_moves(moves, GenStage::Captures);
+  REQUIRE(moves.size() == 2);
+
+  CaptureHistory captures{};
+  const Move preferred = make_move(Square::E4, Square::D5, MoveFlag::Capture);
+  captures.add(Piece::WPawn, Square::D5, PieceType::Knight, 8'000);
+
+  OrderingContext ctx{};
+  ctx.pos = &pos;
+  ctx.capture_history = &captures;
+
+  std::array<int, kMaxMoves> scores{};
+  score_moves(moves, ctx, scores);
+  select_best_move(moves, scores, 0, moves.size());
+  REQUIRE(moves[0] == preferred);
+}
+
 TEST_CASE("SEE estimates material gain", "[moveorder]") {
   Position pos = Position::from_fen("4k3/8/8/3n4/4P3/8/8/4K3 w - - 0 1", true);
   Move capture = make_move(Square::E4, Square::D5, MoveFlag::Capture);
@@ -137,6 +223,26 @@ TEST_CASE("SEE rewards promotion captures", "[moveorder]") {
   REQUIRE(see(pos, promo) > 0);
 }
 
+TEST_CASE("see_ge matches exact SEE at the threshold boundary", "[moveorder]") {
+  Position pos = Position::from_fen("4k3/8/4p3/3p4/4Q3/8/8/4K3 w - - 0 1", true);
+  const Move capture = make_move(Square::E4, Square::D5, MoveFlag::Capture);
+  const int exact = see(pos, capture);
+  REQUIRE(exact < 0);
+  REQUIRE(see_ge(pos, capture, exact));
+  REQUIRE_FALSE(see_ge(pos, capture, exact + 1));
+  REQUIRE(see_ge(pos, capture, exact - 100));
+}
+
+TEST_CASE("see_ge handles quiet moves and winning exchanges", "[moveorder]") {
+  Position pos = Position::from_fen("4k3/8/8/3n4/4P3/8/8/4K3 w - - 0 1", true);
+  const Move capture = make_move(Square::E4, Square::D5, MoveFlag::Capture);
+  REQUIRE(see_ge(pos, capture, 0));
+  REQUIRE_FALSE(see_ge(pos, capture, 1'000));
+  const Move quiet = make_move(Square::E4, Square::E5, MoveFlag::Quiet);
+  REQUIRE(see_ge(pos, quiet, 0));
+  REQUIRE_FALSE(see_ge(pos, quiet, 1));
+}
+
 TEST_CASE("SeeCache reuses stored results", "[moveorder]") {
   Position pos = Position::from_fen("4k3/8/4p3/3p4/4Q3/8/8/4K3 w - - 0 1", true);
   Move move = make_move(Square::E4, Square::D5, MoveFlag::Capture);
@@ -177,4 +283,55 @@ TEST_CASE("score_moves leaves SEE deferred for favorable trades", "[moveorder]")
   REQUIRE(see_entry > 0);
 }
 
+TEST_CASE("MovePicker yields TT move, captures, killers, then quiets", "[moveorder]") {
+  // White can capture on d5 with the e4 pawn; everything else is quiet.
+  Position pos = Position::from_fen(
+      "rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq - 0 2", true);
+  MoveList all;
+  pos.generate_moves(all, GenStage::All);
+
+  OrderingContext ctx = make_ctx(pos);
+  TTEntry tt{};
+  tt.best_move = make_move(Square::G1, Square::F3);
+  ctx.tt = &tt;
+  ctx.killers[0] = make_move(Square::B1, Square::C3);
+
+  MovePicker picker(pos, ctx);
+  const Move first = picker.next();
+  REQUIRE(first == tt.best_move);
+  const Move second = picker.next();
+  REQUIRE(second == make_move(Square::E4, Square::D5, MoveFlag::Capture));
+  const Move third = picker.next();
+  REQUIRE(third == ctx.killers[0]);
+
+  // The remaining yields are the quiets, without repeating earlier stages.
+  std::size_t yielded = 3;
+  for (Move m = picker.next(); !m.is_null(); m = picker.next()) {
+    REQUIRE(m != first);
+    REQUIRE(m != second);
+    REQUIRE(m != third);
+    ++yielded;
+  }
+  REQUIRE(yielded == all.size());
+}
+
+TEST_CASE("MovePicker drops stale TT moves and killers", "[moveorder]") {
+  Position pos = Position::from_fen(kStartFen, true);
+  OrderingContext ctx = make_ctx(pos);
+  TTEntry tt{};
+  // A knight hop that does not exist in this position.
+  tt.best_move = make_move(Square::G1, Square::E4);
+  ctx.tt = &tt;
+  ctx.killers[0] = make_move(Square::E4, Square::E5);
+
+  MovePicker picker(pos, ctx);
+  std::size_t yielded = 0;
+  for (Move m = picker.next(); !m.is_null(); m = picker.next()) {
+    REQUIRE(m != tt.best_move);
+    REQUIRE(m != ctx.killers[0]);
+    ++yielded;
+  }
+  REQUIRE(yielded == 20);
+}
+
 }  // namespace bby::test
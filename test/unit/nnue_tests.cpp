@@ -0,0 +1,102 @@
+#include "nnue.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "board.h"
+#include "eval.h"
+
+namespace bby::test {
+
+namespace {
+
+// Serializes a deterministic toy network in the "bbynn01" dump layout.
+std::vector<unsigned char> make_test_network() {
+  std::vector<unsigned char> bytes;
+  const auto push_i16 = [&](std::int16_t value) {
+    unsigned char raw[2];
+    std::memcpy(raw, &value, sizeof(raw));
+    bytes.insert(bytes.end(), raw, raw + sizeof(raw));
+  };
+  const char magic[8] = {'b', 'b', 'y', 'n', 'n', '0', '1', '\0'};
+  bytes.insert(bytes.end(), magic, magic + sizeof(magic));
+  const std::uint32_t hidden = kNnueHidden;
+  unsigned char raw32[4];
+  std::memcpy(raw32, &hidden, sizeof(raw32));
+  bytes.insert(bytes.end(), raw32, raw32 + sizeof(raw32));
+
+  for (int h = 0; h < kNnueHidden; ++h) {
+    push_i16(static_cast<std::int16_t>(h % 5));
+  }
+  for (int feature = 0; feature < kNnueInputs; ++feature) {
+    for (int h = 0; h < kNnueHidden; ++h) {
+      push_i16(static_cast<std::int16_t>((feature * 31 + h * 7) % 11 - 5));
+    }
+  }
+  for (int h = 0; h < 2 * kNnueHidden; ++h) {
+    push_i16(static_cast<std::int16_t>((h * 13) % 9 - 4));
+  }
+  const std::int32_t output_bias = 640;
+  std::memcpy(raw32, &output_bias, sizeof(raw32));
+  bytes.insert(bytes.end(), raw32, raw32 + sizeof(raw32));
+  return bytes;
+}
+
+}  // namespace
+
+TEST_CASE("NNUE network loads, evaluates incrementally and unloads", "[nnue]") {
+  const auto path =
+      (std::filesystem::temp_directory_path() / "bby_nnue_test.net").string();
+  {
+    const auto bytes = make_test_network();
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(bytes.data()),
+              static_cast<std::streamsize>(bytes.size()));
+  }
+
+  REQUIRE_FALSE(nnue_available());
+  auto pos = Position::from_fen(
+      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", false);
+  const Score pesto = evaluate(pos);
+
+  REQUIRE(nnue_load(path));
+  REQUIRE(nnue_available());
+
+  // A truncated dump must be rejected without disturbing the loaded net.
+  REQUIRE_FALSE(nnue_load(path + ".missing"));
+  REQUIRE(nnue_available());
+
+  // Play a few structurally different moves; the incrementally maintained
+  // accumulator has to agree with a from-scratch refresh at every step.
+  const Move line[] = {
+      make_move(Square::E2, Square::E4, MoveFlag::DoublePush),
+      make_move(Square::D7, Square::D5, MoveFlag::DoublePush),
+      make_move(Square::E4, Square::D5, MoveFlag::Capture),
+      make_move(Square::G8, Square::F6),
+  };
+  Undo undos[4];
+  int idx = 0;
+  for (const Move m : line) {
+    pos.make(m, undos[idx++]);
+    const Score incremental = evaluate(pos);
+    const auto rebuilt = Position::from_fen(pos.to_fen(), false);
+    REQUIRE(incremental == evaluate(rebuilt));
+  }
+  for (int step = 3; step >= 0; --step) {
+    pos.unmake(line[step], undos[step]);
+  }
+  const auto rebuilt = Position::from_fen(pos.to_fen(), false);
+  REQUIRE(evaluate(pos) == evaluate(rebuilt));
+
+  nnue_unload();
+  REQUIRE_FALSE(nnue_available());
+  REQUIRE(evaluate(pos) == pesto);
+
+  std::filesystem::remove(path);
+}
+
+}  // namespace bby::test
@@ -45,4 +45,34 @@ TEST_CASE("Perft reference suite matches expected counts", "[perft][reference]")
   }
 }
 
+TEST_CASE("Parallel perft matches serial counts", "[perft]") {
+  const Position start = Position::from_fen(
+      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", true);
+  const Position kiwipete = Position::from_fen(
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+      true);
+  REQUIRE(perft_parallel(start, 4, 4) == 197281ULL);
+  REQUIRE(perft_parallel(kiwipete, 3, 4) == 97862ULL);
+  // Degenerate splits: single thread and depths below the split threshold.
+  REQUIRE(perft_parallel(start, 4, 1) == 197281ULL);
+  REQUIRE(perft_parallel(start, 1, 8) == 20ULL);
+  REQUIRE(perft_parallel(start, 0, 8) == 1ULL);
+}
+
+TEST_CASE("Perft cache preserves counts and survives sharing", "[perft]") {
+  Position pos = Position::from_fen(
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+      true);
+  PerftCache cache(1);
+  REQUIRE(perft(pos, 3, &cache) == 97862ULL);
+  // A second pass is answered from the cache with the same count.
+  REQUIRE(perft(pos, 3, &cache) == 97862ULL);
+  // A different depth for the same key must miss, not alias.
+  REQUIRE(perft(pos, 2, &cache) == 2039ULL);
+  // Shared across parallel workers.
+  const Position start = Position::from_fen(
+      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", true);
+  REQUIRE(perft_parallel(start, 4, 4, &cache) == 197281ULL);
+}
+
 }  // namespace bby::test
@@ -2,6 +2,8 @@
 
 #include <catch2/catch_test_macros.hpp>
 #include <sstream>
+#include <string>
+#include <vector>
 
 namespace bby::test {
 
@@ -43,4 +45,109 @@ TEST_CASE("PGN reader ignores variations and annotations", "[pgn]") {
   REQUIRE(game.result == "1/2-1/2");
 }
 
+TEST_CASE("ingest_pgn_stream parses chunks in input order", "[pgn]") {
+  std::string corpus;
+  for (int game = 0; game < 12; ++game) {
+    corpus += "[Event \"Game " + std::to_string(game) + "\"]\n";
+    corpus += "[Site \"Internet\"]\n\n";
+    corpus += "1. e4 e5 2. Nf3 Nc6 {book} 1-0\n\n";
+  }
+
+  std::istringstream stream(corpus);
+  std::vector<PgnGameView> games;
+  std::vector<std::string> arenas;
+  // A tiny chunk size forces many chunks so ordering actually gets exercised.
+  const std::size_t total = ingest_pgn_stream(
+      stream,
+      [&](PgnChunk&& chunk) {
+        REQUIRE(chunk.errors.empty());
+        arenas.push_back(std::move(chunk.text));
+        for (auto& parsed : chunk.games) {
+          games.push_back(std::move(parsed));
+        }
+      },
+      64);
+
+  REQUIRE(total == 12);
+  REQUIRE(games.size() == 12);
+  for (std::size_t idx = 0; idx < games.size(); ++idx) {
+    REQUIRE(games[idx].tag("Event") == "Game " + std::to_string(idx));
+    REQUIRE(games[idx].tag("Site") == "Internet");
+    REQUIRE_FALSE(games[idx].tag("White").has_value());
+    REQUIRE(games[idx].moves.size() == 4);
+    REQUIRE(games[idx].moves.front().san == "e4");
+    REQUIRE(games[idx].moves.back().comment == "book");
+    REQUIRE(games[idx].result == "1-0");
+  }
+}
+
+TEST_CASE("ingest_pgn_stream aggregates per-game errors", "[pgn]") {
+  const char* kPgn = R"([Event "Good"]
+
+1. d4 d5 1/2-1/2
+
+[Event broken tag
+
+1. e4 e5 *
+
+[Event "Also good"]
+
+1. c4 *
+)";
+  std::istringstream stream(kPgn);
+  std::size_t games = 0;
+  std::vector<std::string> errors;
+  ingest_pgn_stream(
+      stream,
+      [&](PgnChunk&& chunk) {
+        games += chunk.games.size();
+        for (auto& error : chunk.errors) {
+          errors.push_back(std::move(error));
+        }
+      });
+  REQUIRE(games == 3);
+  REQUIRE(errors.size() == 1);
+  REQUIRE(errors.front() == "invalid PGN tag line");
+}
+
+TEST_CASE("write_pgn_game round-trips through the reader", "[pgn]") {
+  const std::vector<std::pair<std::string, std::string>> tags = {
+      {"Event", "Writer Test"},
+      {"White", "bby-a"},
+      {"Black", "bby-b"},
+      {"Result", "1-0"},
+  };
+  const std::vector<std::string> moves = {"e4", "e5", "Nf3", "Nc6", "Bb5"};
+
+  std::ostringstream out;
+  write_pgn_game(out, tags, moves, "1-0");
+
+  std::istringstream stream(out.str());
+  PgnReader reader(stream);
+  PgnGame game;
+  std::string error;
+  REQUIRE(reader.read_next(game, error));
+  REQUIRE(error.empty());
+  REQUIRE(game.tags.at("Event") == "Writer Test");
+  REQUIRE(game.tags.at("White") == "bby-a");
+  REQUIRE(game.moves.size() == moves.size());
+  for (std::size_t idx = 0; idx < moves.size(); ++idx) {
+    REQUIRE(game.moves[idx].san == moves[idx]);
+  }
+  REQUIRE(game.result == "1-0");
+  REQUIRE_FALSE(reader.read_next(game, error));
+}
+
+TEST_CASE("write_pgn_game numbers a black-to-move start", "[pgn]") {
+  const std::vector<std::pair<std::string, std::string>> tags = {
+      {"Event", "Fragment"},
+  };
+  const std::vector<std::string> moves = {"e5", "Nf3", "Nc6"};
+
+  std::ostringstream out;
+  write_pgn_game(out, tags, moves, "*", 12, true);
+  const std::string text = out.str();
+  REQUIRE(text.find("12... e5 13. Nf3 Nc6 *") != std::string::npos);
+}
+
 }  // namespace bby::test
@@ -90,6 +90,29 @@ TEST_CASE("Search prefers immediate winning capture", "[search]") {
   REQUIRE(result.nodes > 0);
 }
 
+TEST_CASE("Deterministic node-limited search is identical at any thread count",
+          "[search][deterministic]") {
+  const char* fen = "r1bqkbnr/pppp1ppp/2n5/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R b KQkq - 3 3";
+  auto run = [&](int threads) {
+    Position pos = Position::from_fen(fen, false);
+    Limits limits;
+    limits.nodes = 20'000;
+    limits.threads = threads;
+    limits.deterministic = true;
+    return search(pos, limits);
+  };
+
+  const auto base = run(1);
+  REQUIRE_FALSE(base.best.is_null());
+  for (const int threads : {2, 4}) {
+    const auto repeat = run(threads);
+    REQUIRE(repeat.best == base.best);
+    REQUIRE(repeat.nodes == base.nodes);
+    REQUIRE(repeat.depth == base.depth);
+    REQUIRE(repeat.eval == base.eval);
+  }
+}
+
 TEST_CASE("Quiescence search resolves horizon captures", "[search][qsearch]") {
   Position pos = Position::from_fen("4k3/8/8/4q3/4Q3/8/8/4K3 w - - 0 1", false);
   Limits limits;
@@ -187,6 +210,23 @@ TEST_CASE("Search returns multiple PV lines when MultiPV requested", "[search][m
   REQUIRE(result.lines[0].best != result.lines[1].best);
 }
 
+TEST_CASE("MultiPV exclusion passes reuse the shared transposition table", "[search][multipv]") {
+  Position pos = Position::from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", false);
+  Limits single_limits;
+  single_limits.depth = 7;
+  const auto single = search(pos, single_limits);
+
+  Limits multi_limits;
+  multi_limits.depth = 7;
+  multi_limits.multipv = 4;
+  const auto multi = search(pos, multi_limits);
+
+  REQUIRE(multi.lines.size() == 4);
+  // Each extra line re-walks the root over warm TT entries, so four lines
+  // must stay well below four single-PV trees.
+  REQUIRE(multi.nodes < single.nodes * 4);
+}
+
 TEST_CASE("Search applies late move reductions on quiet moves", "[search][lmr]") {
   Position pos = Position::from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", false);
   Limits limits;
@@ -340,4 +380,77 @@ TEST_CASE("Multi-cut pruning detects repeated fail-highs", "[search][multicut]")
   REQUIRE(disabled_result.multi_cut_prunes == 0);
 }
 
+TEST_CASE("SearchSession reuses the transposition table across runs", "[search][session]") {
+  SearchSession session;
+  Limits limits;
+  limits.depth = 5;
+
+  Position first_pos = Position::from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", false);
+  const auto first = session.run(first_pos, limits);
+  REQUIRE_FALSE(first.best.is_null());
+
+  Position second_pos = Position::from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", false);
+  const auto second = session.run(second_pos, limits);
+  REQUIRE_FALSE(second.best.is_null());
+  REQUIRE(second.nodes <= first.nodes);
+
+  session.clear();
+  Position cleared_pos = Position::from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", false);
+  const auto cleared = session.run(cleared_pos, limits);
+  REQUIRE_FALSE(cleared.best.is_null());
+}
+
+TEST_CASE("Search answers tablebase roots without searching", "[search][syzygy]") {
+  Position pos = Position::from_fen("3k4/8/3K4/8/8/8/8/3Q4 w - - 0 1", false);
+  Limits limits;
+  limits.depth = 8;
+
+  const auto result = search(pos, limits);
+  REQUIRE_FALSE(result.best.is_null());
+  REQUIRE(pos.is_legal(result.best));
+  REQUIRE(result.nodes == 0);
+  REQUIRE(result.tb_hits >= 1);
+  REQUIRE(result.eval > 10000);
+}
+
+TEST_CASE("SearchSession accumulates persistent searchstats counters", "[search][session][stats]") {
+  SearchSession session;
+  Limits limits;
+  limits.depth = 5;
+
+  Position pos = Position::from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", false);
+  session.run(pos, limits);
+  const SearchStats first = session.stats();
+  REQUIRE(first.interior_nodes > 0);
+  REQUIRE(first.qsearch_nodes > 0);
+  REQUIRE(first.tt_probes[0] > 0);
+  REQUIRE(first.beta_cutoffs ==
+          first.cutoff_first_move + first.cutoff_moves_2_to_4 + first.cutoff_late_moves);
+
+  // Counters persist across searches on the same session.
+  Position again = Position::from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", false);
+  session.run(again, limits);
+  const SearchStats second = session.stats();
+  REQUIRE(second.interior_nodes > first.interior_nodes);
+
+  // ucinewgame drops them along with the rest of the session state.
+  session.clear();
+  const SearchStats cleared = session.stats();
+  REQUIRE(cleared.interior_nodes == 0);
+  REQUIRE(cleared.beta_cutoffs == 0);
+}
+
+TEST_CASE("Lazy SMP search returns a legal best move", "[search][smp]") {
+  Position pos = Position::from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", false);
+  Limits limits;
+  limits.depth = 5;
+  limits.threads = 4;
+
+  const auto result = search(pos, limits);
+  REQUIRE_FALSE(result.best.is_null());
+  REQUIRE(pos.is_legal(result.best));
+  REQUIRE(result.depth >= 5);
+  REQUIRE(result.nodes > 0);
+}
+
 }  // namespace bby::test
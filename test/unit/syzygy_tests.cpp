@@ -0,0 +1,75 @@
+#include "syzygy/tbprobe.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <string_view>
+
+namespace bby::test {
+
+namespace {
+syzygy::Wdl probe(std::string_view fen) {
+  Position pos = Position::from_fen(fen, false);
+  const auto wdl = syzygy::probe_wdl(pos);
+  REQUIRE(wdl.has_value());
+  return *wdl;
+}
+}  // namespace
+
+TEST_CASE("Tablebases score basic 3-man material correctly", "[syzygy]") {
+  // Queen and rook win from either side to move.
+  REQUIRE(probe("3k4/8/3K4/8/8/8/8/3Q4 w - - 0 1") == syzygy::Wdl::Win);
+  REQUIRE(probe("3k4/8/3K4/8/8/8/8/3Q4 b - - 0 1") == syzygy::Wdl::Loss);
+  REQUIRE(probe("8/8/8/4k3/8/8/8/KR6 w - - 0 1") == syzygy::Wdl::Win);
+  // A lone minor piece cannot force mate.
+  REQUIRE(probe("8/8/8/4k3/8/8/8/KB6 w - - 0 1") == syzygy::Wdl::Draw);
+  REQUIRE(probe("8/8/8/4k3/8/8/8/KN6 b - - 0 1") == syzygy::Wdl::Draw);
+}
+
+TEST_CASE("Tablebases know the classic KPK results", "[syzygy]") {
+  // Rook pawn with the defender in front: dead draw.
+  REQUIRE(probe("k7/8/8/8/8/8/P7/K7 w - - 0 1") == syzygy::Wdl::Draw);
+  // King on the key square with the opposition wins; without it, draws.
+  REQUIRE(probe("4k3/8/4K3/4P3/8/8/8/8 w - - 0 1") == syzygy::Wdl::Win);
+  REQUIRE(probe("4k3/8/8/4K3/4P3/8/8/8 b - - 0 1") == syzygy::Wdl::Draw);
+  // Unreachable promotion race.
+  REQUIRE(probe("8/4P3/8/8/8/8/8/K6k w - - 0 1") == syzygy::Wdl::Win);
+}
+
+TEST_CASE("Tablebase root probe returns a converting move", "[syzygy]") {
+  Position mate_in_one = Position::from_fen("7k/8/5K2/8/8/8/6Q1/8 w - - 0 1", false);
+  const auto best = syzygy::probe_root(mate_in_one);
+  REQUIRE(best.has_value());
+  REQUIRE(best->wdl == syzygy::Wdl::Win);
+  REQUIRE(best->dtm == 1);
+
+  Position promo = Position::from_fen("8/4P3/8/8/8/8/8/K6k w - - 0 1", false);
+  const auto converting = syzygy::probe_root(promo);
+  REQUIRE(converting.has_value());
+  REQUIRE(converting->wdl == syzygy::Wdl::Win);
+  REQUIRE(converting->move == make_move(Square::E7, Square::E8, MoveFlag::Promotion,
+                                        PieceType::Queen));
+}
+
+TEST_CASE("TbCache stores and evicts direct-mapped", "[syzygy]") {
+  syzygy::TbCache cache;
+  syzygy::Wdl out{};
+  REQUIRE_FALSE(cache.probe(0x1234u, out));
+  cache.store(0x1234u, syzygy::Wdl::Win);
+  REQUIRE(cache.probe(0x1234u, out));
+  REQUIRE(out == syzygy::Wdl::Win);
+  // A colliding key replaces the slot; the old entry must not answer anymore.
+  cache.store(0x1234u + (1u << 13), syzygy::Wdl::Loss);
+  REQUIRE_FALSE(cache.probe(0x1234u, out));
+  cache.clear();
+  REQUIRE_FALSE(cache.probe(0x1234u + (1u << 13), out));
+}
+
+TEST_CASE("Probes decline material outside coverage", "[syzygy]") {
+  Position start = Position::from_fen(
+      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", false);
+  REQUIRE_FALSE(syzygy::probe_wdl(start).has_value());
+  // Bare kings are a trivial draw rather than a declined probe.
+  Position bare = Position::from_fen("8/8/8/4k3/8/8/8/4K3 w - - 0 1", false);
+  REQUIRE(syzygy::probe_wdl(bare) == syzygy::Wdl::Draw);
+}
+
+}  // namespace bby::test
@@ -32,6 +32,18 @@ TEST_CASE("compute_time_budget respects minimum move time", "[timeman]") {
   REQUIRE(budget.hard_ms >= budget.soft_ms);
 }
 
+TEST_CASE("compute_time_budget grants a ponder bonus", "[timeman]") {
+  Limits limits;
+  limits.wtime_ms = 60'000;
+  limits.winc_ms = 1'000;
+  limits.movetime_ms = -1;
+  limits.ponder = true;
+  const auto budget = compute_time_budget(limits, Color::White);
+  // A quarter more than the 3'500 the same clock yields without ponder.
+  REQUIRE(budget.soft_ms == 4'375);
+  REQUIRE(budget.hard_ms == 4'425);
+}
+
 TEST_CASE("compute_time_budget honors movestogo when provided", "[timeman]") {
   Limits limits;
   limits.wtime_ms = 120'000;
@@ -26,8 +26,8 @@ void uci_fuzz_feed(std::string_view payload);
 
 namespace bby::test {
 
-TEST_CASE("Bench suite exposes 12 valid FENs", "[uci][bench]") {
-  REQUIRE(kBenchFens.size() == 12);
+TEST_CASE("Bench suite exposes 50 valid FENs", "[uci][bench]") {
+  REQUIRE(kBenchFens.size() == 50);
   for (const auto fen : kBenchFens) {
     REQUIRE_NOTHROW(Position::from_fen(fen, true));
   }
@@ -54,6 +54,41 @@ TEST_CASE("repropack emits deterministic metadata", "[uci][repro]") {
   REQUIRE(repro->find("fen=") != std::string::npos);
 }
 
+TEST_CASE("Position replay cache matches from-scratch rebuilds", "[uci][position]") {
+  std::vector<std::string> lines;
+  g_output_sink = &lines;
+  set_uci_writer(&capture_output);
+
+  // The second and third commands extend the first, exercising the suffix
+  // path; the fourth does not, forcing a rebuild.
+  const std::string script =
+      "uci\nisready\n"
+      "position startpos moves e2e4\n"
+      "position startpos moves e2e4 e7e5\n"
+      "position startpos moves e2e4 e7e5 g1f3\n"
+      "repropack\n"
+      "position startpos moves d2d4\n"
+      "repropack\n";
+  uci_fuzz_feed(script);
+
+  set_uci_writer(nullptr);
+  g_output_sink = nullptr;
+
+  std::vector<std::string> repros;
+  for (const std::string& line : lines) {
+    if (line.rfind("info string repro ", 0) == 0) {
+      repros.push_back(line);
+    }
+  }
+  REQUIRE(repros.size() == 2);
+  REQUIRE(repros[0].find(
+              "fen=rnbqkbnr/pppp1ppp/8/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R b KQkq - 1 2"
+              " zobrist=") != std::string::npos);
+  REQUIRE(repros[1].find(
+              "fen=rnbqkbnr/pppppppp/8/8/3P4/8/PPP1PPPP/RNBQKBNR b KQkq d3 0 1"
+              " zobrist=") != std::string::npos);
+}
+
 TEST_CASE("Stop returns current best move", "[uci][stop]") {
   std::vector<std::string> lines;
   g_output_sink = &lines;
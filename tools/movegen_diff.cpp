@@ -0,0 +1,215 @@
+// movegen_diff.cpp -- Differential movegen tester against the vendored
+// chess-library oracle (see movegen_diff_oracle.h). Worker threads
+// random-walk games from the start position, and at every node diff the
+// legal move set produced by Position::generate_moves against the oracle's,
+// then make every move on both boards and compare the resulting piece
+// placement, side to move, and castling rights, plus a bby-side
+// make/unmake round trip of zobrist key and FEN. The en passant FEN field
+// is deliberately excluded from the state comparison: bby records the
+// square after every double push while the oracle only records it when a
+// legal capture exists, and a semantic divergence still surfaces as a
+// move-set diff one ply later.
+
+#include "bbinit.h"
+#include "board.h"
+#include "movegen_diff_oracle.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Options {
+  std::string fen;
+  std::int64_t positions{1'000'000};
+  int threads{0};
+  int max_ply{200};
+  std::uint64_t seed{0x5eedf00dULL};
+};
+
+Options parse(int argc, char** argv) {
+  Options opt;
+  opt.fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if ((arg == "-f" || arg == "--fen") && i + 1 < argc) {
+      opt.fen = argv[++i];
+    } else if ((arg == "-n" || arg == "--positions") && i + 1 < argc) {
+      opt.positions = std::stoll(argv[++i]);
+    } else if ((arg == "-t" || arg == "--threads") && i + 1 < argc) {
+      opt.threads = std::stoi(argv[++i]);
+    } else if (arg == "--max-ply" && i + 1 < argc) {
+      opt.max_ply = std::stoi(argv[++i]);
+    } else if (arg == "--seed" && i + 1 < argc) {
+      opt.seed = std::stoull(argv[++i]);
+    }
+  }
+  return opt;
+}
+
+// First three space-separated FEN fields: placement, side, castling.
+std::string fen_prefix(const std::string& fen) {
+  std::size_t pos = 0;
+  for (int i = 0; i < 3 && pos != std::string::npos; ++i) {
+    pos = fen.find(' ', pos + 1);
+  }
+  return fen.substr(0, pos);
+}
+
+std::vector<std::string> bby_move_set(const bby::MoveList& moves) {
+  std::vector<std::string> out;
+  out.reserve(moves.size());
+  for (const bby::Move move : moves) {
+    out.push_back(bby::move_to_uci(move));
+  }
+  std::sort(out.begin(), out.end());
+  return out;
+}
+
+std::string join(const std::vector<std::string>& items) {
+  std::ostringstream oss;
+  for (std::size_t i = 0; i < items.size(); ++i) {
+    if (i != 0) {
+      oss << ' ';
+    }
+    oss << items[i];
+  }
+  return oss.str();
+}
+
+struct Shared {
+  std::atomic<std::int64_t> positions{0};
+  std::atomic<bool> failed{false};
+  std::mutex report_mutex;
+};
+
+void report(Shared& shared, const std::string& message) {
+  std::lock_guard<std::mutex> lock(shared.report_mutex);
+  std::cerr << message << "\n";
+  shared.failed.store(true, std::memory_order_relaxed);
+}
+
+// Diffs one position: move sets first, then make/unmake state for every
+// move. Returns false on any mismatch so the walk restarts from a clean
+// position instead of compounding the divergence.
+bool check_position(bby::Position& pos, const oracle::Board& board,
+                    Shared& shared) {
+  bby::MoveList moves;
+  pos.generate_moves(moves, bby::GenStage::All);
+  const auto bby_set = bby_move_set(moves);
+  const auto oracle_set = board.legal_moves();
+  if (bby_set != oracle_set) {
+    std::ostringstream oss;
+    oss << "move set mismatch fen=\"" << pos.to_fen() << "\"\n"
+        << "  bby:    " << join(bby_set) << "\n"
+        << "  oracle: " << join(oracle_set);
+    report(shared, oss.str());
+    return false;
+  }
+  const std::string fen_before = pos.to_fen();
+  const std::uint64_t key_before = pos.zobrist();
+  for (const bby::Move move : moves) {
+    const std::string uci = bby::move_to_uci(move);
+    bby::Undo undo;
+    pos.make(move, undo);
+    const std::string bby_after = fen_prefix(pos.to_fen());
+    const std::string oracle_after = fen_prefix(board.fen_after(uci));
+    if (bby_after != oracle_after) {
+      std::ostringstream oss;
+      oss << "make state mismatch fen=\"" << fen_before << "\" move=" << uci
+          << "\n  bby:    " << bby_after << "\n  oracle: " << oracle_after;
+      report(shared, oss.str());
+      pos.unmake(move, undo);
+      return false;
+    }
+    pos.unmake(move, undo);
+    if (pos.zobrist() != key_before || pos.to_fen() != fen_before) {
+      std::ostringstream oss;
+      oss << "unmake mismatch fen=\"" << fen_before << "\" move=" << uci
+          << " restored=\"" << pos.to_fen() << "\"";
+      report(shared, oss.str());
+      return false;
+    }
+  }
+  return true;
+}
+
+void worker(const Options& options, std::size_t index, Shared& shared) {
+  std::mt19937_64 rng(options.seed + 0x9e3779b97f4a7c15ULL * (index + 1));
+  while (!shared.failed.load(std::memory_order_relaxed) &&
+         shared.positions.load(std::memory_order_relaxed) < options.positions) {
+    bby::Position pos = bby::Position::from_fen(options.fen, false);
+    oracle::Board board(options.fen);
+    for (int ply = 0; ply < options.max_ply; ++ply) {
+      if (shared.failed.load(std::memory_order_relaxed) ||
+          shared.positions.fetch_add(1, std::memory_order_relaxed) >=
+              options.positions) {
+        return;
+      }
+      if (!check_position(pos, board, shared)) {
+        break;
+      }
+      bby::MoveList moves;
+      pos.generate_moves(moves, bby::GenStage::All);
+      if (moves.size() == 0) {
+        break;
+      }
+      const bby::Move move = moves[rng() % moves.size()];
+      const std::string uci = bby::move_to_uci(move);
+      bby::Undo undo;
+      pos.make(move, undo);
+      if (!board.make(uci)) {
+        // check_position already proved the sets match, so this cannot
+        // happen without an oracle bug; restart the walk regardless.
+        break;
+      }
+    }
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  [[maybe_unused]] const auto init_state = bby::initialize();
+  const Options options = parse(argc, argv);
+  int thread_count = options.threads;
+  if (thread_count <= 0) {
+    thread_count = static_cast<int>(std::thread::hardware_concurrency());
+    if (thread_count <= 0) {
+      thread_count = 1;
+    }
+  }
+
+  Shared shared;
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  workers.reserve(static_cast<std::size_t>(thread_count));
+  for (int i = 0; i < thread_count; ++i) {
+    workers.emplace_back(worker, std::cref(options),
+                         static_cast<std::size_t>(i), std::ref(shared));
+  }
+  for (auto& thread : workers) {
+    thread.join();
+  }
+  const auto end = std::chrono::steady_clock::now();
+  const auto elapsed_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+  const std::int64_t checked = std::min<std::int64_t>(
+      shared.positions.load(std::memory_order_relaxed), options.positions);
+  std::cout << "movegen-diff positions=" << checked
+            << " threads=" << thread_count << " seed=" << options.seed
+            << " time_ms=" << elapsed_ms
+            << (shared.failed.load(std::memory_order_relaxed) ? " FAILED" : " ok")
+            << "\n";
+  return shared.failed.load(std::memory_order_relaxed) ? 1 : 0;
+}
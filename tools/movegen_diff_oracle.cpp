@@ -0,0 +1,70 @@
+// movegen_diff_oracle.cpp -- chess-library backing for the oracle::Board
+// wrapper. This is the only translation unit that includes chess.hpp.
+
+#include "movegen_diff_oracle.h"
+
+#include "chess.hpp"
+
+#include <algorithm>
+
+namespace oracle {
+
+struct Board::Impl {
+  chess::Board board;
+};
+
+namespace {
+
+// Finds the legal move whose non-960 UCI rendering matches `uci`; returns
+// chess::Move::NO_MOVE when absent.
+chess::Move find_move(const chess::Board& board, const std::string& uci) {
+  chess::Movelist moves;
+  chess::movegen::legalmoves(moves, board);
+  for (const chess::Move move : moves) {
+    if (chess::uci::moveToUci(move, /*chess960=*/false) == uci) {
+      return move;
+    }
+  }
+  return chess::Move(chess::Move::NO_MOVE);
+}
+
+}  // namespace
+
+Board::Board(const std::string& fen) : impl_(new Impl{chess::Board(fen)}) {}
+
+Board::~Board() = default;
+
+std::vector<std::string> Board::legal_moves() const {
+  chess::Movelist moves;
+  chess::movegen::legalmoves(moves, impl_->board);
+  std::vector<std::string> out;
+  out.reserve(static_cast<std::size_t>(moves.size()));
+  for (const chess::Move move : moves) {
+    out.push_back(chess::uci::moveToUci(move, /*chess960=*/false));
+  }
+  std::sort(out.begin(), out.end());
+  return out;
+}
+
+std::string Board::fen_after(const std::string& uci) const {
+  const chess::Move move = find_move(impl_->board, uci);
+  if (move == chess::Move(chess::Move::NO_MOVE)) {
+    return std::string();
+  }
+  chess::Board scratch = impl_->board;
+  scratch.makeMove(move);
+  return scratch.getFen();
+}
+
+bool Board::make(const std::string& uci) {
+  const chess::Move move = find_move(impl_->board, uci);
+  if (move == chess::Move(chess::Move::NO_MOVE)) {
+    return false;
+  }
+  impl_->board.makeMove(move);
+  return true;
+}
+
+std::string Board::fen() const { return impl_->board.getFen(); }
+
+}  // namespace oracle
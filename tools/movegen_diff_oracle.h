@@ -0,0 +1,38 @@
+#pragma once
+// movegen_diff_oracle.h -- Thin pimpl wrapper around the vendored
+// chess-library board, used as the reference implementation by
+// movegen_diff.cpp. Keeping chess.hpp confined to the wrapper's own
+// translation unit keeps the 8k-line header out of the driver TU and pins
+// the oracle behind a UCI-string interface, so the diff can never
+// accidentally compare through shared code.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace oracle {
+
+class Board {
+public:
+  explicit Board(const std::string& fen);
+  ~Board();
+  Board(const Board&) = delete;
+  Board& operator=(const Board&) = delete;
+
+  // Sorted UCI strings for every legal move in the current position.
+  [[nodiscard]] std::vector<std::string> legal_moves() const;
+
+  // FEN after playing `uci` on a copy; empty string if no such legal move.
+  [[nodiscard]] std::string fen_after(const std::string& uci) const;
+
+  // Plays `uci` in place; returns false (board unchanged) if illegal.
+  bool make(const std::string& uci);
+
+  [[nodiscard]] std::string fen() const;
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace oracle
@@ -3,6 +3,7 @@
 #include "perft.h"
 
 #include <chrono>
+#include <memory>
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -15,6 +16,8 @@ struct Options {
   std::string epd_path;
   std::string suite_path;
   int depth{4};
+  int threads{1};
+  int hash_mb{0};
   bool split{false};
 };
 
@@ -31,6 +34,10 @@ Options parse(int argc, char** argv) {
       opt.epd_path = argv[++i];
     } else if ((arg == "-s" || arg == "--suite") && i + 1 < argc) {
       opt.suite_path = argv[++i];
+    } else if ((arg == "-t" || arg == "--threads") && i + 1 < argc) {
+      opt.threads = std::stoi(argv[++i]);
+    } else if (arg == "--hash" && i + 1 < argc) {
+      opt.hash_mb = std::stoi(argv[++i]);
     } else if (arg == "--split") {
       opt.split = true;
     }
@@ -43,6 +50,11 @@ Options parse(int argc, char** argv) {
 int main(int argc, char** argv) {
   [[maybe_unused]] const auto init_state = bby::initialize();
   const Options options = parse(argc, argv);
+  std::unique_ptr<bby::PerftCache> cache;
+  if (options.hash_mb > 0) {
+    cache = std::make_unique<bby::PerftCache>(
+        static_cast<std::size_t>(options.hash_mb));
+  }
   if (!options.suite_path.empty()) {
     std::ifstream suite(options.suite_path);
     if (!suite) {
@@ -70,7 +82,7 @@ int main(int argc, char** argv) {
       const std::uint64_t expected = std::stoull(line.substr(second_bar + 1));
       bby::Position pos = bby::Position::from_fen(fen, false);
       const auto start = std::chrono::steady_clock::now();
-      const std::uint64_t nodes = bby::perft(pos, depth);
+      const std::uint64_t nodes = bby::perft_parallel(pos, depth, options.threads, cache.get());
       const auto end = std::chrono::steady_clock::now();
       const auto elapsed_ms =
           std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
@@ -105,7 +117,7 @@ int main(int argc, char** argv) {
     for (std::size_t idx = 0; idx < load_result.records.size(); ++idx) {
       bby::Position pos = load_result.records[idx].position;
       const auto start = std::chrono::steady_clock::now();
-      const std::uint64_t nodes = bby::perft(pos, options.depth);
+      const std::uint64_t nodes = bby::perft_parallel(pos, options.depth, options.threads, cache.get());
       const auto end = std::chrono::steady_clock::now();
       const auto elapsed_ms =
           std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
@@ -136,7 +148,8 @@ int main(int argc, char** argv) {
     for (const bby::Move move : moves) {
       bby::Undo undo;
       pos.make(move, undo);
-      const std::uint64_t nodes = bby::perft(pos, options.depth - 1);
+      const std::uint64_t nodes = bby::perft_parallel(
+          pos, options.depth - 1, options.threads, cache.get());
       pos.unmake(move, undo);
       total += nodes;
       std::cout << bby::move_to_uci(move) << ": " << nodes << "\n";
@@ -146,7 +159,7 @@ int main(int argc, char** argv) {
   }
 
   const auto start = std::chrono::steady_clock::now();
-  std::uint64_t nodes = bby::perft(pos, options.depth);
+  std::uint64_t nodes = bby::perft_parallel(pos, options.depth, options.threads, cache.get());
   const auto end = std::chrono::steady_clock::now();
   const auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
 
@@ -1,8 +1,11 @@
 #include <iostream>
 #include <string>
-#include "../third_party/chess-library/chess.hpp"
+
+#include "bbinit.h"
+#include "board.h"
 
 int main() {
+  (void)bby::initialize();
   std::string fen;
   if (!std::getline(std::cin, fen)) {
     std::cerr << "missing fen" << std::endl;
@@ -14,13 +17,13 @@ int main() {
     return 1;
   }
   try {
-    chess::Board board(fen);
-    const chess::Move move = chess::uci::parseSan(board, san);
-    if (move == chess::Move::NO_MOVE) {
+    const bby::Position pos = bby::Position::from_fen(fen);
+    const bby::Move move = bby::move_from_san(pos, san);
+    if (move.is_null()) {
       std::cerr << "error: no move" << std::endl;
       return 1;
     }
-    std::cout << chess::uci::moveToUci(move) << std::endl;
+    std::cout << bby::move_to_uci(move) << std::endl;
   } catch (const std::exception& ex) {
     std::cerr << "error: " << ex.what() << std::endl;
     return 1;